@@ -1,29 +1,50 @@
 @echo off
 setlocal
 
+rem build.bat --static: one executable with built-in ciphers (no plugin DLLs), built with LTO.
+if "%1"=="--static" (
+    echo Building static executable with LTO...
+    g++ -O2 -flto -DCIPHER_STATIC_PLUGINS -o cipher_tool.exe main.cpp plugin\plugin_host.cpp plugin\pipeline.cpp plugin\stdio_stream.cpp plugin\stats_collector.cpp plugin\crc_framing.cpp runtime\thread_pool.cpp runtime\text_encoding.cpp runtime\crc32c.cpp runtime\streebog.cpp runtime\cipher_async.cpp gost\gost.cpp gost\gost_checkpoint.cpp gost\gost_compress.cpp gost\gost_delta.cpp gost\gost_file.cpp gost\gost_archive.cpp gost\gost_plugin.cpp morse\morse.cpp morse\morse_plugin.cpp rot13\rot13_bitwise.cpp rot13\rot13_simd.cpp rot13\rot13_plugin.cpp -I./plugin -I./gost -I./morse -I./rot13 -I./runtime -pthread -lpsapi
+    if errorlevel 1 (
+        echo Static executable compilation failed.
+        exit /b 1
+    )
+    echo.
+    echo Build successful!
+    exit /b 0
+)
+
+rem Shared thread pool: every cipher library and the executable use one copy.
+echo Building runtime library...
+g++ -O2 -shared -DCIPHER_RUNTIME_BUILD -o libcipher_runtime.dll runtime\thread_pool.cpp runtime\text_encoding.cpp runtime\crc32c.cpp runtime\streebog.cpp runtime\cipher_async.cpp -I./runtime -pthread
+if errorlevel 1 (
+    echo Runtime library compilation failed.
+    exit /b 1
+)
+
 echo Building GOST library...
-g++ -shared -o libgost_cipher.dll gost\gost.cpp gost\gost_bridge.cpp -I./gost
+g++ -O2 -shared -o libgost_cipher.dll gost\gost.cpp gost\gost_checkpoint.cpp gost\gost_compress.cpp gost\gost_delta.cpp gost\gost_file.cpp gost\gost_archive.cpp gost\gost_bridge.cpp gost\gost_plugin.cpp -I./gost -I./plugin -I./runtime -L. -lcipher_runtime
 if errorlevel 1 (
     echo GOST library compilation failed.
     exit /b 1
 )
 
 echo Building Morse library...
-g++ -shared -o libmorse_cipher.dll morse\morse.cpp morse\morse_bridge.cpp -I./morse
+g++ -O2 -shared -o libmorse_cipher.dll morse\morse.cpp morse\morse_bridge.cpp morse\morse_plugin.cpp -I./morse -I./plugin -I./runtime -L. -lcipher_runtime
 if errorlevel 1 (
     echo Morse library compilation failed.
     exit /b 1
 )
 
 echo Building ROT13 library...
-g++ -shared -o librot13_cipher.dll rot13\rot13_bitwise.cpp rot13\rot13_bridge.cpp -I./rot13
+g++ -O2 -shared -o librot13_cipher.dll rot13\rot13_bitwise.cpp rot13\rot13_simd.cpp rot13\rot13_bridge.cpp rot13\rot13_plugin.cpp -I./rot13 -I./plugin -I./runtime -pthread -L. -lcipher_runtime
 if errorlevel 1 (
     echo ROT13 library compilation failed.
     exit /b 1
 )
 
 echo Building main executable...
-g++ main.cpp -o cipher_tool.exe -I./gost -I./morse -I./rot13
+g++ -O2 main.cpp plugin\plugin_host.cpp plugin\pipeline.cpp plugin\stdio_stream.cpp plugin\stats_collector.cpp plugin\crc_framing.cpp -o cipher_tool.exe -I./plugin -I./runtime -pthread -lpsapi -L. -lcipher_runtime
 if errorlevel 1 (
     echo Main executable compilation failed.
     exit /b 1
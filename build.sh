@@ -3,18 +3,45 @@
 # Прекратить выполнение при любой ошибке
 set -e
 
+# CIPHER_USDT=1 ./build.sh — с точками трассировки USDT в шифрах (plugin/cipher_probes.h),
+# нужен заголовок <sys/sdt.h> из пакета systemtap-sdt-dev.
+USDT_FLAGS=""
+if [ "${CIPHER_USDT:-0}" = "1" ]; then
+    USDT_FLAGS="-DCIPHER_USDT"
+fi
+
+# ./build.sh --static — один исполняемый файл со встроенными шифрами, без плагинов.
+# Шифры регистрируются на этапе компиляции, сборка с LTO.
+if [ "$1" = "--static" ]; then
+    echo "Сборка статического исполняемого файла (LTO)..."
+    g++ -O2 -flto=auto -DCIPHER_STATIC_PLUGINS $USDT_FLAGS -o cipher_tool main.cpp plugin/plugin_host.cpp plugin/pipeline.cpp plugin/stdio_stream.cpp plugin/stats_collector.cpp plugin/crc_framing.cpp \
+        runtime/thread_pool.cpp runtime/text_encoding.cpp runtime/crc32c.cpp runtime/streebog.cpp runtime/cipher_async.cpp gost/gost.cpp gost/gost_checkpoint.cpp gost/gost_compress.cpp gost/gost_delta.cpp gost/gost_file.cpp gost/gost_archive.cpp gost/gost_plugin.cpp morse/morse.cpp morse/morse_plugin.cpp \
+        rot13/rot13_bitwise.cpp rot13/rot13_simd.cpp rot13/rot13_plugin.cpp \
+        -I./plugin -I./gost -I./morse -I./rot13 -I./runtime -pthread -ldl
+    echo ""
+    echo "Сборка успешно завершена!"
+    exit 0
+fi
+
+# Общий пул потоков: библиотеки шифров и программа связываются с одной копией,
+# а находят её рядом с собой ($ORIGIN).
+RUNTIME_LINK="-L. -lcipher_runtime -Wl,-rpath,\$ORIGIN"
+
+echo "Сборка общей библиотеки потоков..."
+g++ -O2 -shared -fPIC -DCIPHER_RUNTIME_BUILD -o libcipher_runtime.so runtime/thread_pool.cpp runtime/text_encoding.cpp runtime/crc32c.cpp runtime/streebog.cpp runtime/cipher_async.cpp -I./runtime -pthread
+
 echo "Сборка библиотеки GOST..."
-g++ -shared -fPIC -o libgost_cipher.so gost/gost.cpp gost/gost_bridge.cpp -I./gost
+g++ -O2 -shared -fPIC $USDT_FLAGS -o libgost_cipher.so gost/gost.cpp gost/gost_checkpoint.cpp gost/gost_compress.cpp gost/gost_delta.cpp gost/gost_file.cpp gost/gost_archive.cpp gost/gost_bridge.cpp gost/gost_plugin.cpp -I./gost -I./plugin -I./runtime $RUNTIME_LINK
 
 echo "Сборка библиотеки Morse..."
-g++ -shared -fPIC -o libmorse_cipher.so morse/morse.cpp morse/morse_bridge.cpp -I./morse
+g++ -O2 -shared -fPIC $USDT_FLAGS -o libmorse_cipher.so morse/morse.cpp morse/morse_bridge.cpp morse/morse_plugin.cpp -I./morse -I./plugin -I./runtime $RUNTIME_LINK
 
 echo "Сборка библиотеки ROT13..."
-g++ -shared -fPIC -o librot13_cipher.so rot13/rot13_bitwise.cpp rot13/rot13_bridge.cpp -I./rot13
+g++ -O2 -shared -fPIC $USDT_FLAGS -o librot13_cipher.so rot13/rot13_bitwise.cpp rot13/rot13_simd.cpp rot13/rot13_bridge.cpp rot13/rot13_plugin.cpp -I./rot13 -I./plugin -I./runtime -pthread $RUNTIME_LINK
 
 echo "Сборка основного исполняемого файла..."
-# Флаг -ldl необходим для функций dlopen/dlsym
-g++ main.cpp -o cipher_tool -ldl -I./gost -I./morse -I./rot13
+# Шифры загружаются как плагины, флаг -ldl необходим для функций dlopen/dlsym
+g++ -O2 main.cpp plugin/plugin_host.cpp plugin/pipeline.cpp plugin/stdio_stream.cpp plugin/stats_collector.cpp plugin/crc_framing.cpp -o cipher_tool -ldl -I./plugin -I./runtime -pthread $RUNTIME_LINK
 
 echo ""
 echo "Сборка успешно завершена!"
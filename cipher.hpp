@@ -0,0 +1,216 @@
+#ifndef CIPHER_HPP
+#define CIPHER_HPP
+
+// Типизированный C++ API для встраивания шифров в другие программы — без
+// плагинов, C-моста и промежуточных C-структур. Собирается вместе со
+// статической библиотекой шифров (CMake: CIPHER_STATIC=ON, цель cipher_static)
+// или с исходниками gost/, morse/ и rot13/ напрямую.
+//
+// У всех шифров общий интерфейс:
+//   Bytes encode(const Bytes&) const, Bytes decode(const Bytes&) const,
+//   void encodeFile(in, out) const, void decodeFile(in, out) const,
+// а ошибки сообщаются исключением cipher::Error. Поэтому код можно писать
+// обобщённо, например template <class Tag> void f(const Cipher<Tag>&).
+
+#include "gost/gost.hpp"
+#include "morse/morse.h"
+#include "rot13/rot13_bitwise.h"
+#include "rot13/rot13_simd.h"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cipher {
+
+using Bytes = std::vector<unsigned char>;
+
+class Error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Теги шифров.
+struct Gost {};
+struct Morse {};
+struct Rot13 {};
+
+template <class Tag>
+class Cipher;
+
+// ГОСТ 28147-89 в режиме CBC с PKCS7. encode возвращает IV и шифротекст подряд —
+// в том же формате, что и файл, зашифрованный encodeFile.
+template <>
+class Cipher<Gost> {
+public:
+    static constexpr const char* name = "gost";
+
+    explicit Cipher(const std::string& key_hex) : key_(parseKey(key_hex)) {}
+
+    static Cipher generate() {
+        GostKeyGenResult result = generateKeyGOST();
+        if (!result.success) throw Error(result.error_message);
+        return Cipher(result.key_hex);
+    }
+
+    std::string keyHex() const { return bytesToHexString(key_); }
+
+    // Шифрует с заданным IV (пустой — случайный); использованный IV возвращается через iv.
+    Bytes encrypt(const Bytes& plaintext, Bytes& iv) const {
+        if (iv.empty()) generateRandomBytes(iv, GOST_IV_SIZE_BYTES);
+        checkIv(iv);
+        return gost_encrypt_data(plaintext, key_, iv);
+    }
+
+    Bytes decrypt(const Bytes& ciphertext, const Bytes& iv) const {
+        checkIv(iv);
+        return gost_decrypt_data(ciphertext, key_, iv);
+    }
+
+    Bytes encode(const Bytes& plaintext) const {
+        Bytes iv;
+        Bytes ciphertext = encrypt(plaintext, iv);
+        iv.insert(iv.end(), ciphertext.begin(), ciphertext.end());
+        return iv;
+    }
+
+    Bytes decode(const Bytes& data) const {
+        if (data.size() < GOST_IV_SIZE_BYTES) throw Error("Ciphertext is shorter than the IV.");
+        Bytes iv(data.begin(), data.begin() + GOST_IV_SIZE_BYTES);
+        return decrypt(Bytes(data.begin() + GOST_IV_SIZE_BYTES, data.end()), iv);
+    }
+
+    // Возвращает использованный IV (hex).
+    std::string encodeFile(const std::string& inputPath, const std::string& outputPath,
+                           const std::string& iv_hex = "", const GostFileOptions& options = {}) const {
+        GostFileOperationResult result = encryptFileGOST(inputPath, outputPath, keyHex(), iv_hex, options);
+        if (!result.success) throw Error(result.message);
+        return result.used_iv_hex;
+    }
+
+    void decodeFile(const std::string& inputPath, const std::string& outputPath) const {
+        GostFileOperationResult result = decryptFileGOST(inputPath, outputPath, keyHex());
+        if (!result.success) throw Error(result.message);
+    }
+
+private:
+    static Bytes parseKey(const std::string& key_hex) {
+        Bytes key;
+        try {
+            key = hexStringToBytes(key_hex);
+        } catch (const std::exception& e) {
+            throw Error(e.what());
+        }
+        if (key.size() != GOST_KEY_SIZE_BYTES) {
+            throw Error("Invalid key length. Must be " + std::to_string(GOST_KEY_SIZE_BYTES * 2) + " hex characters.");
+        }
+        return key;
+    }
+
+    static void checkIv(const Bytes& iv) {
+        if (iv.size() != GOST_IV_SIZE_BYTES) {
+            throw Error("Invalid IV length. Must be " + std::to_string(GOST_IV_SIZE_BYTES * 2) + " hex characters.");
+        }
+    }
+
+    Bytes key_;
+};
+
+// Универсальный бинарный код Морзе; encodeAudioFile озвучивает файл в WAV.
+template <>
+class Cipher<Morse> {
+public:
+    static constexpr const char* name = "morse";
+
+    explicit Cipher(const MorseAudioParams& audio = {}) : audio_(audio) {}
+
+    Bytes encode(const Bytes& data) const {
+        MorseEncodedResult result = encodeTextToMorse(std::string(data.begin(), data.end()));
+        if (!result.success) throw Error(result.error_message);
+        return std::move(result.binary_data);
+    }
+
+    Bytes decode(const Bytes& data) const {
+        MorseDecodedResult result = decodeTextFromMorse(data);
+        if (!result.success) throw Error(result.error_message);
+        return Bytes(result.plaintext.begin(), result.plaintext.end());
+    }
+
+    void encodeFile(const std::string& inputPath, const std::string& outputPath) const {
+        check(encodeFileToMorse(inputPath, outputPath));
+    }
+
+    void decodeFile(const std::string& inputPath, const std::string& outputPath) const {
+        check(decodeFileFromMorse(inputPath, outputPath));
+    }
+
+    void encodeAudioFile(const std::string& inputPath, const std::string& outputPath) const {
+        check(encodeFileToMorseWav(inputPath, outputPath, audio_));
+    }
+
+private:
+    static void check(const MorseFileOperationResult& result) {
+        if (!result.success) throw Error(result.message);
+    }
+
+    MorseAudioParams audio_;
+};
+
+// ROT-N + XOR. Таблицы и ядро готовятся в конструкторе; transform вызывает
+// ядро напрямую и позволяет обрабатывать данные без копирования, на месте или частями.
+template <>
+class Cipher<Rot13> {
+public:
+    static constexpr const char* name = "rot13";
+
+    explicit Cipher(const Rot13Options& options = {}) : options_(options), cipher_(makeCipher(options)) {}
+
+    // offset — позиция in[0] от начала данных (фаза ключа XOR). В режиме кириллицы
+    // при final == false незавершённая пара в конце не обрабатывается; возвращается
+    // число обработанных байт.
+    std::size_t transform(const unsigned char* in, unsigned char* out, std::size_t size, Rot13XorDirection direction,
+                          std::uint64_t offset = 0, bool final = true) const {
+        if (options_.cyrillic) return cipher_.transformUtf8(in, out, size, direction, final, offset);
+        cipher_.transform(in, out, size, direction, offset);
+        return size;
+    }
+
+    Bytes encode(const Bytes& data) const { return transformed(data, Rot13XorDirection::Encode); }
+    Bytes decode(const Bytes& data) const { return transformed(data, Rot13XorDirection::Decode); }
+
+    void encodeFile(const std::string& inputPath, const std::string& outputPath) const {
+        check(encodeFileRot13Xor(inputPath, outputPath, options_));
+    }
+
+    void decodeFile(const std::string& inputPath, const std::string& outputPath) const {
+        check(decodeFileRot13Xor(inputPath, outputPath, options_));
+    }
+
+private:
+    static Rot13XorCipher makeCipher(const Rot13Options& options) {
+        try {
+            return Rot13XorCipher(options.rotation, options.xor_key);
+        } catch (const std::invalid_argument& e) {
+            throw Error(e.what());
+        }
+    }
+
+    static void check(const FileOperationResult& result) {
+        if (!result.success) throw Error(result.message);
+    }
+
+    Bytes transformed(const Bytes& data, Rot13XorDirection direction) const {
+        Bytes out(data.size());
+        transform(data.data(), out.data(), data.size(), direction);
+        return out;
+    }
+
+    Rot13Options options_;
+    Rot13XorCipher cipher_;
+};
+
+} // namespace cipher
+
+#endif // CIPHER_HPP
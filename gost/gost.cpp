@@ -1,5 +1,16 @@
 #include "gost.hpp"
+#include "cipher_probes.h"
+#include "cipher_progress.hpp"
+#include "cipher_stats.hpp"
+#include "gost_archive.hpp"
+#include "gost_checkpoint.hpp"
+#include "gost_compress.hpp"
+#include "gost_delta.hpp"
+#include "gost_file.hpp"
+#include "text_encoding.hpp"
+#include "thread_pool.h"
 #include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -68,6 +79,7 @@ void pkcs7_pad(std::vector<unsigned char> &data, size_t block_size) {
     if (padding_len == 0)
         padding_len =
             block_size;
+    CIPHER_PROBE(gost, pad, padding_len);
     for (size_t i = 0; i < padding_len; ++i) {
         data.push_back(static_cast<unsigned char>(padding_len));
     }
@@ -77,18 +89,48 @@ bool pkcs7_unpad(std::vector<unsigned char> &data) {
     if (data.empty())
         return false;
     unsigned char padding_len = data.back();
-    if (padding_len == 0 || padding_len > data.size() ||
-        padding_len > GOST_BLOCK_SIZE_BYTES) {
-        return false;
+    bool ok = padding_len != 0 && padding_len <= data.size() &&
+              padding_len <= GOST_BLOCK_SIZE_BYTES;
+    for (size_t i = 0; ok && i < padding_len; ++i) {
+        ok = data[data.size() - 1 - i] == padding_len;
     }
-    for (size_t i = 0; i < padding_len; ++i) {
-        if (data[data.size() - 1 - i] != padding_len) {
-            return false;
-        }
+    CIPHER_PROBE(gost, unpad, padding_len, ok);
+    if (!ok) {
+        return false;
     }
     data.resize(data.size() - padding_len);
     return true;
 }
+// Заглушка ядра: байт на позиции position преобразуется с key[position % 32] ^ iv[position % 8].
+static void gost_apply_placeholder(const unsigned char *in, unsigned char *out,
+                                   size_t size, size_t position,
+                                   const unsigned char *key,
+                                   const unsigned char *iv) {
+    CIPHER_PROBE(gost, chunk_start, position, size);
+    for (size_t i = 0; i < size; ++i) {
+        out[i] = in[i] ^ key[(position + i) % GOST_KEY_SIZE_BYTES] ^
+                 iv[(position + i) % GOST_IV_SIZE_BYTES];
+    }
+    CIPHER_PROBE(gost, chunk_done, position, size);
+}
+
+// Байт заглушки зависит только от своей позиции, поэтому большие объёмы
+// делятся на части между потоками общего пула (runtime/thread_pool.h).
+static const size_t GOST_PARALLEL_THRESHOLD = 4 << 20;
+
+static void gost_apply(const unsigned char *in, unsigned char *out, size_t size,
+                       size_t position, const unsigned char *key,
+                       const unsigned char *iv) {
+    if (size < GOST_PARALLEL_THRESHOLD) {
+        gost_apply_placeholder(in, out, size, position, key, iv);
+        return;
+    }
+    cipherParallelFor(size, 0, 0, [&](uint64_t begin, uint64_t end, unsigned) {
+        gost_apply_placeholder(in + begin, out + begin, end - begin,
+                               position + begin, key, iv);
+    });
+}
+
 void gost_cbc_encrypt_placeholder(const std::vector<unsigned char> &plaintext,
                                   std::vector<unsigned char> &ciphertext,
                                   const std::vector<unsigned char> &key,
@@ -101,10 +143,8 @@ void gost_cbc_encrypt_placeholder(const std::vector<unsigned char> &plaintext,
     pkcs7_pad(padded_plaintext, GOST_BLOCK_SIZE_BYTES);
 
     ciphertext.resize(padded_plaintext.size());
-    for (size_t i = 0; i < padded_plaintext.size(); ++i) {
-        ciphertext[i] =
-            padded_plaintext[i] ^ key[i % key.size()] ^ iv[i % iv.size()];
-    }
+    gost_apply(padded_plaintext.data(), ciphertext.data(),
+               padded_plaintext.size(), 0, key.data(), iv.data());
 }
 
 bool gost_cbc_decrypt_placeholder(const std::vector<unsigned char> &ciphertext,
@@ -119,10 +159,8 @@ bool gost_cbc_decrypt_placeholder(const std::vector<unsigned char> &ciphertext,
     }
 
     std::vector<unsigned char> decrypted_padded_data(ciphertext.size());
-    for (size_t i = 0; i < ciphertext.size(); ++i) {
-        decrypted_padded_data[i] =
-            ciphertext[i] ^ key[i % key.size()] ^ iv[i % iv.size()];
-    }
+    gost_apply(ciphertext.data(), decrypted_padded_data.data(),
+               ciphertext.size(), 0, key.data(), iv.data());
     if (!pkcs7_unpad(decrypted_padded_data)) {
         plaintext.clear();
         return false;
@@ -144,6 +182,7 @@ gost_encrypt_data(const std::vector<unsigned char> &plaintext,
                                     std::to_string(GOST_IV_SIZE_BYTES) +
                                     " bytes.");
     }
+    CIPHER_PROBE(gost, key_setup, 1);
     std::vector<unsigned char> ciphertext;
     gost_cbc_encrypt_placeholder(plaintext, ciphertext, key, iv);
     return ciphertext;
@@ -167,15 +206,586 @@ gost_decrypt_data(const std::vector<unsigned char> &ciphertext,
         return {};
     }
 
+    CIPHER_PROBE(gost, key_setup, 0);
     std::vector<unsigned char> plaintext;
     if (!gost_cbc_decrypt_placeholder(ciphertext, plaintext, key, iv)) {
         throw std::runtime_error("Decryption failed (e.g., invalid padding).");
     }
     return plaintext;
 }
+
+size_t gost_ciphertext_size(size_t plaintext_size) {
+    return (plaintext_size / GOST_BLOCK_SIZE_BYTES + 1) * GOST_BLOCK_SIZE_BYTES;
+}
+
+void gost_encrypt_into(const unsigned char *in, size_t size,
+                       const unsigned char *key, const unsigned char *iv,
+                       unsigned char *out) {
+    // Последний неполный блок с дополнением собирается отдельно до записи в out,
+    // чтобы out мог совпадать с in.
+    size_t full = size - size % GOST_BLOCK_SIZE_BYTES;
+    unsigned char last[GOST_BLOCK_SIZE_BYTES];
+    size_t tail = size - full;
+    std::copy(in + full, in + size, last);
+    std::fill(last + tail, last + GOST_BLOCK_SIZE_BYTES,
+              static_cast<unsigned char>(GOST_BLOCK_SIZE_BYTES - tail));
+    CIPHER_PROBE(gost, pad, GOST_BLOCK_SIZE_BYTES - tail);
+    gost_apply(in, out, full, 0, key, iv);
+    gost_apply_placeholder(last, out + full, GOST_BLOCK_SIZE_BYTES, full, key, iv);
+}
+
+// Те же проверки, что и в pkcs7_unpad, но только по последнему блоку: tail —
+// последние size (1..GOST_BLOCK_SIZE_BYTES) байт шифротекста с позиции position.
+static bool gost_padding_length(const unsigned char *tail, size_t size,
+                                uint64_t position, const unsigned char *key,
+                                const unsigned char *iv, size_t &padding_len) {
+    unsigned char last[GOST_BLOCK_SIZE_BYTES];
+    gost_apply_placeholder(tail, last, size, position, key, iv);
+    padding_len = last[size - 1];
+    bool ok = padding_len != 0 && padding_len <= size;
+    for (size_t i = 0; ok && i < padding_len; ++i) {
+        ok = last[size - 1 - i] == padding_len;
+    }
+    CIPHER_PROBE(gost, unpad, padding_len, ok);
+    return ok;
+}
+
+bool gost_plaintext_size(const unsigned char *in, size_t size,
+                         const unsigned char *key, const unsigned char *iv,
+                         size_t &plaintext_size) {
+    if (size == 0) {
+        plaintext_size = 0;
+        return true;
+    }
+    size_t checked = std::min<size_t>(size, GOST_BLOCK_SIZE_BYTES);
+    size_t padding_len;
+    if (!gost_padding_length(in + size - checked, checked, size - checked, key,
+                             iv, padding_len)) {
+        return false;
+    }
+    plaintext_size = size - padding_len;
+    return true;
+}
+
+void gost_decrypt_into(const unsigned char *in, size_t plaintext_size,
+                       const unsigned char *key, const unsigned char *iv,
+                       unsigned char *out) {
+    gost_apply(in, out, plaintext_size, 0, key, iv);
+}
+
+void gost_apply_keystream(const unsigned char *in, unsigned char *out, size_t size,
+                          uint64_t position, const unsigned char *key,
+                          const unsigned char *iv) {
+    gost_apply(in, out, size, static_cast<size_t>(position), key, iv);
+}
+
+GostStreamCipher::GostStreamCipher(const std::vector<unsigned char> &key,
+                                   const std::vector<unsigned char> &iv,
+                                   bool encrypt, uint64_t position)
+    : encrypt_(encrypt), position_(position) {
+    if (key.size() != GOST_KEY_SIZE_BYTES || iv.size() != GOST_IV_SIZE_BYTES) {
+        throw std::invalid_argument("Invalid key or IV size for GOST stream.");
+    }
+    // Байт i преобразуется с key[i % 32] ^ iv[i % 8]; период гаммы — 32 байта.
+    for (size_t i = 0; i < GOST_KEY_SIZE_BYTES; ++i) {
+        pad_[i] = key[i] ^ iv[i % GOST_IV_SIZE_BYTES];
+    }
+    CIPHER_PROBE(gost, key_setup, encrypt);
+}
+
+void GostStreamCipher::apply(const unsigned char *data, size_t size,
+                             std::vector<unsigned char> &out) {
+    size_t start = out.size();
+    out.resize(start + size);
+    CIPHER_PROBE(gost, chunk_start, position_, size);
+    for (size_t i = 0; i < size; ++i) {
+        out[start + i] = data[i] ^ pad_[(position_ + i) % GOST_KEY_SIZE_BYTES];
+    }
+    CIPHER_PROBE(gost, chunk_done, position_, size);
+    position_ += size;
+}
+
+void GostStreamCipher::update(const unsigned char *data, size_t size,
+                              std::vector<unsigned char> &out) {
+    if (encrypt_) {
+        apply(data, size, out);
+        return;
+    }
+    // Последние GOST_BLOCK_SIZE_BYTES байт могут оказаться дополнением.
+    size_t total = pending_.size() + size;
+    if (total <= GOST_BLOCK_SIZE_BYTES) {
+        pending_.insert(pending_.end(), data, data + size);
+        return;
+    }
+    size_t ready = total - GOST_BLOCK_SIZE_BYTES;
+    size_t from_pending = std::min(ready, pending_.size());
+    apply(pending_.data(), from_pending, out);
+    pending_.erase(pending_.begin(), pending_.begin() + from_pending);
+    apply(data, ready - from_pending, out);
+    pending_.insert(pending_.end(), data + (ready - from_pending), data + size);
+}
+
+void GostStreamCipher::finish(std::vector<unsigned char> &out) {
+    if (encrypt_) {
+        unsigned char padding[GOST_BLOCK_SIZE_BYTES];
+        size_t padding_len = GOST_BLOCK_SIZE_BYTES - position_ % GOST_BLOCK_SIZE_BYTES;
+        std::fill(padding, padding + padding_len, static_cast<unsigned char>(padding_len));
+        CIPHER_PROBE(gost, pad, padding_len);
+        apply(padding, padding_len, out);
+        return;
+    }
+    if (position_ == 0 && pending_.empty()) {
+        return;
+    }
+    std::vector<unsigned char> last;
+    apply(pending_.data(), pending_.size(), last);
+    pending_.clear();
+    if (!pkcs7_unpad(last)) {
+        throw std::runtime_error("Decryption failed (e.g., invalid padding).");
+    }
+    out.insert(out.end(), last.begin(), last.end());
+}
+
+static void store_le32(unsigned char *out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+static uint32_t load_le32(const unsigned char *in) {
+    return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8 |
+           static_cast<uint32_t>(in[2]) << 16 |
+           static_cast<uint32_t>(in[3]) << 24;
+}
+
+bool gost_is_framed(const unsigned char *data, size_t size) {
+    return size >= sizeof(GOST_FRAMED_MAGIC) &&
+           std::equal(GOST_FRAMED_MAGIC,
+                      GOST_FRAMED_MAGIC + sizeof(GOST_FRAMED_MAGIC), data);
+}
+
+GostFramedEncoder::GostFramedEncoder(const std::vector<unsigned char> &key,
+                                     const std::vector<unsigned char> &iv,
+                                     uint32_t flags)
+    : cipher_(key, iv, true), iv_(iv), flags_(flags) {
+    if (flags & ~GOST_FRAMED_KNOWN_FLAGS) {
+        throw std::invalid_argument("Unsupported framed file flags.");
+    }
+}
+
+GostFramedEncoder::GostFramedEncoder(const std::vector<unsigned char> &key,
+                                     const std::vector<unsigned char> &iv,
+                                     uint32_t flags, uint64_t position)
+    : cipher_(key, iv, true, position), iv_(iv), flags_(flags),
+      header_written_(true) {
+    if (flags & ~GOST_FRAMED_KNOWN_FLAGS) {
+        throw std::invalid_argument("Unsupported framed file flags.");
+    }
+}
+
+void GostFramedEncoder::writeHeader(std::vector<unsigned char> &out) {
+    if (header_written_) {
+        return;
+    }
+    unsigned char header[GOST_FRAMED_HEADER_SIZE];
+    std::copy(GOST_FRAMED_MAGIC, GOST_FRAMED_MAGIC + sizeof(GOST_FRAMED_MAGIC),
+              header);
+    store_le32(header + 8, flags_);
+    store_le32(header + 12, GOST_FRAMED_CHUNK_SIZE);
+    std::copy(iv_.begin(), iv_.end(), header + 16);
+    out.insert(out.end(), header, header + sizeof(header));
+    header_written_ = true;
+}
+
+void GostFramedEncoder::writeChunks(const unsigned char *data, size_t size,
+                                    std::vector<unsigned char> &out) {
+    size_t count = (size + GOST_FRAMED_CHUNK_SIZE - 1) / GOST_FRAMED_CHUNK_SIZE;
+    packed_sizes_.assign(count, 0);
+    if (flags_ & GOST_FRAMED_COMPRESSED) {
+        if (packed_.size() < count) {
+            packed_.resize(count);
+        }
+        // Части цикла совпадают с блоками: размер блока кратен 4 КиБ.
+        auto pack = [&](uint64_t begin, uint64_t end, unsigned) {
+            size_t index = begin / GOST_FRAMED_CHUNK_SIZE;
+            size_t length = end - begin;
+            std::vector<unsigned char> &packed = packed_[index];
+            packed.resize(length - length / GOST_FRAMED_MIN_GAIN);
+            packed_sizes_[index] = gost_lz_compress(data + begin, length,
+                                                    packed.data(), packed.size());
+        };
+        if (count > 1) {
+            cipherParallelFor(size, GOST_FRAMED_CHUNK_SIZE, 0, pack);
+        } else {
+            pack(0, size, 0);
+        }
+    }
+    for (size_t index = 0; index < count; ++index) {
+        size_t begin = index * GOST_FRAMED_CHUNK_SIZE;
+        size_t length = std::min<size_t>(GOST_FRAMED_CHUNK_SIZE, size - begin);
+        size_t packed = packed_sizes_[index];
+        bool raw = packed == 0 || packed >= length;
+        unsigned char word[4];
+        store_le32(word, raw ? static_cast<uint32_t>(length) | GOST_FRAME_RAW
+                             : static_cast<uint32_t>(packed));
+        CIPHER_PROBE(gost, frame, begin, length, raw ? length : packed);
+        cipher_.update(word, sizeof(word), out);
+        cipher_.update(raw ? data + begin : packed_[index].data(),
+                       raw ? length : packed, out);
+    }
+}
+
+void GostFramedEncoder::update(const unsigned char *data, size_t size,
+                               std::vector<unsigned char> &out) {
+    writeHeader(out);
+    if (!pending_.empty()) {
+        size_t take = std::min(size, GOST_FRAMED_CHUNK_SIZE - pending_.size());
+        pending_.insert(pending_.end(), data, data + take);
+        data += take;
+        size -= take;
+        if (pending_.size() < GOST_FRAMED_CHUNK_SIZE) {
+            return;
+        }
+        writeChunks(pending_.data(), pending_.size(), out);
+        pending_.clear();
+    }
+    size_t whole = size - size % GOST_FRAMED_CHUNK_SIZE;
+    if (whole > 0) {
+        writeChunks(data, whole, out);
+    }
+    pending_.insert(pending_.end(), data + whole, data + size);
+}
+
+void GostFramedEncoder::finish(std::vector<unsigned char> &out) {
+    writeHeader(out);
+    if (!pending_.empty()) {
+        writeChunks(pending_.data(), pending_.size(), out);
+        pending_.clear();
+    }
+    cipher_.finish(out);
+}
+
+GostFramedDecoder::GostFramedDecoder(const std::vector<unsigned char> &key)
+    : key_(key) {
+    if (key.size() != GOST_KEY_SIZE_BYTES) {
+        throw std::invalid_argument("Invalid key size for GOST stream.");
+    }
+}
+
+void GostFramedDecoder::readHeader() {
+    if (!gost_is_framed(header_.data(), header_.size())) {
+        throw std::runtime_error("Not a framed GOST file.");
+    }
+    flags_ = load_le32(header_.data() + 8);
+    chunk_size_ = load_le32(header_.data() + 12);
+    if (flags_ & ~GOST_FRAMED_KNOWN_FLAGS) {
+        throw std::runtime_error("Unsupported framed file flags.");
+    }
+    if (chunk_size_ == 0 || chunk_size_ > GOST_FRAMED_MAX_CHUNK_SIZE) {
+        throw std::runtime_error("Invalid chunk size in framed file header.");
+    }
+    iv_.assign(header_.begin() + 16, header_.end());
+    cipher_.reset(new GostStreamCipher(key_, iv_, false));
+}
+
+void GostFramedDecoder::readFrames(std::vector<unsigned char> &out) {
+    size_t position = 0;
+    while (frames_.size() - position >= 4) {
+        uint32_t word = load_le32(frames_.data() + position);
+        bool raw = (word & GOST_FRAME_RAW) != 0;
+        size_t stored = word & ~GOST_FRAME_RAW;
+        if (stored == 0 || stored > chunk_size_ ||
+            (!raw && !(flags_ & GOST_FRAMED_COMPRESSED))) {
+            throw std::runtime_error(
+                "Corrupted frame header at plaintext offset " +
+                std::to_string(plaintext_offset_) + " (wrong key or damaged file).");
+        }
+        if (frames_.size() - position - 4 < stored) {
+            break;
+        }
+        const unsigned char *payload = frames_.data() + position + 4;
+        size_t length = stored;
+        if (raw) {
+            out.insert(out.end(), payload, payload + stored);
+        } else {
+            size_t start = out.size();
+            out.resize(start + chunk_size_);
+            if (!gost_lz_decompress(payload, stored, out.data() + start,
+                                    chunk_size_, length)) {
+                throw std::runtime_error(
+                    "Corrupted compressed chunk at plaintext offset " +
+                    std::to_string(plaintext_offset_) +
+                    " (wrong key or damaged file).");
+            }
+            out.resize(start + length);
+        }
+        CIPHER_PROBE(gost, frame, plaintext_offset_, length, stored);
+        plaintext_offset_ += length;
+        position += 4 + stored;
+    }
+    frames_.erase(frames_.begin(), frames_.begin() + position);
+}
+
+void GostFramedDecoder::update(const unsigned char *data, size_t size,
+                               std::vector<unsigned char> &out) {
+    if (!cipher_) {
+        size_t take = std::min(size, GOST_FRAMED_HEADER_SIZE - header_.size());
+        header_.insert(header_.end(), data, data + take);
+        data += take;
+        size -= take;
+        if (header_.size() < GOST_FRAMED_HEADER_SIZE) {
+            return;
+        }
+        readHeader();
+    }
+    cipher_->update(data, size, frames_);
+    readFrames(out);
+}
+
+void GostFramedDecoder::finish(std::vector<unsigned char> &out) {
+    if (!cipher_) {
+        throw std::runtime_error("Framed file is shorter than its header.");
+    }
+    cipher_->finish(frames_);
+    readFrames(out);
+    if (!frames_.empty()) {
+        throw std::runtime_error("Framed file ends inside a frame at plaintext offset " +
+                                 std::to_string(plaintext_offset_) + ".");
+    }
+}
+
+// Блочный формат читается и пишется частями по GOST_FILE_BLOCK_SIZE, так что
+// память не зависит от размера файла.
+static const size_t GOST_FILE_BLOCK_SIZE = 4 << 20;
+
+// Контрольные точки по ходу gost_transform_file (GostFileOptions::checkpoint_interval):
+// после каждого блока выхода, если с прошлой точки прочитано не меньше
+// interval байт, выход сбрасывается на диск и журнал заменяется новой точкой.
+struct GostCheckpointWriter {
+    std::string path;
+    std::string output_path;
+    uint64_t interval = 0;
+    GostCheckpoint state; // последняя записанная точка
+    uint64_t input_offset = 0;
+    uint64_t output_offset = 0;
+
+    void blockWritten(size_t input_bytes, size_t output_bytes, bool more,
+                      std::ostream &output) {
+        uint64_t block_input = input_offset;
+        uint64_t block_output = output_offset;
+        input_offset += input_bytes;
+        output_offset += output_bytes;
+        // После последнего блока выход уже дополнен — продолжать его нельзя.
+        if (!more || input_offset - state.input_offset < interval) {
+            return;
+        }
+        output.flush();
+        if (!output || !gost_sync_file(output_path)) {
+            throw std::runtime_error("Error flushing output file for a checkpoint.");
+        }
+        state.verify_input_offset = block_input;
+        state.verify_output_offset = block_output;
+        state.input_offset = input_offset;
+        state.output_offset = output_offset;
+        gost_write_checkpoint(path, state);
+    }
+};
+
+template <class Codec>
+static void gost_transform_file(std::istream &input, std::ostream &output,
+                                Codec &codec, const CipherStatsSinkC *stats,
+                                GostCheckpointWriter *checkpoints = nullptr,
+                                CipherProgress *progress = nullptr) {
+    CipherStageTimer readTimer(stats, CIPHER_STAGE_READ);
+    readTimer.pause();
+    CipherStageTimer transformTimer(stats, CIPHER_STAGE_TRANSFORM);
+    transformTimer.pause();
+    CipherStageTimer writeTimer(stats, CIPHER_STAGE_WRITE);
+    writeTimer.pause();
+
+    std::vector<unsigned char> block(GOST_FILE_BLOCK_SIZE);
+    std::vector<unsigned char> out;
+    for (bool more = true; more;) {
+        readTimer.resume();
+        CIPHER_PROBE(gost, read_start, block.size());
+        input.read(reinterpret_cast<char *>(block.data()), block.size());
+        size_t got = static_cast<size_t>(input.gcount());
+        CIPHER_PROBE(gost, read_done, got);
+        readTimer.addBytes(got);
+        readTimer.pause();
+        if (input.bad()) {
+            throw std::runtime_error("Error reading input file content.");
+        }
+        more = static_cast<bool>(input);
+
+        transformTimer.resume();
+        out.clear();
+        codec.update(block.data(), got, out);
+        if (!more) {
+            codec.finish(out);
+        }
+        transformTimer.addBytes(got);
+        transformTimer.pause();
+
+        writeTimer.resume();
+        CIPHER_PROBE(gost, write_start, out.size());
+        output.write(reinterpret_cast<const char *>(out.data()), out.size());
+        if (!more) {
+            output.flush();
+        }
+        CIPHER_PROBE(gost, write_done, out.size());
+        writeTimer.addBytes(out.size());
+        writeTimer.pause();
+        if (!output) {
+            throw std::runtime_error("Error writing output file.");
+        }
+        if (checkpoints) {
+            checkpoints->blockWritten(got, out.size(), more, output);
+        }
+        if (progress && !progress->advance(got) && more) {
+            throw std::runtime_error(CIPHER_CANCELLED_MESSAGE);
+        }
+    }
+}
+
+// Блок прямого ввода-вывода, кратный GOST_DIRECT_IO_ALIGNMENT.
+static const size_t GOST_DIRECT_BLOCK_SIZE = 8 << 20;
+
+// Обычный формат с прямым вводом-выводом (GostFileOptions::direct_io). Вход
+// читается выровненными блоками попеременно в два буфера, и чтение
+// следующего блока идёт параллельно с шифрованием и записью текущего. Выход
+// сдвинут относительно входа на IV, поэтому копится в своём буфере и пишется
+// выровненными частями; невыровненный остаток в конце пишется через кэш и
+// сразу вытесняется из него. Если файловая система не умеет O_DIRECT, блоки
+// идут через кэш и вытесняются после обработки. Возвращает true, если кэш
+// удалось обойти для обоих файлов.
+static bool gost_transform_file_direct(const std::string &inputFilePath,
+                                       const std::string &outputFilePath,
+                                       const std::vector<unsigned char> &key,
+                                       const std::vector<unsigned char> &iv,
+                                       bool encrypt,
+                                       const CipherStatsSinkC *stats,
+                                       const CipherProgressC *progress = nullptr) {
+    const uint64_t INDEX_SPAN = CIPHER_PARALLEL_CHUNK_ALIGNMENT;
+    const size_t BLOCK = GOST_DIRECT_BLOCK_SIZE;
+    const size_t ALIGN = GOST_DIRECT_IO_ALIGNMENT;
+    GostFile input(inputFilePath, false, false, true);
+    GostFile output(outputFilePath, true, true, true);
+    const bool direct = input.direct() && output.direct();
+    const uint64_t input_size = std::filesystem::file_size(inputFilePath);
+    // При расшифровании данные начинаются после IV.
+    const uint64_t skip = encrypt ? 0 : GOST_IV_SIZE_BYTES;
+    const uint64_t data_size = input_size - skip;
+    // При расшифровании последний блок придерживается до проверки дополнения.
+    const size_t hold = encrypt ? 0 : GOST_BLOCK_SIZE_BYTES;
+    CipherProgress tracker(progress, data_size);
+
+    GostAlignedBuffer blocks[2] = {GostAlignedBuffer(BLOCK), GostAlignedBuffer(BLOCK)};
+    size_t sizes[2] = {0, 0};
+    // Блок выхода, невыровненный остаток прошлого и дополнение.
+    GostAlignedBuffer staged(BLOCK + 2 * ALIGN);
+    size_t pending = 0;
+    uint64_t output_offset = 0;
+    if (encrypt) {
+        std::copy(iv.begin(), iv.end(), staged.data());
+        pending = iv.size();
+    }
+
+    auto readBlock = [&](uint64_t index) {
+        CipherStageTimer readTimer(stats, CIPHER_STAGE_READ);
+        uint64_t offset = index * BLOCK;
+        size_t expected = static_cast<size_t>(std::min<uint64_t>(BLOCK, input_size - offset));
+        CIPHER_PROBE(gost, read_start, expected);
+        size_t got = input.readUpTo(blocks[index % 2].data(), BLOCK, offset);
+        CIPHER_PROBE(gost, read_done, got);
+        if (got != expected) {
+            throw std::runtime_error("Input file changed while it was being processed.");
+        }
+        if (!input.direct()) input.dropCache(offset, got);
+        readTimer.addBytes(got);
+        sizes[index % 2] = got;
+    };
+
+    auto processBlock = [&](uint64_t index) {
+        uint64_t offset = index * BLOCK;
+        size_t from = static_cast<size_t>(offset < skip ? skip - offset : 0);
+        size_t size = sizes[index % 2] - from;
+        CipherStageTimer transformTimer(stats, CIPHER_STAGE_TRANSFORM);
+        gost_apply_keystream(blocks[index % 2].data() + from, staged.data() + pending, size,
+                             offset + from - skip, key.data(), iv.data());
+        pending += size;
+        transformTimer.addBytes(size);
+        transformTimer.stop();
+        if (!tracker.advance(size) && offset + BLOCK < input_size) {
+            throw std::runtime_error(CIPHER_CANCELLED_MESSAGE);
+        }
+
+        if (pending <= hold) return;
+        size_t flush = (pending - hold) / ALIGN * ALIGN;
+        if (flush == 0) return;
+        CipherStageTimer writeTimer(stats, CIPHER_STAGE_WRITE);
+        CIPHER_PROBE(gost, write_start, flush);
+        output.writeAt(staged.data(), flush, output_offset);
+        CIPHER_PROBE(gost, write_done, flush);
+        if (!output.direct()) output.dropCache(output_offset, flush);
+        writeTimer.addBytes(flush);
+        output_offset += flush;
+        pending -= flush;
+        std::copy(staged.data() + flush, staged.data() + flush + pending, staged.data());
+    };
+
+    const uint64_t block_count = (input_size + BLOCK - 1) / BLOCK;
+    if (block_count > 0) readBlock(0);
+    for (uint64_t index = 0; index < block_count; ++index) {
+        if (index + 1 == block_count) {
+            processBlock(index);
+            break;
+        }
+        cipherParallelFor(2 * INDEX_SPAN, INDEX_SPAN, 2, [&](uint64_t begin, uint64_t end, unsigned) {
+            for (uint64_t task = begin / INDEX_SPAN; task < end / INDEX_SPAN; ++task) {
+                if (task == 0) {
+                    readBlock(index + 1);
+                } else {
+                    processBlock(index);
+                }
+            }
+        });
+    }
+
+    if (encrypt) {
+        unsigned char padding[GOST_BLOCK_SIZE_BYTES];
+        size_t padding_len = GOST_BLOCK_SIZE_BYTES - data_size % GOST_BLOCK_SIZE_BYTES;
+        std::fill(padding, padding + padding_len, static_cast<unsigned char>(padding_len));
+        CIPHER_PROBE(gost, pad, padding_len);
+        gost_apply_keystream(padding, staged.data() + pending, padding_len, data_size,
+                             key.data(), iv.data());
+        pending += padding_len;
+    } else if (data_size > 0) {
+        // Те же проверки, что в gost_padding_length, но по уже расшифрованному.
+        size_t checked = static_cast<size_t>(std::min<uint64_t>(data_size, GOST_BLOCK_SIZE_BYTES));
+        const unsigned char *last = staged.data() + pending - checked;
+        size_t padding_len = last[checked - 1];
+        bool ok = padding_len != 0 && padding_len <= checked;
+        for (size_t i = 0; ok && i < padding_len; ++i) {
+            ok = last[checked - 1 - i] == padding_len;
+        }
+        CIPHER_PROBE(gost, unpad, padding_len, ok);
+        if (!ok) {
+            throw std::runtime_error("Decryption failed (e.g., invalid padding).");
+        }
+        pending -= padding_len;
+    }
+    CipherStageTimer writeTimer(stats, CIPHER_STAGE_WRITE);
+    output.writeAt(staged.data(), pending, output_offset);
+    output.dropCache(output_offset, 0);
+    writeTimer.addBytes(pending);
+    return direct;
+}
+
 GostEncryptedTextResult encryptTextGOST(const std::string &plaintext_str,
                                         const std::string &key_hex,
-                                        const std::string &initial_iv_hex) {
+                                        const std::string &initial_iv_hex,
+                                        CipherTextEncodingC encoding) {
     GostEncryptedTextResult result;
     try {
         std::vector<unsigned char> key = hexStringToBytes(key_hex);
@@ -205,7 +815,8 @@ GostEncryptedTextResult encryptTextGOST(const std::string &plaintext_str,
             gost_encrypt_data(plaintext_bytes, key, iv);
 
         result.iv_hex = bytesToHexString(iv);
-        result.ciphertext_hex = bytesToHexString(ciphertext_bytes);
+        result.ciphertext_hex = encodeText(encoding, ciphertext_bytes.data(),
+                                           ciphertext_bytes.size());
         result.success = true;
     } catch (const std::exception &e) {
         result.error_message =
@@ -215,7 +826,8 @@ GostEncryptedTextResult encryptTextGOST(const std::string &plaintext_str,
 }
 GostDecryptedTextResult decryptTextGOST(const std::string &iv_hex,
                                         const std::string &ciphertext_hex,
-                                        const std::string &key_hex) {
+                                        const std::string &key_hex,
+                                        CipherTextEncodingC encoding) {
     GostDecryptedTextResult result;
     try {
         std::vector<unsigned char> key = hexStringToBytes(key_hex);
@@ -232,8 +844,13 @@ GostDecryptedTextResult decryptTextGOST(const std::string &iv_hex,
                                    " hex characters.";
             return result;
         }
-        std::vector<unsigned char> ciphertext_bytes =
-            hexStringToBytes(ciphertext_hex);
+        std::vector<unsigned char> ciphertext_bytes;
+        if (!decodeText(encoding, ciphertext_hex, ciphertext_bytes)) {
+            result.error_message = std::string("Invalid ") +
+                                   cipher_text_encoding_name(encoding) +
+                                   " ciphertext.";
+            return result;
+        }
         std::vector<unsigned char> plaintext_bytes =
             gost_decrypt_data(ciphertext_bytes, key, iv);
 
@@ -246,17 +863,471 @@ GostDecryptedTextResult decryptTextGOST(const std::string &iv_hex,
     }
     return result;
 }
+// Сигнатура кадров с контрольными суммами (--crc, plugin/crc_framing.h).
+static const unsigned char CRC_FRAME_MAGIC[8] = {'C', 'I', 'P', 'H', 'C', 'R', 'C', '1'};
+
+// Форматы, к которым нельзя дописывать: у них свои заголовки и завершающие
+// структуры, а обычным файлом их сигнатура была бы принята за IV.
+static bool gost_is_unappendable(const unsigned char *data, size_t size) {
+    auto starts_with = [&](const unsigned char (&magic)[8]) {
+        return size >= sizeof(magic) && std::equal(magic, magic + sizeof(magic), data);
+    };
+    return starts_with(CRC_FRAME_MAGIC) || starts_with(GOST_CHECKPOINT_MAGIC) ||
+           gost_is_delta(data, size) || gost_is_archive(data, size);
+}
+
+// Дописывание (GostFileOptions::append). Гамма зависит только от позиции
+// байта, поэтому шифротекст перед дополнением остаётся верным и для
+// продолжения: дополнение последнего блока отбрасывается, и поток шифруется
+// дальше с его места. Читаются только заголовок и последний блок.
+static GostFileOperationResult
+gost_append_file(std::istream &input, std::fstream &target,
+                 const std::vector<unsigned char> &key,
+                 const std::string &initial_iv_hex,
+                 const CipherStatsSinkC *stats) {
+    GostFileOperationResult fres;
+    CipherStageTimer readTimer(stats, CIPHER_STAGE_READ);
+    target.seekg(0, std::ios::end);
+    uint64_t file_size = static_cast<uint64_t>(target.tellg());
+    unsigned char header[GOST_FRAMED_HEADER_SIZE];
+    size_t header_size = static_cast<size_t>(
+        std::min<uint64_t>(file_size, GOST_FRAMED_HEADER_SIZE));
+    target.seekg(0, std::ios::beg);
+    CIPHER_PROBE(gost, read_start, header_size);
+    target.read(reinterpret_cast<char *>(header), header_size);
+    CIPHER_PROBE(gost, read_done, target.gcount());
+    if (header_size < GOST_IV_SIZE_BYTES || !target) {
+        fres.message = "Error reading IV from the encrypted file (file too "
+                       "short or read error).";
+        return fres;
+    }
+    if (gost_is_unappendable(header, header_size)) {
+        fres.message = "Append is not supported for this container.";
+        return fres;
+    }
+
+    bool framed = gost_is_framed(header, header_size);
+    uint64_t data_offset = GOST_IV_SIZE_BYTES;
+    uint32_t flags = 0;
+    std::vector<unsigned char> iv(header, header + GOST_IV_SIZE_BYTES);
+    if (framed) {
+        if (header_size < GOST_FRAMED_HEADER_SIZE) {
+            fres.message = "Framed file is shorter than its header.";
+            return fres;
+        }
+        flags = load_le32(header + 8);
+        if (flags & ~GOST_FRAMED_KNOWN_FLAGS) {
+            fres.message = "Unsupported framed file flags.";
+            return fres;
+        }
+        if (load_le32(header + 12) != GOST_FRAMED_CHUNK_SIZE) {
+            fres.message = "Cannot append to a framed file with a different "
+                           "chunk size.";
+            return fres;
+        }
+        data_offset = GOST_FRAMED_HEADER_SIZE;
+        iv.assign(header + 16, header + GOST_FRAMED_HEADER_SIZE);
+    }
+    fres.used_iv_hex = bytesToHexString(iv);
+    if (!initial_iv_hex.empty() && hexStringToBytes(initial_iv_hex) != iv) {
+        fres.message = "The encrypted file already uses IV " +
+                       fres.used_iv_hex + "; a different IV cannot be appended.";
+        return fres;
+    }
+
+    uint64_t stream_size = file_size - data_offset;
+    if (stream_size % GOST_BLOCK_SIZE_BYTES != 0) {
+        fres.message = "Encrypted file size is not a multiple of the block "
+                       "size (damaged file).";
+        return fres;
+    }
+    // Пустой поток (файл из одного IV) расшифровывается в пустой текст.
+    uint64_t position = 0;
+    if (stream_size > 0) {
+        unsigned char last[GOST_BLOCK_SIZE_BYTES];
+        target.seekg(static_cast<std::streamoff>(file_size - sizeof(last)),
+                     std::ios::beg);
+        CIPHER_PROBE(gost, read_start, sizeof(last));
+        target.read(reinterpret_cast<char *>(last), sizeof(last));
+        CIPHER_PROBE(gost, read_done, target.gcount());
+        size_t padding_len;
+        if (!target ||
+            !gost_padding_length(last, sizeof(last), stream_size - sizeof(last),
+                                 key.data(), iv.data(), padding_len)) {
+            fres.message = "Invalid padding in the last block of the "
+                           "encrypted file (wrong key or damaged file).";
+            return fres;
+        }
+        position = stream_size - padding_len;
+    }
+    readTimer.addBytes(header_size + (stream_size > 0 ? GOST_BLOCK_SIZE_BYTES : 0));
+    readTimer.stop();
+
+    // Новый поток не короче прежнего дополнения, так что хвост файла
+    // перезаписывается целиком и обрезать его не нужно.
+    target.clear();
+    target.seekp(static_cast<std::streamoff>(data_offset + position),
+                 std::ios::beg);
+    if (framed) {
+        GostFramedEncoder encoder(key, iv, flags, position);
+        gost_transform_file(input, target, encoder, stats);
+    } else {
+        GostStreamCipher cipher(key, iv, true, position);
+        gost_transform_file(input, target, cipher, stats);
+    }
+    fres.success = true;
+    fres.message = "Data appended to the encrypted file successfully.";
+    return fres;
+}
+
+// Заголовок формата: IV или заголовок блочного формата.
+static std::vector<unsigned char>
+gost_file_prefix(const GostCheckpoint &checkpoint) {
+    if (!checkpoint.framed) {
+        return std::vector<unsigned char>(checkpoint.iv,
+                                          checkpoint.iv + GOST_IV_SIZE_BYTES);
+    }
+    std::vector<unsigned char> header(GOST_FRAMED_HEADER_SIZE);
+    std::copy(GOST_FRAMED_MAGIC, GOST_FRAMED_MAGIC + sizeof(GOST_FRAMED_MAGIC),
+              header.begin());
+    store_le32(header.data() + 8, checkpoint.framed_flags);
+    store_le32(header.data() + 12, GOST_FRAMED_CHUNK_SIZE);
+    std::copy(checkpoint.iv, checkpoint.iv + GOST_IV_SIZE_BYTES,
+              header.begin() + 16);
+    return header;
+}
+
+static bool gost_read_at(std::istream &stream, uint64_t offset,
+                         std::vector<unsigned char> &data) {
+    stream.clear();
+    stream.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+    stream.read(reinterpret_cast<char *>(data.data()), data.size());
+    return static_cast<size_t>(stream.gcount()) == data.size();
+}
+
+// Сверяет выход с контрольной точкой: заголовок формата и последний блок
+// перед точкой, зашифрованный заново, что проверяет ключ и то, что ни вход,
+// ни выход не изменились.
+static bool gost_verify_checkpoint(std::istream &input, std::istream &output,
+                                   const std::vector<unsigned char> &key,
+                                   const GostCheckpoint &checkpoint) {
+    std::vector<unsigned char> prefix = gost_file_prefix(checkpoint);
+    std::vector<unsigned char> stored(prefix.size());
+    if (checkpoint.verify_output_offset < prefix.size() ||
+        !gost_read_at(output, 0, stored) || stored != prefix) {
+        return false;
+    }
+    std::vector<unsigned char> plaintext(checkpoint.input_offset -
+                                         checkpoint.verify_input_offset);
+    stored.resize(checkpoint.output_offset - checkpoint.verify_output_offset);
+    if (!gost_read_at(input, checkpoint.verify_input_offset, plaintext) ||
+        !gost_read_at(output, checkpoint.verify_output_offset, stored)) {
+        return false;
+    }
+    std::vector<unsigned char> iv(checkpoint.iv, checkpoint.iv + GOST_IV_SIZE_BYTES);
+    uint64_t position = checkpoint.verify_output_offset - prefix.size();
+    std::vector<unsigned char> expected;
+    if (checkpoint.framed) {
+        GostFramedEncoder encoder(key, iv, checkpoint.framed_flags, position);
+        encoder.update(plaintext.data(), plaintext.size(), expected);
+    } else {
+        GostStreamCipher cipher(key, iv, true, position);
+        cipher.update(plaintext.data(), plaintext.size(), expected);
+    }
+    return expected == stored;
+}
+
+// Шифрование с контрольными точками (GostFileOptions::checkpoint_interval и
+// resume). Файл обрабатывается потоком, как блочный формат, поэтому
+// продолжение после сбоя стоит повторного шифрования одного блока, а не
+// всего, что было сделано до него.
+static GostFileOperationResult gost_encrypt_file_checkpointed(
+    std::ifstream &inputFile, const std::string &inputFilePath,
+    const std::string &outputFilePath, const std::vector<unsigned char> &key,
+    const std::string &initial_iv_hex, const GostFileOptions &options,
+    const CipherStatsSinkC *stats) {
+    GostFileOperationResult fres;
+    std::string checkpoint_path = gost_checkpoint_path(outputFilePath);
+    std::error_code ec;
+    GostCheckpoint checkpoint;
+    checkpoint.input_size = std::filesystem::file_size(inputFilePath, ec);
+    if (!ec) {
+        checkpoint.input_mtime = static_cast<int64_t>(
+            std::filesystem::last_write_time(inputFilePath, ec)
+                .time_since_epoch()
+                .count());
+    }
+    if (ec) {
+        fres.message = "Error reading input file attributes: " + ec.message();
+        return fres;
+    }
+
+    GostCheckpoint saved;
+    bool resuming = options.resume && gost_read_checkpoint(checkpoint_path, saved);
+    std::vector<unsigned char> iv;
+    if (resuming) {
+        if (saved.input_size != checkpoint.input_size ||
+            saved.input_mtime != checkpoint.input_mtime) {
+            fres.message = "Input file has changed since the checkpoint; remove " +
+                           checkpoint_path + " to start over.";
+            return fres;
+        }
+        checkpoint = saved;
+        iv.assign(checkpoint.iv, checkpoint.iv + GOST_IV_SIZE_BYTES);
+        if (!initial_iv_hex.empty() && hexStringToBytes(initial_iv_hex) != iv) {
+            fres.message = "The checkpoint was made with IV " +
+                           bytesToHexString(iv) + "; a different IV cannot be used.";
+            return fres;
+        }
+    } else {
+        if (!initial_iv_hex.empty()) {
+            iv = hexStringToBytes(initial_iv_hex);
+            if (iv.size() != GOST_IV_SIZE_BYTES) {
+                fres.message = "Invalid IV length for file encryption.";
+                return fres;
+            }
+        } else {
+            generateRandomBytes(iv, GOST_IV_SIZE_BYTES);
+        }
+        if (!options.compress && (gost_is_framed(iv.data(), iv.size()) ||
+                                  gost_is_delta(iv.data(), iv.size()) ||
+                                  gost_is_archive(iv.data(), iv.size()))) {
+            fres.message = "This IV is reserved for a file format signature.";
+            return fres;
+        }
+        checkpoint.framed = options.compress;
+        checkpoint.framed_flags = options.compress ? GOST_FRAMED_COMPRESSED : 0;
+        std::copy(iv.begin(), iv.end(), checkpoint.iv);
+        std::filesystem::remove(checkpoint_path, ec); // журнал прошлого запуска
+    }
+    fres.used_iv_hex = bytesToHexString(iv);
+    std::vector<unsigned char> prefix = gost_file_prefix(checkpoint);
+
+    std::fstream outputFile;
+    if (resuming) {
+        outputFile.open(outputFilePath, std::ios::binary | std::ios::in);
+        if (!outputFile) {
+            fres.message = "Error opening output file: " + outputFilePath;
+            return fres;
+        }
+        CipherStageTimer readTimer(stats, CIPHER_STAGE_READ);
+        if (!gost_verify_checkpoint(inputFile, outputFile, key, checkpoint)) {
+            fres.message = "The checkpoint does not match the input and output "
+                           "files (wrong key or modified files); remove " +
+                           checkpoint_path + " to start over.";
+            return fres;
+        }
+        readTimer.addBytes(prefix.size() +
+                           (checkpoint.input_offset - checkpoint.verify_input_offset) +
+                           (checkpoint.output_offset - checkpoint.verify_output_offset));
+        readTimer.stop();
+        outputFile.close();
+        // Всё, что записано после точки, могло не дойти до диска целиком.
+        std::filesystem::resize_file(outputFilePath, checkpoint.output_offset, ec);
+        if (ec) {
+            fres.message = "Error truncating output file: " + ec.message();
+            return fres;
+        }
+        outputFile.open(outputFilePath,
+                        std::ios::binary | std::ios::in | std::ios::out);
+        outputFile.seekp(static_cast<std::streamoff>(checkpoint.output_offset),
+                         std::ios::beg);
+        inputFile.clear();
+        inputFile.seekg(static_cast<std::streamoff>(checkpoint.input_offset),
+                        std::ios::beg);
+    } else {
+        outputFile.open(outputFilePath,
+                        std::ios::binary | std::ios::out | std::ios::trunc);
+        outputFile.write(reinterpret_cast<const char *>(prefix.data()),
+                         prefix.size());
+    }
+    if (!outputFile) {
+        fres.message = "Error opening output file: " + outputFilePath;
+        return fres;
+    }
+
+    GostCheckpointWriter writer;
+    writer.path = checkpoint_path;
+    writer.output_path = outputFilePath;
+    writer.interval = options.checkpoint_interval ? options.checkpoint_interval
+                                                  : GOST_CHECKPOINT_DEFAULT_INTERVAL;
+    writer.state = checkpoint;
+    writer.input_offset = checkpoint.input_offset;
+    writer.output_offset = resuming ? checkpoint.output_offset : prefix.size();
+    uint64_t position = writer.output_offset - prefix.size();
+    if (checkpoint.framed) {
+        // Заголовок уже записан, поэтому кадры продолжают поток с position.
+        GostFramedEncoder encoder(key, iv, checkpoint.framed_flags, position);
+        gost_transform_file(inputFile, outputFile, encoder, stats, &writer);
+    } else {
+        GostStreamCipher cipher(key, iv, true, position);
+        gost_transform_file(inputFile, outputFile, cipher, stats, &writer);
+    }
+    outputFile.close();
+    std::filesystem::remove(checkpoint_path, ec);
+
+    fres.success = true;
+    fres.message = resuming ? "File encryption resumed from input offset " +
+                                  std::to_string(checkpoint.input_offset) +
+                                  " and completed successfully."
+                            : "File encrypted successfully.";
+    return fres;
+}
+
 GostFileOperationResult encryptFileGOST(const std::string &inputFilePath,
                                         const std::string &outputFilePath,
                                         const std::string &key_hex,
-                                        const std::string &initial_iv_hex) {
+                                        const std::string &initial_iv_hex,
+                                        const GostFileOptions &options,
+                                        const CipherStatsSinkC *stats,
+                                        const CipherProgressC *progress) {
     GostFileOperationResult fres;
+    if (options.direct_io && (options.archive || options.delta || options.append ||
+                              options.compress || options.checkpoint_interval ||
+                              options.resume)) {
+        fres.message = "Direct I/O applies only to the plain file format.";
+        return fres;
+    }
+    if (options.archive) {
+        // Вход может быть каталогом, поэтому архив обходится без inputFile.
+        if (options.append || options.compress || options.checkpoint_interval ||
+            options.resume || options.delta) {
+            fres.message = "An archive cannot be combined with append, "
+                           "compression, checkpoints or delta encryption.";
+            return fres;
+        }
+        return encryptArchiveGOST({inputFilePath}, outputFilePath, key_hex,
+                                  initial_iv_hex, stats);
+    }
     std::ifstream inputFile(inputFilePath, std::ios::binary);
     if (!inputFile) {
         fres.message = "Error opening input file: " + inputFilePath;
         return fres;
     }
 
+    if (options.delta) {
+        if (options.append || options.compress || options.checkpoint_interval ||
+            options.resume) {
+            fres.message = "Delta encryption cannot be combined with append, "
+                           "compression or checkpoints.";
+            return fres;
+        }
+        if (!initial_iv_hex.empty()) {
+            fres.message = "Delta encryption picks a random IV for every chunk; "
+                           "an IV cannot be set.";
+            return fres;
+        }
+        try {
+            CipherStageTimer parseTimer(stats, CIPHER_STAGE_PARSE);
+            std::vector<unsigned char> key = hexStringToBytes(key_hex);
+            if (key.size() != GOST_KEY_SIZE_BYTES) {
+                fres.message = "Invalid key length for file encryption.";
+                return fres;
+            }
+            parseTimer.stop();
+            inputFile.close();
+            return gost_encrypt_file_delta(inputFilePath, outputFilePath, key,
+                                           options, stats);
+        } catch (const std::exception &e) {
+            fres.message =
+                std::string("C++ Exception during file encryption: ") + e.what();
+            return fres;
+        }
+    }
+
+    if (options.checkpoint_interval || options.resume) {
+        if (options.append) {
+            fres.message = "Appending cannot be combined with checkpoints.";
+            return fres;
+        }
+        try {
+            CipherStageTimer parseTimer(stats, CIPHER_STAGE_PARSE);
+            std::vector<unsigned char> key = hexStringToBytes(key_hex);
+            if (key.size() != GOST_KEY_SIZE_BYTES) {
+                fres.message = "Invalid key length for file encryption.";
+                return fres;
+            }
+            parseTimer.stop();
+            return gost_encrypt_file_checkpointed(inputFile, inputFilePath,
+                                                  outputFilePath, key,
+                                                  initial_iv_hex, options, stats);
+        } catch (const std::exception &e) {
+            fres.message =
+                std::string("C++ Exception during file encryption: ") + e.what();
+            return fres;
+        }
+    }
+
+    if (options.append) {
+        std::fstream target(outputFilePath,
+                            std::ios::binary | std::ios::in | std::ios::out);
+        if (target) {
+            try {
+                CipherStageTimer parseTimer(stats, CIPHER_STAGE_PARSE);
+                std::vector<unsigned char> key = hexStringToBytes(key_hex);
+                if (key.size() != GOST_KEY_SIZE_BYTES) {
+                    fres.message = "Invalid key length for file encryption.";
+                    return fres;
+                }
+                parseTimer.stop();
+                return gost_append_file(inputFile, target, key, initial_iv_hex,
+                                        stats);
+            } catch (const std::exception &e) {
+                fres.message =
+                    std::string("C++ Exception while appending to file: ") +
+                    e.what();
+                return fres;
+            }
+        }
+        if (std::ifstream(outputFilePath)) {
+            fres.message = "Error opening output file for appending: " +
+                           outputFilePath;
+            return fres;
+        }
+        // Файла ещё нет — он создаётся как обычно.
+    }
+
+    if (options.direct_io) {
+        try {
+            CipherStageTimer parseTimer(stats, CIPHER_STAGE_PARSE);
+            std::vector<unsigned char> key = hexStringToBytes(key_hex);
+            if (key.size() != GOST_KEY_SIZE_BYTES) {
+                fres.message = "Invalid key length for file encryption.";
+                return fres;
+            }
+            std::vector<unsigned char> iv;
+            if (!initial_iv_hex.empty()) {
+                iv = hexStringToBytes(initial_iv_hex);
+                if (iv.size() != GOST_IV_SIZE_BYTES) {
+                    fres.message = "Invalid IV length for file encryption.";
+                    return fres;
+                }
+            } else {
+                generateRandomBytes(iv, GOST_IV_SIZE_BYTES);
+            }
+            if (gost_is_framed(iv.data(), iv.size()) ||
+                gost_is_delta(iv.data(), iv.size()) ||
+                gost_is_archive(iv.data(), iv.size())) {
+                fres.message = "This IV is reserved for a file format signature.";
+                return fres;
+            }
+            fres.used_iv_hex = bytesToHexString(iv);
+            parseTimer.stop();
+            inputFile.close();
+            bool direct = gost_transform_file_direct(inputFilePath, outputFilePath,
+                                                     key, iv, true, stats, progress);
+            fres.success = true;
+            fres.message = direct ? "File encrypted successfully with direct I/O."
+                                  : "File encrypted successfully; direct I/O is not "
+                                    "supported here, so the page cache was "
+                                    "released after each block.";
+        } catch (const std::exception &e) {
+            fres.message =
+                std::string("C++ Exception during file encryption: ") + e.what();
+        }
+        return fres;
+    }
+
     std::ofstream outputFile(outputFilePath,
                              std::ios::binary | std::ios::trunc);
     if (!outputFile) {
@@ -265,6 +1336,7 @@ GostFileOperationResult encryptFileGOST(const std::string &inputFilePath,
     }
 
     try {
+        CipherStageTimer parseTimer(stats, CIPHER_STAGE_PARSE);
         std::vector<unsigned char> key = hexStringToBytes(key_hex);
         if (key.size() != GOST_KEY_SIZE_BYTES) {
             fres.message = "Invalid key length for file encryption.";
@@ -282,20 +1354,53 @@ GostFileOperationResult encryptFileGOST(const std::string &inputFilePath,
             generateRandomBytes(iv, GOST_IV_SIZE_BYTES);
         }
         fres.used_iv_hex = bytesToHexString(iv);
-        outputFile.write(reinterpret_cast<const char *>(iv.data()), iv.size());
-        if (!outputFile) {
-            fres.message = "Error writing IV to output file.";
+        parseTimer.stop();
+
+        std::error_code size_error;
+        uint64_t input_size = std::filesystem::file_size(inputFilePath, size_error);
+        CipherProgress tracker(progress, size_error ? 0 : input_size);
+        if (options.compress) {
+            GostFramedEncoder encoder(key, iv, GOST_FRAMED_COMPRESSED);
+            gost_transform_file(inputFile, outputFile, encoder, stats, nullptr,
+                                &tracker);
+            fres.success = true;
+            fres.message = "File compressed and encrypted successfully.";
+            return fres;
+        }
+        if (gost_is_framed(iv.data(), iv.size()) ||
+            gost_is_delta(iv.data(), iv.size()) ||
+            gost_is_archive(iv.data(), iv.size())) {
+            fres.message = "This IV is reserved for a file format signature.";
             return fres;
         }
+        // С приёмником хода файл шифруется блоками, чтобы ход сообщался по
+        // мере работы, а отмена срабатывала между блоками; результат тот же.
+        if (progress) {
+            outputFile.write(reinterpret_cast<const char *>(iv.data()), iv.size());
+            if (!outputFile) {
+                fres.message = "Error writing IV to output file.";
+                return fres;
+            }
+            GostStreamCipher cipher(key, iv, true);
+            gost_transform_file(inputFile, outputFile, cipher, stats, nullptr,
+                                &tracker);
+            fres.success = true;
+            fres.message = "File encrypted successfully.";
+            return fres;
+        }
+
+        CipherStageTimer readTimer(stats, CIPHER_STAGE_READ);
         inputFile.seekg(0, std::ios::end);
         std::streamsize fileSize = inputFile.tellg();
         inputFile.seekg(0, std::ios::beg);
         std::vector<unsigned char> plaintext_bytes(
             static_cast<size_t>(fileSize));
+        CIPHER_PROBE(gost, read_start, plaintext_bytes.size());
         if (fileSize > 0) {
             inputFile.read(reinterpret_cast<char *>(plaintext_bytes.data()),
                            fileSize);
         }
+        CIPHER_PROBE(gost, read_done, inputFile.gcount());
 
         if (!inputFile &&
             !inputFile.eof()) {
@@ -309,16 +1414,32 @@ GostFileOperationResult encryptFileGOST(const std::string &inputFilePath,
                 return fres;
             }
         }
+        readTimer.addBytes(plaintext_bytes.size());
+        readTimer.stop();
 
+        CipherStageTimer transformTimer(stats, CIPHER_STAGE_TRANSFORM);
         std::vector<unsigned char> ciphertext_bytes =
             gost_encrypt_data(plaintext_bytes, key, iv);
+        transformTimer.addBytes(plaintext_bytes.size());
+        transformTimer.stop();
+
+        CipherStageTimer writeTimer(stats, CIPHER_STAGE_WRITE);
+        CIPHER_PROBE(gost, write_start, iv.size() + ciphertext_bytes.size());
+        outputFile.write(reinterpret_cast<const char *>(iv.data()), iv.size());
+        if (!outputFile) {
+            fres.message = "Error writing IV to output file.";
+            return fres;
+        }
         outputFile.write(
             reinterpret_cast<const char *>(ciphertext_bytes.data()),
             ciphertext_bytes.size());
+        outputFile.flush();
         if (!outputFile) {
             fres.message = "Error writing ciphertext to output file.";
             return fres;
         }
+        CIPHER_PROBE(gost, write_done, iv.size() + ciphertext_bytes.size());
+        writeTimer.addBytes(iv.size() + ciphertext_bytes.size());
 
         fres.success = true;
         fres.message = "File encrypted successfully.";
@@ -335,7 +1456,17 @@ GostFileOperationResult encryptFileGOST(const std::string &inputFilePath,
 
 GostFileOperationResult decryptFileGOST(const std::string &inputFilePath,
                                         const std::string &outputFilePath,
-                                        const std::string &key_hex) {
+                                        const std::string &key_hex,
+                                        const CipherStatsSinkC *stats) {
+    return decryptFileGOST(inputFilePath, outputFilePath, key_hex,
+                           GostFileOptions(), stats);
+}
+
+GostFileOperationResult decryptFileGOST(const std::string &inputFilePath,
+                                        const std::string &outputFilePath,
+                                        const std::string &key_hex,
+                                        const GostFileOptions &options,
+                                        const CipherStatsSinkC *stats) {
     GostFileOperationResult fres;
     std::ifstream inputFile(inputFilePath, std::ios::binary);
     if (!inputFile) {
@@ -343,6 +1474,18 @@ GostFileOperationResult decryptFileGOST(const std::string &inputFilePath,
         return fres;
     }
 
+    // Архив извлекается в каталог outputFilePath, поэтому его сигнатура
+    // проверяется до открытия выходного файла.
+    unsigned char magic[sizeof(GOST_ARCHIVE_MAGIC)] = {};
+    inputFile.read(reinterpret_cast<char *>(magic), sizeof(magic));
+    if (gost_is_archive(magic, static_cast<size_t>(inputFile.gcount()))) {
+        inputFile.close();
+        return extractArchiveGOST(inputFilePath, outputFilePath, key_hex, {},
+                                  stats);
+    }
+    inputFile.clear();
+    inputFile.seekg(0, std::ios::beg);
+
     std::ofstream outputFile(outputFilePath,
                              std::ios::binary | std::ios::trunc);
     if (!outputFile) {
@@ -351,15 +1494,20 @@ GostFileOperationResult decryptFileGOST(const std::string &inputFilePath,
     }
 
     try {
+        CipherStageTimer parseTimer(stats, CIPHER_STAGE_PARSE);
         std::vector<unsigned char> key = hexStringToBytes(key_hex);
         if (key.size() != GOST_KEY_SIZE_BYTES) {
             fres.message = "Invalid key length for file decryption.";
             return fres;
         }
+        parseTimer.stop();
 
         // Read IV from the beginning of the input file
+        CipherStageTimer readTimer(stats, CIPHER_STAGE_READ);
         std::vector<unsigned char> iv(GOST_IV_SIZE_BYTES);
+        CIPHER_PROBE(gost, read_start, iv.size());
         inputFile.read(reinterpret_cast<char *>(iv.data()), iv.size());
+        CIPHER_PROBE(gost, read_done, inputFile.gcount());
         if (static_cast<size_t>(inputFile.gcount()) != GOST_IV_SIZE_BYTES) {
             fres.message = "Error reading IV from input file (file too short "
                            "or read error).";
@@ -367,6 +1515,41 @@ GostFileOperationResult decryptFileGOST(const std::string &inputFilePath,
         }
         fres.used_iv_hex = bytesToHexString(iv);
 
+        if (gost_is_framed(iv.data(), iv.size())) {
+            readTimer.stop();
+            inputFile.seekg(0, std::ios::beg);
+            GostFramedDecoder decoder(key);
+            gost_transform_file(inputFile, outputFile, decoder, stats);
+            fres.used_iv_hex = bytesToHexString(decoder.iv());
+            fres.success = true;
+            fres.message = "File decrypted successfully.";
+            return fres;
+        }
+        if (gost_is_delta(iv.data(), iv.size())) {
+            readTimer.stop();
+            inputFile.seekg(0, std::ios::beg);
+            GostDeltaDecoder decoder(key);
+            gost_transform_file(inputFile, outputFile, decoder, stats);
+            fres.used_iv_hex.clear(); // у каждого блока свой IV
+            fres.success = true;
+            fres.message = "File decrypted successfully.";
+            return fres;
+        }
+
+        if (options.direct_io) {
+            readTimer.stop();
+            inputFile.close();
+            outputFile.close();
+            bool direct = gost_transform_file_direct(inputFilePath, outputFilePath,
+                                                     key, iv, false, stats);
+            fres.success = true;
+            fres.message = direct ? "File decrypted successfully with direct I/O."
+                                  : "File decrypted successfully; direct I/O is not "
+                                    "supported here, so the page cache was "
+                                    "released after each block.";
+            return fres;
+        }
+
         inputFile.seekg(0, std::ios::end);
         std::streamsize totalFileSize = inputFile.tellg();
         inputFile.seekg(GOST_IV_SIZE_BYTES, std::ios::beg);
@@ -380,10 +1563,12 @@ GostFileOperationResult decryptFileGOST(const std::string &inputFilePath,
 
         std::vector<unsigned char> ciphertext_bytes(
             static_cast<size_t>(ciphertextFileSize));
+        CIPHER_PROBE(gost, read_start, ciphertext_bytes.size());
         if (ciphertextFileSize > 0) {
             inputFile.read(reinterpret_cast<char *>(ciphertext_bytes.data()),
                            ciphertextFileSize);
         }
+        CIPHER_PROBE(gost, read_done, inputFile.gcount());
 
         if (!inputFile && !inputFile.eof()) {
             fres.message = "Error reading ciphertext from input file.";
@@ -396,18 +1581,28 @@ GostFileOperationResult decryptFileGOST(const std::string &inputFilePath,
                 return fres;
             }
         }
+        readTimer.addBytes(GOST_IV_SIZE_BYTES + ciphertext_bytes.size());
+        readTimer.stop();
 
+        CipherStageTimer transformTimer(stats, CIPHER_STAGE_TRANSFORM);
         std::vector<unsigned char> plaintext_bytes =
             gost_decrypt_data(ciphertext_bytes, key, iv);
+        transformTimer.addBytes(ciphertext_bytes.size());
+        transformTimer.stop();
         if (!plaintext_bytes.empty() ||
             (ciphertext_bytes.empty() && ciphertextFileSize == 0)) {
+            CipherStageTimer writeTimer(stats, CIPHER_STAGE_WRITE);
+            CIPHER_PROBE(gost, write_start, plaintext_bytes.size());
             outputFile.write(
                 reinterpret_cast<const char *>(plaintext_bytes.data()),
                 plaintext_bytes.size());
+            outputFile.flush();
+            writeTimer.addBytes(plaintext_bytes.size());
             if (!outputFile) {
                 fres.message = "Error writing plaintext to output file.";
                 return fres;
             }
+            CIPHER_PROBE(gost, write_done, plaintext_bytes.size());
         } else if (!ciphertext_bytes.empty()) {
             fres.message = "Decryption resulted in empty plaintext from "
                            "non-empty ciphertext (check for padding errors).";
@@ -1,9 +1,17 @@
 #ifndef GOST_CIPHER_HPP
 #define GOST_CIPHER_HPP
 
+#include <cstdint>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <vector>
+
+#include "text_encoding.h"
+
+struct CipherStatsSinkC; // plugin/cipher_stats.h
+struct CipherProgressC;  // runtime/cipher_progress.h
+
 const unsigned int GOST_KEY_SIZE_BITS = 256;
 const unsigned int GOST_KEY_SIZE_BYTES = GOST_KEY_SIZE_BITS / 8;
 const unsigned int GOST_BLOCK_SIZE_BYTES = 8;
@@ -27,6 +35,31 @@ std::vector<unsigned char>
 gost_decrypt_data(const std::vector<unsigned char> &ciphertext,
                   const std::vector<unsigned char> &key,
                   const std::vector<unsigned char> &iv);
+// Шифрование и расшифрование в буфер вызывающего без выделения памяти.
+// key — GOST_KEY_SIZE_BYTES байт, iv — GOST_IV_SIZE_BYTES. Результат совпадает с
+// gost_encrypt_data / gost_decrypt_data; допускается out == in.
+size_t gost_ciphertext_size(size_t plaintext_size);
+// out вмещает gost_ciphertext_size(size) байт.
+void gost_encrypt_into(const unsigned char *in, size_t size,
+                       const unsigned char *key, const unsigned char *iv,
+                       unsigned char *out);
+// Проверяет дополнение PKCS7 и возвращает размер открытого текста; false —
+// дополнение неверно. Пустой шифротекст соответствует пустому тексту.
+bool gost_plaintext_size(const unsigned char *in, size_t size,
+                         const unsigned char *key, const unsigned char *iv,
+                         size_t &plaintext_size);
+// Расшифровывает первые plaintext_size байт (см. gost_plaintext_size).
+void gost_decrypt_into(const unsigned char *in, size_t plaintext_size,
+                       const unsigned char *key, const unsigned char *iv,
+                       unsigned char *out);
+// Гамма без дополнения: out = in ^ гамма с позиции position, шифрование и
+// расшифрование совпадают. Для форматов с произвольным доступом к частям
+// потока (gost_archive.hpp); допускается out == in.
+void gost_apply_keystream(const unsigned char *in, unsigned char *out, size_t size,
+                          uint64_t position, const unsigned char *key,
+                          const unsigned char *iv);
+// The IV is always hex; the ciphertext uses the requested text encoding
+// (runtime/text_encoding.h), hex by default.
 struct GostEncryptedTextResult {
     std::string iv_hex;
     std::string ciphertext_hex;
@@ -36,7 +69,8 @@ struct GostEncryptedTextResult {
 
 GostEncryptedTextResult encryptTextGOST(const std::string &plaintext,
                                         const std::string &key_hex,
-                                        const std::string &iv_hex = "");
+                                        const std::string &iv_hex = "",
+                                        CipherTextEncodingC encoding = CIPHER_TEXT_HEX);
 
 struct GostDecryptedTextResult {
     std::string plaintext;
@@ -46,19 +80,70 @@ struct GostDecryptedTextResult {
 
 GostDecryptedTextResult decryptTextGOST(const std::string &iv_hex,
                                         const std::string &ciphertext_hex,
-                                        const std::string &key_hex);
+                                        const std::string &key_hex,
+                                        CipherTextEncodingC encoding = CIPHER_TEXT_HEX);
 struct GostFileOperationResult {
     bool success = false;
     std::string message;
     std::string used_iv_hex;
 };
+struct GostFileOptions {
+    // Сжимать данные перед шифрованием; файл пишется в блочном формате
+    // (см. GostFramedEncoder), decryptFileGOST распознаёт его сам.
+    bool compress = false;
+    // Дописать данные в конец уже зашифрованного outputFilePath тем же ключом
+    // (IV и формат берутся из файла, compress не влияет). Читаются только
+    // заголовок и последний блок, так что время зависит от объёма новых
+    // данных, а не от размера файла. Если файла нет, он создаётся как обычно.
+    bool append = false;
+    // Каждые checkpoint_interval байт входа сбрасывать выход на диск и
+    // записывать контрольную точку в "<outputFilePath>.ckpt" (0 — без журнала,
+    // см. gost/gost_checkpoint.hpp). Журнал удаляется после успешного конца.
+    uint64_t checkpoint_interval = 0;
+    // Продолжить прерванное шифрование с последней контрольной точки (IV и
+    // формат берутся из журнала); без журнала файл шифруется с начала.
+    bool resume = false;
+    // Поблочный формат с манифестом (gost/gost_delta.hpp): заново шифруются
+    // только блоки входа, изменившиеся с прошлого раза, остальные переносятся
+    // из прежней версии как есть.
+    bool delta = false;
+    // Прежняя версия для delta; пусто — outputFilePath обновляется на месте.
+    std::string delta_base;
+    // inputFilePath — файл или каталог, который упаковывается в архив
+    // (gost/gost_archive.hpp); decryptFileGOST распознаёт архив сам.
+    bool archive = false;
+    // При расшифровании архива — извлекаемые члены (путь файла или каталога
+    // внутри архива); пусто — все.
+    std::vector<std::string> archive_members;
+    // Обычный формат: читать и писать файлы в обход страничного кэша
+    // (O_DIRECT) выровненными блоками, чтобы шифрование больших файлов не
+    // вытесняло из кэша данные соседних процессов. Где файловая система этого
+    // не умеет, обработанные блоки сразу вытесняются из кэша.
+    bool direct_io = false;
+};
+// Интервал контрольных точек для resume без checkpoint_interval.
+const uint64_t GOST_CHECKPOINT_DEFAULT_INTERVAL = 256ull << 20;
+// stats — optional receiver of per-stage timings (plugin/cipher_stats.h).
+// progress — optional receiver of input bytes processed, which may also cancel
+// the operation (runtime/cipher_progress.h). It is used by the plain, compressed
+// and direct I/O formats; a cancelled call fails with "Operation cancelled.".
 GostFileOperationResult encryptFileGOST(const std::string &inputFilePath,
                                         const std::string &outputFilePath,
                                         const std::string &key_hex,
-                                        const std::string &initial_iv_hex = "");
+                                        const std::string &initial_iv_hex = "",
+                                        const GostFileOptions &options = {},
+                                        const CipherStatsSinkC *stats = nullptr,
+                                        const CipherProgressC *progress = nullptr);
+GostFileOperationResult decryptFileGOST(const std::string &inputFilePath,
+                                        const std::string &outputFilePath,
+                                        const std::string &key_hex,
+                                        const CipherStatsSinkC *stats = nullptr);
+// Из options учитывается только direct_io (для файлов обычного формата).
 GostFileOperationResult decryptFileGOST(const std::string &inputFilePath,
                                         const std::string &outputFilePath,
-                                        const std::string &key_hex);
+                                        const std::string &key_hex,
+                                        const GostFileOptions &options,
+                                        const CipherStatsSinkC *stats = nullptr);
 
 // --- Added for Key Generation ---
 struct GostKeyGenResult {
@@ -69,5 +154,109 @@ struct GostKeyGenResult {
 
 GostKeyGenResult generateKeyGOST();
 
+// Потоковое шифрование и расшифрование: данные подаются частями произвольного
+// размера, а итог совпадает с gost_encrypt_data / gost_decrypt_data для всех
+// данных сразу. При расшифровании последний блок придерживается до finish,
+// где проверяется дополнение PKCS7 (std::runtime_error при ошибке).
+// position — позиция гаммы первого байта (ненулевая при дописывании к файлу).
+class GostStreamCipher {
+public:
+    GostStreamCipher(const std::vector<unsigned char> &key,
+                     const std::vector<unsigned char> &iv, bool encrypt,
+                     uint64_t position = 0);
+
+    // Результат дописывается в конец out.
+    void update(const unsigned char *data, size_t size,
+                std::vector<unsigned char> &out);
+    void finish(std::vector<unsigned char> &out);
+
+private:
+    void apply(const unsigned char *data, size_t size,
+               std::vector<unsigned char> &out);
+
+    unsigned char pad_[GOST_KEY_SIZE_BYTES];
+    bool encrypt_;
+    uint64_t position_ = 0;
+    std::vector<unsigned char> pending_;
+};
+
+// Блочный формат файла (GostFileOptions::compress). Заголовок открытым текстом:
+// сигнатура "GOSTFRM1", флаги и размер блока (uint32 LE), IV. Далее, так же как
+// в обычном формате (гамма с позиции 0, дополнение PKCS7), зашифрован поток
+// кадров: слово uint32 LE (длина данных кадра | GOST_FRAME_RAW) и данные — блок
+// открытого текста по chunk_size байт (последний короче), сжатый
+// gost_lz_compress или сохранённый как есть, если сжатие экономит меньше
+// 1/GOST_FRAMED_MIN_GAIN. Обычный файл начинается со случайного IV, поэтому
+// IV, совпадающий с сигнатурой, для него запрещён.
+const unsigned char GOST_FRAMED_MAGIC[8] = {'G', 'O', 'S', 'T', 'F', 'R', 'M', '1'};
+const size_t GOST_FRAMED_HEADER_SIZE = sizeof(GOST_FRAMED_MAGIC) + 8 + GOST_IV_SIZE_BYTES;
+const uint32_t GOST_FRAMED_COMPRESSED = 1u;
+const uint32_t GOST_FRAMED_KNOWN_FLAGS = GOST_FRAMED_COMPRESSED;
+const uint32_t GOST_FRAMED_CHUNK_SIZE = 256 * 1024;
+const uint32_t GOST_FRAMED_MAX_CHUNK_SIZE = 64u << 20;
+const uint32_t GOST_FRAMED_MIN_GAIN = 16;
+const uint32_t GOST_FRAME_RAW = 0x80000000u;
+
+// true — данные начинаются с сигнатуры блочного формата.
+bool gost_is_framed(const unsigned char *data, size_t size);
+
+// Запись блочного формата частями произвольного размера; полные блоки
+// сжимаются параллельно на общем пуле потоков.
+class GostFramedEncoder {
+public:
+    GostFramedEncoder(const std::vector<unsigned char> &key,
+                      const std::vector<unsigned char> &iv, uint32_t flags);
+    // Продолжение существующего файла: заголовок не пишется, а кадры
+    // шифруются с позиции position — длины его потока кадров без дополнения.
+    GostFramedEncoder(const std::vector<unsigned char> &key,
+                      const std::vector<unsigned char> &iv, uint32_t flags,
+                      uint64_t position);
+
+    // Результат, начиная с заголовка, дописывается в конец out.
+    void update(const unsigned char *data, size_t size,
+                std::vector<unsigned char> &out);
+    void finish(std::vector<unsigned char> &out);
+
+private:
+    void writeHeader(std::vector<unsigned char> &out);
+    void writeChunks(const unsigned char *data, size_t size,
+                     std::vector<unsigned char> &out);
+
+    GostStreamCipher cipher_;
+    std::vector<unsigned char> iv_;
+    uint32_t flags_;
+    bool header_written_ = false;
+    std::vector<unsigned char> pending_;
+    std::vector<std::vector<unsigned char>> packed_;
+    std::vector<size_t> packed_sizes_;
+};
+
+// Чтение блочного формата, включая заголовок; ошибки формата и повреждённые
+// блоки — std::runtime_error.
+class GostFramedDecoder {
+public:
+    explicit GostFramedDecoder(const std::vector<unsigned char> &key);
+
+    void update(const unsigned char *data, size_t size,
+                std::vector<unsigned char> &out);
+    void finish(std::vector<unsigned char> &out);
+
+    // IV из заголовка (пуст, пока заголовок не прочитан).
+    const std::vector<unsigned char> &iv() const { return iv_; }
+
+private:
+    void readHeader();
+    void readFrames(std::vector<unsigned char> &out);
+
+    std::vector<unsigned char> key_;
+    std::vector<unsigned char> header_;
+    std::vector<unsigned char> iv_;
+    std::unique_ptr<GostStreamCipher> cipher_;
+    uint32_t flags_ = 0;
+    uint32_t chunk_size_ = 0;
+    std::vector<unsigned char> frames_;
+    uint64_t plaintext_offset_ = 0;
+};
+
 
 #endif // GOST_CIPHER_HPP
@@ -0,0 +1,594 @@
+#include "gost_archive.hpp"
+#include "cipher_stats.hpp"
+#include "crc32c.h"
+#include "gost_file.hpp"
+#include "thread_pool.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <sys/stat.h>
+#include <sys/utime.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// Порция соседних файлов, которые читаются, шифруются и пишутся за раз;
+// файлы крупнее порции обрабатываются по одному частями того же размера.
+const size_t BATCH_BYTES = 16u << 20;
+const size_t BATCH_FILES = 4096;
+// При выборочном извлечении файлы читаются из архива одним блоком, если
+// между ними лежит не больше MAX_GAP байт чужих данных.
+const uint64_t MAX_GAP = 256 * 1024;
+// Параллельные циклы идут по индексам файлов, как в gost_delta.cpp.
+const uint64_t INDEX_SPAN = CIPHER_PARALLEL_CHUNK_ALIGNMENT;
+// Смещение, размер, время изменения, CRC32C и длина пути записи индекса.
+const size_t ENTRY_FIXED_SIZE = 8 + 8 + 8 + 4 + 2;
+const int64_t NS_PER_SECOND = 1000000000;
+
+void store_le(unsigned char *out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) out[i] = static_cast<unsigned char>(value >> (8 * i));
+}
+
+uint64_t load_le(const unsigned char *in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    return value;
+}
+
+// Файл на устройстве; по нему архив исключается из собственных входов.
+struct FileId {
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    bool valid = false;
+
+    bool operator==(const FileId &other) const {
+        return valid && other.valid && device == other.device && inode == other.inode;
+    }
+};
+
+// Размер, время изменения (нс от эпохи Unix) и FileId одним вызовом stat.
+bool stat_file(const std::string &path, uint64_t &size, int64_t &mtime, FileId &id) {
+#ifdef _WIN32
+    struct _stat64 st;
+    if (_stat64(path.c_str(), &st) != 0) return false;
+    size = static_cast<uint64_t>(st.st_size);
+    mtime = static_cast<int64_t>(st.st_mtime) * NS_PER_SECOND;
+    id = FileId();
+#else
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) return false;
+    size = static_cast<uint64_t>(st.st_size);
+#ifdef __APPLE__
+    mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * NS_PER_SECOND + st.st_mtimespec.tv_nsec;
+#else
+    mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * NS_PER_SECOND + st.st_mtim.tv_nsec;
+#endif
+    id.device = static_cast<uint64_t>(st.st_dev);
+    id.inode = static_cast<uint64_t>(st.st_ino);
+    id.valid = true;
+#endif
+    return true;
+}
+
+// Время изменения восстанавливается по возможности: ошибка не мешает извлечению.
+void set_file_mtime(const std::string &path, int64_t mtime) {
+    int64_t seconds = mtime / NS_PER_SECOND, nanoseconds = mtime % NS_PER_SECOND;
+    if (nanoseconds < 0) {
+        nanoseconds += NS_PER_SECOND;
+        --seconds;
+    }
+#ifdef _WIN32
+    struct __utimbuf64 times;
+    times.actime = seconds;
+    times.modtime = seconds;
+    _utime64(path.c_str(), &times);
+#else
+    struct timespec times[2];
+    times[0].tv_sec = 0;
+    times[0].tv_nsec = UTIME_OMIT;
+    times[1].tv_sec = static_cast<time_t>(seconds);
+    times[1].tv_nsec = static_cast<long>(nanoseconds);
+    ::utimensat(AT_FDCWD, path.c_str(), times, 0);
+#endif
+}
+
+std::vector<unsigned char> parse_key(const std::string &key_hex) {
+    std::vector<unsigned char> key = hexStringToBytes(key_hex);
+    if (key.size() != GOST_KEY_SIZE_BYTES) {
+        throw std::invalid_argument("Invalid key length for archive.");
+    }
+    return key;
+}
+
+struct Source {
+    std::string path;
+    GostArchiveEntry entry;
+};
+
+void add_source(std::vector<Source> &sources, const fs::path &file, const std::string &name,
+                const FileId &archive_id) {
+    Source source;
+    source.path = file.string();
+    source.entry.path = name;
+    FileId id;
+    if (!stat_file(source.path, source.entry.size, source.entry.mtime, id)) {
+        throw std::runtime_error("Error reading file attributes: " + source.path);
+    }
+    if (id == archive_id) return; // сам архив внутри упаковываемого каталога
+    if (name.size() > 0xFFFF) throw std::runtime_error("Path is too long for the archive: " + name);
+    sources.push_back(std::move(source));
+}
+
+// Обычные файлы входов, упорядоченные по пути внутри архива.
+std::vector<Source> collect_sources(const std::vector<std::string> &inputPaths, const FileId &archive_id) {
+    std::vector<Source> sources;
+    for (const std::string &input : inputPaths) {
+        fs::path root = fs::path(input).lexically_normal();
+        if (!root.has_filename() && root.has_parent_path()) root = root.parent_path(); // "dir/"
+        if (fs::is_regular_file(root)) {
+            add_source(sources, root, root.filename().generic_string(), archive_id);
+        } else if (fs::is_directory(root)) {
+            fs::path base = root.filename();
+            std::string prefix = (base.empty() || base == "." || base == "..") ? "" : base.generic_string() + "/";
+            for (const fs::directory_entry &entry : fs::recursive_directory_iterator(root)) {
+                if (!entry.is_regular_file()) continue;
+                add_source(sources, entry.path(), prefix + entry.path().lexically_relative(root).generic_string(),
+                           archive_id);
+            }
+        } else {
+            throw std::runtime_error("Error opening input: " + input);
+        }
+    }
+    std::sort(sources.begin(), sources.end(),
+              [](const Source &a, const Source &b) { return a.entry.path < b.entry.path; });
+    for (size_t i = 1; i < sources.size(); ++i) {
+        if (sources[i].entry.path == sources[i - 1].entry.path) {
+            throw std::runtime_error("Duplicate path in archive: " + sources[i].entry.path);
+        }
+    }
+    return sources;
+}
+
+// Файл должен остаться того же размера, что при обходе каталогов: под него
+// уже отведено место в потоке данных.
+void read_source(std::ifstream &file, const Source &source, unsigned char *out, size_t size, bool last) {
+    file.read(reinterpret_cast<char *>(out), static_cast<std::streamsize>(size));
+    if (static_cast<size_t>(file.gcount()) != size ||
+        (last && file.peek() != std::ifstream::traits_type::eof())) {
+        throw std::runtime_error("File changed while it was being archived: " + source.path);
+    }
+}
+
+std::vector<unsigned char> build_index(const std::vector<Source> &sources) {
+    size_t size = 8 + 4;
+    for (const Source &source : sources) size += ENTRY_FIXED_SIZE + source.entry.path.size();
+    std::vector<unsigned char> index(size);
+    unsigned char *out = index.data();
+    store_le(out, sources.size(), 8);
+    out += 8;
+    for (const Source &source : sources) {
+        const GostArchiveEntry &entry = source.entry;
+        store_le(out, entry.offset, 8);
+        store_le(out + 8, entry.size, 8);
+        store_le(out + 16, static_cast<uint64_t>(entry.mtime), 8);
+        store_le(out + 24, entry.crc, 4);
+        store_le(out + 28, entry.path.size(), 2);
+        out = std::copy(entry.path.begin(), entry.path.end(), out + ENTRY_FIXED_SIZE);
+    }
+    store_le(out, cipher_crc32c(0, index.data(), size - 4), 4);
+    return index;
+}
+
+struct ArchiveLayout {
+    std::vector<unsigned char> iv;
+    uint64_t data_size = 0;
+    std::vector<GostArchiveEntry> entries;
+};
+
+// Заголовок, хвост и индекс; ошибки формата и неверный ключ — std::runtime_error.
+ArchiveLayout read_layout(GostFile &archive, uint64_t file_size, const std::vector<unsigned char> &key) {
+    if (file_size < GOST_ARCHIVE_HEADER_SIZE + GOST_ARCHIVE_TRAILER_SIZE) {
+        throw std::runtime_error("Archive is truncated.");
+    }
+    unsigned char header[GOST_ARCHIVE_HEADER_SIZE];
+    archive.readAt(header, sizeof(header), 0);
+    if (!gost_is_archive(header, sizeof(header))) throw std::runtime_error("Not a GOST archive.");
+    if (load_le(header + 8, 4) != 0) throw std::runtime_error("Unsupported archive flags.");
+
+    unsigned char trailer[GOST_ARCHIVE_TRAILER_SIZE];
+    archive.readAt(trailer, sizeof(trailer), file_size - sizeof(trailer));
+    ArchiveLayout layout;
+    layout.iv.assign(header + 16, header + 16 + GOST_IV_SIZE_BYTES);
+    layout.data_size = load_le(trailer, 8);
+    uint64_t index_size = load_le(trailer + 8, 8);
+    uint64_t payload = file_size - GOST_ARCHIVE_HEADER_SIZE - GOST_ARCHIVE_TRAILER_SIZE;
+    if (!std::equal(GOST_ARCHIVE_END_MAGIC, GOST_ARCHIVE_END_MAGIC + sizeof(GOST_ARCHIVE_END_MAGIC), trailer + 16) ||
+        layout.data_size > payload || index_size != payload - layout.data_size || index_size < 8 + 4) {
+        throw std::runtime_error("Archive is truncated or damaged.");
+    }
+
+    std::vector<unsigned char> index(static_cast<size_t>(index_size));
+    archive.readAt(index.data(), index.size(), GOST_ARCHIVE_HEADER_SIZE + layout.data_size);
+    gost_apply_keystream(index.data(), index.data(), index.size(), layout.data_size, key.data(),
+                         layout.iv.data());
+    if (load_le(index.data() + index.size() - 4, 4) != cipher_crc32c(0, index.data(), index.size() - 4)) {
+        throw std::runtime_error("Wrong key or damaged archive index.");
+    }
+    const unsigned char *in = index.data() + 8;
+    const unsigned char *end = index.data() + index.size() - 4;
+    uint64_t count = load_le(index.data(), 8);
+    if (count > static_cast<uint64_t>(end - in) / ENTRY_FIXED_SIZE) {
+        throw std::runtime_error("Damaged archive index.");
+    }
+    layout.entries.resize(static_cast<size_t>(count));
+    for (GostArchiveEntry &entry : layout.entries) {
+        if (static_cast<size_t>(end - in) < ENTRY_FIXED_SIZE) throw std::runtime_error("Damaged archive index.");
+        entry.offset = load_le(in, 8);
+        entry.size = load_le(in + 8, 8);
+        entry.mtime = static_cast<int64_t>(load_le(in + 16, 8));
+        entry.crc = static_cast<uint32_t>(load_le(in + 24, 4));
+        size_t length = static_cast<size_t>(load_le(in + 28, 2));
+        in += ENTRY_FIXED_SIZE;
+        if (static_cast<size_t>(end - in) < length || entry.offset > layout.data_size ||
+            entry.size > layout.data_size - entry.offset) {
+            throw std::runtime_error("Damaged archive index.");
+        }
+        entry.path.assign(in, in + length);
+        in += length;
+    }
+    return layout;
+}
+
+// Путь из архива не должен выводить за каталог извлечения.
+bool safe_member_path(const std::string &name) {
+    if (name.empty()) return false;
+#ifdef _WIN32
+    if (name.find_first_of("\\:") != std::string::npos) return false;
+#endif
+    fs::path path(name);
+    if (path.is_absolute() || path.has_root_path()) return false;
+    for (const fs::path &part : path) {
+        if (part.empty() || part == "." || part == "..") return false;
+    }
+    return true;
+}
+
+// Записи для извлечения в порядке смещений: members — пути файлов или каталогов.
+std::vector<const GostArchiveEntry *> select_entries(const std::vector<GostArchiveEntry> &entries,
+                                                     const std::vector<std::string> &members) {
+    std::vector<char> selected(entries.size(), members.empty());
+    for (std::string member : members) {
+        while (member.size() > 1 && member.back() == '/') member.pop_back();
+        bool found = false;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const std::string &path = entries[i].path;
+            if (path == member || (path.size() > member.size() && path.compare(0, member.size(), member) == 0 &&
+                                   path[member.size()] == '/')) {
+                selected[i] = found = true;
+            }
+        }
+        if (!found) throw std::runtime_error("Archive has no member: " + member);
+    }
+    std::vector<const GostArchiveEntry *> result;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (!selected[i]) continue;
+        if (!safe_member_path(entries[i].path)) {
+            throw std::runtime_error("Unsafe path in archive: " + entries[i].path);
+        }
+        result.push_back(&entries[i]);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const GostArchiveEntry *a, const GostArchiveEntry *b) { return a->offset < b->offset; });
+    return result;
+}
+
+void check_member(const GostArchiveEntry &entry, uint32_t crc) {
+    if (crc != entry.crc) {
+        throw std::runtime_error("Corrupted archive member " + entry.path + " (CRC32C mismatch).");
+    }
+}
+
+} // namespace
+
+bool gost_is_archive(const unsigned char *data, size_t size) {
+    return size >= sizeof(GOST_ARCHIVE_MAGIC) &&
+           std::equal(GOST_ARCHIVE_MAGIC, GOST_ARCHIVE_MAGIC + sizeof(GOST_ARCHIVE_MAGIC), data);
+}
+
+GostFileOperationResult encryptArchiveGOST(const std::vector<std::string> &inputPaths,
+                                           const std::string &archivePath,
+                                           const std::string &key_hex,
+                                           const std::string &iv_hex,
+                                           const CipherStatsSinkC *stats) {
+    GostFileOperationResult fres;
+    try {
+        CipherStageTimer parseTimer(stats, CIPHER_STAGE_PARSE);
+        std::vector<unsigned char> key = parse_key(key_hex);
+        std::vector<unsigned char> iv;
+        if (!iv_hex.empty()) {
+            iv = hexStringToBytes(iv_hex);
+            if (iv.size() != GOST_IV_SIZE_BYTES) {
+                fres.message = "Invalid IV length for archive.";
+                return fres;
+            }
+        } else {
+            generateRandomBytes(iv, GOST_IV_SIZE_BYTES);
+        }
+        fres.used_iv_hex = bytesToHexString(iv);
+        parseTimer.stop();
+
+        CipherStageTimer readTimer(stats, CIPHER_STAGE_READ);
+        readTimer.pause();
+        CipherStageTimer transformTimer(stats, CIPHER_STAGE_TRANSFORM);
+        transformTimer.pause();
+        CipherStageTimer writeTimer(stats, CIPHER_STAGE_WRITE);
+        writeTimer.pause();
+
+        GostFile output(archivePath, true, true);
+        uint64_t ignored_size;
+        int64_t ignored_mtime;
+        FileId archive_id;
+        stat_file(archivePath, ignored_size, ignored_mtime, archive_id);
+        readTimer.resume();
+        std::vector<Source> sources = collect_sources(inputPaths, archive_id);
+        readTimer.pause();
+        uint64_t data_size = 0;
+        for (Source &source : sources) {
+            source.entry.offset = data_size;
+            data_size += source.entry.size;
+        }
+
+        unsigned char header[GOST_ARCHIVE_HEADER_SIZE] = {};
+        std::copy(GOST_ARCHIVE_MAGIC, GOST_ARCHIVE_MAGIC + sizeof(GOST_ARCHIVE_MAGIC), header);
+        std::copy(iv.begin(), iv.end(), header + 16);
+        writeTimer.resume();
+        output.writeAt(header, sizeof(header), 0);
+        writeTimer.addBytes(sizeof(header));
+        writeTimer.pause();
+
+        std::vector<unsigned char> buffer;
+        for (size_t first = 0; first < sources.size();) {
+            const GostArchiveEntry &head = sources[first].entry;
+            if (head.size > BATCH_BYTES) {
+                // Крупный файл — частями, с одной CRC32C на весь файл.
+                Source &source = sources[first++];
+                std::ifstream file(source.path, std::ios::binary);
+                if (!file) throw std::runtime_error("Error opening input file: " + source.path);
+                buffer.resize(BATCH_BYTES);
+                uint32_t crc = 0;
+                for (uint64_t done = 0; done < head.size;) {
+                    size_t part = static_cast<size_t>(std::min<uint64_t>(BATCH_BYTES, head.size - done));
+                    readTimer.resume();
+                    read_source(file, source, buffer.data(), part, done + part == head.size);
+                    readTimer.addBytes(part);
+                    readTimer.pause();
+                    transformTimer.resume();
+                    crc = cipher_crc32c(crc, buffer.data(), part);
+                    gost_apply_keystream(buffer.data(), buffer.data(), part, head.offset + done, key.data(),
+                                         iv.data());
+                    transformTimer.addBytes(part);
+                    transformTimer.pause();
+                    writeTimer.resume();
+                    output.writeAt(buffer.data(), part, GOST_ARCHIVE_HEADER_SIZE + head.offset + done);
+                    writeTimer.addBytes(part);
+                    writeTimer.pause();
+                    done += part;
+                }
+                source.entry.crc = crc;
+                continue;
+            }
+
+            size_t last = first;
+            size_t bytes = 0;
+            while (last < sources.size() && last - first < BATCH_FILES &&
+                   bytes + sources[last].entry.size <= BATCH_BYTES) {
+                bytes += static_cast<size_t>(sources[last++].entry.size);
+            }
+            size_t count = last - first;
+            buffer.resize(bytes);
+
+            // Мелкие файлы читаются параллельно: на открытие и чтение каждого
+            // приходится по несколько системных вызовов, которые так перекрываются.
+            readTimer.resume();
+            cipherParallelFor(count * INDEX_SPAN, INDEX_SPAN, 0, [&](uint64_t from, uint64_t to, unsigned) {
+                for (uint64_t i = from / INDEX_SPAN; i < to / INDEX_SPAN; ++i) {
+                    const Source &source = sources[first + i];
+                    std::ifstream file(source.path, std::ios::binary);
+                    if (!file) throw std::runtime_error("Error opening input file: " + source.path);
+                    read_source(file, source, buffer.data() + (source.entry.offset - head.offset),
+                                static_cast<size_t>(source.entry.size), true);
+                }
+            });
+            readTimer.addBytes(bytes);
+            readTimer.pause();
+
+            transformTimer.resume();
+            cipherParallelFor(count * INDEX_SPAN, INDEX_SPAN, 0, [&](uint64_t from, uint64_t to, unsigned) {
+                for (uint64_t i = from / INDEX_SPAN; i < to / INDEX_SPAN; ++i) {
+                    GostArchiveEntry &entry = sources[first + i].entry;
+                    entry.crc = cipher_crc32c(0, buffer.data() + (entry.offset - head.offset),
+                                              static_cast<size_t>(entry.size));
+                }
+            });
+            gost_apply_keystream(buffer.data(), buffer.data(), bytes, head.offset, key.data(), iv.data());
+            transformTimer.addBytes(bytes);
+            transformTimer.pause();
+
+            writeTimer.resume();
+            output.writeAt(buffer.data(), bytes, GOST_ARCHIVE_HEADER_SIZE + head.offset);
+            writeTimer.addBytes(bytes);
+            writeTimer.pause();
+            first = last;
+        }
+
+        std::vector<unsigned char> index = build_index(sources);
+        gost_apply_keystream(index.data(), index.data(), index.size(), data_size, key.data(), iv.data());
+        unsigned char trailer[GOST_ARCHIVE_TRAILER_SIZE];
+        store_le(trailer, data_size, 8);
+        store_le(trailer + 8, index.size(), 8);
+        std::copy(GOST_ARCHIVE_END_MAGIC, GOST_ARCHIVE_END_MAGIC + sizeof(GOST_ARCHIVE_END_MAGIC), trailer + 16);
+        index.insert(index.end(), trailer, trailer + sizeof(trailer));
+        writeTimer.resume();
+        output.writeAt(index.data(), index.size(), GOST_ARCHIVE_HEADER_SIZE + data_size);
+        writeTimer.addBytes(index.size());
+        writeTimer.pause();
+
+        fres.success = true;
+        fres.message = "Archive created: " + std::to_string(sources.size()) + " files, " +
+                       std::to_string(data_size) + " bytes.";
+    } catch (const std::exception &e) {
+        fres.message = std::string("C++ Exception during archive creation: ") + e.what();
+    }
+    return fres;
+}
+
+GostFileOperationResult extractArchiveGOST(const std::string &archivePath,
+                                           const std::string &outputDir,
+                                           const std::string &key_hex,
+                                           const std::vector<std::string> &members,
+                                           const CipherStatsSinkC *stats) {
+    GostFileOperationResult fres;
+    try {
+        CipherStageTimer parseTimer(stats, CIPHER_STAGE_PARSE);
+        std::vector<unsigned char> key = parse_key(key_hex);
+        parseTimer.stop();
+
+        CipherStageTimer readTimer(stats, CIPHER_STAGE_READ);
+        GostFile archive(archivePath, false, false);
+        ArchiveLayout layout = read_layout(archive, fs::file_size(archivePath), key);
+        readTimer.pause();
+        fres.used_iv_hex = bytesToHexString(layout.iv);
+        std::vector<const GostArchiveEntry *> selected = select_entries(layout.entries, members);
+
+        CipherStageTimer transformTimer(stats, CIPHER_STAGE_TRANSFORM);
+        transformTimer.pause();
+        CipherStageTimer writeTimer(stats, CIPHER_STAGE_WRITE);
+        // Каталоги создаются заранее, чтобы участники параллельного цикла только писали файлы.
+        const fs::path root(outputDir);
+        std::set<fs::path> directories{root};
+        for (const GostArchiveEntry *entry : selected) directories.insert((root / entry->path).parent_path());
+        for (const fs::path &directory : directories) fs::create_directories(directory);
+        writeTimer.pause();
+
+        std::vector<unsigned char> buffer;
+        uint64_t bytes_extracted = 0;
+        for (size_t first = 0; first < selected.size();) {
+            const GostArchiveEntry &head = *selected[first];
+            if (head.size > BATCH_BYTES) {
+                const std::string target = (root / head.path).string();
+                {
+                    GostFile file(target, true, true);
+                    buffer.resize(BATCH_BYTES);
+                    uint32_t crc = 0;
+                    for (uint64_t done = 0; done < head.size;) {
+                        size_t part = static_cast<size_t>(std::min<uint64_t>(BATCH_BYTES, head.size - done));
+                        readTimer.resume();
+                        archive.readAt(buffer.data(), part, GOST_ARCHIVE_HEADER_SIZE + head.offset + done);
+                        readTimer.addBytes(part);
+                        readTimer.pause();
+                        transformTimer.resume();
+                        gost_apply_keystream(buffer.data(), buffer.data(), part, head.offset + done, key.data(),
+                                             layout.iv.data());
+                        crc = cipher_crc32c(crc, buffer.data(), part);
+                        transformTimer.addBytes(part);
+                        transformTimer.pause();
+                        writeTimer.resume();
+                        file.writeAt(buffer.data(), part, done);
+                        writeTimer.addBytes(part);
+                        writeTimer.pause();
+                        done += part;
+                    }
+                    check_member(head, crc);
+                }
+                set_file_mtime(target, head.mtime);
+                bytes_extracted += head.size;
+                ++first;
+                continue;
+            }
+
+            // Соседние файлы читаются одним блоком вместе с небольшими промежутками.
+            size_t last = first + 1;
+            uint64_t end = head.offset + head.size;
+            while (last < selected.size() && last - first < BATCH_FILES) {
+                const GostArchiveEntry &entry = *selected[last];
+                uint64_t entry_end = std::max(end, entry.offset + entry.size);
+                if (entry.offset > end + MAX_GAP || entry_end - head.offset > BATCH_BYTES) break;
+                end = entry_end;
+                ++last;
+            }
+            size_t count = last - first;
+            size_t span = static_cast<size_t>(end - head.offset);
+            buffer.resize(span);
+
+            readTimer.resume();
+            archive.readAt(buffer.data(), span, GOST_ARCHIVE_HEADER_SIZE + head.offset);
+            readTimer.addBytes(span);
+            readTimer.pause();
+
+            transformTimer.resume();
+            gost_apply_keystream(buffer.data(), buffer.data(), span, head.offset, key.data(), layout.iv.data());
+            cipherParallelFor(count * INDEX_SPAN, INDEX_SPAN, 0, [&](uint64_t from, uint64_t to, unsigned) {
+                for (uint64_t i = from / INDEX_SPAN; i < to / INDEX_SPAN; ++i) {
+                    const GostArchiveEntry &entry = *selected[first + i];
+                    check_member(entry, cipher_crc32c(0, buffer.data() + (entry.offset - head.offset),
+                                                      static_cast<size_t>(entry.size)));
+                }
+            });
+            transformTimer.addBytes(span);
+            transformTimer.pause();
+
+            writeTimer.resume();
+            cipherParallelFor(count * INDEX_SPAN, INDEX_SPAN, 0, [&](uint64_t from, uint64_t to, unsigned) {
+                for (uint64_t i = from / INDEX_SPAN; i < to / INDEX_SPAN; ++i) {
+                    const GostArchiveEntry &entry = *selected[first + i];
+                    const std::string target = (root / entry.path).string();
+                    {
+                        GostFile file(target, true, true);
+                        file.writeAt(buffer.data() + (entry.offset - head.offset), static_cast<size_t>(entry.size),
+                                     0);
+                    }
+                    set_file_mtime(target, entry.mtime);
+                }
+            });
+            writeTimer.pause();
+            for (size_t i = first; i < last; ++i) bytes_extracted += selected[i]->size;
+            first = last;
+        }
+        writeTimer.addBytes(bytes_extracted);
+
+        fres.success = true;
+        fres.message = "Archive extracted: " + std::to_string(selected.size()) + " of " +
+                       std::to_string(layout.entries.size()) + " files, " + std::to_string(bytes_extracted) +
+                       " bytes.";
+    } catch (const std::exception &e) {
+        fres.message = std::string("C++ Exception during archive extraction: ") + e.what();
+    }
+    return fres;
+}
+
+GostFileOperationResult listArchiveGOST(const std::string &archivePath,
+                                        const std::string &key_hex,
+                                        std::vector<GostArchiveEntry> &entries) {
+    GostFileOperationResult fres;
+    try {
+        std::vector<unsigned char> key = parse_key(key_hex);
+        GostFile archive(archivePath, false, false);
+        ArchiveLayout layout = read_layout(archive, fs::file_size(archivePath), key);
+        entries = std::move(layout.entries);
+        fres.used_iv_hex = bytesToHexString(layout.iv);
+        fres.success = true;
+        fres.message = "Archive contains " + std::to_string(entries.size()) + " files.";
+    } catch (const std::exception &e) {
+        fres.message = std::string("C++ Exception while reading archive index: ") + e.what();
+    }
+    return fres;
+}
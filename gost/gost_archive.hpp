@@ -0,0 +1,62 @@
+#ifndef GOST_ARCHIVE_HPP
+#define GOST_ARCHIVE_HPP
+
+// Архив многих файлов в одном зашифрованном потоке (GostFileOptions::archive):
+// у отдельного файла нет ни своего выходного файла, ни IV, ни дополнения, а
+// выход пишется крупными последовательными блоками.
+//
+// Заголовок открытым текстом: сигнатура "GOSTARC1", флаги (uint32 LE, 0),
+// резерв (4 байта) и IV. Далее содержимое файлов подряд, без выравнивания,
+// за ним индекс, а в конце хвост открытым текстом: размер данных и размер
+// индекса (uint64 LE) и сигнатура "GOSTAEND". Данные и индекс зашифрованы как
+// один поток гаммы с позиции 0 без дополнения, поэтому любой файл
+// расшифровывается отдельно по смещению из индекса.
+//
+// Индекс: число записей (uint64 LE), затем для каждого файла смещение и
+// размер в потоке данных, время изменения (нс от эпохи Unix), CRC32C
+// содержимого (uint32 LE), длина пути (uint16 LE) и путь (UTF-8, разделитель
+// '/'); в конце CRC32C всего индекса, по которой узнаётся неверный ключ.
+// Каталоги хранятся только как части путей файлов.
+
+#include "gost.hpp"
+
+const unsigned char GOST_ARCHIVE_MAGIC[8] = {'G', 'O', 'S', 'T', 'A', 'R', 'C', '1'};
+const unsigned char GOST_ARCHIVE_END_MAGIC[8] = {'G', 'O', 'S', 'T', 'A', 'E', 'N', 'D'};
+const size_t GOST_ARCHIVE_HEADER_SIZE = sizeof(GOST_ARCHIVE_MAGIC) + 8 + GOST_IV_SIZE_BYTES;
+const size_t GOST_ARCHIVE_TRAILER_SIZE = 16 + sizeof(GOST_ARCHIVE_END_MAGIC);
+
+// true — данные начинаются с сигнатуры архива.
+bool gost_is_archive(const unsigned char *data, size_t size);
+
+struct GostArchiveEntry {
+    std::string path;
+    uint64_t offset = 0; // в потоке данных
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint32_t crc = 0;
+};
+
+// Упаковывает файлы и каталоги inputPaths (каталоги — рекурсивно, путь
+// внутри архива начинается с имени каталога) в archivePath. Файлы читаются и
+// шифруются параллельно порциями на общем пуле потоков.
+GostFileOperationResult encryptArchiveGOST(const std::vector<std::string> &inputPaths,
+                                           const std::string &archivePath,
+                                           const std::string &key_hex,
+                                           const std::string &iv_hex = "",
+                                           const CipherStatsSinkC *stats = nullptr);
+
+// Извлекает members (пути файлов или каталогов внутри архива; пусто — все) в
+// каталог outputDir. Соседние файлы читаются из архива одним блоком и
+// расшифровываются и записываются параллельно; содержимое сверяется с CRC32C.
+GostFileOperationResult extractArchiveGOST(const std::string &archivePath,
+                                           const std::string &outputDir,
+                                           const std::string &key_hex,
+                                           const std::vector<std::string> &members = {},
+                                           const CipherStatsSinkC *stats = nullptr);
+
+// Оглавление архива; читается только индекс.
+GostFileOperationResult listArchiveGOST(const std::string &archivePath,
+                                        const std::string &key_hex,
+                                        std::vector<GostArchiveEntry> &entries);
+
+#endif // GOST_ARCHIVE_HPP
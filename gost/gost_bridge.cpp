@@ -1,22 +1,58 @@
 #include "gost_bridge.h"
 #include "gost.hpp"
+#include "gost_archive.hpp"
+#include <cstdio>
 #include <cstring>
 #include <string>
 
 
-char* duplicate_string(const std::string& s) {
+static char* duplicate_string(const std::string& s) {
     char* cstr = new char[s.length() + 1];
-    std::strcpy(cstr, s.c_str());
+    std::memcpy(cstr, s.c_str(), s.length() + 1);
     return cstr;
 }
 
+// Arguments of encryptFileGOSTAsync_C, copied for the job thread.
+struct GostEncryptFileWork {
+    std::string inputFilePath;
+    std::string outputFilePath;
+    std::string key_hex;
+    std::string initial_iv_hex;
+};
+
+static void run_encrypt_file_gost(CipherAsyncJobC* job, void* work, const CipherProgressC* progress) {
+    auto* args = static_cast<GostEncryptFileWork*>(work);
+    GostFileOperationResult result = encryptFileGOST(args->inputFilePath, args->outputFilePath, args->key_hex,
+                                                     args->initial_iv_hex, {}, nullptr, progress);
+    if (!result.success && cipher_async_stopped(job)) std::remove(args->outputFilePath.c_str());
+    cipher_async_finish(job, result.success, result.message.c_str(),
+                        result.success ? result.used_iv_hex.c_str() : nullptr);
+}
+
+static void free_encrypt_file_gost(void* work) {
+    delete static_cast<GostEncryptFileWork*>(work);
+}
+
 extern "C" {
 
 DLL_EXPORT GostEncryptedTextResultC encryptTextGOST_C(const char* plaintext,
                                                         const char* key_hex,
                                                         const char* iv_hex) {
+    return encryptTextGOSTEncoded_C(plaintext, key_hex, iv_hex, CIPHER_TEXT_HEX);
+}
+
+DLL_EXPORT GostDecryptedTextResultC decryptTextGOST_C(const char* iv_hex,
+                                                        const char* ciphertext_hex,
+                                                        const char* key_hex) {
+    return decryptTextGOSTEncoded_C(iv_hex, ciphertext_hex, key_hex, CIPHER_TEXT_HEX);
+}
+
+DLL_EXPORT GostEncryptedTextResultC encryptTextGOSTEncoded_C(const char* plaintext,
+                                                               const char* key_hex,
+                                                               const char* iv_hex,
+                                                               CipherTextEncodingC encoding) {
     std::string iv_hex_str = (iv_hex) ? iv_hex : "";
-    GostEncryptedTextResult result = encryptTextGOST(plaintext, key_hex, iv_hex_str);
+    GostEncryptedTextResult result = encryptTextGOST(plaintext, key_hex, iv_hex_str, encoding);
     GostEncryptedTextResultC c_result;
     c_result.success = result.success;
     c_result.iv_hex = result.success ? duplicate_string(result.iv_hex) : nullptr;
@@ -25,10 +61,11 @@ DLL_EXPORT GostEncryptedTextResultC encryptTextGOST_C(const char* plaintext,
     return c_result;
 }
 
-DLL_EXPORT GostDecryptedTextResultC decryptTextGOST_C(const char* iv_hex,
-                                                        const char* ciphertext_hex,
-                                                        const char* key_hex) {
-    GostDecryptedTextResult result = decryptTextGOST(iv_hex, ciphertext_hex, key_hex);
+DLL_EXPORT GostDecryptedTextResultC decryptTextGOSTEncoded_C(const char* iv_hex,
+                                                               const char* ciphertext,
+                                                               const char* key_hex,
+                                                               CipherTextEncodingC encoding) {
+    GostDecryptedTextResult result = decryptTextGOST(iv_hex, ciphertext, key_hex, encoding);
     GostDecryptedTextResultC c_result;
     c_result.success = result.success;
     c_result.plaintext = result.success ? duplicate_string(result.plaintext) : nullptr;
@@ -40,19 +77,16 @@ DLL_EXPORT GostFileOperationResultC encryptFileGOST_C(const char* inputFilePath,
                                                         const char* outputFilePath,
                                                         const char* key_hex,
                                                         const char* initial_iv_hex) {
-    std::string initial_iv_hex_str = (initial_iv_hex) ? initial_iv_hex : "";
-    GostFileOperationResult result = encryptFileGOST(inputFilePath, outputFilePath, key_hex, initial_iv_hex_str);
-    GostFileOperationResultC c_result;
-    c_result.success = result.success;
-    c_result.message = duplicate_string(result.message);
-    c_result.used_iv_hex = result.success ? duplicate_string(result.used_iv_hex) : nullptr;
-    return c_result;
+    return encryptFileGOSTStats_C(inputFilePath, outputFilePath, key_hex, initial_iv_hex, nullptr);
 }
 
 DLL_EXPORT GostFileOperationResultC decryptFileGOST_C(const char* inputFilePath,
                                                         const char* outputFilePath,
                                                         const char* key_hex) {
-    GostFileOperationResult result = decryptFileGOST(inputFilePath, outputFilePath, key_hex);
+    return decryptFileGOSTStats_C(inputFilePath, outputFilePath, key_hex, nullptr);
+}
+
+static GostFileOperationResultC to_c_file_result(const GostFileOperationResult& result) {
     GostFileOperationResultC c_result;
     c_result.success = result.success;
     c_result.message = duplicate_string(result.message);
@@ -60,6 +94,130 @@ DLL_EXPORT GostFileOperationResultC decryptFileGOST_C(const char* inputFilePath,
     return c_result;
 }
 
+DLL_EXPORT GostFileOperationResultC encryptFileGOSTStats_C(const char* inputFilePath,
+                                                             const char* outputFilePath,
+                                                             const char* key_hex,
+                                                             const char* initial_iv_hex,
+                                                             const CipherStatsSinkC* stats) {
+    std::string initial_iv_hex_str = (initial_iv_hex) ? initial_iv_hex : "";
+    return to_c_file_result(encryptFileGOST(inputFilePath, outputFilePath, key_hex, initial_iv_hex_str,
+                                            GostFileOptions(), stats));
+}
+
+DLL_EXPORT GostFileOperationResultC encryptFileGOSTCompressed_C(const char* inputFilePath,
+                                                              const char* outputFilePath,
+                                                              const char* key_hex,
+                                                              const char* initial_iv_hex,
+                                                              const CipherStatsSinkC* stats) {
+    std::string initial_iv_hex_str = (initial_iv_hex) ? initial_iv_hex : "";
+    GostFileOptions options;
+    options.compress = true;
+    return to_c_file_result(encryptFileGOST(inputFilePath, outputFilePath, key_hex, initial_iv_hex_str,
+                                            options, stats));
+}
+
+DLL_EXPORT GostFileOperationResultC appendFileGOST_C(const char* inputFilePath,
+                                                     const char* encryptedFilePath,
+                                                     const char* key_hex,
+                                                     const CipherStatsSinkC* stats) {
+    GostFileOptions options;
+    options.append = true;
+    return to_c_file_result(encryptFileGOST(inputFilePath, encryptedFilePath, key_hex, "", options, stats));
+}
+
+DLL_EXPORT GostFileOperationResultC encryptFileGOSTCheckpointed_C(const char* inputFilePath,
+                                                                  const char* outputFilePath,
+                                                                  const char* key_hex,
+                                                                  const char* initial_iv_hex,
+                                                                  unsigned long long checkpoint_interval,
+                                                                  int resume,
+                                                                  const CipherStatsSinkC* stats) {
+    std::string initial_iv_hex_str = (initial_iv_hex) ? initial_iv_hex : "";
+    GostFileOptions options;
+    options.checkpoint_interval = checkpoint_interval;
+    options.resume = resume != 0;
+    return to_c_file_result(encryptFileGOST(inputFilePath, outputFilePath, key_hex, initial_iv_hex_str,
+                                            options, stats));
+}
+
+DLL_EXPORT GostFileOperationResultC encryptFileGOSTDelta_C(const char* inputFilePath,
+                                                           const char* outputFilePath,
+                                                           const char* key_hex,
+                                                           const char* baseFilePath,
+                                                           const CipherStatsSinkC* stats) {
+    GostFileOptions options;
+    options.delta = true;
+    options.delta_base = (baseFilePath) ? baseFilePath : "";
+    return to_c_file_result(encryptFileGOST(inputFilePath, outputFilePath, key_hex, "", options, stats));
+}
+
+static std::vector<std::string> to_string_list(const char* const* items, size_t count) {
+    std::vector<std::string> result;
+    for (size_t i = 0; items && i < count; ++i) {
+        if (items[i]) result.push_back(items[i]);
+    }
+    return result;
+}
+
+DLL_EXPORT GostFileOperationResultC encryptArchiveGOST_C(const char* const* inputPaths,
+                                                         size_t inputCount,
+                                                         const char* archivePath,
+                                                         const char* key_hex,
+                                                         const char* initial_iv_hex,
+                                                         const CipherStatsSinkC* stats) {
+    std::string initial_iv_hex_str = (initial_iv_hex) ? initial_iv_hex : "";
+    return to_c_file_result(encryptArchiveGOST(to_string_list(inputPaths, inputCount), archivePath ? archivePath : "",
+                                               key_hex ? key_hex : "", initial_iv_hex_str, stats));
+}
+
+DLL_EXPORT GostFileOperationResultC extractArchiveGOST_C(const char* archivePath,
+                                                         const char* outputDir,
+                                                         const char* key_hex,
+                                                         const char* const* members,
+                                                         size_t memberCount,
+                                                         const CipherStatsSinkC* stats) {
+    return to_c_file_result(extractArchiveGOST(archivePath ? archivePath : "", outputDir ? outputDir : "",
+                                               key_hex ? key_hex : "", to_string_list(members, memberCount), stats));
+}
+
+DLL_EXPORT GostFileOperationResultC decryptFileGOSTStats_C(const char* inputFilePath,
+                                                             const char* outputFilePath,
+                                                             const char* key_hex,
+                                                             const CipherStatsSinkC* stats) {
+    return to_c_file_result(decryptFileGOST(inputFilePath, outputFilePath, key_hex, stats));
+}
+
+DLL_EXPORT GostFileOperationResultC encryptFileGOSTDirect_C(const char* inputFilePath,
+                                                            const char* outputFilePath,
+                                                            const char* key_hex,
+                                                            const char* initial_iv_hex,
+                                                            const CipherStatsSinkC* stats) {
+    std::string initial_iv_hex_str = (initial_iv_hex) ? initial_iv_hex : "";
+    GostFileOptions options;
+    options.direct_io = true;
+    return to_c_file_result(encryptFileGOST(inputFilePath, outputFilePath, key_hex, initial_iv_hex_str,
+                                            options, stats));
+}
+
+DLL_EXPORT GostFileOperationResultC decryptFileGOSTDirect_C(const char* inputFilePath,
+                                                            const char* outputFilePath,
+                                                            const char* key_hex,
+                                                            const CipherStatsSinkC* stats) {
+    GostFileOptions options;
+    options.direct_io = true;
+    return to_c_file_result(decryptFileGOST(inputFilePath, outputFilePath, key_hex, options, stats));
+}
+
+DLL_EXPORT CipherAsyncJobC* encryptFileGOSTAsync_C(const char* inputFilePath,
+                                                   const char* outputFilePath,
+                                                   const char* key_hex,
+                                                   const char* initial_iv_hex,
+                                                   const CipherAsyncOptionsC* options) {
+    auto* work = new GostEncryptFileWork{inputFilePath, outputFilePath, key_hex,
+                                         initial_iv_hex ? initial_iv_hex : ""};
+    return cipher_async_submit(run_encrypt_file_gost, work, free_encrypt_file_gost, options);
+}
+
 // --- Added for Key Generation ---
 DLL_EXPORT GostKeyGenResultC generateKeyGOST_C() {
     GostKeyGenResult result = generateKeyGOST();
@@ -70,6 +228,26 @@ DLL_EXPORT GostKeyGenResultC generateKeyGOST_C() {
     return c_result;
 }
 
+DLL_EXPORT GostStatusC encryptGOSTInto_C(const unsigned char* plaintext, size_t plaintext_size,
+                                         const unsigned char* key, const unsigned char* iv,
+                                         unsigned char* output, size_t output_capacity, size_t* output_size) {
+    if ((!plaintext && plaintext_size) || !key || !iv || !output_size) return GOST_STATUS_INVALID_ARGUMENT;
+    *output_size = gost_ciphertext_size(plaintext_size);
+    if (output_capacity < *output_size || (!output && *output_size)) return GOST_STATUS_BUFFER_TOO_SMALL;
+    gost_encrypt_into(plaintext, plaintext_size, key, iv, output);
+    return GOST_STATUS_OK;
+}
+
+DLL_EXPORT GostStatusC decryptGOSTInto_C(const unsigned char* ciphertext, size_t ciphertext_size,
+                                         const unsigned char* key, const unsigned char* iv,
+                                         unsigned char* output, size_t output_capacity, size_t* output_size) {
+    if ((!ciphertext && ciphertext_size) || !key || !iv || !output_size) return GOST_STATUS_INVALID_ARGUMENT;
+    if (!gost_plaintext_size(ciphertext, ciphertext_size, key, iv, *output_size)) return GOST_STATUS_INVALID_DATA;
+    if (output_capacity < *output_size || (!output && *output_size)) return GOST_STATUS_BUFFER_TOO_SMALL;
+    gost_decrypt_into(ciphertext, *output_size, key, iv, output);
+    return GOST_STATUS_OK;
+}
+
 // --- Memory Freeing Functions ---
 DLL_EXPORT void free_gost_encrypted_result_C(GostEncryptedTextResultC* result) {
     if (!result) return;
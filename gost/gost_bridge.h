@@ -1,6 +1,13 @@
 #ifndef GOST_BRIDGE_H
 #define GOST_BRIDGE_H
 
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cipher_async.h"
+#include "cipher_stats.h"
+#include "text_encoding.h"
+
 #ifdef _WIN32
 #define DLL_EXPORT __declspec(dllexport)
 #else
@@ -47,6 +54,18 @@ DLL_EXPORT GostDecryptedTextResultC decryptTextGOST_C(const char* iv_hex,
                                                     const char* ciphertext_hex,
                                                     const char* key_hex);
 
+// Same as above, with the ciphertext in the given text encoding (hex, Base64
+// or Base85; see runtime/text_encoding.h). The IV stays hex.
+DLL_EXPORT GostEncryptedTextResultC encryptTextGOSTEncoded_C(const char* plaintext,
+                                                           const char* key_hex,
+                                                           const char* iv_hex,
+                                                           CipherTextEncodingC encoding);
+
+DLL_EXPORT GostDecryptedTextResultC decryptTextGOSTEncoded_C(const char* iv_hex,
+                                                           const char* ciphertext,
+                                                           const char* key_hex,
+                                                           CipherTextEncodingC encoding);
+
 DLL_EXPORT GostFileOperationResultC encryptFileGOST_C(const char* inputFilePath,
                                                     const char* outputFilePath,
                                                     const char* key_hex,
@@ -56,10 +75,132 @@ DLL_EXPORT GostFileOperationResultC decryptFileGOST_C(const char* inputFilePath,
                                                     const char* outputFilePath,
                                                     const char* key_hex);
 
+// Same as above; stats (may be NULL) receives per-stage timings:
+// key parsing, read, transform and write (see plugin/cipher_stats.h).
+DLL_EXPORT GostFileOperationResultC encryptFileGOSTStats_C(const char* inputFilePath,
+                                                         const char* outputFilePath,
+                                                         const char* key_hex,
+                                                         const char* initial_iv_hex,
+                                                         const CipherStatsSinkC* stats);
+
+DLL_EXPORT GostFileOperationResultC decryptFileGOSTStats_C(const char* inputFilePath,
+                                                         const char* outputFilePath,
+                                                         const char* key_hex,
+                                                         const CipherStatsSinkC* stats);
+
+// Compresses the data in chunks before encryption and writes the framed format
+// (chunks that do not shrink are stored as is). decryptFileGOST_C and
+// decryptFileGOSTStats_C recognise such files by their header.
+DLL_EXPORT GostFileOperationResultC encryptFileGOSTCompressed_C(const char* inputFilePath,
+                                                              const char* outputFilePath,
+                                                              const char* key_hex,
+                                                              const char* initial_iv_hex,
+                                                              const CipherStatsSinkC* stats);
+
+// Encrypts inputFilePath onto the end of encryptedFilePath (either format) with
+// the IV stored in it; only the header and the last block are read, so the cost
+// depends on the appended size. A missing encryptedFilePath is created as by
+// encryptFileGOST_C. used_iv_hex is the file's IV.
+DLL_EXPORT GostFileOperationResultC appendFileGOST_C(const char* inputFilePath,
+                                                     const char* encryptedFilePath,
+                                                     const char* key_hex,
+                                                     const CipherStatsSinkC* stats);
+
+// Encrypts a file while journaling progress to "<outputFilePath>.ckpt" every
+// checkpoint_interval input bytes (0 with resume: every 256 MiB). With resume
+// != 0 an interrupted job continues from the last verified checkpoint (the
+// checkpoint's IV is used); without a journal it starts from the beginning.
+DLL_EXPORT GostFileOperationResultC encryptFileGOSTCheckpointed_C(const char* inputFilePath,
+                                                                  const char* outputFilePath,
+                                                                  const char* key_hex,
+                                                                  const char* initial_iv_hex,
+                                                                  unsigned long long checkpoint_interval,
+                                                                  int resume,
+                                                                  const CipherStatsSinkC* stats);
+
+// Encrypts a file in the chunked delta format, re-encrypting only the chunks
+// whose plaintext hash differs from "<previous>.manifest". The previous version
+// is baseFilePath (unchanged chunks are cloned or copied from it) or, when
+// baseFilePath is NULL or empty, outputFilePath itself, updated in place.
+// decryptFileGOST_C recognises the format by its header.
+DLL_EXPORT GostFileOperationResultC encryptFileGOSTDelta_C(const char* inputFilePath,
+                                                           const char* outputFilePath,
+                                                           const char* key_hex,
+                                                           const char* baseFilePath,
+                                                           const CipherStatsSinkC* stats);
+
+// Packs inputCount files or directories (directories recursively) into one
+// encrypted archive; small files are read and encrypted in parallel batches.
+// initial_iv_hex may be NULL or empty for a random IV.
+DLL_EXPORT GostFileOperationResultC encryptArchiveGOST_C(const char* const* inputPaths,
+                                                         size_t inputCount,
+                                                         const char* archivePath,
+                                                         const char* key_hex,
+                                                         const char* initial_iv_hex,
+                                                         const CipherStatsSinkC* stats);
+
+// Extracts an archive into outputDir, creating directories as needed. members
+// (memberCount paths of files or directories inside the archive) selects what
+// to extract; NULL or 0 extracts everything. Each file is checked against its
+// CRC32C. decryptFileGOST_C also recognises an archive and extracts all of it.
+DLL_EXPORT GostFileOperationResultC extractArchiveGOST_C(const char* archivePath,
+                                                         const char* outputDir,
+                                                         const char* key_hex,
+                                                         const char* const* members,
+                                                         size_t memberCount,
+                                                         const CipherStatsSinkC* stats);
+
+// Encrypt / decrypt a plain-format file bypassing the page cache (O_DIRECT with
+// aligned 8 MiB blocks; the unaligned tail is written through the cache and
+// dropped). Where the file system rejects O_DIRECT, the processed ranges are
+// evicted from the cache instead; the message says which way was used.
+// Decryption of other formats ignores the direct I/O request.
+DLL_EXPORT GostFileOperationResultC encryptFileGOSTDirect_C(const char* inputFilePath,
+                                                            const char* outputFilePath,
+                                                            const char* key_hex,
+                                                            const char* initial_iv_hex,
+                                                            const CipherStatsSinkC* stats);
+DLL_EXPORT GostFileOperationResultC decryptFileGOSTDirect_C(const char* inputFilePath,
+                                                            const char* outputFilePath,
+                                                            const char* key_hex,
+                                                            const CipherStatsSinkC* stats);
+
+// Asynchronous encryptFileGOST_C: queues the job on the runtime's job pool and
+// returns at once (see runtime/cipher_async.h). The file is encrypted in blocks,
+// reporting input bytes done to options->progress and checking for cancellation
+// and the deadline between blocks; a stopped job removes its partial output.
+// cipher_async_iv_hex gives the IV used. options may be NULL.
+DLL_EXPORT CipherAsyncJobC* encryptFileGOSTAsync_C(const char* inputFilePath,
+                                                   const char* outputFilePath,
+                                                   const char* key_hex,
+                                                   const char* initial_iv_hex,
+                                                   const CipherAsyncOptionsC* options);
+
 // --- Added for Key Generation ---
 DLL_EXPORT GostKeyGenResultC generateKeyGOST_C();
 
 
+// --- Binary-safe buffer API (no allocation inside the library) ---
+// Input is (data, size); the result is written to output (capacity bytes) and its
+// length to *output_size. Size query: pass output == NULL (or a too small buffer)
+// to get GOST_STATUS_BUFFER_TOO_SMALL and the required size. key is
+// 32 raw bytes, iv is 8 raw bytes; output may alias input.
+typedef enum {
+    GOST_STATUS_OK = 0,
+    GOST_STATUS_BUFFER_TOO_SMALL = 1,
+    GOST_STATUS_INVALID_ARGUMENT = 2,
+    GOST_STATUS_INVALID_DATA = 3, // bad padding
+} GostStatusC;
+
+DLL_EXPORT GostStatusC encryptGOSTInto_C(const unsigned char* plaintext, size_t plaintext_size,
+                                         const unsigned char* key, const unsigned char* iv,
+                                         unsigned char* output, size_t output_capacity, size_t* output_size);
+
+DLL_EXPORT GostStatusC decryptGOSTInto_C(const unsigned char* ciphertext, size_t ciphertext_size,
+                                         const unsigned char* key, const unsigned char* iv,
+                                         unsigned char* output, size_t output_capacity, size_t* output_size);
+
+
 // --- Memory Freeing Functions ---
 DLL_EXPORT void free_gost_encrypted_result_C(GostEncryptedTextResultC* result);
 DLL_EXPORT void free_gost_decrypted_result_C(GostDecryptedTextResultC* result);
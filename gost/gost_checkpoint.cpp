@@ -0,0 +1,127 @@
+#include "gost_checkpoint.hpp"
+#include "crc32c.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Сигнатура, формат и флаги, IV, шесть 64-битных полей, CRC32C предыдущих байт.
+const size_t CHECKPOINT_SIZE = 8 + 4 + 4 + 8 + 6 * 8 + 4;
+
+void store_le(unsigned char *&out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) *out++ = static_cast<unsigned char>(value >> (8 * i));
+}
+
+uint64_t load_le(const unsigned char *&in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) value |= static_cast<uint64_t>(*in++) << (8 * i);
+    return value;
+}
+
+} // namespace
+
+std::string gost_checkpoint_path(const std::string &output_path) {
+    return output_path + ".ckpt";
+}
+
+bool gost_read_checkpoint(const std::string &path, GostCheckpoint &checkpoint) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    unsigned char data[CHECKPOINT_SIZE + 1];
+    file.read(reinterpret_cast<char *>(data), sizeof(data));
+    if (static_cast<size_t>(file.gcount()) != CHECKPOINT_SIZE ||
+        !std::equal(GOST_CHECKPOINT_MAGIC, GOST_CHECKPOINT_MAGIC + sizeof(GOST_CHECKPOINT_MAGIC), data)) {
+        throw std::runtime_error("Checkpoint file " + path + " has an unknown format.");
+    }
+    const unsigned char *in = data + CHECKPOINT_SIZE - 4;
+    if (load_le(in, 4) != cipher_crc32c(0, data, CHECKPOINT_SIZE - 4)) {
+        throw std::runtime_error("Checkpoint file " + path + " is damaged (CRC32C mismatch).");
+    }
+    in = data + sizeof(GOST_CHECKPOINT_MAGIC);
+    checkpoint.framed = load_le(in, 4) != 0;
+    checkpoint.framed_flags = static_cast<uint32_t>(load_le(in, 4));
+    std::copy(in, in + sizeof(checkpoint.iv), checkpoint.iv);
+    in += sizeof(checkpoint.iv);
+    checkpoint.input_size = load_le(in, 8);
+    checkpoint.input_mtime = static_cast<int64_t>(load_le(in, 8));
+    checkpoint.input_offset = load_le(in, 8);
+    checkpoint.output_offset = load_le(in, 8);
+    checkpoint.verify_input_offset = load_le(in, 8);
+    checkpoint.verify_output_offset = load_le(in, 8);
+    if (checkpoint.verify_input_offset > checkpoint.input_offset ||
+        checkpoint.verify_output_offset > checkpoint.output_offset ||
+        checkpoint.input_offset > checkpoint.input_size) {
+        throw std::runtime_error("Checkpoint file " + path + " has inconsistent offsets.");
+    }
+    return true;
+}
+
+void gost_write_checkpoint(const std::string &path, const GostCheckpoint &checkpoint) {
+    unsigned char data[CHECKPOINT_SIZE];
+    unsigned char *out = std::copy(GOST_CHECKPOINT_MAGIC, GOST_CHECKPOINT_MAGIC + sizeof(GOST_CHECKPOINT_MAGIC), data);
+    store_le(out, checkpoint.framed ? 1 : 0, 4);
+    store_le(out, checkpoint.framed_flags, 4);
+    out = std::copy(checkpoint.iv, checkpoint.iv + sizeof(checkpoint.iv), out);
+    store_le(out, checkpoint.input_size, 8);
+    store_le(out, static_cast<uint64_t>(checkpoint.input_mtime), 8);
+    store_le(out, checkpoint.input_offset, 8);
+    store_le(out, checkpoint.output_offset, 8);
+    store_le(out, checkpoint.verify_input_offset, 8);
+    store_le(out, checkpoint.verify_output_offset, 8);
+    store_le(out, cipher_crc32c(0, data, CHECKPOINT_SIZE - 4), 4);
+
+    gost_write_file_atomically(path, data, sizeof(data));
+}
+
+void gost_write_file_atomically(const std::string &path, const unsigned char *data, size_t size) {
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(data), size);
+        file.flush();
+        if (!file) {
+            throw std::runtime_error("Error writing " + temp_path + ".");
+        }
+    }
+    if (!gost_sync_file(temp_path)) {
+        throw std::runtime_error("Error syncing " + temp_path + ".");
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        throw std::runtime_error("Error replacing " + path + ": " + ec.message());
+    }
+#ifndef _WIN32
+    // Переименование становится постоянным только после сброса каталога.
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    gost_sync_file(directory.empty() ? "." : directory.string());
+#endif
+}
+
+bool gost_sync_file(const std::string &path) {
+#ifdef _WIN32
+    int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+    if (fd < 0) return false;
+    bool ok = _commit(fd) == 0;
+    _close(fd);
+#else
+    // fsync сбрасывает данные файла, через какой бы дескриптор они ни были записаны.
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+#endif
+    return ok;
+}
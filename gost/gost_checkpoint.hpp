@@ -0,0 +1,51 @@
+#ifndef GOST_CHECKPOINT_HPP
+#define GOST_CHECKPOINT_HPP
+
+// Журнал контрольных точек шифрования файла (GostFileOptions::checkpoint_interval
+// и resume): рядом с выходным файлом лежит "<выход>.ckpt" с сохранённым
+// смещением входа и выхода и состоянием гаммы. Файл журнала заменяется
+// атомарно (запись во временный файл, сброс на диск, переименование) и
+// защищён CRC32C, так что после сбоя в нём либо прежняя, либо новая точка.
+
+#include <cstdint>
+#include <string>
+
+// Состояние шифрования на момент контрольной точки. Гамма зависит только от
+// позиции, поэтому продолжение задаётся IV и позицией потока — числом байт
+// выхода после заголовка (output_offset минус заголовок формата).
+struct GostCheckpoint {
+    bool framed = false;      // блочный формат (GostFileOptions::compress)
+    uint32_t framed_flags = 0;
+    unsigned char iv[8] = {};
+    uint64_t input_size = 0;  // размер и время изменения входа при старте
+    int64_t input_mtime = 0;
+    uint64_t input_offset = 0;  // зашифровано байт входа
+    uint64_t output_offset = 0; // записано и сброшено на диск байт выхода
+    // Последний блок перед точкой: при продолжении он шифруется заново и
+    // сравнивается с выходом, что проверяет ключ, вход и выход.
+    uint64_t verify_input_offset = 0;
+    uint64_t verify_output_offset = 0;
+};
+
+// Сигнатура файла журнала.
+const unsigned char GOST_CHECKPOINT_MAGIC[8] = {'G', 'O', 'S', 'T', 'C', 'K', 'P', '1'};
+
+std::string gost_checkpoint_path(const std::string &output_path);
+
+// false — журнала нет; повреждённый журнал — std::runtime_error.
+bool gost_read_checkpoint(const std::string &path, GostCheckpoint &checkpoint);
+
+// Атомарно заменяет журнал; ошибки — std::runtime_error.
+void gost_write_checkpoint(const std::string &path,
+                           const GostCheckpoint &checkpoint);
+
+// Сбрасывает на диск уже записанные данные файла (fsync).
+bool gost_sync_file(const std::string &path);
+
+// Заменяет файл целиком так, что после сбоя в нём либо прежнее, либо новое
+// содержимое (так же пишется манифест gost/gost_delta.hpp); ошибки —
+// std::runtime_error.
+void gost_write_file_atomically(const std::string &path,
+                                const unsigned char *data, size_t size);
+
+#endif // GOST_CHECKPOINT_HPP
@@ -0,0 +1,168 @@
+#include "gost_compress.hpp"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const size_t MIN_MATCH = 4;
+// Последние LAST_LITERALS байт блока всегда литералы, а совпадение не
+// начинается ближе MATCH_LIMIT байт к концу — как требует формат LZ4.
+const size_t LAST_LITERALS = 5;
+const size_t MATCH_LIMIT = 12;
+const size_t MAX_OFFSET = 65535;
+const unsigned HASH_LOG = 12;
+// Каждые 2^SKIP_TRIGGER неудачных попыток шаг поиска растёт на байт.
+const unsigned SKIP_TRIGGER = 6;
+
+uint32_t read32(const unsigned char *p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hash32(uint32_t value) {
+    return (value * 2654435761u) >> (32 - HASH_LOG);
+}
+
+// Длина 15 и больше продолжается байтами 255 и остатком.
+unsigned char *write_length(unsigned char *op, size_t length) {
+    for (; length >= 255; length -= 255) *op++ = 255;
+    *op++ = static_cast<unsigned char>(length);
+    return op;
+}
+
+bool read_length(const unsigned char *in, size_t size, size_t &ip,
+                 size_t &length) {
+    unsigned char byte;
+    do {
+        if (ip >= size) return false;
+        byte = in[ip++];
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// Худший размер последовательности с literals литералами и совпадением match.
+size_t sequence_bound(size_t literals, size_t match) {
+    return 1 + literals + literals / 255 + 1 + 2 + match / 255 + 1;
+}
+
+unsigned char *write_sequence(unsigned char *op, const unsigned char *literals,
+                              size_t literal_count, size_t offset,
+                              size_t match) {
+    unsigned char *token = op++;
+    if (literal_count >= 15) {
+        *token = 15 << 4;
+        op = write_length(op, literal_count - 15);
+    } else {
+        *token = static_cast<unsigned char>(literal_count << 4);
+    }
+    if (literal_count) std::memcpy(op, literals, literal_count);
+    op += literal_count;
+    if (match == 0) return op; // последняя последовательность — без ссылки
+    *op++ = static_cast<unsigned char>(offset);
+    *op++ = static_cast<unsigned char>(offset >> 8);
+    size_t extra = match - MIN_MATCH;
+    if (extra >= 15) {
+        *token |= 15;
+        op = write_length(op, extra - 15);
+    } else {
+        *token |= static_cast<unsigned char>(extra);
+    }
+    return op;
+}
+
+} // namespace
+
+size_t gost_lz_compress(const unsigned char *in, size_t size,
+                        unsigned char *out, size_t capacity) {
+    unsigned char *op = out;
+    unsigned char *const op_end = out + capacity;
+    size_t anchor = 0;
+    if (size > MATCH_LIMIT) {
+        std::vector<uint32_t> table(size_t(1) << HASH_LOG, 0);
+        const size_t search_end = size - MATCH_LIMIT;
+        const size_t match_end = size - LAST_LITERALS;
+        size_t ip = 1;
+        while (ip <= search_end) {
+            size_t ref = 0;
+            size_t attempts = size_t(1) << SKIP_TRIGGER;
+            bool found = false;
+            for (size_t step = 1; ip <= search_end;
+                 step = attempts++ >> SKIP_TRIGGER) {
+                uint32_t sequence = read32(in + ip);
+                uint32_t &slot = table[hash32(sequence)];
+                ref = slot;
+                slot = static_cast<uint32_t>(ip);
+                if (ip - ref <= MAX_OFFSET && read32(in + ref) == sequence) {
+                    found = true;
+                    break;
+                }
+                ip += step;
+            }
+            if (!found) break;
+            while (ip > anchor && ref > 0 && in[ip - 1] == in[ref - 1]) {
+                --ip;
+                --ref;
+            }
+            size_t match = MIN_MATCH;
+            while (ip + match < match_end && in[ref + match] == in[ip + match]) {
+                ++match;
+            }
+            size_t literal_count = ip - anchor;
+            if (static_cast<size_t>(op_end - op) <
+                sequence_bound(literal_count, match)) {
+                return 0;
+            }
+            op = write_sequence(op, in + anchor, literal_count, ip - ref, match);
+            ip += match;
+            anchor = ip;
+            if (ip <= search_end) {
+                table[hash32(read32(in + ip - 2))] = static_cast<uint32_t>(ip - 2);
+            }
+        }
+    }
+    size_t literal_count = size - anchor;
+    if (static_cast<size_t>(op_end - op) < sequence_bound(literal_count, 0)) {
+        return 0;
+    }
+    op = write_sequence(op, in + anchor, literal_count, 0, 0);
+    return static_cast<size_t>(op - out);
+}
+
+bool gost_lz_decompress(const unsigned char *in, size_t size,
+                        unsigned char *out, size_t capacity,
+                        size_t &out_size) {
+    size_t ip = 0, op = 0;
+    while (ip < size) {
+        unsigned char token = in[ip++];
+        size_t literal_count = token >> 4;
+        if (literal_count == 15 && !read_length(in, size, ip, literal_count)) {
+            return false;
+        }
+        if (literal_count > size - ip || literal_count > capacity - op) {
+            return false;
+        }
+        if (literal_count) std::memcpy(out + op, in + ip, literal_count);
+        ip += literal_count;
+        op += literal_count;
+        if (ip == size) break; // последняя последовательность
+        if (size - ip < 2) return false;
+        size_t offset = in[ip] | static_cast<size_t>(in[ip + 1]) << 8;
+        ip += 2;
+        size_t match = token & 15;
+        if (match == 15 && !read_length(in, size, ip, match)) return false;
+        match += MIN_MATCH;
+        if (offset == 0 || offset > op || match > capacity - op) return false;
+        if (offset >= match) {
+            std::memcpy(out + op, out + op - offset, match);
+        } else {
+            // Перекрывающаяся ссылка повторяет последние offset байт.
+            for (size_t i = 0; i < match; ++i) out[op + i] = out[op - offset + i];
+        }
+        op += match;
+    }
+    out_size = op;
+    return true;
+}
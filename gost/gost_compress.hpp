@@ -0,0 +1,23 @@
+#ifndef GOST_COMPRESS_HPP
+#define GOST_COMPRESS_HPP
+
+// Быстрое сжатие блоков перед шифрованием (формат блока LZ4: последовательности
+// «литералы + ссылка назад не дальше 64 КиБ», минимальное совпадение 4 байта).
+// Сжимает однопроходным жадным поиском по хеш-таблице, на несжимаемых данных
+// шаг поиска растёт, так что они проходят почти со скоростью копирования.
+
+#include <cstddef>
+
+// Сжимает size байт в out (capacity байт) и возвращает размер результата или 0,
+// если он не поместился в capacity. Передавая capacity меньше size, вызывающий
+// задаёт минимальный выигрыш, ниже которого блок выгоднее хранить как есть.
+size_t gost_lz_compress(const unsigned char *in, size_t size,
+                        unsigned char *out, size_t capacity);
+
+// Распаковывает блок size байт в out (не больше capacity байт). false — блок
+// повреждён (выход за границы входа, выхода или ссылка до начала блока).
+bool gost_lz_decompress(const unsigned char *in, size_t size,
+                        unsigned char *out, size_t capacity,
+                        size_t &out_size);
+
+#endif // GOST_COMPRESS_HPP
@@ -0,0 +1,410 @@
+#include "gost_delta.hpp"
+#include "cipher_stats.hpp"
+#include "crc32c.h"
+#include "gost_checkpoint.hpp"
+#include "gost_file.hpp"
+#include "streebog.hpp"
+#include "thread_pool.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+const size_t CHUNK_SIZE = GOST_DELTA_RECORD_SIZE - GOST_DELTA_RECORD_OVERHEAD;
+// Блоков входа в одной порции чтения, хеширования и шифрования.
+const size_t BATCH_CHUNKS = 32;
+// Параллельные циклы идут по индексам блоков: на индекс приходится 4 КиБ
+// диапазона, так что части пула (кратные 4 КиБ) не делят блок.
+const uint64_t INDEX_SPAN = CIPHER_PARALLEL_CHUNK_ALIGNMENT;
+
+const unsigned char MANIFEST_MAGIC[8] = {'G', 'O', 'S', 'T', 'M', 'A', 'N', '1'};
+// Сигнатура, размер записи и резерв, контрольное значение ключа, размер входа,
+// размер и время изменения файла, число блоков; затем хеши блоков и CRC32C
+// всего предыдущего.
+const size_t MANIFEST_HEADER_SIZE = 8 + 4 + 4 + 8 + 4 * 8;
+
+void store_le(unsigned char *out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) out[i] = static_cast<unsigned char>(value >> (8 * i));
+}
+
+uint64_t load_le(const unsigned char *in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    return value;
+}
+
+// SipHash-2-4: хеш с ключом, так что по манифесту нельзя подобрать текст блока.
+struct SipKey {
+    uint64_t k0, k1;
+};
+
+uint64_t rotl(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t siphash24(const SipKey &key, const unsigned char *data, size_t size) {
+    uint64_t v0 = 0x736f6d6570736575ull ^ key.k0;
+    uint64_t v1 = 0x646f72616e646f6dull ^ key.k1;
+    uint64_t v2 = 0x6c7967656e657261ull ^ key.k0;
+    uint64_t v3 = 0x7465646279746573ull ^ key.k1;
+    auto round = [&] {
+        v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+        v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+        v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+        v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+    };
+    size_t whole = size - size % 8;
+    for (size_t i = 0; i < whole; i += 8) {
+        uint64_t m = load_le(data + i, 8);
+        v3 ^= m;
+        round();
+        round();
+        v0 ^= m;
+    }
+    uint64_t last = static_cast<uint64_t>(size) << 56;
+    for (size_t i = 0; i < size % 8; ++i) last |= static_cast<uint64_t>(data[whole + i]) << (8 * i);
+    v3 ^= last;
+    round();
+    round();
+    v0 ^= last;
+    v2 ^= 0xff;
+    for (int i = 0; i < 4; ++i) round();
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+// Ключ хеширования и контрольное значение ключа — части Стрибог-512(ключ ||
+// "GOSTMAN1"): хеш необратим, так что разные ключи шифрования не дают общего
+// ключа хеширования, а контрольное значение не раскрывает ни один из них.
+struct ManifestKeys {
+    SipKey hash;
+    uint64_t check;
+};
+
+ManifestKeys manifest_keys(const std::vector<unsigned char> &key) {
+    Streebog streebog(512);
+    streebog.update(key.data(), key.size());
+    streebog.update(MANIFEST_MAGIC, sizeof(MANIFEST_MAGIC));
+    std::vector<unsigned char> digest = streebog.finish();
+    return {{load_le(digest.data(), 8), load_le(digest.data() + 8, 8)}, load_le(digest.data() + 16, 8)};
+}
+
+size_t chunk_length(uint64_t input_size, uint64_t index) {
+    return static_cast<size_t>(std::min<uint64_t>(CHUNK_SIZE, input_size - index * CHUNK_SIZE));
+}
+
+uint64_t record_offset(uint64_t index) {
+    return GOST_DELTA_HEADER_SIZE + index * GOST_DELTA_RECORD_SIZE;
+}
+
+size_t record_length(size_t chunk) {
+    return GOST_IV_SIZE_BYTES + gost_ciphertext_size(chunk);
+}
+
+struct DeltaManifest {
+    uint32_t record_size = 0;
+    uint64_t key_check = 0;
+    uint64_t input_size = 0;
+    uint64_t output_size = 0;
+    int64_t output_mtime = 0;
+    std::vector<uint64_t> hashes;
+};
+
+int64_t file_mtime(const std::string &path, std::error_code &ec) {
+    return static_cast<int64_t>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+}
+
+// Повреждённый или чужой манифест равнозначен отсутствующему: все блоки
+// будут зашифрованы заново.
+bool read_manifest(const std::string &path, DeltaManifest &manifest) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < MANIFEST_HEADER_SIZE + 4 ||
+        !std::equal(MANIFEST_MAGIC, MANIFEST_MAGIC + sizeof(MANIFEST_MAGIC), data.begin()) ||
+        load_le(data.data() + data.size() - 4, 4) != cipher_crc32c(0, data.data(), data.size() - 4)) {
+        return false;
+    }
+    manifest.record_size = static_cast<uint32_t>(load_le(data.data() + 8, 4));
+    manifest.key_check = load_le(data.data() + 16, 8);
+    manifest.input_size = load_le(data.data() + 24, 8);
+    manifest.output_size = load_le(data.data() + 32, 8);
+    manifest.output_mtime = static_cast<int64_t>(load_le(data.data() + 40, 8));
+    uint64_t count = load_le(data.data() + 48, 8);
+    if (count != (data.size() - MANIFEST_HEADER_SIZE - 4) / 8 ||
+        count != (manifest.input_size + CHUNK_SIZE - 1) / CHUNK_SIZE) {
+        return false;
+    }
+    manifest.hashes.resize(count);
+    for (uint64_t i = 0; i < count; ++i) manifest.hashes[i] = load_le(data.data() + MANIFEST_HEADER_SIZE + 8 * i, 8);
+    return true;
+}
+
+void write_manifest(const std::string &path, const DeltaManifest &manifest) {
+    std::vector<unsigned char> data(MANIFEST_HEADER_SIZE + 8 * manifest.hashes.size() + 4);
+    std::copy(MANIFEST_MAGIC, MANIFEST_MAGIC + sizeof(MANIFEST_MAGIC), data.begin());
+    store_le(data.data() + 8, manifest.record_size, 4);
+    store_le(data.data() + 16, manifest.key_check, 8);
+    store_le(data.data() + 24, manifest.input_size, 8);
+    store_le(data.data() + 32, manifest.output_size, 8);
+    store_le(data.data() + 40, static_cast<uint64_t>(manifest.output_mtime), 8);
+    store_le(data.data() + 48, manifest.hashes.size(), 8);
+    for (size_t i = 0; i < manifest.hashes.size(); ++i) {
+        store_le(data.data() + MANIFEST_HEADER_SIZE + 8 * i, manifest.hashes[i], 8);
+    }
+    store_le(data.data() + data.size() - 4, cipher_crc32c(0, data.data(), data.size() - 4), 4);
+    gost_write_file_atomically(path, data.data(), data.size());
+}
+
+std::vector<unsigned char> delta_header() {
+    std::vector<unsigned char> header(GOST_DELTA_HEADER_SIZE, 0);
+    std::copy(GOST_DELTA_MAGIC, GOST_DELTA_MAGIC + sizeof(GOST_DELTA_MAGIC), header.begin());
+    store_le(header.data() + 8, 0, 4);
+    store_le(header.data() + 12, GOST_DELTA_RECORD_SIZE, 4);
+    return header;
+}
+
+// Прежняя версия пригодна, если её манифест цел, составлен с тем же ключом и
+// описывает именно этот файл. Манифест другого ключа считается отсутствующим:
+// иначе неизменённые блоки остались бы зашифрованы прежним ключом.
+bool load_previous(const std::string &base_path, uint64_t key_check, DeltaManifest &manifest) {
+    std::error_code ec;
+    if (!read_manifest(base_path + ".manifest", manifest) || manifest.record_size != GOST_DELTA_RECORD_SIZE ||
+        manifest.key_check != key_check) {
+        return false;
+    }
+    uint64_t size = std::filesystem::file_size(base_path, ec);
+    int64_t mtime = ec ? 0 : file_mtime(base_path, ec);
+    if (ec || size != manifest.output_size || mtime != manifest.output_mtime) return false;
+    std::ifstream base(base_path, std::ios::binary);
+    std::vector<unsigned char> header(GOST_DELTA_HEADER_SIZE);
+    base.read(reinterpret_cast<char *>(header.data()), header.size());
+    return base && header == delta_header();
+}
+
+} // namespace
+
+bool gost_is_delta(const unsigned char *data, size_t size) {
+    return size >= sizeof(GOST_DELTA_MAGIC) &&
+           std::equal(GOST_DELTA_MAGIC, GOST_DELTA_MAGIC + sizeof(GOST_DELTA_MAGIC), data);
+}
+
+GostFileOperationResult gost_encrypt_file_delta(const std::string &inputFilePath,
+                                                const std::string &outputFilePath,
+                                                const std::vector<unsigned char> &key,
+                                                const GostFileOptions &options,
+                                                const CipherStatsSinkC *stats) {
+    GostFileOperationResult fres;
+    std::error_code ec;
+    bool in_place = options.delta_base.empty() || std::filesystem::equivalent(options.delta_base, outputFilePath, ec);
+    const std::string &base_path = in_place ? outputFilePath : options.delta_base;
+    uint64_t input_size = std::filesystem::file_size(inputFilePath, ec);
+    std::ifstream input(inputFilePath, std::ios::binary);
+    if (ec || !input) {
+        fres.message = "Error opening input file: " + inputFilePath;
+        return fres;
+    }
+
+    CipherStageTimer readTimer(stats, CIPHER_STAGE_READ);
+    readTimer.pause();
+    CipherStageTimer transformTimer(stats, CIPHER_STAGE_TRANSFORM);
+    transformTimer.pause();
+    CipherStageTimer writeTimer(stats, CIPHER_STAGE_WRITE);
+    writeTimer.pause();
+
+    const ManifestKeys manifest_key = manifest_keys(key);
+    DeltaManifest previous;
+    bool have_previous = load_previous(base_path, manifest_key.check, previous);
+    std::unique_ptr<GostFile> base;
+    if (have_previous && !in_place) base.reset(new GostFile(base_path, false, false));
+    // На месте без манифеста файл пишется заново целиком.
+    GostFile output(outputFilePath, true, !(in_place && have_previous));
+    std::vector<unsigned char> header = delta_header();
+    writeTimer.resume();
+    output.writeAt(header.data(), header.size(), 0);
+    writeTimer.addBytes(header.size());
+    writeTimer.pause();
+
+    DeltaManifest current;
+    current.record_size = GOST_DELTA_RECORD_SIZE;
+    current.key_check = manifest_key.check;
+    current.input_size = input_size;
+    uint64_t count = (input_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    current.hashes.resize(count);
+
+    std::vector<unsigned char> plaintext(BATCH_CHUNKS * CHUNK_SIZE);
+    std::vector<unsigned char> records(BATCH_CHUNKS * GOST_DELTA_RECORD_SIZE);
+    std::vector<unsigned char> ivs;
+    std::vector<char> changed(BATCH_CHUNKS);
+    uint64_t reencrypted = 0, kept = 0;
+    for (uint64_t first = 0; first < count; first += BATCH_CHUNKS) {
+        size_t batch = static_cast<size_t>(std::min<uint64_t>(BATCH_CHUNKS, count - first));
+        uint64_t begin = first * CHUNK_SIZE;
+        size_t bytes = static_cast<size_t>(std::min<uint64_t>(batch * CHUNK_SIZE, input_size - begin));
+        readTimer.resume();
+        input.read(reinterpret_cast<char *>(plaintext.data()), bytes);
+        if (static_cast<size_t>(input.gcount()) != bytes) {
+            throw std::runtime_error("Input file changed while it was being read.");
+        }
+        readTimer.addBytes(bytes);
+        readTimer.pause();
+
+        transformTimer.resume();
+        cipherParallelFor(batch * INDEX_SPAN, INDEX_SPAN, 0, [&](uint64_t from, uint64_t to, unsigned) {
+            for (uint64_t i = from / INDEX_SPAN; i < to / INDEX_SPAN; ++i) {
+                current.hashes[first + i] = siphash24(manifest_key.hash, plaintext.data() + i * CHUNK_SIZE,
+                                                      chunk_length(input_size, first + i));
+            }
+        });
+        size_t changed_count = 0;
+        for (size_t i = 0; i < batch; ++i) {
+            uint64_t index = first + i;
+            changed[i] = !(have_previous && index < previous.hashes.size() &&
+                           previous.hashes[index] == current.hashes[index] &&
+                           chunk_length(previous.input_size, index) == chunk_length(input_size, index));
+            changed_count += changed[i];
+        }
+        // Каждому новому шифротексту блока — свой IV.
+        generateRandomBytes(ivs, changed_count * GOST_IV_SIZE_BYTES);
+        for (size_t i = 0, next = 0; i < batch; ++i) {
+            if (!changed[i]) continue;
+            std::copy(ivs.begin() + next * GOST_IV_SIZE_BYTES, ivs.begin() + (next + 1) * GOST_IV_SIZE_BYTES,
+                      records.begin() + i * GOST_DELTA_RECORD_SIZE);
+            ++next;
+        }
+        cipherParallelFor(batch * INDEX_SPAN, INDEX_SPAN, 0, [&](uint64_t from, uint64_t to, unsigned) {
+            for (uint64_t i = from / INDEX_SPAN; i < to / INDEX_SPAN; ++i) {
+                if (!changed[i]) continue;
+                unsigned char *record = records.data() + i * GOST_DELTA_RECORD_SIZE;
+                gost_encrypt_into(plaintext.data() + i * CHUNK_SIZE, chunk_length(input_size, first + i), key.data(),
+                                  record, record + GOST_IV_SIZE_BYTES);
+            }
+        });
+        transformTimer.addBytes(bytes);
+        transformTimer.pause();
+
+        // Соседние записи одного вида пишутся или переносятся одним вызовом.
+        writeTimer.resume();
+        for (size_t i = 0; i < batch;) {
+            size_t run = i;
+            size_t length = 0;
+            for (; run < batch && changed[run] == changed[i]; ++run) {
+                length += record_length(chunk_length(input_size, first + run));
+            }
+            uint64_t offset = record_offset(first + i);
+            if (changed[i]) {
+                output.writeAt(records.data() + i * GOST_DELTA_RECORD_SIZE, length, offset);
+                reencrypted += run - i;
+                writeTimer.addBytes(length);
+            } else {
+                if (base) output.copyFrom(*base, offset, length);
+                kept += run - i;
+            }
+            i = run;
+        }
+        writeTimer.pause();
+    }
+
+    uint64_t output_size = count ? record_offset(count - 1) + record_length(chunk_length(input_size, count - 1))
+                                 : GOST_DELTA_HEADER_SIZE;
+    writeTimer.resume();
+    output.resize(output_size);
+    output.sync();
+    writeTimer.pause();
+    current.output_size = output_size;
+    current.output_mtime = file_mtime(outputFilePath, ec);
+    if (ec) throw std::runtime_error("Error reading output file attributes: " + ec.message());
+    // Манифест заменяется только после того, как данные записаны на диск.
+    write_manifest(outputFilePath + ".manifest", current);
+
+    fres.success = true;
+    fres.message = "File encrypted in delta mode: " + std::to_string(reencrypted) + " of " + std::to_string(count) +
+                   " chunks re-encrypted, " + std::to_string(kept) +
+                   (in_place ? " left unchanged." : " copied from " + base_path + ".");
+    return fres;
+}
+
+GostDeltaDecoder::GostDeltaDecoder(const std::vector<unsigned char> &key) : key_(key) {
+    if (key.size() != GOST_KEY_SIZE_BYTES) {
+        throw std::invalid_argument("Invalid key size for GOST stream.");
+    }
+}
+
+void GostDeltaDecoder::decryptRecords(const unsigned char *data, size_t count, std::vector<unsigned char> &out) {
+    size_t chunk = record_size_ - GOST_DELTA_RECORD_OVERHEAD;
+    size_t start = out.size();
+    out.resize(start + count * chunk);
+    auto decrypt = [&](uint64_t from, uint64_t to, unsigned) {
+        for (uint64_t i = from / INDEX_SPAN; i < to / INDEX_SPAN; ++i) {
+            const unsigned char *iv = data + i * record_size_;
+            size_t plaintext_size;
+            if (!gost_plaintext_size(iv + GOST_IV_SIZE_BYTES, record_size_ - GOST_IV_SIZE_BYTES, key_.data(), iv,
+                                     plaintext_size) ||
+                plaintext_size != chunk) {
+                throw std::runtime_error("Corrupted chunk " + std::to_string(record_index_ + i) +
+                                         " (wrong key or damaged file).");
+            }
+            gost_decrypt_into(iv + GOST_IV_SIZE_BYTES, plaintext_size, key_.data(), iv, out.data() + start + i * chunk);
+        }
+    };
+    if (count > 1) {
+        cipherParallelFor(count * INDEX_SPAN, INDEX_SPAN, 0, decrypt);
+    } else {
+        decrypt(0, count * INDEX_SPAN, 0);
+    }
+    record_index_ += count;
+}
+
+void GostDeltaDecoder::update(const unsigned char *data, size_t size, std::vector<unsigned char> &out) {
+    if (!record_size_) {
+        size_t take = std::min(size, GOST_DELTA_HEADER_SIZE - header_.size());
+        header_.insert(header_.end(), data, data + take);
+        data += take;
+        size -= take;
+        if (header_.size() < GOST_DELTA_HEADER_SIZE) return;
+        if (!gost_is_delta(header_.data(), header_.size()) || load_le(header_.data() + 8, 4) != 0) {
+            throw std::runtime_error("Not a delta GOST file or unsupported flags.");
+        }
+        uint32_t record_size = static_cast<uint32_t>(load_le(header_.data() + 12, 4));
+        if (record_size <= GOST_DELTA_RECORD_OVERHEAD || record_size % GOST_BLOCK_SIZE_BYTES != 0 ||
+            record_size > GOST_FRAMED_MAX_CHUNK_SIZE) {
+            throw std::runtime_error("Invalid record size in delta file header.");
+        }
+        record_size_ = record_size;
+    }
+    if (!pending_.empty()) {
+        size_t take = std::min(size, record_size_ - pending_.size());
+        pending_.insert(pending_.end(), data, data + take);
+        data += take;
+        size -= take;
+        if (pending_.size() < record_size_) return;
+        decryptRecords(pending_.data(), 1, out);
+        pending_.clear();
+    }
+    size_t count = size / record_size_;
+    if (count > 0) decryptRecords(data, count, out);
+    pending_.assign(data + count * record_size_, data + size);
+}
+
+void GostDeltaDecoder::finish(std::vector<unsigned char> &out) {
+    if (!record_size_) {
+        throw std::runtime_error("Delta file is shorter than its header.");
+    }
+    if (pending_.empty()) return;
+    // Последняя запись короче полной: IV и хотя бы один блок шифротекста.
+    size_t size = pending_.size();
+    const unsigned char *iv = pending_.data();
+    size_t plaintext_size;
+    if (size < GOST_DELTA_RECORD_OVERHEAD || (size - GOST_IV_SIZE_BYTES) % GOST_BLOCK_SIZE_BYTES != 0 ||
+        !gost_plaintext_size(iv + GOST_IV_SIZE_BYTES, size - GOST_IV_SIZE_BYTES, key_.data(), iv, plaintext_size)) {
+        throw std::runtime_error("Corrupted or truncated chunk " + std::to_string(record_index_) +
+                                 " (wrong key or damaged file).");
+    }
+    size_t start = out.size();
+    out.resize(start + plaintext_size);
+    gost_decrypt_into(iv + GOST_IV_SIZE_BYTES, plaintext_size, key_.data(), iv, out.data() + start);
+    pending_.clear();
+    ++record_index_;
+}
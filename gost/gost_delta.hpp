@@ -0,0 +1,60 @@
+#ifndef GOST_DELTA_HPP
+#define GOST_DELTA_HPP
+
+// Поблочный формат для инкрементального шифрования (GostFileOptions::delta).
+// Заголовок открытым текстом занимает GOST_DELTA_HEADER_SIZE байт: сигнатура
+// "GOSTDLT1", флаги (0) и размер записи (uint32 LE), остальное — нули. Далее
+// записи по record_size байт (последняя короче): собственный случайный IV и
+// шифротекст блока открытого текста в record_size - 16 байт с дополнением
+// PKCS7 (с позиции 0, как gost_encrypt_data). Записи независимы и лежат по
+// фиксированным смещениям, выровненным по 4 КиБ, поэтому неизменённые блоки
+// переносятся из прежней версии файла как есть — клонированием диапазона,
+// copy_file_range или вовсе не трогаются при обновлении на месте.
+//
+// Рядом с файлом лежит "<файл>.manifest": размер и время изменения файла,
+// контрольное значение ключа и хеши блоков открытого текста (SipHash-2-4 с
+// ключом, выведенным из ключа шифрования через Стрибог, так что манифест не
+// раскрывает текст). Шифруются заново только блоки, хеш которых изменился;
+// манифест другого ключа не используется, и тогда шифруются все блоки.
+
+#include "gost.hpp"
+
+const unsigned char GOST_DELTA_MAGIC[8] = {'G', 'O', 'S', 'T', 'D', 'L', 'T', '1'};
+const size_t GOST_DELTA_HEADER_SIZE = 4096;
+const uint32_t GOST_DELTA_RECORD_SIZE = 1u << 20;
+const uint32_t GOST_DELTA_RECORD_OVERHEAD = GOST_IV_SIZE_BYTES + GOST_BLOCK_SIZE_BYTES;
+
+// true — данные начинаются с сигнатуры поблочного формата.
+bool gost_is_delta(const unsigned char *data, size_t size);
+
+// Шифрует inputFilePath в поблочный формат, используя прежнюю версию
+// (options.delta_base или сам outputFilePath) и её манифест; без подходящего
+// манифеста шифруются все блоки. Вызывается из encryptFileGOST.
+GostFileOperationResult gost_encrypt_file_delta(const std::string &inputFilePath,
+                                                const std::string &outputFilePath,
+                                                const std::vector<unsigned char> &key,
+                                                const GostFileOptions &options,
+                                                const CipherStatsSinkC *stats);
+
+// Чтение поблочного формата, включая заголовок; полные записи
+// расшифровываются параллельно. Ошибки — std::runtime_error.
+class GostDeltaDecoder {
+public:
+    explicit GostDeltaDecoder(const std::vector<unsigned char> &key);
+
+    void update(const unsigned char *data, size_t size,
+                std::vector<unsigned char> &out);
+    void finish(std::vector<unsigned char> &out);
+
+private:
+    void decryptRecords(const unsigned char *data, size_t count,
+                        std::vector<unsigned char> &out);
+
+    std::vector<unsigned char> key_;
+    std::vector<unsigned char> header_;
+    uint32_t record_size_ = 0;
+    std::vector<unsigned char> pending_;
+    uint64_t record_index_ = 0;
+};
+
+#endif // GOST_DELTA_HPP
@@ -0,0 +1,197 @@
+#include "gost_file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+GostAlignedBuffer::GostAlignedBuffer(size_t size)
+    : data_(static_cast<unsigned char *>(::operator new(
+          std::max<size_t>(size, 1), std::align_val_t(GOST_DIRECT_IO_ALIGNMENT)))),
+      size_(size) {}
+
+GostAlignedBuffer::~GostAlignedBuffer() {
+    ::operator delete(data_, std::align_val_t(GOST_DIRECT_IO_ALIGNMENT));
+}
+
+// В Windows прямого режима нет: FILE_FLAG_NO_BUFFERING недоступен через _open.
+GostFile::GostFile(const std::string &path, bool write, bool truncate, bool direct)
+    : path_(path), write_(write) {
+#ifdef _WIN32
+    (void)direct;
+    int flags = _O_BINARY | (write ? _O_RDWR | _O_CREAT : _O_RDONLY) | (truncate ? _O_TRUNC : 0);
+    fd_ = _open(path.c_str(), flags, _S_IREAD | _S_IWRITE);
+#else
+    int flags = (write ? O_RDWR | O_CREAT : O_RDONLY) | (truncate ? O_TRUNC : 0);
+#ifdef O_DIRECT
+    if (direct) {
+        // EINVAL — файловая система (tmpfs, часть FUSE) не умеет O_DIRECT.
+        fd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        direct_ = fd_ >= 0;
+    }
+#endif
+    if (fd_ < 0) fd_ = ::open(path.c_str(), flags, 0644);
+#ifdef F_NOCACHE
+    if (direct && fd_ >= 0) direct_ = ::fcntl(fd_, F_NOCACHE, 1) == 0;
+#endif
+#endif
+    if (fd_ < 0) throw std::runtime_error("Error opening file: " + path);
+}
+
+GostFile::~GostFile() {
+#ifdef _WIN32
+    _close(fd_);
+#else
+    ::close(fd_);
+#endif
+}
+
+bool GostFile::aligned(const void *data, size_t size, uint64_t offset) const {
+#ifdef O_DIRECT
+    return reinterpret_cast<uintptr_t>(data) % GOST_DIRECT_IO_ALIGNMENT == 0 &&
+           size % GOST_DIRECT_IO_ALIGNMENT == 0 && offset % GOST_DIRECT_IO_ALIGNMENT == 0;
+#else
+    (void)data;
+    (void)size;
+    (void)offset;
+    return true; // F_NOCACHE не требует выравнивания
+#endif
+}
+
+void GostFile::disableDirect() {
+#if defined(O_DIRECT)
+    int flags = ::fcntl(fd_, F_GETFL);
+    if (flags >= 0) ::fcntl(fd_, F_SETFL, flags & ~O_DIRECT);
+#elif defined(F_NOCACHE)
+    ::fcntl(fd_, F_NOCACHE, 0);
+#endif
+    direct_ = false;
+}
+
+// Один вызов чтения или записи; -1 — ошибка.
+long long GostFile::transfer(unsigned char *data, size_t size, uint64_t offset, bool write) {
+    if (direct_ && !aligned(data, size, offset)) disableDirect();
+    for (;;) {
+#ifdef _WIN32
+        if (_lseeki64(fd_, static_cast<long long>(offset), SEEK_SET) < 0) return -1;
+        unsigned part = static_cast<unsigned>(std::min<size_t>(size, 1u << 30));
+        return write ? _write(fd_, data, part) : _read(fd_, data, part);
+#else
+        ssize_t n = write ? ::pwrite(fd_, data, size, static_cast<off_t>(offset))
+                          : ::pread(fd_, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EINVAL && direct_) {
+            disableDirect(); // открыть с O_DIRECT удалось, а читать и писать так нельзя
+            continue;
+        }
+        return n;
+#endif
+    }
+}
+
+void GostFile::readAt(unsigned char *data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        long long n = transfer(data, size, offset, false);
+        if (n <= 0) throw std::runtime_error("Error reading file: " + path_);
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+}
+
+size_t GostFile::readUpTo(unsigned char *data, size_t size, uint64_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        long long n = transfer(data + done, size - done, offset + done, false);
+        if (n < 0) throw std::runtime_error("Error reading file: " + path_);
+        if (n == 0) break;
+        done += static_cast<size_t>(n);
+    }
+    return done;
+}
+
+void GostFile::writeAt(const unsigned char *data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        long long n = transfer(const_cast<unsigned char *>(data), size, offset, true);
+        if (n <= 0) throw std::runtime_error("Error writing file: " + path_);
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+}
+
+void GostFile::copyFrom(GostFile &source, uint64_t offset, uint64_t length) {
+#ifdef FICLONERANGE
+    struct file_clone_range range = {};
+    range.src_fd = source.fd_;
+    range.src_offset = offset;
+    range.src_length = length;
+    range.dest_offset = offset;
+    if (::ioctl(fd_, FICLONERANGE, &range) == 0) return;
+#endif
+#ifdef __linux__
+    while (length > 0) {
+        loff_t in = static_cast<loff_t>(offset), out = static_cast<loff_t>(offset);
+        ssize_t n = ::copy_file_range(source.fd_, &in, fd_, &out, length, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break; // другая файловая система, старое ядро — дальше обычным копированием
+        offset += static_cast<uint64_t>(n);
+        length -= static_cast<uint64_t>(n);
+    }
+#endif
+    std::vector<unsigned char> buffer(static_cast<size_t>(std::min<uint64_t>(length, 4u << 20)));
+    while (length > 0) {
+        size_t part = static_cast<size_t>(std::min<uint64_t>(length, buffer.size()));
+        source.readAt(buffer.data(), part, offset);
+        writeAt(buffer.data(), part, offset);
+        offset += part;
+        length -= part;
+    }
+}
+
+void GostFile::resize(uint64_t size) {
+#ifdef _WIN32
+    bool ok = _chsize_s(fd_, static_cast<long long>(size)) == 0;
+#else
+    bool ok = ::ftruncate(fd_, static_cast<off_t>(size)) == 0;
+#endif
+    if (!ok) throw std::runtime_error("Error resizing file: " + path_);
+}
+
+void GostFile::sync() {
+#ifdef _WIN32
+    bool ok = _commit(fd_) == 0;
+#else
+    bool ok = ::fsync(fd_) == 0;
+#endif
+    if (!ok) throw std::runtime_error("Error syncing file: " + path_);
+}
+
+void GostFile::dropCache(uint64_t offset, uint64_t length) {
+#ifdef __linux__
+    if (write_) {
+        ::sync_file_range(fd_, static_cast<off_t>(offset), static_cast<off_t>(length),
+                          SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+    }
+#endif
+#ifdef POSIX_FADV_DONTNEED
+    ::posix_fadvise(fd_, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_DONTNEED);
+#else
+    (void)offset;
+    (void)length;
+#endif
+}
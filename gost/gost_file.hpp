@@ -0,0 +1,78 @@
+#ifndef GOST_FILE_HPP
+#define GOST_FILE_HPP
+
+// Файл с чтением и записью по смещению (pread/pwrite) для форматов с
+// произвольным доступом: поблочного (gost_delta.hpp) и архива
+// (gost_archive.hpp). Ошибки — std::runtime_error. В Windows смещение
+// задаётся отдельным вызовом, поэтому там один объект не используется из
+// нескольких потоков одновременно.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Кратность адреса буфера, смещения и размера при прямом вводе-выводе:
+// 4 КиБ подходит и для дисков с логическим блоком 512 байт, и для 4 КиБ.
+const size_t GOST_DIRECT_IO_ALIGNMENT = 4096;
+
+// Буфер, выровненный по GOST_DIRECT_IO_ALIGNMENT.
+class GostAlignedBuffer {
+public:
+    explicit GostAlignedBuffer(size_t size);
+    ~GostAlignedBuffer();
+
+    GostAlignedBuffer(const GostAlignedBuffer &) = delete;
+    GostAlignedBuffer &operator=(const GostAlignedBuffer &) = delete;
+
+    unsigned char *data() { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    unsigned char *data_;
+    size_t size_;
+};
+
+class GostFile {
+public:
+    // write — открыть для записи (создав файл), truncate — обнулить его.
+    // direct — в обход страничного кэша (O_DIRECT, в macOS F_NOCACHE); если
+    // файловая система этого не умеет, файл открывается обычным образом.
+    GostFile(const std::string &path, bool write, bool truncate, bool direct = false);
+    ~GostFile();
+
+    GostFile(const GostFile &) = delete;
+    GostFile &operator=(const GostFile &) = delete;
+
+    // В прямом режиме невыровненный запрос (обычно хвост файла) переводит
+    // файл в обычный режим; так же при отказе файловой системы (EINVAL).
+    void readAt(unsigned char *data, size_t size, uint64_t offset);
+    void writeAt(const unsigned char *data, size_t size, uint64_t offset);
+    // Читает до size байт; меньше — только если файл кончился.
+    size_t readUpTo(unsigned char *data, size_t size, uint64_t offset);
+
+    // Переносит length байт source с offset на то же место этого файла:
+    // клонированием диапазона (reflink), copy_file_range или чтением и записью.
+    void copyFrom(GostFile &source, uint64_t offset, uint64_t length);
+
+    void resize(uint64_t size);
+    void sync();
+    // Вытесняет диапазон из страничного кэша, записанное — дождавшись записи
+    // на диск. Там, где ОС этого не умеет, ничего не делает.
+    void dropCache(uint64_t offset, uint64_t length);
+
+    const std::string &path() const { return path_; }
+    // true — чтение и запись идут в обход кэша.
+    bool direct() const { return direct_; }
+
+private:
+    bool aligned(const void *data, size_t size, uint64_t offset) const;
+    void disableDirect();
+    long long transfer(unsigned char *data, size_t size, uint64_t offset, bool write);
+
+    std::string path_;
+    int fd_ = -1;
+    bool write_ = false;
+    bool direct_ = false;
+};
+
+#endif // GOST_FILE_HPP
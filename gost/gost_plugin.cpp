@@ -0,0 +1,382 @@
+// Дескриптор плагина ГОСТ (см. plugin/cipher_plugin.h).
+// Нужен ключ key_hex; IV при шифровании берётся из iv_hex или генерируется и
+// возвращается в результате. При расшифровании буфера IV обязателен, при
+// расшифровании файла читается из его начала.
+// Параметр compress (файлы и потоки) сжимает данные перед шифрованием,
+// append (шифрование файла) дописывает их к уже зашифрованному выходному файлу,
+// checkpoint=<МиБ> и resume (шифрование файла) ведут журнал контрольных точек
+// и продолжают прерванное шифрование, delta и delta-base=<путь> (шифрование
+// файла) шифруют заново только изменившиеся блоки (gost_delta.hpp), archive
+// (шифрование файла) упаковывает файл или каталог в архив (gost_archive.hpp), а
+// при расшифровании файла требует, чтобы вход был архивом, member=<путь>
+// (расшифрование файла, можно повторять) извлекает из архива только указанные
+// файлы и каталоги.
+
+#include "cipher_plugin.h"
+#include "cipher_plugin_util.hpp"
+#include "cipher_stats.hpp"
+#include "gost.hpp"
+#include "gost_archive.hpp"
+#include "gost_delta.hpp"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Переводит строку параметров задания в GostFileOptions; неизвестное имя — ошибка.
+static bool parseGostOptions(const CipherParamsC* params, GostFileOptions& options, std::string& error) {
+    try {
+        for (const PluginOption& option : parsePluginOptions(params ? params->options : nullptr)) {
+            if (option.name == "compress" && !option.has_value) {
+                options.compress = true;
+            } else if (option.name == "append" && !option.has_value) {
+                options.append = true;
+            } else if (option.name == "checkpoint" && option.has_value) {
+                options.checkpoint_interval = std::stoull(option.value) << 20;
+            } else if (option.name == "resume" && !option.has_value) {
+                options.resume = true;
+            } else if (option.name == "delta" && !option.has_value) {
+                options.delta = true;
+            } else if (option.name == "delta-base" && option.has_value) {
+                options.delta = true;
+                options.delta_base = option.value;
+            } else if (option.name == "archive" && !option.has_value) {
+                options.archive = true;
+            } else if (option.name == "member" && option.has_value) {
+                options.archive_members.push_back(option.value);
+            } else {
+                error = "Error: unsupported gost option '" + option.name + "'.";
+                return false;
+            }
+        }
+    } catch (const std::exception& e) {
+        error = std::string("Error: invalid gost option: ") + e.what();
+        return false;
+    }
+    return true;
+}
+
+// Дописывать, продолжать и обновлять поблочно можно только файл: потоку
+// некуда вернуться за уже записанным выходом. Архив тоже собирается из файлов.
+static bool checkGostFileEncryptOnly(const GostFileOptions& options, std::string& error) {
+    const char* name = nullptr;
+    if (options.append) name = "append";
+    if (options.checkpoint_interval) name = "checkpoint";
+    if (options.resume) name = "resume";
+    if (options.delta) name = "delta";
+    if (options.archive) name = "archive";
+    if (!name) return true;
+    error = std::string("Error: gost option '") + name + "' applies only to file encryption.";
+    return false;
+}
+
+// Члены архива выбираются только при извлечении из файла.
+static bool checkGostArchiveMembers(const GostFileOptions& options, std::string& error) {
+    if (options.archive_members.empty()) return true;
+    error = "Error: gost option 'member' applies only to archive extraction.";
+    return false;
+}
+
+// Для буферов параметров нет: сжатый формат есть только у файлов и потоков.
+static bool checkGostOptions(const CipherParamsC* params, std::string& error) {
+    GostFileOptions options;
+    if (!parseGostOptions(params, options, error)) return false;
+    if (options.compress) {
+        error = "Error: gost option 'compress' applies only to files and streams.";
+        return false;
+    }
+    return checkGostFileEncryptOnly(options, error) && checkGostArchiveMembers(options, error);
+}
+
+static std::string paramString(const char* value) {
+    return value ? value : "";
+}
+
+static bool readKey(const CipherParamsC* params, std::vector<unsigned char>& key, std::string& error) {
+    key = hexStringToBytes(paramString(params ? params->key_hex : nullptr));
+    if (key.size() != GOST_KEY_SIZE_BYTES) {
+        error = "Invalid key length. Must be " + std::to_string(GOST_KEY_SIZE_BYTES * 2) + " hex characters.";
+        return false;
+    }
+    return true;
+}
+
+static bool readIv(const std::string& iv_hex, std::vector<unsigned char>& iv, std::string& error) {
+    iv = hexStringToBytes(iv_hex);
+    if (iv.size() != GOST_IV_SIZE_BYTES) {
+        error = "Invalid IV length. Must be " + std::to_string(GOST_IV_SIZE_BYTES * 2) + " hex characters.";
+        return false;
+    }
+    return true;
+}
+
+// Состояние потока: при шифровании IV выдаётся в начале выхода, при
+// расшифровании читается из первых GOST_IV_SIZE_BYTES байт входа. Со сжатием
+// поток пишется в блочном формате; при расшифровании он и поблочный формат
+// (gost_delta.hpp) узнаются по сигнатуре на месте IV.
+struct GostStream {
+    bool encode = true;
+    std::vector<unsigned char> key;
+    std::vector<unsigned char> iv;
+    std::unique_ptr<GostStreamCipher> cipher;
+    std::unique_ptr<GostFramedEncoder> framedEncoder;
+    std::unique_ptr<GostFramedDecoder> framedDecoder;
+    std::unique_ptr<GostDeltaDecoder> deltaDecoder;
+    std::vector<unsigned char> out;
+
+    bool started() const { return cipher || framedEncoder || framedDecoder || deltaDecoder; }
+};
+
+static CipherResultC gostFlush(GostStream* stream, CipherSinkFunc sink, void* context) {
+    bool accepted = stream->out.empty() || sink(context, stream->out.data(), stream->out.size());
+    stream->out.clear();
+    return accepted ? pluginSuccess("") : pluginError("Error: stream output was rejected.");
+}
+
+extern "C" {
+
+static CipherResultC gostEncryptBuffer(const unsigned char* data, size_t size, const CipherParamsC* params) {
+    std::string error;
+    if (!checkGostOptions(params, error)) return pluginError(error);
+    try {
+        std::vector<unsigned char> key, iv;
+        if (!readKey(params, key, error)) return pluginError(error);
+        std::string iv_hex = paramString(params ? params->iv_hex : nullptr);
+        if (iv_hex.empty()) {
+            generateRandomBytes(iv, GOST_IV_SIZE_BYTES);
+        } else if (!readIv(iv_hex, iv, error)) {
+            return pluginError(error);
+        }
+
+        std::vector<unsigned char> ciphertext = gost_encrypt_data(std::vector<unsigned char>(data, data + size), key, iv);
+        CipherResultC result = pluginData(ciphertext.data(), ciphertext.size());
+        result.iv_hex = pluginDuplicateString(bytesToHexString(iv));
+        return result;
+    } catch (const std::exception& e) {
+        return pluginError(std::string("C++ Exception in GOST encryption: ") + e.what());
+    }
+}
+
+static CipherResultC gostDecryptBuffer(const unsigned char* data, size_t size, const CipherParamsC* params) {
+    std::string error;
+    if (!checkGostOptions(params, error)) return pluginError(error);
+    try {
+        std::vector<unsigned char> key, iv;
+        if (!readKey(params, key, error)) return pluginError(error);
+        if (!readIv(paramString(params ? params->iv_hex : nullptr), iv, error)) return pluginError(error);
+
+        std::vector<unsigned char> plaintext = gost_decrypt_data(std::vector<unsigned char>(data, data + size), key, iv);
+        CipherResultC result = pluginData(plaintext.data(), plaintext.size());
+        result.iv_hex = pluginDuplicateString(bytesToHexString(iv));
+        return result;
+    } catch (const std::exception& e) {
+        return pluginError(std::string("C++ Exception in GOST decryption: ") + e.what());
+    }
+}
+
+static CipherResultC gostFileResult(const GostFileOperationResult& result) {
+    if (!result.success) return pluginError(result.message);
+    CipherResultC c_result = pluginSuccess(result.message);
+    c_result.iv_hex = pluginDuplicateString(result.used_iv_hex);
+    return c_result;
+}
+
+static CipherResultC gostEncryptFile(const char* inputPath, const char* outputPath, const CipherParamsC* params) {
+    std::string error;
+    GostFileOptions options;
+    if (!parseGostOptions(params, options, error) || !checkGostArchiveMembers(options, error)) return pluginError(error);
+    if (!inputPath || !outputPath) return pluginError("Error: input and output files must be specified.");
+    options.direct_io = params && (params->flags & CIPHER_JOB_DIRECT_IO);
+    return gostFileResult(encryptFileGOST(inputPath, outputPath, paramString(params ? params->key_hex : nullptr),
+                                          paramString(params ? params->iv_hex : nullptr), options,
+                                          params ? params->stats : nullptr));
+}
+
+static CipherResultC gostDecryptFile(const char* inputPath, const char* outputPath, const CipherParamsC* params) {
+    std::string error;
+    GostFileOptions options; // формат файла определяется по его заголовку
+    if (!parseGostOptions(params, options, error)) return pluginError(error);
+    // archive при расшифровании лишь утверждает, что вход — архив: извлечение
+    // проверяет сигнатуру до того, как создать что-либо в каталоге выхода.
+    GostFileOptions encryptOnly = options;
+    encryptOnly.archive = false;
+    if (!checkGostFileEncryptOnly(encryptOnly, error)) return pluginError(error);
+    if (!inputPath || !outputPath) return pluginError("Error: input and output files must be specified.");
+    if (options.archive || !options.archive_members.empty()) {
+        return gostFileResult(extractArchiveGOST(inputPath, outputPath, paramString(params ? params->key_hex : nullptr),
+                                                 options.archive_members, params ? params->stats : nullptr));
+    }
+    options.direct_io = params && (params->flags & CIPHER_JOB_DIRECT_IO);
+    return gostFileResult(decryptFileGOST(inputPath, outputPath, paramString(params ? params->key_hex : nullptr),
+                                          options, params ? params->stats : nullptr));
+}
+
+static CipherResultC gostGenerateKey(void) {
+    GostKeyGenResult result = generateKeyGOST();
+    if (!result.success) return pluginError(result.error_message);
+    CipherResultC c_result = pluginSuccess("Key generated.");
+    c_result.key_hex = pluginDuplicateString(result.key_hex);
+    return c_result;
+}
+
+static CipherResultC gostStreamOpen(bool encode, const CipherParamsC* params, void** stream) {
+    std::string error;
+    GostFileOptions options;
+    if (!parseGostOptions(params, options, error)) return pluginError(error);
+    if (!encode && options.archive) {
+        return pluginError("Error: a GOST archive cannot be decrypted as a stream; extract it from a file.");
+    }
+    if (!checkGostFileEncryptOnly(options, error) || !checkGostArchiveMembers(options, error)) {
+        return pluginError(error);
+    }
+    CipherStageTimer parseTimer(params ? params->stats : nullptr, CIPHER_STAGE_PARSE);
+    try {
+        std::unique_ptr<GostStream> state(new GostStream);
+        state->encode = encode;
+        if (!readKey(params, state->key, error)) return pluginError(error);
+        if (encode) {
+            std::string iv_hex = paramString(params ? params->iv_hex : nullptr);
+            if (iv_hex.empty()) {
+                generateRandomBytes(state->iv, GOST_IV_SIZE_BYTES);
+            } else if (!readIv(iv_hex, state->iv, error)) {
+                return pluginError(error);
+            }
+            if (options.compress) {
+                state->framedEncoder.reset(new GostFramedEncoder(state->key, state->iv, GOST_FRAMED_COMPRESSED));
+            } else if (gost_is_framed(state->iv.data(), state->iv.size()) ||
+                       gost_is_delta(state->iv.data(), state->iv.size()) ||
+                       gost_is_archive(state->iv.data(), state->iv.size())) {
+                return pluginError("Error: this IV is reserved for a file format signature.");
+            } else {
+                state->cipher.reset(new GostStreamCipher(state->key, state->iv, true));
+                state->out = state->iv;
+            }
+        }
+        CipherResultC result = pluginSuccess("");
+        if (encode) result.iv_hex = pluginDuplicateString(bytesToHexString(state->iv));
+        *stream = state.release();
+        return result;
+    } catch (const std::exception& e) {
+        return pluginError(std::string("C++ Exception in GOST stream: ") + e.what());
+    }
+}
+
+static CipherResultC gostStreamUpdate(void* stream, const unsigned char* data, size_t size, CipherSinkFunc sink,
+                                      void* context) {
+    GostStream* state = static_cast<GostStream*>(stream);
+    try {
+        if (!state->started()) {
+            size_t take = std::min<size_t>(size, GOST_IV_SIZE_BYTES - state->iv.size());
+            state->iv.insert(state->iv.end(), data, data + take);
+            data += take;
+            size -= take;
+            if (state->iv.size() < GOST_IV_SIZE_BYTES) return pluginSuccess("");
+            if (gost_is_framed(state->iv.data(), state->iv.size())) {
+                state->framedDecoder.reset(new GostFramedDecoder(state->key));
+                state->framedDecoder->update(state->iv.data(), state->iv.size(), state->out);
+            } else if (gost_is_delta(state->iv.data(), state->iv.size())) {
+                state->deltaDecoder.reset(new GostDeltaDecoder(state->key));
+                state->deltaDecoder->update(state->iv.data(), state->iv.size(), state->out);
+            } else if (gost_is_archive(state->iv.data(), state->iv.size())) {
+                return pluginError("Error: a GOST archive cannot be decrypted as a stream; extract it from a file.");
+            } else {
+                state->cipher.reset(new GostStreamCipher(state->key, state->iv, false));
+            }
+        }
+        if (state->framedEncoder) {
+            state->framedEncoder->update(data, size, state->out);
+        } else if (state->framedDecoder) {
+            state->framedDecoder->update(data, size, state->out);
+        } else if (state->deltaDecoder) {
+            state->deltaDecoder->update(data, size, state->out);
+        } else {
+            state->cipher->update(data, size, state->out);
+        }
+        return gostFlush(state, sink, context);
+    } catch (const std::exception& e) {
+        return pluginError(std::string("C++ Exception in GOST stream: ") + e.what());
+    }
+}
+
+static CipherResultC gostStreamFinish(void* stream, CipherSinkFunc sink, void* context) {
+    GostStream* state = static_cast<GostStream*>(stream);
+    if (!state->started()) return pluginError("Error: ciphertext is shorter than the IV.");
+    try {
+        if (state->framedEncoder) {
+            state->framedEncoder->finish(state->out);
+        } else if (state->framedDecoder) {
+            state->framedDecoder->finish(state->out);
+        } else if (state->deltaDecoder) {
+            state->deltaDecoder->finish(state->out);
+        } else {
+            state->cipher->finish(state->out);
+        }
+        return gostFlush(state, sink, context);
+    } catch (const std::exception& e) {
+        return pluginError(std::string("C++ Exception in GOST stream: ") + e.what());
+    }
+}
+
+static void gostStreamClose(void* stream) {
+    delete static_cast<GostStream*>(stream);
+}
+
+static int gostInto(const unsigned char* data, size_t size, unsigned char* output, size_t capacity,
+                    size_t* output_size, const CipherParamsC* params, bool encode) {
+    unsigned char key[GOST_KEY_SIZE_BYTES];
+    unsigned char iv[GOST_IV_SIZE_BYTES];
+    std::string error;
+    if (!output_size || (!data && size) || !checkGostOptions(params, error) || !params ||
+        !pluginHexToArray(params->key_hex, key, sizeof(key)) || !pluginHexToArray(params->iv_hex, iv, sizeof(iv))) {
+        return CIPHER_STATUS_INVALID_ARGUMENT;
+    }
+    if (encode) {
+        *output_size = gost_ciphertext_size(size);
+    } else if (!gost_plaintext_size(data, size, key, iv, *output_size)) {
+        return CIPHER_STATUS_INVALID_DATA;
+    }
+    if (capacity < *output_size || (!output && *output_size)) return CIPHER_STATUS_BUFFER_TOO_SMALL;
+    if (encode) {
+        gost_encrypt_into(data, size, key, iv, output);
+    } else {
+        gost_decrypt_into(data, *output_size, key, iv, output);
+    }
+    return CIPHER_STATUS_OK;
+}
+
+static int gostEncryptInto(const unsigned char* data, size_t size, unsigned char* output, size_t capacity,
+                           size_t* output_size, const CipherParamsC* params) {
+    return gostInto(data, size, output, capacity, output_size, params, true);
+}
+
+static int gostDecryptInto(const unsigned char* data, size_t size, unsigned char* output, size_t capacity,
+                           size_t* output_size, const CipherParamsC* params) {
+    return gostInto(data, size, output, capacity, output_size, params, false);
+}
+
+extern const CipherPluginDescriptor CIPHER_PLUGIN_DESCRIPTOR(gost) = {
+    CIPHER_PLUGIN_ABI_VERSION,
+    sizeof(CipherPluginDescriptor),
+    "gost",
+    "ГОСТ 28147-89 (CBC с PKCS7)",
+    CIPHER_CAP_BUFFER | CIPHER_CAP_FILE | CIPHER_CAP_KEYED | CIPHER_CAP_KEYGEN | CIPHER_CAP_CHUNKED |
+        CIPHER_CAP_INTO | CIPHER_CAP_DIRECT_IO,
+    gostEncryptBuffer,
+    gostDecryptBuffer,
+    gostEncryptFile,
+    gostDecryptFile,
+    gostGenerateKey,
+    nullptr,
+    nullptr,
+    pluginFreeResult,
+    gostStreamOpen,
+    gostStreamUpdate,
+    gostStreamFinish,
+    gostStreamClose,
+    gostEncryptInto,
+    gostDecryptInto,
+    nullptr,
+    0,
+};
+
+}
@@ -1,266 +1,709 @@
 #include <iostream>
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <stdexcept>
 #include <limits>
-#include <map>
 #include <memory>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
 #include <sstream>
 #include <iomanip>
+#include <system_error>
+#include <fstream>
 
-// --- Платформо-зависимые заголовоки для динамической загрузки ---
 #ifdef _WIN32
 #include <windows.h>
-#else
-#include <dlfcn.h>
 #endif
 
-// --- Подключаем C-совместимые заголовки от наших библиотек ---
-#include "gost/gost_bridge.h"
-#include "morse/morse_bridge.h"
-#include "rot13/rot13_bridge.h"
-
-void displayMenu() {
-    std::cout << "\n--- Меню Инструмента Шифрования ---\n"
-              << "Выберите алгоритм:\n"
-              << "1. ГОСТ (CBC с PKCS7)\n"
-              << "2. Морзе (универсальный бинарный)\n"
-              << "3. ROT13 + XOR\n"
-              << "4. Выход\n"
-              << "Введите ваш выбор: ";
-}
+// --- Шифры подключаются как плагины (см. plugin/cipher_plugin.h) ---
+#include "plugin/cipher_plugin.h"
+#include "plugin/plugin_host.h"
+#include "plugin/builtin_ciphers.h"
+#include "plugin/pipeline.h"
+#include "plugin/stdio_stream.h"
+#include "plugin/crc_framing.h"
+#include "plugin/cipher_stats.hpp"
+#include "plugin/stats_collector.h"
+#include "runtime/cipher_runtime.h"
+#include "runtime/text_encoding.hpp"
+#include "runtime/streebog.hpp"
+
+// Файлы от этого размера обрабатываются многопоточно, если плагин это умеет.
+const std::uintmax_t PARALLEL_FILE_THRESHOLD = 64ull << 20;
+
+// Размер блока чтения файла для --hash без шифрования.
+const size_t HASH_READ_BLOCK = 4u << 20;
 
 void printHelp() {
     std::cout << "Использование: ./cipher_tool [опции]\n\n"
-              << "Если опции не указаны, будет показано интерактивное меню.\n\n"
+              << "Если опции не указаны, будет показано интерактивное меню.\n"
+              << "Шифры загружаются как плагины из каталога --plugin-dir (переменная CIPHER_PLUGIN_DIR,\n"
+              << "по умолчанию текущий каталог); список доступных выводит --list-ciphers. В статической сборке\n"
+              << "шифры встроены, а каталог плагинов просматривается, только если он задан явно.\n\n"
               << "Опции:\n"
-              << "  --cipher <name>      Указать шифр: 'gost', 'morse', 'rot13'. (Обязательно для работы с флагами)\n"
+              << "  --cipher <name>      Указать шифр, например 'gost', 'morse', 'rot13'. (Обязательно для работы с флагами)\n"
+              << "                       Несколько шифров через запятую образуют конвейер: при шифровании данные\n"
+              << "                       проходят шифры по порядку, при расшифровании — в обратном порядке.\n"
               << "  -e, --encrypt        Зашифровать входные данные.\n"
               << "  -d, --decrypt        Расшифровать входные данные.\n"
-              << "  --generate-key       Сгенерировать ключ ГОСТ и вывести его.\n"
-              << "  --text <string>      Текстовая строка для обработки.\n"
-              << "  --input <path>       Путь к входному файлу.\n"
-              << "  --output <path>      Путь к выходному файту.\n"
-              << "  --key <hex_string>   Ключ для ГОСТ (64 hex-символа). Необязателен при шифровании (будет сгенерирован).\n"
-              << "  --iv <hex_string>    Вектор инициализации для ГОСТ (16 hex-символов). Можно опустить при шифровании для генерации случайного.\n"
+              << "  --generate-key       Сгенерировать ключ (для шифров с ключом) и вывести его.\n"
+              << "  --text <string>      Текстовая строка для обработки. Можно указать несколько раз.\n"
+              << "  --encoding <name>    Представление двоичных данных для --text: hex (по умолчанию), base64\n"
+              << "                       или base85 (алфавит Z85): шифротекст при шифровании и вход при дешифровании;\n"
+              << "                       так же выводится дайджест --hash.\n"
+              << "  --input <path>       Путь к входному файлу; '-' — стандартный ввод.\n"
+              << "  --output <path>      Путь к выходному файту; '-' — стандартный вывод (двоичные данные как есть,\n"
+              << "                       в том числе для --text; сообщения идут в stderr).\n"
+              << "  --key <hex_string>   Ключ (ГОСТ: 64 hex-символа). Необязателен при шифровании (будет сгенерирован).\n"
+              << "  --iv <hex_string>    Вектор инициализации (ГОСТ: 16 hex-символов). Можно опустить при шифровании для генерации случайного.\n"
+              << "  --option <k[=v]>     Параметр шифра, передаётся плагину. Можно указать несколько раз.\n"
+              << "                       Вид <шифр>:<k[=v]> передаёт параметр только этому шифру конвейера.\n"
+              << "  --plugin-dir <path>  Каталог с библиотеками шифров.\n"
+              << "  --list-ciphers       Показать найденные шифры и их возможности.\n"
+              << "  --in-place           Преобразовать --input на месте, без --output (если шифр это умеет).\n"
+              << "  --msync-window <MiB> На месте: сбрасывать изменения на диск окнами указанного размера.\n"
+              << "  --direct-io          Читать и писать файлы в обход страничного кэша (O_DIRECT) выровненными блоками,\n"
+              << "                       не вытесняя из кэша данные других процессов (ГОСТ, обычный формат). Где\n"
+              << "                       файловая система этого не умеет, обработанные блоки вытесняются из кэша.\n"
+              << "  --threads <n>        Число потоков общего пула шифров (0 — по числу доступных ядер с учётом\n"
+              << "                       квоты cgroup) и многопоточная обработка файла блоками.\n"
+              << "                       Без этой опции файлы от 64 МиБ обрабатываются многопоточно автоматически.\n"
+              << "  --pin-threads        Закрепить потоки пула за ядрами.\n"
+              << "  --cyrillic           ROT13: считать данные UTF-8 и вращать также русский алфавит (с Ё/ё).\n"
+              << "  --rot <n>            ROT13: сдвиг алфавита вместо 13 (ROT-N).\n"
+              << "  --xor-key <hex>      ROT13: ключ XOR произвольной длины, повторяется по всем данным (по умолчанию aa).\n"
+              << "  --crc                Файлы и потоки: писать шифротекст кадрами по 1 МиБ с CRC32C и проверять\n"
+              << "                       их при расшифровании до передачи шифру (указывается в обоих направлениях).\n"
+              << "  --compress           ГОСТ: сжимать данные блоками перед шифрованием (несжимаемые блоки\n"
+              << "                       хранятся как есть); при расшифровании формат распознаётся сам.\n"
+              << "  --append             ГОСТ: дописать --input в конец уже зашифрованного --output тем же ключом,\n"
+              << "                       не перешифровывая файл (если --output нет, он создаётся).\n"
+              << "  --checkpoint <MiB>   ГОСТ: при шифровании файла каждые <MiB> входа сбрасывать выход на диск и\n"
+              << "                       сохранять контрольную точку в <output>.ckpt.\n"
+              << "  --resume             ГОСТ: продолжить прерванное шифрование с последней контрольной точки\n"
+              << "                       (без неё — начать сначала); точки пишутся каждые --checkpoint или 256 МиБ.\n"
+              << "  --delta              ГОСТ: поблочный формат с манифестом <output>.manifest — при повторном\n"
+              << "                       шифровании в тот же --output заново шифруются только изменившиеся блоки.\n"
+              << "  --delta-base <path>  ГОСТ: как --delta, но неизменённые блоки переносятся в новый --output из\n"
+              << "                       прежней версии <path> (клонированием или copy_file_range, где возможно).\n"
+              << "  --archive            ГОСТ: упаковать файл или каталог --input (рекурсивно) в один зашифрованный\n"
+              << "                       архив --output; при дешифровании архив распаковывается в каталог --output\n"
+              << "                       (архив узнаётся и без флага, а с ним вход, не являющийся архивом, — ошибка).\n"
+              << "  --member <path>      ГОСТ: при дешифровании архива извлечь только этот файл или каталог\n"
+              << "                       (можно указать несколько раз).\n"
+              << "  --audio              Морзе: озвучить --input в WAV-файл --output (16-битный PCM).\n"
+              << "  --wpm <n>            Морзе: скорость звука в словах в минуту (по умолчанию 20).\n"
+              << "  --tone <hz>          Морзе: частота тона в Гц (по умолчанию 700).\n"
+              << "  --sample-rate <hz>   Морзе: частота дискретизации WAV (по умолчанию 44100).\n"
+              << "  --hash[=256|512]     Без -e/-d: вывести хеш Стрибог (ГОСТ Р 34.11-2012, по умолчанию 512 бит)\n"
+              << "                       файла --input ('-' — стандартного ввода) или строк --text. С -e/-d: попутно\n"
+              << "                       вычислить хеш открытого текста (входа при шифровании, выхода при дешифровании)\n"
+              << "                       за тот же проход, без повторного чтения. Несовместим с файловыми режимами\n"
+              << "                       ГОСТ (--append, --checkpoint, --resume, --delta, --delta-base, --archive,\n"
+              << "                       --member) и с распаковкой архива.\n"
+              << "  --stats[=json]       Вывести в stderr время и процессорное время стадий (загрузка библиотек,\n"
+              << "                       разбор ключа и hex, чтение, преобразование, запись), объём и скорость,\n"
+              << "                       загрузку потоков и пиковый объём памяти; =json — одной строкой JSON.\n"
               << "  -h, --help           Показать это справочное сообщение.\n\n"
+              << "Опции --cyrillic, --rot, --xor-key, --compress, --append, --checkpoint, --resume, --delta,\n"
+              << "--delta-base, --archive, --member, --audio, --wpm, --tone и --sample-rate — сокращения для --option rot13:cyrillic, --option rot13:rot=<n>,\n"
+              << "--option gost:compress и т. д.\n\n"
               << "Примеры:\n"
+              << "  ./cipher_tool --list-ciphers\n"
               << "  ./cipher_tool --cipher gost --generate-key\n"
               << "  ./cipher_tool --cipher gost -e --text \"привет\"\n"
               << "  ./cipher_tool --cipher gost -d --text <hex-шифротекст> --key <64-hex-ключа> --iv <16-hex-iv>\n"
+              << "  ./cipher_tool --cipher gost -e --encoding base64 --text \"привет\"\n"
               << "  ./cipher_tool --cipher morse -e --text \"hello\"\n"
               << "  ./cipher_tool --cipher morse -d --text <hex-представление-морзе>\n"
-              << "  ./cipher_tool --cipher rot13 -e --input message.txt --output message.enc\n";
+              << "  ./cipher_tool --cipher morse -e --audio --wpm 25 --input message.txt --output message.wav\n"
+              << "  ./cipher_tool --cipher gost -e --compress --key <64-hex-ключа> --input export.csv --output export.enc\n"
+              << "  ./cipher_tool --cipher gost -e --append --key <64-hex-ключа> --input new-lines.log --output app.log.enc\n"
+              << "  ./cipher_tool --cipher gost -e --direct-io --key <64-hex-ключа> --input backup.tar --output backup.enc\n"
+              << "  ./cipher_tool --cipher gost -e --resume --checkpoint 512 --key <64-hex-ключа> --input disk.img --output disk.enc\n"
+              << "  ./cipher_tool --cipher gost -e --delta-base dataset-mon.enc --key <64-hex-ключа> --input dataset --output dataset-tue.enc\n"
+              << "  ./cipher_tool --cipher gost -e --archive --key <64-hex-ключа> --input photos --output photos.arc\n"
+              << "  ./cipher_tool --cipher gost -d --archive --member photos/2024 --key <64-hex-ключа> --input photos.arc --output restored\n"
+              << "  ./cipher_tool --cipher rot13 -e --input message.txt --output message.enc\n"
+              << "  ./cipher_tool --cipher rot13 -e --in-place --msync-window 64 --input big.dat\n"
+              << "  ./cipher_tool --cipher rot13 -e --rot 5 --xor-key 0badc0de --text \"hello\" --text \"world\"\n"
+              << "  ./cipher_tool --cipher rot13,morse,gost -e --key <64-hex-ключа> --input message.txt --output message.enc\n"
+              << "  ./cipher_tool --hash=256 --input disk.img\n"
+              << "  ./cipher_tool --cipher gost -e --hash --key <64-hex-ключа> --input disk.img --output disk.enc\n"
+              << "  ./cipher_tool --cipher rot13 -e --threads 8 --stats=json --input big.dat --output big.enc\n"
+              << "  pg_dump db | ./cipher_tool --cipher gost -e --key <64-hex-ключа> --input - --output - | zstd > db.enc.zst\n";
 }
 
+// --- Вспомогательные функции ---
 
-struct GostFuncs {
-    using EncryptTextFunc = GostEncryptedTextResultC (*)(const char*, const char*, const char*);
-    using DecryptTextFunc = GostDecryptedTextResultC (*)(const char*, const char*, const char*);
-    using EncryptFileFunc = GostFileOperationResultC (*)(const char*, const char*, const char*, const char*);
-    using DecryptFileFunc = GostFileOperationResultC (*)(const char*, const char*, const char*);
-    using GenerateKeyFunc = GostKeyGenResultC (*)();
-    using FreeEncResFunc = void (*)(GostEncryptedTextResultC*);
-    using FreeDecResFunc = void (*)(GostDecryptedTextResultC*);
-    using FreeFileResFunc = void (*)(GostFileOperationResultC*);
-    using FreeKeyResFunc = void(*)(GostKeyGenResultC*);
-
-
-    EncryptTextFunc encryptText;
-    DecryptTextFunc decryptText;
-    EncryptFileFunc encryptFile;
-    DecryptFileFunc decryptFile;
-    GenerateKeyFunc generateKey;
-    FreeEncResFunc freeEncResult;
-    FreeDecResFunc freeDecResult;
-    FreeFileResFunc freeFileResult;
-    FreeKeyResFunc freeKeyResult;
-};
+std::string to_text(CipherTextEncodingC encoding, const unsigned char* data, size_t size) {
+    if (!data) return "";
+    return encodeText(encoding, data, size);
+}
 
-struct MorseFuncs {
-    using EncodeTextFunc = MorseEncodedResultC (*)(const char*);
-    using DecodeTextFunc = MorseDecodedResultC (*)(const unsigned char*, size_t);
-    using EncodeFileFunc = MorseFileOperationResultC (*)(const char*, const char*);
-    using DecodeFileFunc = MorseFileOperationResultC (*)(const char*, const char*);
-    using FreeEncResFunc = void (*)(MorseEncodedResultC*);
-    using FreeDecResFunc = void (*)(MorseDecodedResultC*);
-    using FreeFileResFunc = void (*)(MorseFileOperationResultC*);
-
-    EncodeTextFunc encodeText;
-    DecodeTextFunc decodeText;
-    EncodeFileFunc encodeFile;
-    DecodeFileFunc decodeFile;
-    FreeEncResFunc freeEncResult;
-    FreeDecResFunc freeDecResult;
-    FreeFileResFunc freeFileResult;
-};
+std::vector<unsigned char> from_text(CipherTextEncodingC encoding, const std::string& text) {
+    std::vector<unsigned char> bytes;
+    if (!decodeText(encoding, text, bytes)) {
+        throw std::invalid_argument(std::string("Недопустимая строка в кодировке ") +
+                                    cipher_text_encoding_name(encoding) + ": " + text);
+    }
+    return bytes;
+}
 
-struct Rot13Funcs {
-    using EncodeTextFunc = EncodedResultC (*)(const char*);
-    using DecodeTextFunc = DecodedResultC (*)(const unsigned char*, size_t);
-    using EncodeFileFunc = FileOperationResultC (*)(const char*, const char*);
-    using DecodeFileFunc = FileOperationResultC (*)(const char*, const char*);
-    using FreeEncResFunc = void (*)(EncodedResultC*);
-    using FreeDecResFunc = void (*)(DecodedResultC*);
-    using FreeFileResFunc = void (*)(FileOperationResultC*);
-
-    EncodeTextFunc encodeText;
-    DecodeTextFunc decodeText;
-    EncodeFileFunc encodeFile;
-    DecodeFileFunc decodeFile;
-    FreeEncResFunc freeEncResult;
-    FreeDecResFunc freeDecResult;
-    FreeFileResFunc freeFileResult;
+// Результат вызова плагина; освобождается функцией free_result того же плагина.
+class PluginResult {
+public:
+    PluginResult(const CipherPluginDescriptor& plugin, CipherResultC result) : plugin_(plugin), result_(result) {}
+    ~PluginResult() { plugin_.free_result(&result_); }
+    PluginResult(const PluginResult&) = delete;
+    PluginResult& operator=(const PluginResult&) = delete;
+
+    const CipherResultC& get() const { return result_; }
+    const CipherResultC* operator->() const { return &result_; }
+
+    // Бросает исключение с сообщением плагина, если операция не удалась.
+    void check(const char* fallback) const {
+        if (!result_.success) throw std::runtime_error(result_.message ? result_.message : fallback);
+    }
+
+private:
+    const CipherPluginDescriptor& plugin_;
+    CipherResultC result_;
 };
 
-// --- Глобальный менеджер загруженных библиотек ---
+std::string capabilityNames(uint32_t caps) {
+    static const struct { uint32_t flag; const char* name; } names[] = {
+        {CIPHER_CAP_BUFFER, "buffer"},     {CIPHER_CAP_FILE, "file"},         {CIPHER_CAP_STREAMING, "streaming"},
+        {CIPHER_CAP_IN_PLACE, "in-place"}, {CIPHER_CAP_PARALLEL, "parallel"}, {CIPHER_CAP_BATCH, "batch"},
+        {CIPHER_CAP_KEYED, "keyed"},       {CIPHER_CAP_KEYGEN, "keygen"},     {CIPHER_CAP_CHUNKED, "chunked"},
+        {CIPHER_CAP_INTO, "into"},         {CIPHER_CAP_DIRECT_IO, "direct-io"},
+    };
+    std::string result;
+    for (const auto& entry : names) {
+        if (!(caps & entry.flag)) continue;
+        if (!result.empty()) result += ", ";
+        result += entry.name;
+    }
+    return result;
+}
 
-#ifdef _WIN32
-using LibraryHandle = HMODULE;
-#else
-using LibraryHandle = void*;
-#endif
+void appendOption(std::string& options, const std::string& option) {
+    if (!options.empty()) options += ';';
+    options += option;
+}
+
+// Параметр вида "шифр:имя[=значение]" адресован одному шифру конвейера; возвращает
+// имя шифра или пустую строку, если параметр общий.
+std::string optionTarget(const std::string& option) {
+    size_t colon = option.find(':');
+    if (colon == std::string::npos || colon > option.find('=')) return "";
+    return option.substr(0, colon);
+}
 
-struct Library {
-    LibraryHandle handle = nullptr;
-    union {
-        GostFuncs gost;
-        MorseFuncs morse;
-        Rot13Funcs rot13;
-    } funcs;
+// Параметры для шифра cipher: общие и адресованные ему (без префикса).
+std::string stageOptions(const std::string& options, const std::string& cipher) {
+    std::string result;
+    std::istringstream stream(options);
+    for (std::string option; std::getline(stream, option, ';');) {
+        if (option.empty()) continue;
+        std::string target = optionTarget(option);
+        if (target.empty()) {
+            appendOption(result, option);
+        } else if (target == cipher) {
+            appendOption(result, option.substr(target.size() + 1));
+        }
+    }
+    return result;
+}
 
-    ~Library() {
-        if (handle) {
-            #ifdef _WIN32
-            FreeLibrary(handle);
-            #else
-            dlclose(handle);
-            #endif
+// Параметр для шифра, которого нет среди выбранных, скорее всего ошибка в командной строке.
+void checkOptionTargets(const std::string& options, const std::vector<std::string>& ciphers) {
+    std::istringstream stream(options);
+    for (std::string option; std::getline(stream, option, ';');) {
+        std::string target = optionTarget(option);
+        if (!target.empty() && std::find(ciphers.begin(), ciphers.end(), target) == ciphers.end()) {
+            throw std::runtime_error("Параметр '" + option + "' относится к шифру " + target +
+                                     ", который не указан в --cipher.");
         }
     }
+}
+
+// Задание для плагина, собранное из командной строки или меню.
+struct CipherJob {
+    bool encrypt = true;
+    std::vector<std::string> texts;
+    std::string inputFile, outputFile, key, iv, options;
+    bool inPlace = false;
+    bool directIo = false;                            // --direct-io
+    size_t msyncWindow = 0;
+    bool threadsSet = false;
+    unsigned threads = 0;
+    CipherTextEncodingC encoding = CIPHER_TEXT_HEX;  // --encoding
+    bool crc = false;                                 // --crc
+    unsigned hashBits = 0;                            // --hash: 256 или 512, 0 — без хеша
+    StatsCollector* stats = nullptr;  // --stats
 };
 
-std::map<std::string, std::unique_ptr<Library>> loaded_libraries;
+// Приёмник замеров шифра cipher (пустое имя — сама программа) или nullptr без --stats.
+const CipherStatsSinkC* statsSink(const CipherJob& job, const std::string& cipher) {
+    return job.stats ? job.stats->sink(cipher) : nullptr;
+}
 
-template<typename T>
-T load_symbol(LibraryHandle handle, const char* name) {
-    #ifdef _WIN32
-    return reinterpret_cast<T>(GetProcAddress(handle, name));
-    #else
-    return reinterpret_cast<T>(dlsym(handle, name));
-    #endif
+std::string generateKey(const CipherPluginDescriptor& plugin) {
+    if (!(plugin.capabilities & CIPHER_CAP_KEYGEN)) {
+        throw std::runtime_error(std::string("Шифр ") + plugin.name + " не поддерживает генерацию ключа.");
+    }
+    PluginResult res(plugin, plugin.generate_key());
+    res.check("Unknown error during key generation.");
+    return res->key_hex ? res->key_hex : "";
 }
 
-bool load_cipher_library(const std::string& cipher_name) {
-    if (loaded_libraries.count(cipher_name)) {
-        return true;
+bool sameFile(const std::string& a, const std::string& b) {
+    std::error_code ec;
+    return std::filesystem::equivalent(a, b, ec);
+}
+
+void printBufferResult(const CipherJob& job, const unsigned char* data, size_t size, const char* iv_hex,
+                       const std::string& label) {
+    if (job.encrypt) {
+        if (iv_hex) std::cout << label << "IV (hex): " << iv_hex << "\n";
+        std::cout << label << "Результат (" << cipher_text_encoding_name(job.encoding)
+                  << "): " << to_text(job.encoding, data, size) << std::endl;
+    } else {
+        std::cout << label << "Открытый текст: " << std::string(reinterpret_cast<const char*>(data), size) << std::endl;
     }
+}
 
-    std::string lib_path;
-    #ifdef _WIN32
-    lib_path = cipher_name + "_cipher.dll";
-    #else
-    // Путь для Linux, предполагающий, что библиотеки лежат рядом
-    lib_path = "./lib" + cipher_name + "_cipher.so";
-    #endif
+void printBufferResult(const CipherJob& job, const CipherResultC& res, const std::string& label) {
+    printBufferResult(job, res.data, res.data_size, res.iv_hex, label);
+}
 
-    LibraryHandle handle = nullptr;
-    #ifdef _WIN32
-    handle = LoadLibrary(lib_path.c_str());
-    #else
-    handle = dlopen(lib_path.c_str(), RTLD_LAZY);
-    #endif
+// --direct-io относится только к преобразованию файла --input в другой --output.
+void checkDirectIo(const CipherJob& job) {
+    if (job.directIo && (!job.texts.empty() || job.inPlace)) {
+        throw std::runtime_error("--direct-io работает только с файлами --input и --output, без --text и --in-place.");
+    }
+}
 
-    if (!handle) {
-        std::cerr << "Ошибка: не удалось загрузить библиотеку: " << lib_path << std::endl;
-        #ifndef _WIN32
-        if(dlerror() != NULL) std::cerr << "dlopen error: " << dlerror() << std::endl;
-        #endif
-        return false;
-    }
-
-    auto lib = std::make_unique<Library>();
-    lib->handle = handle;
-
-    bool success = true;
-
-    if (cipher_name == "gost") {
-        lib->funcs.gost = {
-            load_symbol<GostFuncs::EncryptTextFunc>(handle, "encryptTextGOST_C"),
-            load_symbol<GostFuncs::DecryptTextFunc>(handle, "decryptTextGOST_C"),
-            load_symbol<GostFuncs::EncryptFileFunc>(handle, "encryptFileGOST_C"),
-            load_symbol<GostFuncs::DecryptFileFunc>(handle, "decryptFileGOST_C"),
-            load_symbol<GostFuncs::GenerateKeyFunc>(handle, "generateKeyGOST_C"),
-            load_symbol<GostFuncs::FreeEncResFunc>(handle, "free_gost_encrypted_result_C"),
-            load_symbol<GostFuncs::FreeDecResFunc>(handle, "free_gost_decrypted_result_C"),
-            load_symbol<GostFuncs::FreeFileResFunc>(handle, "free_gost_file_result_C"),
-            load_symbol<GostFuncs::FreeKeyResFunc>(handle, "free_gost_key_result_C")
-        };
-    } else if (cipher_name == "morse") {
-        lib->funcs.morse = {
-            load_symbol<MorseFuncs::EncodeTextFunc>(handle, "encodeTextToMorse_C"),
-            load_symbol<MorseFuncs::DecodeTextFunc>(handle, "decodeTextFromMorse_C"),
-            load_symbol<MorseFuncs::EncodeFileFunc>(handle, "encodeFileToMorse_C"),
-            load_symbol<MorseFuncs::DecodeFileFunc>(handle, "decodeFileFromMorse_C"),
-            load_symbol<MorseFuncs::FreeEncResFunc>(handle, "free_morse_encoded_result_C"),
-            load_symbol<MorseFuncs::FreeDecResFunc>(handle, "free_morse_decoded_result_C"),
-            load_symbol<MorseFuncs::FreeFileResFunc>(handle, "free_morse_file_result_C")
-        };
-    } else if (cipher_name == "rot13") {
-        lib->funcs.rot13 = {
-            load_symbol<Rot13Funcs::EncodeTextFunc>(handle, "encodeTextRot13Xor_C"),
-            load_symbol<Rot13Funcs::DecodeTextFunc>(handle, "decodeTextRot13Xor_C"),
-            load_symbol<Rot13Funcs::EncodeFileFunc>(handle, "encodeFileRot13Xor_C"),
-            load_symbol<Rot13Funcs::DecodeFileFunc>(handle, "decodeFileRot13Xor_C"),
-            load_symbol<Rot13Funcs::FreeEncResFunc>(handle, "free_rot13_encoded_result_C"),
-            load_symbol<Rot13Funcs::FreeDecResFunc>(handle, "free_rot13_decoded_result_C"),
-            load_symbol<Rot13Funcs::FreeFileResFunc>(handle, "free_rot13_file_result_C")
-        };
+// Выполняет задание самым быстрым путём, который поддерживает плагин:
+// пакетом для нескольких строк, на месте — если вход и выход совпадают,
+// многопоточно — для больших файлов. Ошибки сообщаются исключениями.
+void runJob(const CipherPluginDescriptor& plugin, CipherJob& job) {
+    checkDirectIo(job);
+    uint32_t caps = plugin.capabilities;
+    if (caps & CIPHER_CAP_KEYED) {
+        if (job.key.empty() && job.encrypt) {
+            job.key = generateKey(plugin);
+            std::cout << "Ключ не указан, сгенерирован новый: " << job.key << std::endl;
+        } else if (job.key.empty()) {
+            throw std::runtime_error(std::string("Для дешифрования шифром ") + plugin.name + " требуется ключ (--key).");
+        }
+    }
+
+    CipherParamsC params = {};
+    params.key_hex = job.key.c_str();
+    params.iv_hex = job.iv.c_str();
+    params.options = job.options.c_str();
+    params.stats = statsSink(job, plugin.name);
+
+    if (!job.texts.empty()) {
+        if (!(caps & CIPHER_CAP_BUFFER)) {
+            throw std::runtime_error(std::string("Шифр ") + plugin.name + " не поддерживает обработку текста.");
+        }
+        if ((caps & CIPHER_CAP_KEYED) && !job.encrypt && job.iv.empty()) {
+            throw std::runtime_error("Для дешифрования текста требуется вектор инициализации (--iv).");
+        }
+        // При шифровании текст передаётся как есть, при дешифровании — в кодировке --encoding.
+        // Буферные вызовы плагин не замеряет, поэтому их время считается здесь.
+        CipherStageTimer parseTimer(statsSink(job, ""), CIPHER_STAGE_PARSE);
+        std::vector<std::vector<unsigned char>> inputs;
+        for (const std::string& text : job.texts) {
+            inputs.push_back(job.encrypt ? std::vector<unsigned char>(text.begin(), text.end()) : from_text(job.encoding, text));
+            parseTimer.addBytes(text.size());
+        }
+        parseTimer.stop();
+        auto label = [&](size_t i) { return inputs.size() > 1 ? "[" + std::to_string(i + 1) + "] " : std::string(); };
+
+        if (inputs.size() > 1 && (caps & CIPHER_CAP_BATCH)) {
+            std::vector<CipherBufferC> buffers;
+            for (const auto& input : inputs) buffers.push_back({input.data(), input.size()});
+            std::vector<CipherResultC> results(inputs.size());
+            auto batch = job.encrypt ? plugin.encode_batch : plugin.decode_batch;
+            CipherStageTimer timer(params.stats, CIPHER_STAGE_TRANSFORM);
+            for (const auto& input : inputs) timer.addBytes(input.size());
+            batch(buffers.data(), buffers.size(), &params, results.data());
+            timer.stop();
+            std::vector<std::unique_ptr<PluginResult>> owned;
+            for (const CipherResultC& result : results) owned.push_back(std::make_unique<PluginResult>(plugin, result));
+            for (size_t i = 0; i < owned.size(); ++i) {
+                owned[i]->check("Unknown batch error.");
+                printBufferResult(job, owned[i]->get(), label(i));
+            }
+            return;
+        }
+
+        // Шифру с ключом encode_into нужен готовый IV, поэтому без --iv
+        // используется encode_buffer, который сгенерирует его сам.
+        bool into = !(caps & CIPHER_CAP_KEYED) || !job.iv.empty();
+        auto transform = job.encrypt ? plugin.encode_buffer : plugin.decode_buffer;
+        std::vector<unsigned char> output;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            CipherStageTimer timer(params.stats, CIPHER_STAGE_TRANSFORM);
+            timer.addBytes(inputs[i].size());
+            if (into && pluginTransformInto(plugin, job.encrypt, inputs[i].data(), inputs[i].size(), &params, output)) {
+                timer.stop();
+                printBufferResult(job, output.data(), output.size(),
+                                  (caps & CIPHER_CAP_KEYED) ? job.iv.c_str() : nullptr, label(i));
+                continue;
+            }
+            PluginResult res(plugin, transform(inputs[i].data(), inputs[i].size(), &params));
+            timer.stop();
+            res.check(job.encrypt ? "Unknown encryption error." : "Unknown decryption error.");
+            printBufferResult(job, res.get(), label(i));
+        }
+        return;
+    }
+
+    if (job.inputFile.empty()) {
+        throw std::runtime_error("Укажите либо --text, либо --input и --output.");
+    }
+    if (!(caps & CIPHER_CAP_FILE)) {
+        throw std::runtime_error(std::string("Шифр ") + plugin.name + " не поддерживает обработку файлов.");
+    }
+
+    bool inPlace = job.inPlace || (!job.outputFile.empty() && sameFile(job.inputFile, job.outputFile));
+    if (inPlace) {
+        if (job.directIo) {
+            throw std::runtime_error("--direct-io не работает с преобразованием на месте; укажите другой --output.");
+        }
+        if (!(caps & CIPHER_CAP_IN_PLACE)) {
+            throw std::runtime_error(std::string("Шифр ") + plugin.name +
+                                     " не поддерживает преобразование на месте; укажите другой --output.");
+        }
+        params.flags |= CIPHER_JOB_IN_PLACE;
+        params.msync_window = job.msyncWindow;
     } else {
-        success = false;
+        if (job.directIo) {
+            if (!(caps & CIPHER_CAP_DIRECT_IO)) {
+                throw std::runtime_error(std::string("Шифр ") + plugin.name + " не поддерживает --direct-io.");
+            }
+            params.flags |= CIPHER_JOB_DIRECT_IO;
+        }
+        if (job.outputFile.empty()) throw std::runtime_error("Укажите --output.");
+        std::error_code ec;
+        std::uintmax_t size = std::filesystem::file_size(job.inputFile, ec);
+        bool large = !ec && size >= PARALLEL_FILE_THRESHOLD;
+        if ((caps & CIPHER_CAP_PARALLEL) && (job.threadsSet || large)) {
+            params.flags |= CIPHER_JOB_PARALLEL;
+            params.thread_count = job.threads;
+        }
     }
 
-    if (!success) return false;
+    auto transform = job.encrypt ? plugin.encode_file : plugin.decode_file;
+    PluginResult res(plugin, transform(job.inputFile.c_str(), inPlace ? nullptr : job.outputFile.c_str(), &params));
+    res.check("Unknown file operation error.");
+    if (res->message) std::cout << res->message << std::endl;
+    if (res->iv_hex && *res->iv_hex) std::cout << "Использованный IV: " << res->iv_hex << std::endl;
+}
 
-    loaded_libraries[cipher_name] = std::move(lib);
-    return true;
+// Параметры ГОСТ, которые выполняет только файловая операция шифра: --hash
+// считается на потоке конвейера, поэтому с ними не сочетается.
+const char* const GOST_FILE_ONLY_OPTIONS[] = {"append", "checkpoint", "resume", "delta", "delta-base", "archive",
+                                              "member"};
+// Сигнатура архива ГОСТ (gost/gost_archive.hpp): у архива нет единого открытого текста.
+const char GOST_ARCHIVE_SIGNATURE[] = "GOSTARC1";
+
+// Отвергает --hash с файловыми режимами ГОСТ и с распаковкой архива до того,
+// как будет создан или обрезан выходной файл.
+void checkHashJob(const CipherJob& job) {
+    std::istringstream stream(stageOptions(job.options, "gost"));
+    for (std::string option; std::getline(stream, option, ';');) {
+        std::string name = option.substr(0, option.find('='));
+        for (const char* fileOnly : GOST_FILE_ONLY_OPTIONS) {
+            if (name == fileOnly) {
+                throw std::runtime_error("--hash нельзя сочетать с --" + name +
+                                         ": хеш считается потоком, а этот режим ГОСТ работает только с файлом.");
+            }
+        }
+    }
+    if (job.encrypt || job.inputFile.empty() || job.inputFile == "-") return;
+    char header[sizeof(GOST_ARCHIVE_SIGNATURE) - 1] = {};
+    std::ifstream in(job.inputFile, std::ios::binary);
+    in.read(header, sizeof(header));
+    if (in.gcount() == sizeof(header) && std::equal(header, header + sizeof(header), GOST_ARCHIVE_SIGNATURE)) {
+        throw std::runtime_error("--hash нельзя сочетать с распаковкой архива ГОСТ: у архива нет единого открытого текста.");
+    }
 }
 
-// --- Вспомогательные функции и меню ---
+// Конвейер из нескольких шифров. Стадии с ключом получают общий --key; IV
+// каждой такой стадии записывается в её выход, поэтому результат шифрования
+// расшифровывается тем же конвейером без --iv. Этим же путём, конвейером из
+// одного шифра, обрабатываются стандартные ввод и вывод ('-'): данные идут
+// потоком, а сообщения при выводе в stdout печатаются в stderr.
+void runPipelineJob(const std::vector<const CipherPluginDescriptor*>& plugins, CipherJob& job) {
+    bool toStdout = job.outputFile == "-";
+    std::ostream& status = toStdout ? std::cerr : std::cout;
+    std::vector<PipelineStage> stages;
+    const CipherPluginDescriptor* keyed = nullptr;
+    for (const CipherPluginDescriptor* plugin : plugins) {
+        stages.push_back({plugin, stageOptions(job.options, plugin->name), statsSink(job, plugin->name)});
+        if (!keyed && (plugin->capabilities & CIPHER_CAP_KEYED)) keyed = plugin;
+    }
+    std::string error = validatePipeline(stages);
+    if (!error.empty()) throw std::runtime_error(error);
+    checkDirectIo(job);
+    if (job.hashBits) checkHashJob(job);
+
+    if (keyed && job.key.empty()) {
+        if (!job.encrypt) {
+            throw std::runtime_error(std::string("Для дешифрования шифром ") + keyed->name + " требуется ключ (--key).");
+        }
+        job.key = generateKey(*keyed);
+        status << "Ключ не указан, сгенерирован новый: " << job.key << std::endl;
+    }
+
+    const CipherStatsSinkC* hostStats = statsSink(job, "");
+    // --hash: открытый текст — вход при шифровании и выход при дешифровании.
+    std::unique_ptr<Streebog> hash;
+    if (job.hashBits) hash.reset(new Streebog(job.hashBits));
+    auto printDigest = [&](const std::string& label) {
+        std::vector<unsigned char> digest = hash->finish();
+        status << label << hash->name() << " открытого текста: "
+               << to_text(job.encoding, digest.data(), digest.size()) << std::endl;
+    };
+
+    if (!job.texts.empty()) {
+        if (job.crc) throw std::runtime_error("--crc применяется только к файлам и потокам (--input/--output).");
+        for (size_t i = 0; i < job.texts.size(); ++i) {
+            CipherStageTimer parseTimer(hostStats, CIPHER_STAGE_PARSE);
+            std::vector<unsigned char> input = job.encrypt
+                ? std::vector<unsigned char>(job.texts[i].begin(), job.texts[i].end())
+                : from_text(job.encoding, job.texts[i]);
+            parseTimer.addBytes(job.texts[i].size());
+            parseTimer.stop();
+            size_t offset = 0;
+            std::vector<unsigned char> output;
+            PipelineResult result = runPipeline(
+                stages, job.encrypt, job.key, job.iv,
+                [&](unsigned char* buffer, size_t capacity, size_t& size, std::string&) {
+                    size = std::min(capacity, input.size() - offset);
+                    std::copy(input.begin() + offset, input.begin() + offset + size, buffer);
+                    offset += size;
+                    return true;
+                },
+                [&](const unsigned char* data, size_t size, std::string&) {
+                    output.insert(output.end(), data, data + size);
+                    return true;
+                },
+                hostStats);
+            if (!result.success) throw std::runtime_error(result.message);
+            std::string label = job.texts.size() > 1 ? "[" + std::to_string(i + 1) + "] " : "";
+            if (hash) {
+                const std::vector<unsigned char>& plaintext = job.encrypt ? input : output;
+                hash->update(plaintext.data(), plaintext.size());
+                printDigest(label);
+            }
 
-void displayMenu();
-void handleGostMenu();
-void handleMorseMenu();
-void handleRot13Menu();
+            if (toStdout) {
+                CipherStageTimer writeTimer(hostStats, CIPHER_STAGE_WRITE);
+                StdoutWriter writer;
+                std::string error;
+                if (!writer.write(output.data(), output.size(), error) || !writer.flush(error)) {
+                    throw std::runtime_error(error);
+                }
+                continue;
+            }
+            if (job.encrypt) {
+                std::cout << label << "Результат (" << cipher_text_encoding_name(job.encoding)
+                          << "): " << to_text(job.encoding, output.data(), output.size()) << std::endl;
+            } else {
+                std::cout << label << "Открытый текст: " << std::string(output.begin(), output.end()) << std::endl;
+            }
+        }
+        return;
+    }
 
-std::string to_hex_string(const unsigned char* data, size_t size) {
-    if (!data) return "";
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
-    for (size_t i = 0; i < size; ++i) {
-        oss << std::setw(2) << static_cast<int>(data[i]);
+    if (job.inputFile.empty() || job.outputFile.empty()) {
+        throw std::runtime_error("Укажите либо --text, либо --input и --output.");
+    }
+    bool fromStdin = job.inputFile == "-";
+    if (job.inPlace || (!fromStdin && !toStdout && sameFile(job.inputFile, job.outputFile))) {
+        throw std::runtime_error("Конвейер не поддерживает преобразование на месте; укажите другой --output.");
+    }
+    if (job.directIo) {
+        throw std::runtime_error("--direct-io работает только с файлами одного шифра, без конвейера, --crc и --hash.");
     }
-    return oss.str();
+    std::ifstream in;
+    if (!fromStdin) {
+        in.open(job.inputFile, std::ios::binary);
+        if (!in) throw std::runtime_error("Не удалось открыть входной файл: " + job.inputFile);
+    }
+    std::ofstream out;
+    if (!toStdout) {
+        out.open(job.outputFile, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Не удалось открыть выходной файл: " + job.outputFile);
+    }
+    std::unique_ptr<StdoutWriter> writer;
+    if (toStdout) writer.reset(new StdoutWriter);
+
+    PipelineSource source = readStdin;
+    if (!fromStdin) {
+        source = [&](unsigned char* buffer, size_t capacity, size_t& size, std::string& error) {
+            in.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(capacity));
+            size = static_cast<size_t>(in.gcount());
+            if (in.bad()) {
+                error = "Ошибка чтения файла: " + job.inputFile;
+                return false;
+            }
+            return true;
+        };
+    }
+    PipelineSink sink = [&](const unsigned char* data, size_t size, std::string& error) {
+        return writer->write(data, size, error);
+    };
+    if (!toStdout) {
+        sink = [&](const unsigned char* data, size_t size, std::string& error) {
+            if (!out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size))) {
+                error = "Ошибка записи файла: " + job.outputFile;
+                return false;
+            }
+            return true;
+        };
+    }
+
+    if (hash && job.encrypt) {
+        PipelineSource plain = source;
+        source = [&, plain](unsigned char* buffer, size_t capacity, size_t& size, std::string& error) {
+            if (!plain(buffer, capacity, size, error)) return false;
+            hash->update(buffer, size);
+            return true;
+        };
+    } else if (hash) {
+        PipelineSink plain = sink;
+        sink = [&, plain](const unsigned char* data, size_t size, std::string& error) {
+            hash->update(data, size);
+            return plain(data, size, error);
+        };
+    }
+
+    // --crc: шифротекст идёт кадрами с CRC32C, которые проверяются до расшифрования.
+    std::unique_ptr<CrcFrameWriter> crcWriter;
+    std::unique_ptr<CrcFrameReader> crcReader;
+    if (job.crc && job.encrypt) {
+        crcWriter.reset(new CrcFrameWriter(sink));
+        sink = [&](const unsigned char* data, size_t size, std::string& error) {
+            return crcWriter->write(data, size, error);
+        };
+    } else if (job.crc) {
+        crcReader.reset(new CrcFrameReader(source));
+        source = [&](unsigned char* buffer, size_t capacity, size_t& size, std::string& error) {
+            return crcReader->read(buffer, capacity, size, error);
+        };
+    }
+
+    PipelineResult result = runPipeline(stages, job.encrypt, job.key, job.iv, source, sink, hostStats);
+    if (!result.success) throw std::runtime_error(result.message);
+    CipherStageTimer flushTimer(hostStats, CIPHER_STAGE_WRITE);
+    if (crcWriter && !crcWriter->finish(error)) throw std::runtime_error(error);
+    if (toStdout && !writer->flush(error)) throw std::runtime_error(error);
+    if (!toStdout) {
+        out.close();
+        if (!out) throw std::runtime_error("Ошибка записи файла: " + job.outputFile);
+    }
+    flushTimer.stop();
+    status << result.message << std::endl;
+    if (hash) printDigest("");
 }
 
-std::vector<unsigned char> from_hex_string(const std::string& hex) {
-    if (hex.length() % 2 != 0) {
-        throw std::invalid_argument("Hex-строка должна иметь четное количество символов.");
+// --hash без -e/-d: хеш Стрибог строк --text или файла --input ('-' — стандартный
+// ввод) в виде "<дайджест>  <имя>", как у sha256sum и gostsum.
+void runHashJob(const CipherJob& job) {
+    Streebog hash(job.hashBits);
+    const CipherStatsSinkC* hostStats = statsSink(job, "");
+    if (!job.texts.empty()) {
+        for (const std::string& text : job.texts) {
+            CipherStageTimer timer(hostStats, CIPHER_STAGE_TRANSFORM);
+            timer.addBytes(text.size());
+            hash.update(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+            std::vector<unsigned char> digest = hash.finish();
+            timer.stop();
+            std::cout << to_text(job.encoding, digest.data(), digest.size()) << "  \"" << text << "\"" << std::endl;
+        }
+        return;
     }
-    std::vector<unsigned char> bytes;
-    for (unsigned int i = 0; i < hex.length(); i += 2) {
-        std::string byteString = hex.substr(i, 2);
-        try {
-            unsigned char byte = static_cast<unsigned char>(std::stoul(byteString, nullptr, 16));
-            bytes.push_back(byte);
-        } catch (const std::exception& e) {
-            throw std::invalid_argument("Недопустимый символ в hex-строке: " + byteString);
+    if (job.inputFile.empty()) throw std::runtime_error("Укажите --text или --input для --hash.");
+
+    bool fromStdin = job.inputFile == "-";
+    std::ifstream in;
+    if (!fromStdin) {
+        in.open(job.inputFile, std::ios::binary);
+        if (!in) throw std::runtime_error("Не удалось открыть входной файл: " + job.inputFile);
+    }
+    std::vector<unsigned char> buffer(HASH_READ_BLOCK);
+    CipherStageTimer readTimer(hostStats, CIPHER_STAGE_READ);
+    CipherStageTimer hashTimer(hostStats, CIPHER_STAGE_TRANSFORM);
+    for (;;) {
+        hashTimer.pause();
+        readTimer.resume();
+        size_t size = 0;
+        std::string error;
+        if (fromStdin) {
+            if (!readStdin(buffer.data(), buffer.size(), size, error)) throw std::runtime_error(error);
+        } else {
+            in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+            size = static_cast<size_t>(in.gcount());
+            if (in.bad()) throw std::runtime_error("Ошибка чтения файла: " + job.inputFile);
         }
+        readTimer.pause();
+        if (size == 0) break;
+        readTimer.addBytes(size);
+        hashTimer.resume();
+        hashTimer.addBytes(size);
+        hash.update(buffer.data(), size);
     }
-    return bytes;
+    std::vector<unsigned char> digest = hash.finish();
+    readTimer.stop();
+    hashTimer.stop();
+    std::cout << to_text(job.encoding, digest.data(), digest.size()) << "  " << job.inputFile << std::endl;
 }
 
+void listCiphers(const PluginRegistry& registry) {
+    if (registry.plugins().empty()) {
+        std::cout << "Шифры не найдены." << std::endl;
+        return;
+    }
+    for (const LoadedPlugin& plugin : registry.plugins()) {
+        const CipherPluginDescriptor& d = *plugin.descriptor;
+        std::cout << d.name << " — " << (d.description ? d.description : "") << "\n"
+                  << "    возможности: " << capabilityNames(d.capabilities) << "\n"
+                  << "    библиотека: " << plugin.path << std::endl;
+    }
+}
 
+void printPluginErrors(const std::vector<std::string>& errors) {
+    for (const std::string& error : errors) std::cerr << "Пропущен плагин: " << error << std::endl;
+}
+
+// Регистрирует встроенные шифры (статическая сборка) и загружает плагины из каталога.
+// В статической сборке каталог сканируется, только если он задан явно.
+void loadCiphers(PluginRegistry& registry, const std::string& pluginDir, bool pluginDirSet,
+                 std::vector<std::string>& errors, const CipherStatsSinkC* stats = nullptr) {
+    CipherStageTimer timer(stats, CIPHER_STAGE_LOAD);
+#ifdef CIPHER_STATIC_PLUGINS
+    for (const CipherPluginDescriptor* descriptor : BUILTIN_CIPHERS) {
+        std::string error;
+        if (!registry.add(descriptor, "(встроенный)", error)) errors.push_back(error);
+    }
+    if (!pluginDirSet) return;
+#else
+    (void)pluginDirSet;
+#endif
+    registry.discover(pluginDir, errors);
+}
+
+void handlePluginMenu(const CipherPluginDescriptor& plugin);
 
 int main(int argc, char* argv[]) {
     #ifdef _WIN32
@@ -270,380 +713,308 @@ int main(int argc, char* argv[]) {
         SetConsoleOutputCP(CP_UTF8);
     #endif
 
+    const char* envPluginDir = std::getenv("CIPHER_PLUGIN_DIR");
+    bool pluginDirSet = envPluginDir && *envPluginDir;
+    std::string pluginDir = pluginDirSet ? envPluginDir : ".";
+    PluginRegistry registry;
+    std::vector<std::string> pluginErrors;
+
     if (argc > 1) {
-        std::string cipher, text, inputFile, outputFile, key, iv;
-        bool encrypt = false, decrypt = false, generateKey = false;
-
-        for (int i = 1; i < argc; ++i) {
-            std::string arg = argv[i];
-            if (arg == "-h" || arg == "--help") {
-                printHelp(); return 0;
-            } else if (arg == "--cipher") {
-                cipher = (i + 1 < argc) ? argv[++i] : "";
-            } else if (arg == "-e" || arg == "--encrypt") {
-                encrypt = true;
-            } else if (arg == "-d" || arg == "--decrypt") {
-                decrypt = true;
-            } else if (arg == "--generate-key") {
-                generateKey = true;
-            } else if (arg == "--text") {
-                text = (i + 1 < argc) ? argv[++i] : "";
-            } else if (arg == "--input") {
-                inputFile = (i + 1 < argc) ? argv[++i] : "";
-            } else if (arg == "--output") {
-                outputFile = (i + 1 < argc) ? argv[++i] : "";
-            } else if (arg == "--key") {
-                key = (i + 1 < argc) ? argv[++i] : "";
-            } else if (arg == "--iv") {
-                iv = (i + 1 < argc) ? argv[++i] : "";
+        std::string cipher;
+        CipherJob job;
+        bool encrypt = false, decrypt = false, generateKeyMode = false, listMode = false;
+        std::unique_ptr<StatsCollector> stats;
+        bool statsJson = false;
+
+        try {
+            for (int i = 1; i < argc; ++i) {
+                std::string arg = argv[i];
+                auto next = [&]() { return (i + 1 < argc) ? std::string(argv[++i]) : std::string(); };
+                if (arg == "-h" || arg == "--help") {
+                    printHelp(); return 0;
+                } else if (arg == "--cipher") {
+                    cipher = next();
+                } else if (arg == "-e" || arg == "--encrypt") {
+                    encrypt = true;
+                } else if (arg == "-d" || arg == "--decrypt") {
+                    decrypt = true;
+                } else if (arg == "--generate-key") {
+                    generateKeyMode = true;
+                } else if (arg == "--list-ciphers") {
+                    listMode = true;
+                } else if (arg == "--plugin-dir") {
+                    pluginDir = next();
+                    pluginDirSet = true;
+                } else if (arg == "--text") {
+                    job.texts.push_back(next());
+                } else if (arg == "--input") {
+                    job.inputFile = next();
+                } else if (arg == "--output") {
+                    job.outputFile = next();
+                } else if (arg == "--key") {
+                    job.key = next();
+                } else if (arg == "--iv") {
+                    job.iv = next();
+                } else if (arg == "--option") {
+                    appendOption(job.options, next());
+                } else if (arg == "--cyrillic") {
+                    appendOption(job.options, "rot13:cyrillic");
+                } else if (arg == "--rot") {
+                    appendOption(job.options, "rot13:rot=" + std::to_string(std::stoi(next())));
+                } else if (arg == "--xor-key") {
+                    appendOption(job.options, "rot13:xor-key=" + next());
+                } else if (arg == "--in-place") {
+                    job.inPlace = true;
+                } else if (arg == "--direct-io") {
+                    job.directIo = true;
+                } else if (arg == "--msync-window") {
+                    job.msyncWindow = static_cast<size_t>(std::stoull(next())) * 1024 * 1024;
+                } else if (arg == "--threads") {
+                    job.threadsSet = true;
+                    job.threads = static_cast<unsigned>(std::stoul(next()));
+                    cipher_runtime_set_threads(job.threads);
+                } else if (arg == "--encoding") {
+                    std::string name = next();
+                    if (!cipher_text_encoding_from_name(name.c_str(), &job.encoding)) {
+                        throw std::invalid_argument("--encoding " + name + " (ожидается hex, base64 или base85)");
+                    }
+                } else if (arg == "--pin-threads") {
+                    cipher_runtime_set_affinity(1);
+                } else if (arg == "--crc") {
+                    job.crc = true;
+                } else if (arg == "--compress") {
+                    appendOption(job.options, "gost:compress");
+                } else if (arg == "--append") {
+                    appendOption(job.options, "gost:append");
+                } else if (arg == "--checkpoint") {
+                    appendOption(job.options, "gost:checkpoint=" + std::to_string(std::stoull(next())));
+                } else if (arg == "--resume") {
+                    appendOption(job.options, "gost:resume");
+                } else if (arg == "--delta") {
+                    appendOption(job.options, "gost:delta");
+                } else if (arg == "--delta-base") {
+                    appendOption(job.options, "gost:delta-base=" + next());
+                } else if (arg == "--archive") {
+                    appendOption(job.options, "gost:archive");
+                } else if (arg == "--member") {
+                    appendOption(job.options, "gost:member=" + next());
+                } else if (arg == "--audio") {
+                    appendOption(job.options, "morse:audio");
+                } else if (arg == "--wpm") {
+                    appendOption(job.options, "morse:wpm=" + std::to_string(std::stoul(next())));
+                } else if (arg == "--tone") {
+                    appendOption(job.options, "morse:tone=" + std::to_string(std::stoul(next())));
+                } else if (arg == "--sample-rate") {
+                    appendOption(job.options, "morse:sample-rate=" + std::to_string(std::stoul(next())));
+                } else if (arg == "--hash" || arg == "--hash=512") {
+                    job.hashBits = 512;
+                } else if (arg == "--hash=256") {
+                    job.hashBits = 256;
+                } else if (arg.compare(0, 7, "--hash=") == 0) {
+                    throw std::invalid_argument(arg + " (ожидается --hash, --hash=256 или --hash=512)");
+                } else if (arg == "--stats" || arg == "--stats=text" || arg == "--stats=json") {
+                    if (!stats) stats.reset(new StatsCollector);
+                    statsJson = arg == "--stats=json";
+                } else if (arg.compare(0, 8, "--stats=") == 0) {
+                    throw std::invalid_argument(arg + " (ожидается --stats или --stats=json)");
+                }
             }
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка: недопустимое значение опции: " << e.what() << std::endl;
+            return 1;
+        }
+
+        job.stats = stats.get();
+        if (job.hashBits && !listMode && !encrypt && !decrypt && !generateKeyMode) {
+            try {
+                runHashJob(job);
+            } catch (const std::exception& e) {
+                std::cerr << "Произошла ошибка: " << e.what() << std::endl;
+                if (stats) std::cerr << stats->report(statsJson) << std::flush;
+                return 1;
+            }
+            if (stats) std::cerr << stats->report(statsJson) << std::flush;
+            return 0;
+        }
+        loadCiphers(registry, pluginDir, pluginDirSet, pluginErrors, statsSink(job, ""));
+
+        if (listMode) {
+            listCiphers(registry);
+            printPluginErrors(pluginErrors);
+            return 0;
         }
 
-        if (cipher.empty() || (encrypt && decrypt) || (generateKey && (encrypt || decrypt))) {
+        if (cipher.empty() || (encrypt + decrypt + generateKeyMode) != 1) {
             std::cerr << "Ошибка: Вы должны указать шифр и ровно один режим (--encrypt, --decrypt или --generate-key)." << std::endl;
             printHelp(); return 1;
         }
 
-        if (!load_cipher_library(cipher)) {
+        std::vector<std::string> names;
+        std::vector<const CipherPluginDescriptor*> pipeline;
+        std::istringstream cipherList(cipher);
+        for (std::string name; std::getline(cipherList, name, ',');) {
+            const CipherPluginDescriptor* plugin = registry.find(name);
+            if (!plugin) {
+                std::cerr << "Ошибка: шифр '" << name << "' не найден в каталоге плагинов: " << pluginDir << std::endl;
+                printPluginErrors(pluginErrors);
+                return 1;
+            }
+            names.push_back(name);
+            pipeline.push_back(plugin);
+        }
+        if (pipeline.empty()) {
+            std::cerr << "Ошибка: шифр не указан." << std::endl;
             return 1;
         }
+        const CipherPluginDescriptor* plugin = pipeline.front();
+        for (const CipherPluginDescriptor* stage : pipeline) {
+            if (stage->capabilities & CIPHER_CAP_KEYGEN) {
+                plugin = stage;
+                break;
+            }
+        }
 
         try {
-            if (cipher == "gost") {
-                auto* funcs = &loaded_libraries.at(cipher)->funcs.gost;
-
-                if (generateKey) {
-                    GostKeyGenResultC res = funcs->generateKey();
-                    if (res.success) {
-                        std::cout << "Сгенерированный ключ (hex): " << res.key_hex << std::endl;
-                    } else throw std::runtime_error(res.error_message ? res.error_message : "Unknown error during key generation.");
-                    funcs->freeKeyResult(&res);
-                    return 0;
-                }
-
-                if (encrypt) {
-                    if (key.empty()) {
-                        GostKeyGenResultC key_res = funcs->generateKey();
-                        if (key_res.success) {
-                            key = key_res.key_hex;
-                             std::cout << "Ключ не указан, сгенерирован новый: " << key << std::endl;
-                        } else {
-                            std::string err_msg = key_res.error_message ? key_res.error_message : "Unknown error during key generation.";
-                            funcs->freeKeyResult(&key_res);
-                            throw std::runtime_error("Не удалось сгенерировать ключ: " + err_msg);
-                        }
-                        funcs->freeKeyResult(&key_res);
-                    }
-                    if (!text.empty()) {
-                        GostEncryptedTextResultC res = funcs->encryptText(text.c_str(), key.c_str(), iv.c_str());
-                        if (res.success) {
-                            std::cout << "Шифрование успешно.\n" << "IV (hex): " << res.iv_hex << "\n" << "Шифротекст (hex): " << res.ciphertext_hex << std::endl;
-                        } else throw std::runtime_error(res.error_message ? res.error_message : "Unknown encryption error.");
-                        funcs->freeEncResult(&res);
-                    } else if (!inputFile.empty() && !outputFile.empty()) {
-                        GostFileOperationResultC res = funcs->encryptFile(inputFile.c_str(), outputFile.c_str(), key.c_str(), iv.c_str());
-                        if(res.success) std::cout << res.message << "\n" << "Использованный IV: " << res.used_iv_hex << std::endl;
-                        else throw std::runtime_error(res.message ? res.message : "Unknown file encryption error.");
-                        funcs->freeFileResult(&res);
-                    } else throw std::runtime_error("Для шифрования ГОСТ укажите либо --text, либо --input и --output.");
-                } else { // Decrypt
-                    if (key.empty()) throw std::runtime_error("Для дешифрования ГОСТ требуется ключ (--key).");
-                    if (iv.empty() && !inputFile.empty()) { /* IV is read from file for decryption */ }
-                    else if (iv.empty()) throw std::runtime_error("Для дешифрования текста ГОСТ требуется вектор инициализации (--iv).");
-
-                     if (!text.empty()) {
-                        GostDecryptedTextResultC res = funcs->decryptText(iv.c_str(), text.c_str(), key.c_str());
-                         if (res.success) std::cout << "Дешифрование успешно.\n" << "Открытый текст: " << res.plaintext << std::endl;
-                         else throw std::runtime_error(res.error_message ? res.error_message : "Unknown decryption error.");
-                         funcs->freeDecResult(&res);
-                    } else if (!inputFile.empty() && !outputFile.empty()) {
-                         GostFileOperationResultC res = funcs->decryptFile(inputFile.c_str(), outputFile.c_str(), key.c_str());
-                         if(res.success) std::cout << res.message << std::endl;
-                         else throw std::runtime_error(res.message ? res.message : "Unknown file decryption error.");
-                         funcs->freeFileResult(&res);
-                    } else throw std::runtime_error("Для дешифрования ГОСТ укажите либо --text (как шифротекст), либо --input и --output.");
-                }
-            } else if (cipher == "morse") {
-                auto* funcs = &loaded_libraries.at(cipher)->funcs.morse;
-                if (!text.empty()) {
-                    if (encrypt) {
-                        MorseEncodedResultC res = funcs->encodeText(text.c_str());
-                        if (res.success) std::cout << "Кодирование в Морзе успешно.\n" << "Бинарные данные (hex): " << to_hex_string(res.binary_data, res.data_size) << std::endl;
-                        else throw std::runtime_error(res.error_message ? res.error_message : "Unknown Morse encoding error.");
-                        funcs->freeEncResult(&res);
-                    } else {
-                        std::vector<unsigned char> data = from_hex_string(text);
-                        MorseDecodedResultC res = funcs->decodeText(data.data(), data.size());
-                        if (res.success) std::cout << "Декодирование из Морзе успешно.\n" << "Открытый текст: " << res.plaintext << std::endl;
-                        else throw std::runtime_error(res.error_message ? res.error_message : "Unknown Morse decoding error.");
-                        funcs->freeDecResult(&res);
-                    }
-                } else if (!inputFile.empty() && !outputFile.empty()) {
-                    MorseFileOperationResultC res = encrypt ? funcs->encodeFile(inputFile.c_str(), outputFile.c_str()) : funcs->decodeFile(inputFile.c_str(), outputFile.c_str());
-                    if(res.success) std::cout << res.message << std::endl;
-                    else throw std::runtime_error(res.message ? res.message : "Unknown Morse file operation error.");
-                    funcs->freeFileResult(&res);
-                } else throw std::runtime_error("Для операций с Морзе укажите либо --text, либо --input и --output.");
-            } else if (cipher == "rot13") {
-                auto* funcs = &loaded_libraries.at(cipher)->funcs.rot13;
-                if (!text.empty()) {
-                    if (encrypt) {
-                        EncodedResultC res = funcs->encodeText(text.c_str());
-                        if(res.success) std::cout << "Кодирование ROT13+XOR успешно.\n" << "Бинарные данные (hex): " << to_hex_string(res.binary_data, res.data_size) << std::endl;
-                        else throw std::runtime_error(res.error_message ? res.error_message : "Unknown ROT13 encoding error.");
-                        funcs->freeEncResult(&res);
-                    } else {
-                        std::vector<unsigned char> data = from_hex_string(text);
-                        DecodedResultC res = funcs->decodeText(data.data(), data.size());
-                        if(res.success) std::cout << "Декодирование ROT13+XOR успешно.\n" << "Открытый текст: " << res.text << std::endl;
-                        else throw std::runtime_error(res.error_message ? res.error_message : "Unknown ROT13 decoding error.");
-                        funcs->freeDecResult(&res);
-                    }
-                } else if (!inputFile.empty() && !outputFile.empty()) {
-                    FileOperationResultC res = encrypt ? funcs->encodeFile(inputFile.c_str(), outputFile.c_str()) : funcs->decodeFile(inputFile.c_str(), outputFile.c_str());
-                    if(res.success) std::cout << res.message << std::endl;
-                    else throw std::runtime_error(res.message ? res.message : "Unknown ROT13 file operation error.");
-                    funcs->freeFileResult(&res);
-                } else throw std::runtime_error("Для операций с ROT13+XOR укажите либо --text, либо --input и --output.");
+            checkOptionTargets(job.options, names);
+            job.encrypt = encrypt;
+            if (generateKeyMode) {
+                std::cout << "Сгенерированный ключ (hex): " << generateKey(*plugin) << std::endl;
+            } else if (pipeline.size() > 1 || job.inputFile == "-" || job.outputFile == "-" || job.crc ||
+                       job.hashBits) {
+                runPipelineJob(pipeline, job);
+            } else {
+                job.options = stageOptions(job.options, plugin->name);
+                runJob(*plugin, job);
             }
         } catch (const std::exception& e) {
             std::cerr << "Произошла ошибка: " << e.what() << std::endl;
+            if (stats) std::cerr << stats->report(statsJson) << std::flush;
             return 1;
         }
+        // Отчёт идёт в stderr: stdout может быть занят данными (--output -).
+        if (stats) std::cerr << stats->report(statsJson) << std::flush;
         return 0;
     }
 
     // --- ИНТЕРАКТИВНОЕ МЕНЮ ---
+    loadCiphers(registry, pluginDir, pluginDirSet, pluginErrors);
+    printPluginErrors(pluginErrors);
+    const std::vector<LoadedPlugin>& plugins = registry.plugins();
+    const int exitChoice = static_cast<int>(plugins.size()) + 1;
+
     int choice;
     do {
-        displayMenu();
-        std::cin >> choice;
+        std::cout << "\n--- Меню Инструмента Шифрования ---\n"
+                  << "Выберите алгоритм:\n";
+        for (size_t i = 0; i < plugins.size(); ++i) {
+            const CipherPluginDescriptor& d = *plugins[i].descriptor;
+            std::cout << i + 1 << ". " << (d.description ? d.description : d.name) << "\n";
+        }
+        std::cout << exitChoice << ". Выход\n"
+                  << "Введите ваш выбор: ";
+        if (!(std::cin >> choice)) break;
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 
-        switch (choice) {
-            case 1: handleGostMenu(); break;
-            case 2: handleMorseMenu(); break;
-            case 3: handleRot13Menu(); break;
-            case 4: std::cout << "Выход." << std::endl; break;
-            default: std::cout << "Неверный выбор, попробуйте снова." << std::endl;
+        if (choice >= 1 && choice < exitChoice) {
+            handlePluginMenu(*plugins[choice - 1].descriptor);
+        } else if (choice == exitChoice) {
+            std::cout << "Выход." << std::endl;
+        } else {
+            std::cout << "Неверный выбор, попробуйте снова." << std::endl;
         }
-        if (choice != 4) {
+        if (choice != exitChoice) {
             std::cout << "\nНажмите Enter, чтобы продолжить...";
             std::cin.get();
         }
-    } while (choice != 4);
+    } while (choice != exitChoice);
 
     return 0;
 }
 
-void handleGostMenu() {
-    if (!load_cipher_library("gost")) return;
-    auto* funcs = &loaded_libraries.at("gost")->funcs.gost;
-
-    int choice;
-    std::cout << "\n-- Меню ГОСТ --\n1. Зашифровать текст\n2. Расшифровать текст\n3. Зашифровать файл\n4. Расшифровать файл\n5. Сгенерировать ключ\nВведите ваш выбор: ";
-    std::cin >> choice;
-    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-
-    std::string text, key_hex, iv_hex, inputFile, outputFile;
-
-    try {
-        if (choice == 2 || choice == 4) { // Decryption requires key
-             std::cout << "Введите ключ (64 hex-символа): ";
-             std::getline(std::cin, key_hex);
-             if(key_hex.empty()){
-                std::cout << "Дешифрование требует ключ." << std::endl;
-                return;
-             }
-        } else if (choice == 1 || choice == 3) { // Encryption can generate key
-             std::cout << "Введите ключ (64 hex-символа) или оставьте пустым для генерации: ";
-             std::getline(std::cin, key_hex);
-        }
-
-        switch (choice) {
-            case 1:
-            case 3: {
-                if (key_hex.empty()) {
-                    GostKeyGenResultC key_res = funcs->generateKey();
-                     if (key_res.success) {
-                        key_hex = key_res.key_hex;
-                         std::cout << "-> Сгенерирован новый ключ: " << key_hex << std::endl;
-                    } else {
-                        std::cerr << "Ошибка генерации ключа: " << (key_res.error_message ? key_res.error_message : "Неизвестная ошибка") << std::endl;
-                        funcs->freeKeyResult(&key_res);
-                        return;
-                    }
-                    funcs->freeKeyResult(&key_res);
-                }
-
-                if (choice == 1) {
-                    std::cout << "Введите текст для шифрования: ";
-                    std::getline(std::cin, text);
-                    std::cout << "Введите IV (16 hex-символов) или оставьте пустым для случайного: ";
-                    std::getline(std::cin, iv_hex);
-                    GostEncryptedTextResultC res = funcs->encryptText(text.c_str(), key_hex.c_str(), iv_hex.c_str());
-                    if (res.success) {
-                        std::cout << "\nШифрование успешно!\n" << "IV: " << res.iv_hex << "\n" << "Шифротекст: " << res.ciphertext_hex << std::endl;
-                    } else std::cerr << "Ошибка: " << res.error_message << std::endl;
-                    funcs->freeEncResult(&res);
-                } else { // choice == 3
-                     std::cout << "Введите путь к входному файлу: ";
-                     std::getline(std::cin, inputFile);
-                     std::cout << "Введите путь к выходному файлу: ";
-                     std::getline(std::cin, outputFile);
-                     std::cout << "Введите IV (16 hex-символов) или оставьте пустым для случайного: ";
-                     std::getline(std::cin, iv_hex);
-                    GostFileOperationResultC res = funcs->encryptFile(inputFile.c_str(), outputFile.c_str(), key_hex.c_str(), iv_hex.c_str());
-                    std::cout << "\n" << res.message << std::endl;
-                    if(res.success) std::cout << "Использованный IV: " << res.used_iv_hex << std::endl;
-                    funcs->freeFileResult(&res);
-                }
-                break;
-            }
-            case 2: { // Расшифровать текст
-                std::cout << "Введите IV (16 hex-символов): ";
-                std::getline(std::cin, iv_hex);
-                std::cout << "Введите шифротекст (hex): ";
-                std::getline(std::cin, text);
-                GostDecryptedTextResultC res = funcs->decryptText(iv_hex.c_str(), text.c_str(), key_hex.c_str());
-                 if (res.success) {
-                    std::cout << "\nДешифрование успешно!\n" << "Открытый текст: " << res.plaintext << std::endl;
-                } else std::cerr << "Ошибка: " << res.error_message << std::endl;
-                funcs->freeDecResult(&res);
-                break;
-            }
-            case 4: { // Расшифровать файл
-                 std::cout << "Введите путь к входному файлу: ";
-                 std::getline(std::cin, inputFile);
-                 std::cout << "Введите путь к выходному файлу: ";
-                 std::getline(std::cin, outputFile);
-                GostFileOperationResultC res = funcs->decryptFile(inputFile.c_str(), outputFile.c_str(), key_hex.c_str());
-                std::cout << "\n" << res.message << std::endl;
-                if(res.success) std::cout << "IV, прочитанный из файла: " << res.used_iv_hex << std::endl;
-                funcs->freeFileResult(&res);
-                break;
-            }
-            case 5: { // Сгенерировать ключ
-                GostKeyGenResultC res = funcs->generateKey();
-                if (res.success) {
-                    std::cout << "\nСгенерированный ключ (hex): " << res.key_hex << std::endl;
-                } else {
-                    std::cerr << "Ошибка генерации ключа: " << (res.error_message ? res.error_message : "Неизвестная ошибка") << std::endl;
-                }
-                funcs->freeKeyResult(&res);
-                break;
-            }
-            default: std::cout << "Неверный выбор." << std::endl;
-        }
-    } catch(const std::exception& e) {
-        std::cerr << "Произошла ошибка: " << e.what() << std::endl;
-    }
+std::string prompt(const std::string& text) {
+    std::cout << text;
+    std::string value;
+    std::getline(std::cin, value);
+    return value;
 }
 
-void handleMorseMenu() {
-    if (!load_cipher_library("morse")) return;
-    auto* funcs = &loaded_libraries.at("morse")->funcs.morse;
+// Меню шифра строится по его возможностям и действиям над файлами, которые
+// объявил плагин (CipherPluginDescriptor::file_actions).
+void handlePluginMenu(const CipherPluginDescriptor& plugin) {
+    enum class Action { EncryptText, DecryptText, EncryptFile, DecryptFile, FileAction, GenerateKey };
+    struct MenuItem {
+        Action action;
+        const char* label;
+        const CipherFileActionC* fileAction;
+    };
+    std::vector<MenuItem> actions;
+    if (plugin.capabilities & CIPHER_CAP_BUFFER) {
+        actions.push_back({Action::EncryptText, "Зашифровать текст", nullptr});
+        actions.push_back({Action::DecryptText, "Расшифровать текст", nullptr});
+    }
+    if (plugin.capabilities & CIPHER_CAP_FILE) {
+        actions.push_back({Action::EncryptFile, "Зашифровать файл", nullptr});
+        actions.push_back({Action::DecryptFile, "Расшифровать файл", nullptr});
+    }
+    for (size_t i = 0; i < pluginFileActionCount(plugin); ++i) {
+        actions.push_back({Action::FileAction, plugin.file_actions[i].label, &plugin.file_actions[i]});
+    }
+    if (plugin.capabilities & CIPHER_CAP_KEYGEN) {
+        actions.push_back({Action::GenerateKey, "Сгенерировать ключ", nullptr});
+    }
 
-    int choice;
-    std::cout << "\n-- Меню Морзе --\n1. Кодировать текст\n2. Декодировать текст\n3. Кодировать файл\n4. Декодировать файл\nВведите ваш выбор: ";
+    std::cout << "\n-- Меню " << plugin.name << " --\n";
+    for (size_t i = 0; i < actions.size(); ++i) std::cout << i + 1 << ". " << actions[i].label << "\n";
+    std::cout << "Введите ваш выбор: ";
+    size_t choice = 0;
     std::cin >> choice;
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    if (choice < 1 || choice > actions.size()) {
+        std::cout << "Неверный выбор." << std::endl;
+        return;
+    }
+    Action action = actions[choice - 1].action;
+    const CipherFileActionC* fileAction = actions[choice - 1].fileAction;
 
     try {
-        switch (choice) {
-            case 1: {
-                std::cout << "Введите текст для кодирования: ";
-                std::string plaintext;
-                std::getline(std::cin, plaintext);
-                MorseEncodedResultC res = funcs->encodeText(plaintext.c_str());
-                if (res.success) {
-                    std::cout << "\nКодирование успешно!\n" << "Результат (hex): " << to_hex_string(res.binary_data, res.data_size) << std::endl;
-                } else std::cerr << "Ошибка: " << res.error_message << std::endl;
-                funcs->freeEncResult(&res);
-                break;
-            }
-            case 2: {
-                std::cout << "Введите данные для декодирования (hex): ";
-                std::string hex_data;
-                std::getline(std::cin, hex_data);
-                std::vector<unsigned char> data = from_hex_string(hex_data);
-                MorseDecodedResultC res = funcs->decodeText(data.data(), data.size());
-                 if (res.success) {
-                    std::cout << "\nДекодирование успешно!\n" << "Открытый текст: " << res.plaintext << std::endl;
-                } else std::cerr << "Ошибка: " << res.error_message << std::endl;
-                funcs->freeDecResult(&res);
-                break;
-            }
-            case 3:
-            case 4: {
-                std::cout << "Введите путь к входному файлу: ";
-                std::string inputFile;
-                std::getline(std::cin, inputFile);
-                std::cout << "Введите путь к выходному файлу: ";
-                std::string outputFile;
-                std::getline(std::cin, outputFile);
-                MorseFileOperationResultC res = (choice == 3) ? funcs->encodeFile(inputFile.c_str(), outputFile.c_str()) : funcs->decodeFile(inputFile.c_str(), outputFile.c_str());
-                std::cout << "\n" << res.message << std::endl;
-                funcs->freeFileResult(&res);
-                break;
-            }
-            default: std::cout << "Неверный выбор." << std::endl;
+        if (action == Action::GenerateKey) {
+            std::cout << "\nСгенерированный ключ (hex): " << generateKey(plugin) << std::endl;
+            return;
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Произошла ошибка: " << e.what() << std::endl;
-    }
-}
-
-void handleRot13Menu() {
-    if (!load_cipher_library("rot13")) return;
-    auto* funcs = &loaded_libraries.at("rot13")->funcs.rot13;
-
-    int choice;
-    std::cout << "\n-- Меню ROT13 + XOR --\n1. Кодировать текст\n2. Декодировать текст\n3. Кодировать файл\n4. Декодировать файл\nВведите ваш выбор: ";
-    std::cin >> choice;
-    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 
-     try {
-        switch (choice) {
-            case 1: {
-                std::cout << "Введите текст для кодирования: ";
-                std::string plaintext;
-                std::getline(std::cin, plaintext);
-                EncodedResultC res = funcs->encodeText(plaintext.c_str());
-                if (res.success) {
-                    std::cout << "\nКодирование успешно!\n" << "Результат (hex): " << to_hex_string(res.binary_data, res.data_size) << std::endl;
-                } else std::cerr << "Ошибка: " << res.error_message << std::endl;
-                funcs->freeEncResult(&res);
-                break;
-            }
-            case 2: {
-                std::cout << "Введите данные для декодирования (hex): ";
-                std::string hex_data;
-                std::getline(std::cin, hex_data);
-                std::vector<unsigned char> data = from_hex_string(hex_data);
-                DecodedResultC res = funcs->decodeText(data.data(), data.size());
-                 if (res.success) {
-                    std::cout << "\nДекодирование успешно!\n" << "Открытый текст: " << res.text << std::endl;
-                } else std::cerr << "Ошибка: " << res.error_message << std::endl;
-                funcs->freeDecResult(&res);
-                break;
-            }
-            case 3:
-            case 4: {
-                std::cout << "Введите путь к входному файлу: ";
-                std::string inputFile;
-                std::getline(std::cin, inputFile);
-                std::cout << "Введите путь к выходному файлу: ";
-                std::string outputFile;
-                std::getline(std::cin, outputFile);
-                FileOperationResultC res = (choice == 3) ? funcs->encodeFile(inputFile.c_str(), outputFile.c_str()) : funcs->decodeFile(inputFile.c_str(), outputFile.c_str());
-                std::cout << "\n" << res.message << std::endl;
-                funcs->freeFileResult(&res);
-                break;
+        CipherJob job;
+        job.encrypt = (action == Action::EncryptText || action == Action::EncryptFile ||
+                       action == Action::FileAction);
+        bool textMode = (action == Action::EncryptText || action == Action::DecryptText);
+
+        if (plugin.capabilities & CIPHER_CAP_KEYED) {
+            job.key = prompt(job.encrypt && (plugin.capabilities & CIPHER_CAP_KEYGEN)
+                                 ? "Введите ключ (hex) или оставьте пустым для генерации: "
+                                 : "Введите ключ (hex): ");
+            if (job.encrypt) {
+                job.iv = prompt("Введите IV (hex) или оставьте пустым для случайного: ");
+            } else if (textMode) {
+                job.iv = prompt("Введите IV (hex): ");
             }
-            default: std::cout << "Неверный выбор." << std::endl;
         }
+
+        if (textMode) {
+            job.texts.push_back(prompt(job.encrypt ? "Введите текст для шифрования: "
+                                                   : "Введите данные для дешифрования (hex): "));
+        } else {
+            job.inputFile = prompt("Введите путь к входному файлу: ");
+            job.outputFile = prompt("Введите путь к выходному файлу: ");
+        }
+        job.options = prompt("Параметры шифра (имя=значение;...) или пусто для значений по умолчанию: ");
+        if (fileAction) {
+            std::string options = fileAction->options;
+            if (!job.options.empty()) appendOption(options, job.options);
+            job.options = options;
+        }
+
+        std::cout << std::endl;
+        runJob(plugin, job);
     } catch (const std::exception& e) {
         std::cerr << "Произошла ошибка: " << e.what() << std::endl;
     }
-}
\ No newline at end of file
+}
@@ -19,7 +19,7 @@ int main(int argc, char* argv[]) {
     // --- 1. Проверка количества аргументов ---
     // Нам нужно ровно 4 аргумента:
     // argv[0] - имя программы (например, ./morse_tool)
-    // argv[1] - команда ("encode" или "decode")
+    // argv[1] - команда ("encode", "decode" или "wav")
     // argv[2] - входной файл
     // argv[3] - выходной файл
     if (argc != 4) {
@@ -27,6 +27,7 @@ int main(int argc, char* argv[]) {
         std::cerr << "Использование:" << std::endl;
         std::cerr << "  " << argv[0] << " encode <входной_файл.txt> <выходной_файл.bin>" << std::endl;
         std::cerr << "  " << argv[0] << " decode <входной_файл.bin> <выходной_файл.txt>" << std::endl;
+        std::cerr << "  " << argv[0] << " wav <входной_файл.txt> <выходной_файл.wav>" << std::endl;
         return 1; // Возвращаем код ошибки
     }
 
@@ -60,9 +61,21 @@ int main(int argc, char* argv[]) {
             return 1; // Возвращаем код ошибки
         }
 
+    } else if (command == "wav") {
+        std::cout << "Озвучивание файла: " << inputFilePath << " -> " << outputFilePath << std::endl;
+
+        MorseFileOperationResult result = encodeFileToMorseWav(inputFilePath, outputFilePath);
+
+        if (result.success) {
+            std::cout << "Успех! " << result.message << std::endl;
+        } else {
+            std::cerr << "Ошибка озвучивания! " << result.message << std::endl;
+            return 1; // Возвращаем код ошибки
+        }
+
     } else {
         std::cerr << "Ошибка: Неизвестная команда '" << command << "'." << std::endl;
-        std::cerr << "Доступные команды: 'encode', 'decode'." << std::endl;
+        std::cerr << "Доступные команды: 'encode', 'decode', 'wav'." << std::endl;
         return 1; // Возвращаем код ошибки
     }
 
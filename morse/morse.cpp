@@ -1,203 +1,659 @@
 #include "morse.h"
+#include "cipher_probes.h"
+#include "cipher_progress.hpp"
+#include "cipher_stats.hpp"
+#include "thread_pool.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
-#include <map>
-#include <sstream>
+#include <string_view>
 #include <vector>
-#include <stdexcept>
-#include <cstring>
 
-static const std::map<unsigned char, std::string> nibble_to_morse_map = {
-    {0x0, "."},    {0x1, "-"},    {0x2, ".."},   {0x3, ".-"},
-    {0x4, "-."},   {0x5, "--"},   {0x6, "..."},  {0x7, "..-"},
-    {0x8, ".-."},  {0x9, ".--"},  {0xA, "-.."},  {0xB, "-.-"},
-    {0xC, "--."},  {0xD, "---"},  {0xE, "...."}, {0xF, "...-"}
+// Все таблицы ниже строятся на этапе компиляции и доступны только для чтения,
+// поэтому библиотека не имеет изменяемого глобального состояния и реентерабельна:
+// функции можно вызывать из любого числа потоков без внешней синхронизации.
+namespace {
+
+constexpr std::array<std::string_view, 16> nibble_to_morse_table = {
+    ".",   "-",   "..",  ".-",
+    "-.",  "--",  "...", "..-",
+    ".-.", ".--", "-..", "-.-",
+    "--.", "---", "....", "...-"
 };
 
-static std::map<std::string, unsigned char> morse_to_nibble_map;
-static bool is_reverse_map_initialized = false;
+constexpr std::size_t MAX_MORSE_SYMBOLS = 4;
+
+// Битовые шаблоны временных единиц (старший бит передаётся первым).
+constexpr uint32_t MORSE_DOT_BITS = 0b1;            // "1"
+constexpr unsigned MORSE_DOT_LENGTH = 1;
+constexpr uint32_t MORSE_DASH_BITS = 0b111;         // "111"
+constexpr unsigned MORSE_DASH_LENGTH = 3;
+constexpr unsigned INTRA_ELEMENT_GAP_LENGTH = 1;    // "0"
+constexpr unsigned BYTE_PART_GAP_LENGTH = 3;        // "000"
+constexpr unsigned INTER_BYTE_GAP_LENGTH = 7;       // "0000000"
+
+struct BitPattern {
+    uint32_t bits = 0;
+    unsigned length = 0;
 
-static void initialize_reverse_map() {
-    if (!is_reverse_map_initialized) {
-        for (const auto& pair : nibble_to_morse_map) {
-            morse_to_nibble_map[pair.second] = pair.first;
+    constexpr void append(uint32_t value, unsigned count) {
+        bits = (bits << count) | value;
+        length += count;
+    }
+};
+
+constexpr BitPattern morse_to_bit_pattern(std::string_view morse_code) {
+    BitPattern pattern;
+    for (std::size_t i = 0; i < morse_code.size(); ++i) {
+        if (morse_code[i] == '.') {
+            pattern.append(MORSE_DOT_BITS, MORSE_DOT_LENGTH);
+        } else {
+            pattern.append(MORSE_DASH_BITS, MORSE_DASH_LENGTH);
+        }
+        if (i + 1 < morse_code.size()) {
+            pattern.append(0, INTRA_ELEMENT_GAP_LENGTH);
         }
-        is_reverse_map_initialized = true;
     }
+    return pattern;
 }
 
-const std::string MORSE_DOT_BITS = "1";
-const std::string MORSE_DASH_BITS = "111";
-const std::string INTRA_ELEMENT_GAP = "0";
-const std::string BYTE_PART_GAP = "000";
-const std::string INTER_BYTE_GAP = "0000000";
+// Полный битовый шаблон байта: старший полубайт, "000", младший полубайт.
+// Межбайтовый промежуток добавляется отдельно, так как после последнего байта его нет.
+constexpr std::array<BitPattern, 256> build_byte_patterns() {
+    std::array<BitPattern, 256> table{};
+    for (unsigned byte = 0; byte < 256; ++byte) {
+        BitPattern high = morse_to_bit_pattern(nibble_to_morse_table[byte >> 4]);
+        BitPattern low = morse_to_bit_pattern(nibble_to_morse_table[byte & 0x0F]);
+        BitPattern pattern = high;
+        pattern.append(0, BYTE_PART_GAP_LENGTH);
+        pattern.append(low.bits, low.length);
+        table[byte] = pattern;
+    }
+    return table;
+}
+
+constexpr std::array<BitPattern, 256> byte_to_bit_pattern = build_byte_patterns();
+static_assert(byte_to_bit_pattern[0xDD].length <= 32, "Byte pattern must fit into 32 bits.");
+
+// Код Морзе длиной L символов (точка = 0, тире = 1) задаёт индекс (1 << L) | code.
+// Значение -1 означает, что такой последовательности нет в таблице.
+constexpr std::size_t morse_key(unsigned length, unsigned code) {
+    return (std::size_t{1} << length) | code;
+}
 
-std::string morse_to_bit_string(const std::string& morse_code) {
-    std::string bits;
-    for (size_t i = 0; i < morse_code.length(); ++i) {
-        bits += (morse_code[i] == '.') ? MORSE_DOT_BITS : MORSE_DASH_BITS;
-        if (i < morse_code.length() - 1) {
-            bits += INTRA_ELEMENT_GAP;
+constexpr std::array<int8_t, (1u << (MAX_MORSE_SYMBOLS + 1))> build_reverse_table() {
+    std::array<int8_t, (1u << (MAX_MORSE_SYMBOLS + 1))> table{};
+    for (auto &entry : table) {
+        entry = -1;
+    }
+    for (unsigned nibble = 0; nibble < nibble_to_morse_table.size(); ++nibble) {
+        std::string_view symbols = nibble_to_morse_table[nibble];
+        unsigned code = 0;
+        for (char symbol : symbols) {
+            code = (code << 1) | (symbol == '-' ? 1u : 0u);
         }
+        table[morse_key(static_cast<unsigned>(symbols.size()), code)] = static_cast<int8_t>(nibble);
     }
-    return bits;
+    return table;
 }
 
-MorseEncodedResult encodeTextToMorse(const std::string &plaintext) {
-    MorseEncodedResult result;
-    std::string final_bit_string;
+constexpr auto morse_to_nibble_table = build_reverse_table();
+static_assert(morse_to_nibble_table[morse_key(3, 0b111)] == 0xD, "Reverse table must invert the forward table.");
+
+// Упаковщик битов в байты (старший бит первым). Размер результата известен
+// заранее (morse_payload_bits), поэтому запись идёт прямо в готовый буфер.
+class BitWriter {
+public:
+    explicit BitWriter(unsigned char *out) : out_(out) {}
+
+    void append(uint32_t bits, unsigned count) {
+        while (count > 0) {
+            unsigned take = std::min(count, 8 - filled_);
+            uint32_t chunk = (bits >> (count - take)) & ((1u << take) - 1);
+            current_ = static_cast<unsigned char>((current_ << take) | chunk);
+            filled_ += take;
+            count -= take;
+            total_bits_ += take;
+            if (filled_ == 8) {
+                *out_++ = current_;
+                current_ = 0;
+                filled_ = 0;
+            }
+        }
+    }
 
-    for (size_t i = 0; i < plaintext.length(); ++i) {
-        unsigned char byte = plaintext[i];
+    void flush() {
+        if (filled_ > 0) {
+            *out_++ = static_cast<unsigned char>(current_ << (8 - filled_));
+            current_ = 0;
+            filled_ = 0;
+        }
+    }
 
-        unsigned char high_nibble = (byte >> 4) & 0x0F;
-        unsigned char low_nibble = byte & 0x0F;
+    uint64_t total_bits() const { return total_bits_; }
 
-        final_bit_string += morse_to_bit_string(nibble_to_morse_map.at(high_nibble));
-        final_bit_string += BYTE_PART_GAP;
-        final_bit_string += morse_to_bit_string(nibble_to_morse_map.at(low_nibble));
+private:
+    unsigned char *out_;
+    unsigned char current_ = 0;
+    unsigned filled_ = 0;
+    uint64_t total_bits_ = 0;
+};
 
-        if (i < plaintext.length() - 1) {
-            final_bit_string += INTER_BYTE_GAP;
-        }
+// Приёмники декодера: строка или буфер вызывающего. BoundedOutput пишет не
+// больше capacity байт, но считает все, чтобы сообщить требуемый размер.
+struct StringOutput {
+    std::string &text;
+    void push(unsigned char byte) { text += static_cast<char>(byte); }
+};
+
+struct BoundedOutput {
+    unsigned char *data;
+    std::size_t capacity;
+    std::size_t size = 0;
+    void push(unsigned char byte) {
+        if (size < capacity) data[size] = byte;
+        ++size;
     }
+};
 
-    std::vector<unsigned char> packed_bytes;
-    uint64_t total_bits = final_bit_string.length();
+// Разбор битового потока: серии единиц — элементы, серии нулей — промежутки.
+// Всё состояние живёт в экземпляре, поэтому разные потоки используют разные декодеры.
+template <class Output>
+class MorseBitDecoder {
+public:
+    explicit MorseBitDecoder(Output &out) : out_(out) {}
+
+    // Возвращает nullptr при успехе или текст ошибки.
+    const char *push_run(bool is_one, uint64_t length) {
+        if (is_one) {
+            if (length == MORSE_DOT_LENGTH) {
+                return push_symbol(0);
+            }
+            if (length == MORSE_DASH_LENGTH) {
+                return push_symbol(1);
+            }
+            return "Invalid Morse element found in data stream.";
+        }
+        if (length >= BYTE_PART_GAP_LENGTH) {
+            return flush_code();
+        }
+        return nullptr;
+    }
 
-    packed_bytes.resize(sizeof(total_bits));
-    std::memcpy(packed_bytes.data(), &total_bits, sizeof(total_bits));
+    const char *finish() { return flush_code(); }
 
-    unsigned char current_byte = 0;
-    int bit_count = 0;
-    for (char bit : final_bit_string) {
-        current_byte = (current_byte << 1) | (bit - '0');
-        bit_count++;
-        if (bit_count == 8) {
-            packed_bytes.push_back(current_byte);
-            bit_count = 0;
+private:
+    const char *push_symbol(unsigned symbol) {
+        if (code_length_ == MAX_MORSE_SYMBOLS) {
+            overflow_ = true;
+            return nullptr;
         }
+        code_ = (code_ << 1) | symbol;
+        ++code_length_;
+        return nullptr;
     }
-    if (bit_count > 0) {
-        current_byte <<= (8 - bit_count);
-        packed_bytes.push_back(current_byte);
+
+    const char *flush_code() {
+        if (code_length_ == 0 && !overflow_) {
+            return nullptr;
+        }
+        int8_t nibble = overflow_ ? -1 : morse_to_nibble_table[morse_key(code_length_, code_)];
+        code_ = 0;
+        code_length_ = 0;
+        overflow_ = false;
+        if (nibble < 0) {
+            return "Invalid Morse sequence for a nibble.";
+        }
+        if (is_high_nibble_) {
+            reconstructed_byte_ = static_cast<unsigned char>(nibble << 4);
+            is_high_nibble_ = false;
+        } else {
+            reconstructed_byte_ |= static_cast<unsigned char>(nibble);
+            out_.push(reconstructed_byte_);
+            is_high_nibble_ = true;
+        }
+        return nullptr;
     }
 
-    result.binary_data = packed_bytes;
-    result.success = true;
-    return result;
-}
+    Output &out_;
+    unsigned code_ = 0;
+    unsigned code_length_ = 0;
+    bool overflow_ = false;
+    unsigned char reconstructed_byte_ = 0;
+    bool is_high_nibble_ = true;
+};
 
-MorseDecodedResult decodeTextFromMorse(const std::vector<unsigned char> &binary_data) {
-    MorseDecodedResult result;
-    initialize_reverse_map();
+// --- Синтез звука ---
 
-    if (binary_data.size() < sizeof(uint64_t)) {
-        return { {}, false, "Invalid data: too short." };
-    }
+// Серия одинаковых временных единиц: тон или тишина.
+struct TimingRun {
+    bool tone = false;
+    uint8_t units = 0;
+};
 
-    uint64_t total_bits;
-    std::memcpy(&total_bits, binary_data.data(), sizeof(total_bits));
+// Байт кодируется не более чем 4 + 3 + 1 + 3 + 4 = 15 сериями.
+struct ByteTimingRuns {
+    std::array<TimingRun, 15> runs{};
+    uint8_t count = 0;
+};
 
-    std::string bit_string;
-    bit_string.reserve(binary_data.size() * 8);
-    for (size_t i = sizeof(total_bits); i < binary_data.size(); ++i) {
-        for (int j = 7; j >= 0; --j) {
-            bit_string += ((binary_data[i] >> j) & 1) ? '1' : '0';
+constexpr std::array<ByteTimingRuns, 256> build_byte_timing_runs() {
+    std::array<ByteTimingRuns, 256> table{};
+    for (unsigned byte = 0; byte < 256; ++byte) {
+        const BitPattern &pattern = byte_to_bit_pattern[byte];
+        ByteTimingRuns &entry = table[byte];
+        for (unsigned i = pattern.length; i > 0; --i) {
+            bool bit = (pattern.bits >> (i - 1)) & 1;
+            if (entry.count > 0 && entry.runs[entry.count - 1].tone == bit) {
+                ++entry.runs[entry.count - 1].units;
+            } else {
+                entry.runs[entry.count++] = {bit, 1};
+            }
         }
     }
-    if (bit_string.length() > total_bits) {
-        bit_string.resize(total_bits);
+    return table;
+}
+
+constexpr std::array<ByteTimingRuns, 256> byte_to_timing_runs = build_byte_timing_runs();
+
+constexpr std::size_t WAV_HEADER_SIZE = 44;
+constexpr uint64_t WAV_MAX_DATA_SIZE = 0xFFFFFFFFull - (WAV_HEADER_SIZE - 8);
+constexpr std::size_t PCM_OUTPUT_BUFFER_SIZE = 1 << 20;
+constexpr std::size_t MORSE_INPUT_CHUNK_SIZE = 1 << 16;
+constexpr std::size_t MORSE_PARALLEL_THRESHOLD = 4 << 20;
+constexpr double MORSE_TONE_AMPLITUDE = 0.8 * 32767.0;
+constexpr unsigned MORSE_TONE_RAMP_MS = 5;
+
+void store_le16(unsigned char *dst, uint16_t value) {
+    dst[0] = static_cast<unsigned char>(value & 0xFF);
+    dst[1] = static_cast<unsigned char>(value >> 8);
+}
+
+void store_le32(unsigned char *dst, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        dst[i] = static_cast<unsigned char>((value >> (8 * i)) & 0xFF);
     }
+}
 
-    std::string plaintext_result;
-    std::string current_morse_code;
-    unsigned char reconstructed_byte = 0;
-    bool is_high_nibble = true;
+std::array<unsigned char, WAV_HEADER_SIZE> make_wav_header(unsigned sample_rate, uint32_t data_size) {
+    std::array<unsigned char, WAV_HEADER_SIZE> header{};
+    std::memcpy(header.data(), "RIFF", 4);
+    store_le32(header.data() + 4, static_cast<uint32_t>(data_size + WAV_HEADER_SIZE - 8));
+    std::memcpy(header.data() + 8, "WAVEfmt ", 8);
+    store_le32(header.data() + 16, 16);              // размер блока fmt
+    store_le16(header.data() + 20, 1);               // PCM
+    store_le16(header.data() + 22, 1);               // моно
+    store_le32(header.data() + 24, sample_rate);
+    store_le32(header.data() + 28, sample_rate * 2); // байт в секунду
+    store_le16(header.data() + 32, 2);               // байт на отсчёт
+    store_le16(header.data() + 34, 16);              // бит на отсчёт
+    std::memcpy(header.data() + 36, "data", 4);
+    store_le32(header.data() + 40, data_size);
+    return header;
+}
 
-    for (size_t i = 0; i < bit_string.length(); ) {
-        size_t gap_pos = bit_string.find('0', i);
-        if (gap_pos == std::string::npos) {
-            gap_pos = bit_string.length();
+// Готовый блок тона из samples отсчётов: синус с плавными фронтами,
+// уже упакованный в 16-битные отсчёты little-endian.
+std::vector<unsigned char> make_tone_block(std::size_t samples, const MorseAudioParams &params) {
+    const double pi = 3.14159265358979323846;
+    std::size_t ramp = std::min<std::size_t>(params.sample_rate * MORSE_TONE_RAMP_MS / 1000, samples / 4);
+    std::vector<unsigned char> block(samples * 2);
+    for (std::size_t n = 0; n < samples; ++n) {
+        double envelope = 1.0;
+        if (ramp > 0 && n < ramp) {
+            envelope = 0.5 - 0.5 * std::cos(pi * static_cast<double>(n) / static_cast<double>(ramp));
+        } else if (ramp > 0 && n >= samples - ramp) {
+            envelope = 0.5 - 0.5 * std::cos(pi * static_cast<double>(samples - 1 - n) / static_cast<double>(ramp));
         }
+        double phase = 2.0 * pi * params.tone_hz * static_cast<double>(n) / params.sample_rate;
+        auto sample = static_cast<int16_t>(std::lround(MORSE_TONE_AMPLITUDE * envelope * std::sin(phase)));
+        store_le16(block.data() + 2 * n, static_cast<uint16_t>(sample));
+    }
+    return block;
+}
 
-        std::string element_bits = bit_string.substr(i, gap_pos - i);
-
-        if (!element_bits.empty()) {
-            if (element_bits == MORSE_DOT_BITS) {
-                current_morse_code += '.';
-            } else if (element_bits == MORSE_DASH_BITS) {
-                current_morse_code += '-';
-            } else {
-                return { {}, false, "Invalid Morse element found in data stream." };
+// Буферизованная запись PCM: данные только копируются из готовых блоков,
+// объём памяти ограничен размером буфера независимо от длины входа.
+// Запись замеряется отдельно: на это время замер синтеза (synth) приостанавливается.
+class PcmBlockWriter {
+public:
+    PcmBlockWriter(std::ofstream &out, const CipherStatsSinkC *stats)
+        : out_(out), buffer_(PCM_OUTPUT_BUFFER_SIZE), stats_(stats) {}
+
+    void set_synth_timer(CipherStageTimer *timer) { synth_ = timer; }
+
+    bool append(const unsigned char *data, std::size_t size) {
+        while (size > 0) {
+            std::size_t take = std::min(size, buffer_.size() - used_);
+            std::memcpy(buffer_.data() + used_, data, take);
+            used_ += take;
+            data += take;
+            size -= take;
+            if (used_ == buffer_.size() && !flush()) {
+                return false;
             }
         }
+        return true;
+    }
+
+    bool flush() {
+        if (data_size_ + used_ > WAV_MAX_DATA_SIZE) {
+            return false;
+        }
+        if (synth_) synth_->pause();
+        CipherStageTimer write_timer(stats_, CIPHER_STAGE_WRITE);
+        CIPHER_PROBE(morse, write_start, used_);
+        out_.write(reinterpret_cast<const char *>(buffer_.data()), static_cast<std::streamsize>(used_));
+        CIPHER_PROBE(morse, write_done, out_ ? used_ : 0);
+        write_timer.addBytes(used_);
+        write_timer.stop();
+        if (synth_) synth_->resume();
+        data_size_ += used_;
+        used_ = 0;
+        return static_cast<bool>(out_);
+    }
+
+    uint64_t data_size() const { return data_size_ + used_; }
+
+private:
+    std::ofstream &out_;
+    std::vector<unsigned char> buffer_;
+    std::size_t used_ = 0;
+    uint64_t data_size_ = 0;
+    const CipherStatsSinkC *stats_;
+    CipherStageTimer *synth_ = nullptr;
+};
+
+uint64_t morse_pattern_bits(const unsigned char *data, std::size_t size) {
+    uint64_t bits = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        bits += byte_to_bit_pattern[data[i]].length;
+    }
+    return bits;
+}
 
-        i = gap_pos;
+// Число бит полезной нагрузки для data: шаблоны байтов и промежутки между ними.
+// Для больших входов суммы частей считаются потоками общего пула.
+uint64_t morse_payload_bits(const unsigned char *data, std::size_t size) {
+    uint64_t bits = 0;
+    if (size < MORSE_PARALLEL_THRESHOLD) {
+        bits = morse_pattern_bits(data, size);
+    } else {
+        std::atomic<uint64_t> total{0};
+        cipherParallelFor(size, 0, 0, [&](uint64_t begin, uint64_t end, unsigned) {
+            total.fetch_add(morse_pattern_bits(data + begin, static_cast<std::size_t>(end - begin)),
+                            std::memory_order_relaxed);
+        });
+        bits = total.load();
+    }
+    if (size > 1) {
+        bits += static_cast<uint64_t>(size - 1) * INTER_BYTE_GAP_LENGTH;
+    }
+    return bits;
+}
 
-        size_t zero_count = 0;
-        while(i < bit_string.length() && bit_string[i] == '0') {
-            zero_count++;
-            i++;
+void encode_morse(const unsigned char *data, std::size_t size, uint64_t total_bits, unsigned char *out) {
+    CIPHER_PROBE(morse, chunk_start, 0, size);
+    std::memcpy(out, &total_bits, sizeof(total_bits));
+    BitWriter writer(out + sizeof(total_bits));
+    for (std::size_t i = 0; i < size; ++i) {
+        const BitPattern &pattern = byte_to_bit_pattern[data[i]];
+        writer.append(pattern.bits, pattern.length);
+        if (i + 1 < size) {
+            writer.append(0, INTER_BYTE_GAP_LENGTH);
         }
+    }
+    writer.flush();
+    CIPHER_PROBE(morse, chunk_done, 0, size);
+}
 
-        if (zero_count >= 3 || i >= bit_string.length()) {
-            if (!current_morse_code.empty()) {
-                if (morse_to_nibble_map.count(current_morse_code)) {
-                    unsigned char nibble = morse_to_nibble_map.at(current_morse_code);
-                    if (is_high_nibble) {
-                        reconstructed_byte = (nibble << 4);
-                        is_high_nibble = false;
-                    } else {
-                        reconstructed_byte |= nibble;
-                        plaintext_result += static_cast<char>(reconstructed_byte);
-                        is_high_nibble = true;
-                    }
-                } else {
-                    return { {}, false, "Invalid Morse sequence for a nibble." };
-                }
-                current_morse_code.clear();
+// Возвращает nullptr при успехе или текст ошибки.
+template <class Output>
+const char *decode_morse_payload(const unsigned char *data, std::size_t size, Output &out) {
+    uint64_t total_bits;
+    if (size < sizeof(total_bits)) {
+        return "Invalid data: too short.";
+    }
+    std::memcpy(&total_bits, data, sizeof(total_bits));
+
+    uint64_t available_bits = (size - sizeof(total_bits)) * 8;
+    if (available_bits > total_bits) {
+        available_bits = total_bits;
+    }
+
+    MorseBitDecoder<Output> decoder(out);
+    bool run_is_one = false;
+    uint64_t run_length = 0;
+    const unsigned char *payload = data + sizeof(total_bits);
+    for (uint64_t bit_index = 0; bit_index < available_bits; ++bit_index) {
+        bool bit = (payload[bit_index >> 3] >> (7 - (bit_index & 7))) & 1;
+        if (run_length > 0 && bit != run_is_one) {
+            if (const char *error = decoder.push_run(run_is_one, run_length)) {
+                return error;
             }
+            run_length = 0;
+        }
+        run_is_one = bit;
+        ++run_length;
+    }
+    if (run_length > 0) {
+        if (const char *error = decoder.push_run(run_is_one, run_length)) {
+            return error;
         }
     }
+    return decoder.finish();
+}
 
-    result.plaintext = plaintext_result;
+template <class Output>
+const char *decode_morse(const unsigned char *data, std::size_t size, Output &out) {
+    CIPHER_PROBE(morse, chunk_start, 0, size);
+    const char *error = decode_morse_payload(data, size, out);
+    CIPHER_PROBE(morse, chunk_done, 0, size);
+    return error;
+}
+
+} // namespace
+
+MorseEncodedResult encodeTextToMorse(const std::string &plaintext) {
+    MorseEncodedResult result;
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(plaintext.data());
+    uint64_t total_bits = morse_payload_bits(data, plaintext.size());
+    result.binary_data.resize(sizeof(total_bits) + (total_bits + 7) / 8);
+    encode_morse(data, plaintext.size(), total_bits, result.binary_data.data());
     result.success = true;
     return result;
 }
 
-MorseFileOperationResult encodeFileToMorse(const std::string &inputFilePath, const std::string &outputFilePath) {
+MorseDecodedResult decodeTextFromMorse(const std::vector<unsigned char> &binary_data) {
+    MorseDecodedResult result;
+    StringOutput output{result.plaintext};
+    if (const char *error = decode_morse(binary_data.data(), binary_data.size(), output)) {
+        return { {}, false, error };
+    }
+    result.success = true;
+    return result;
+}
+
+std::size_t morseEncodedSize(const unsigned char *data, std::size_t size) {
+    return sizeof(uint64_t) + static_cast<std::size_t>((morse_payload_bits(data, size) + 7) / 8);
+}
+
+MorseBufferStatus encodeMorseInto(const unsigned char *data, std::size_t size, unsigned char *out,
+                                  std::size_t capacity, std::size_t &out_size) {
+    uint64_t total_bits = morse_payload_bits(data, size);
+    out_size = sizeof(total_bits) + static_cast<std::size_t>((total_bits + 7) / 8);
+    if (!out || capacity < out_size) {
+        return MorseBufferStatus::BufferTooSmall;
+    }
+    encode_morse(data, size, total_bits, out);
+    return MorseBufferStatus::Ok;
+}
+
+MorseBufferStatus decodeMorseInto(const unsigned char *data, std::size_t size, unsigned char *out,
+                                  std::size_t capacity, std::size_t &out_size) {
+    BoundedOutput output{out, out ? capacity : 0};
+    const char *error = decode_morse(data, size, output);
+    out_size = output.size;
+    if (error) {
+        return MorseBufferStatus::InvalidData;
+    }
+    return output.size > output.capacity ? MorseBufferStatus::BufferTooSmall : MorseBufferStatus::Ok;
+}
+
+// Файл читается целиком и преобразуется в памяти.
+template <typename Transform>
+static MorseFileOperationResult transform_file(const std::string &inputFilePath, const std::string &outputFilePath,
+                                               const CipherStatsSinkC *stats, const CipherProgressC *progress,
+                                               Transform transform) {
+    CipherStageTimer read_timer(stats, CIPHER_STAGE_READ);
     std::ifstream inputFile(inputFilePath, std::ios::binary);
     if (!inputFile) return {false, "Error: Cannot open input file."};
 
-    std::string content((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+    CIPHER_PROBE(morse, read_start, 0);
+    std::vector<unsigned char> content((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
     inputFile.close();
-
-    MorseEncodedResult encoded_data = encodeTextToMorse(content);
-
+    CIPHER_PROBE(morse, read_done, content.size());
+    read_timer.addBytes(content.size());
+    read_timer.stop();
+    CipherProgress tracker(progress, content.size());
+    if (!tracker.advance(0)) return {false, CIPHER_CANCELLED_MESSAGE};
+
+    CipherStageTimer transform_timer(stats, CIPHER_STAGE_TRANSFORM);
+    std::string output;
+    std::string error = transform(content, output);
+    if (!error.empty()) return {false, error};
+    transform_timer.addBytes(content.size());
+    transform_timer.stop();
+    if (!tracker.advance(0)) return {false, CIPHER_CANCELLED_MESSAGE};
+
+    CipherStageTimer write_timer(stats, CIPHER_STAGE_WRITE);
     std::ofstream outputFile(outputFilePath, std::ios::binary);
     if (!outputFile) return {false, "Error: Cannot open output file."};
 
-    outputFile.write(reinterpret_cast<const char*>(encoded_data.binary_data.data()), encoded_data.binary_data.size());
+    CIPHER_PROBE(morse, write_start, output.size());
+    outputFile.write(output.data(), static_cast<std::streamsize>(output.size()));
     outputFile.close();
+    if (!outputFile) return {false, "Error: Cannot write output file."};
+    CIPHER_PROBE(morse, write_done, output.size());
+    write_timer.addBytes(output.size());
+    tracker.advance(content.size());
+    return {true, ""};
+}
 
-    return {true, "File successfully encoded to universal binary Morse."};
+MorseFileOperationResult encodeFileToMorse(const std::string &inputFilePath, const std::string &outputFilePath,
+                                           const CipherStatsSinkC *stats, const CipherProgressC *progress) {
+    MorseFileOperationResult result = transform_file(
+        inputFilePath, outputFilePath, stats, progress,
+        [](const std::vector<unsigned char> &input, std::string &output) {
+            const uint64_t total_bits = morse_payload_bits(input.data(), input.size());
+            output.resize(sizeof(uint64_t) + static_cast<std::size_t>((total_bits + 7) / 8));
+            encode_morse(input.data(), input.size(), total_bits, reinterpret_cast<unsigned char *>(&output[0]));
+            return std::string();
+        });
+    if (result.success) result.message = "File successfully encoded to universal binary Morse.";
+    return result;
 }
 
-MorseFileOperationResult decodeFileFromMorse(const std::string &inputFilePath, const std::string &outputFilePath) {
-    std::ifstream inputFile(inputFilePath, std::ios::binary);
-    if (!inputFile) return {false, "Error: Cannot open input file."};
+MorseFileOperationResult decodeFileFromMorse(const std::string &inputFilePath, const std::string &outputFilePath,
+                                             const CipherStatsSinkC *stats) {
+    MorseFileOperationResult result = transform_file(
+        inputFilePath, outputFilePath, stats, nullptr,
+        [](const std::vector<unsigned char> &input, std::string &output) {
+            MorseDecodedResult decoded = decodeTextFromMorse(input);
+            if (!decoded.success) return decoded.error_message;
+            output = std::move(decoded.plaintext);
+            return std::string();
+        });
+    if (result.success) result.message = "File successfully decoded from universal binary Morse.";
+    return result;
+}
 
-    std::vector<unsigned char> content((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
-    inputFile.close();
+MorseFileOperationResult encodeFileToMorseWav(const std::string &inputFilePath,
+                                              const std::string &outputFilePath,
+                                              const MorseAudioParams &params,
+                                              const CipherStatsSinkC *stats) {
+    if (params.wpm == 0 || params.wpm > 1000) return {false, "Error: WPM must be between 1 and 1000."};
+    if (params.sample_rate < 8000 || params.sample_rate > 384000) {
+        return {false, "Error: Sample rate must be between 8000 and 384000 Hz."};
+    }
+    if (params.tone_hz == 0 || params.tone_hz >= params.sample_rate / 2) {
+        return {false, "Error: Tone frequency must be below half of the sample rate."};
+    }
 
-    MorseDecodedResult decoded_data = decodeTextFromMorse(content);
-    if (!decoded_data.success) return {false, decoded_data.error_message};
+    // Единица времени по стандарту PARIS: 1.2 / WPM секунды.
+    auto samples_per_unit = static_cast<std::size_t>(std::lround(params.sample_rate * 1.2 / params.wpm));
+    if (samples_per_unit == 0) samples_per_unit = 1;
 
-    std::ofstream outputFile(outputFilePath, std::ios::binary);
+    std::ifstream inputFile(inputFilePath, std::ios::binary);
+    if (!inputFile) return {false, "Error: Cannot open input file."};
+
+    std::ofstream outputFile(outputFilePath, std::ios::binary | std::ios::trunc);
     if (!outputFile) return {false, "Error: Cannot open output file."};
 
-    outputFile << decoded_data.plaintext;
+    const std::vector<unsigned char> dot_block = make_tone_block(samples_per_unit * MORSE_DOT_LENGTH, params);
+    const std::vector<unsigned char> dash_block = make_tone_block(samples_per_unit * MORSE_DASH_LENGTH, params);
+    const std::vector<unsigned char> silence_block(samples_per_unit * 2 * INTER_BYTE_GAP_LENGTH, 0);
+    const std::size_t unit_bytes = samples_per_unit * 2;
+    CIPHER_PROBE(morse, key_setup, samples_per_unit, params.sample_rate);
+
+    auto header = make_wav_header(params.sample_rate, 0);
+    outputFile.write(reinterpret_cast<const char *>(header.data()), header.size());
+
+    PcmBlockWriter writer(outputFile, stats);
+    std::vector<char> chunk(MORSE_INPUT_CHUNK_SIZE);
+    bool first_byte = true;
+    bool ok = static_cast<bool>(outputFile);
+    uint64_t offset = 0;
+    while (ok && inputFile) {
+        CipherStageTimer read_timer(stats, CIPHER_STAGE_READ);
+        CIPHER_PROBE(morse, read_start, chunk.size());
+        inputFile.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        std::streamsize got = inputFile.gcount();
+        CIPHER_PROBE(morse, read_done, got);
+        read_timer.addBytes(static_cast<uint64_t>(got));
+        read_timer.stop();
+
+        CipherStageTimer synth_timer(stats, CIPHER_STAGE_TRANSFORM);
+        synth_timer.addBytes(static_cast<uint64_t>(got));
+        writer.set_synth_timer(&synth_timer);
+        CIPHER_PROBE(morse, chunk_start, offset, got);
+        for (std::streamsize i = 0; ok && i < got; ++i) {
+            if (!first_byte) {
+                ok = writer.append(silence_block.data(), unit_bytes * INTER_BYTE_GAP_LENGTH);
+            }
+            first_byte = false;
+            const ByteTimingRuns &entry = byte_to_timing_runs[static_cast<unsigned char>(chunk[i])];
+            for (uint8_t r = 0; ok && r < entry.count; ++r) {
+                const TimingRun &run = entry.runs[r];
+                if (!run.tone) {
+                    ok = writer.append(silence_block.data(), unit_bytes * run.units);
+                } else if (run.units == MORSE_DOT_LENGTH) {
+                    ok = writer.append(dot_block.data(), dot_block.size());
+                } else {
+                    ok = writer.append(dash_block.data(), dash_block.size());
+                }
+            }
+        }
+        CIPHER_PROBE(morse, chunk_done, offset, got);
+        offset += static_cast<uint64_t>(got);
+        writer.set_synth_timer(nullptr);
+    }
+    if (ok) ok = writer.flush();
+    if (!ok) {
+        if (writer.data_size() > WAV_MAX_DATA_SIZE) return {false, "Error: Audio exceeds the 4 GiB WAV size limit."};
+        return {false, "Error: Cannot write output file."};
+    }
+    if (inputFile.bad()) return {false, "Error: Cannot read input file."};
+
+    header = make_wav_header(params.sample_rate, static_cast<uint32_t>(writer.data_size()));
+    outputFile.seekp(0, std::ios::beg);
+    outputFile.write(reinterpret_cast<const char *>(header.data()), header.size());
     outputFile.close();
+    if (!outputFile) return {false, "Error: Cannot write WAV header."};
 
-    return {true, "File successfully decoded from universal binary Morse."};
-}
\ No newline at end of file
+    return {true, "File successfully rendered to Morse audio (WAV)."};
+}
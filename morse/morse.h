@@ -1,9 +1,16 @@
 #ifndef MORSE_CODER_HPP
 #define MORSE_CODER_HPP
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
+struct CipherStatsSinkC; // plugin/cipher_stats.h
+struct CipherProgressC;  // runtime/cipher_progress.h
+
+// Все функции библиотеки реентерабельны и потокобезопасны: таблицы кодов
+// вычисляются на этапе компиляции, изменяемого глобального состояния нет.
+
 // Структура для хранения результата битового кодирования.
 struct MorseEncodedResult {
     std::vector<unsigned char> binary_data; // Результат в виде байтов
@@ -24,18 +31,55 @@ struct MorseFileOperationResult {
     std::string message;
 };
 
+// Параметры синтеза звука Морзе (16-битный моно PCM).
+struct MorseAudioParams {
+    unsigned wpm = 20;            // Скорость, слов в минуту (стандарт PARIS)
+    unsigned tone_hz = 700;       // Частота тона
+    unsigned sample_rate = 44100; // Частота дискретизации
+};
+
 // Кодирует текстовую строку в битовое представление Морзе.
 MorseEncodedResult encodeTextToMorse(const std::string &plaintext);
 
 // Декодирует битовые данные Морзе в текстовую строку.
 MorseDecodedResult decodeTextFromMorse(const std::vector<unsigned char> &binary_data);
 
-// Кодирует файл в бинарный файл Морзе.
+// Кодирование и декодирование в буфер вызывающего без выделения памяти.
+// out_size получает размер результата; если out == nullptr или capacity меньше
+// нужного, возвращается BufferTooSmall, а out_size — требуемый размер.
+enum class MorseBufferStatus { Ok, BufferTooSmall, InvalidData };
+
+// Точный размер результата encodeMorseInto.
+std::size_t morseEncodedSize(const unsigned char *data, std::size_t size);
+MorseBufferStatus encodeMorseInto(const unsigned char *data, std::size_t size, unsigned char *out,
+                                  std::size_t capacity, std::size_t &out_size);
+// Размер открытого текста заранее неизвестен: запрос размера (out == nullptr)
+// декодирует данные без записи.
+MorseBufferStatus decodeMorseInto(const unsigned char *data, std::size_t size, unsigned char *out,
+                                  std::size_t capacity, std::size_t &out_size);
+
+// Файловые функции сообщают время чтения, преобразования и записи в stats,
+// если он задан (см. plugin/cipher_stats.h).
+
+// Кодирует файл в бинарный файл Морзе. progress (может быть nullptr) получает
+// ход в байтах входа и может отменить кодирование (runtime/cipher_progress.h);
+// файл обрабатывается целиком, поэтому ход сообщается между чтением,
+// преобразованием и записью.
 MorseFileOperationResult encodeFileToMorse(const std::string &inputFilePath,
-                                           const std::string &outputFilePath);
+                                           const std::string &outputFilePath,
+                                           const CipherStatsSinkC *stats = nullptr,
+                                           const CipherProgressC *progress = nullptr);
 
 // Декодирует бинарный файл Морзе.
 MorseFileOperationResult decodeFileFromMorse(const std::string &inputFilePath,
-                                             const std::string &outputFilePath);
+                                             const std::string &outputFilePath,
+                                             const CipherStatsSinkC *stats = nullptr);
+
+// Озвучивает файл кодом Морзе и сохраняет результат в WAV.
+// Данные обрабатываются потоково, расход памяти не зависит от размера файла.
+MorseFileOperationResult encodeFileToMorseWav(const std::string &inputFilePath,
+                                              const std::string &outputFilePath,
+                                              const MorseAudioParams &params = {},
+                                              const CipherStatsSinkC *stats = nullptr);
 
 #endif // MORSE_CODER_HPP
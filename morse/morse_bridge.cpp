@@ -6,7 +6,7 @@
 // Память выделяется через new[], чтобы можно было освободить через delete[]
 static char* duplicate_string(const std::string& s) {
     char* cstr = new char[s.length() + 1];
-    std::strcpy(cstr, s.c_str());
+    std::memcpy(cstr, s.c_str(), s.length() + 1);
     return cstr;
 }
 
@@ -42,20 +42,78 @@ DLL_EXPORT MorseDecodedResultC decodeTextFromMorse_C(const unsigned char* binary
     return c_result;
 }
 
-DLL_EXPORT MorseFileOperationResultC encodeFileToMorse_C(const char* inputFilePath, const char* outputFilePath) {
-    MorseFileOperationResult result = encodeFileToMorse(inputFilePath, outputFilePath);
+DLL_EXPORT MorseStatusC encodeMorseInto_C(const unsigned char* data, size_t data_size,
+                                          unsigned char* output, size_t output_capacity, size_t* output_size) {
+    if ((!data && data_size) || !output_size) return MORSE_STATUS_INVALID_ARGUMENT;
+    MorseBufferStatus status = encodeMorseInto(data, data_size, output, output_capacity, *output_size);
+    return status == MorseBufferStatus::Ok ? MORSE_STATUS_OK : MORSE_STATUS_BUFFER_TOO_SMALL;
+}
+
+DLL_EXPORT MorseStatusC decodeMorseInto_C(const unsigned char* data, size_t data_size,
+                                          unsigned char* output, size_t output_capacity, size_t* output_size) {
+    if ((!data && data_size) || !output_size) return MORSE_STATUS_INVALID_ARGUMENT;
+    switch (decodeMorseInto(data, data_size, output, output_capacity, *output_size)) {
+    case MorseBufferStatus::Ok: return MORSE_STATUS_OK;
+    case MorseBufferStatus::BufferTooSmall: return MORSE_STATUS_BUFFER_TOO_SMALL;
+    default: return MORSE_STATUS_INVALID_DATA;
+    }
+}
+
+// Аргументы encodeFileToMorseAsync_C, скопированные для потока задания.
+struct MorseFileWork {
+    std::string inputFilePath;
+    std::string outputFilePath;
+};
+
+static void run_encode_file_morse(CipherAsyncJobC* job, void* work, const CipherProgressC* progress) {
+    auto* args = static_cast<MorseFileWork*>(work);
+    MorseFileOperationResult result = encodeFileToMorse(args->inputFilePath, args->outputFilePath, nullptr, progress);
+    // Выход создаётся только на стадии записи, после последней проверки отмены.
+    cipher_async_finish(job, result.success, result.message.c_str(), nullptr);
+}
+
+static void free_morse_file_work(void* work) {
+    delete static_cast<MorseFileWork*>(work);
+}
+
+static MorseFileOperationResultC to_c_file_result(const MorseFileOperationResult& result) {
     MorseFileOperationResultC c_result = {};
     c_result.success = result.success;
     c_result.message = duplicate_string(result.message);
     return c_result;
 }
 
+DLL_EXPORT MorseFileOperationResultC encodeFileToMorse_C(const char* inputFilePath, const char* outputFilePath) {
+    return to_c_file_result(encodeFileToMorse(inputFilePath, outputFilePath));
+}
+
+DLL_EXPORT CipherAsyncJobC* encodeFileToMorseAsync_C(const char* inputFilePath, const char* outputFilePath,
+                                                     const CipherAsyncOptionsC* options) {
+    auto* work = new MorseFileWork{inputFilePath, outputFilePath};
+    return cipher_async_submit(run_encode_file_morse, work, free_morse_file_work, options);
+}
+
 DLL_EXPORT MorseFileOperationResultC decodeFileFromMorse_C(const char* inputFilePath, const char* outputFilePath) {
-    MorseFileOperationResult result = decodeFileFromMorse(inputFilePath, outputFilePath);
-    MorseFileOperationResultC c_result = {};
-    c_result.success = result.success;
-    c_result.message = duplicate_string(result.message);
-    return c_result;
+    return to_c_file_result(decodeFileFromMorse(inputFilePath, outputFilePath));
+}
+
+DLL_EXPORT MorseFileOperationResultC encodeFileToMorseWav_C(const char* inputFilePath, const char* outputFilePath,
+                                                            unsigned wpm, unsigned tone_hz, unsigned sample_rate) {
+    MorseAudioParams params;
+    if (wpm) params.wpm = wpm;
+    if (tone_hz) params.tone_hz = tone_hz;
+    if (sample_rate) params.sample_rate = sample_rate;
+    return to_c_file_result(encodeFileToMorseWav(inputFilePath, outputFilePath, params));
+}
+
+DLL_EXPORT MorseFileOperationResultC encodeFileToMorseStats_C(const char* inputFilePath, const char* outputFilePath,
+                                                              const CipherStatsSinkC* stats) {
+    return to_c_file_result(encodeFileToMorse(inputFilePath, outputFilePath, stats));
+}
+
+DLL_EXPORT MorseFileOperationResultC decodeFileFromMorseStats_C(const char* inputFilePath, const char* outputFilePath,
+                                                                const CipherStatsSinkC* stats) {
+    return to_c_file_result(decodeFileFromMorse(inputFilePath, outputFilePath, stats));
 }
 
 // Реализация функций для освобождения памяти
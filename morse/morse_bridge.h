@@ -4,6 +4,9 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "cipher_async.h"
+#include "cipher_stats.h"
+
 #ifdef _WIN32
 #define DLL_EXPORT __declspec(dllexport)
 #else
@@ -38,6 +41,15 @@ typedef struct {
 } MorseFileOperationResultC;
 
 
+// Коды возврата функций *Into_C.
+typedef enum {
+    MORSE_STATUS_OK = 0,
+    MORSE_STATUS_BUFFER_TOO_SMALL = 1,  // *output_size — требуемый размер
+    MORSE_STATUS_INVALID_ARGUMENT = 2,
+    MORSE_STATUS_INVALID_DATA = 3,
+} MorseStatusC;
+
+
 // Объявления экспортируемых C-функций
 
 DLL_EXPORT MorseEncodedResultC encodeTextToMorse_C(const char* plaintext);
@@ -48,6 +60,33 @@ DLL_EXPORT MorseFileOperationResultC encodeFileToMorse_C(const char* inputFilePa
 
 DLL_EXPORT MorseFileOperationResultC decodeFileFromMorse_C(const char* inputFilePath, const char* outputFilePath);
 
+// Озвучивание файла в WAV (16-битный PCM). Нулевые параметры заменяются значениями по умолчанию.
+DLL_EXPORT MorseFileOperationResultC encodeFileToMorseWav_C(const char* inputFilePath, const char* outputFilePath,
+                                                            unsigned wpm, unsigned tone_hz, unsigned sample_rate);
+
+// То же с замером стадий: stats (может быть NULL) получает время чтения,
+// преобразования и записи (см. plugin/cipher_stats.h).
+DLL_EXPORT MorseFileOperationResultC encodeFileToMorseStats_C(const char* inputFilePath, const char* outputFilePath,
+                                                              const CipherStatsSinkC* stats);
+DLL_EXPORT MorseFileOperationResultC decodeFileFromMorseStats_C(const char* inputFilePath, const char* outputFilePath,
+                                                                const CipherStatsSinkC* stats);
+
+// Асинхронный encodeFileToMorse_C: задание ставится в очередь пула заданий и
+// функция сразу возвращает описатель (см. runtime/cipher_async.h). Файл
+// кодируется целиком, поэтому ход, отмена и срок проверяются между чтением,
+// кодированием и записью. options может быть NULL.
+DLL_EXPORT CipherAsyncJobC* encodeFileToMorseAsync_C(const char* inputFilePath, const char* outputFilePath,
+                                                     const CipherAsyncOptionsC* options);
+
+// Двоично-безопасные функции без выделения памяти: вход — (data, data_size),
+// результат пишется в output ёмкостью output_capacity, его размер — в *output_size.
+// Запрос размера: output == NULL (или недостаточная ёмкость) — возвращается
+// MORSE_STATUS_BUFFER_TOO_SMALL и требуемый размер.
+DLL_EXPORT MorseStatusC encodeMorseInto_C(const unsigned char* data, size_t data_size,
+                                          unsigned char* output, size_t output_capacity, size_t* output_size);
+DLL_EXPORT MorseStatusC decodeMorseInto_C(const unsigned char* data, size_t data_size,
+                                          unsigned char* output, size_t output_capacity, size_t* output_size);
+
 // Функции для освобождения памяти, выделенной в C++
 DLL_EXPORT void free_morse_encoded_result_C(MorseEncodedResultC* result);
 DLL_EXPORT void free_morse_decoded_result_C(MorseDecodedResultC* result);
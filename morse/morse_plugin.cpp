@@ -0,0 +1,140 @@
+// Дескриптор плагина Морзе (см. plugin/cipher_plugin.h).
+// Параметры: "audio" (кодирование файла в WAV), "wpm=N", "tone=Гц", "sample-rate=Гц".
+
+#include "cipher_plugin.h"
+#include "cipher_plugin_util.hpp"
+#include "morse.h"
+#include <string>
+#include <vector>
+
+struct MorsePluginOptions {
+    bool audio = false;
+    MorseAudioParams audio_params;
+};
+
+static bool parseMorseOptions(const CipherParamsC* params, MorsePluginOptions& options, std::string& error) {
+    try {
+        for (const PluginOption& option : parsePluginOptions(params ? params->options : nullptr)) {
+            if (option.name == "audio" && !option.has_value) {
+                options.audio = true;
+            } else if (option.name == "wpm" && option.has_value) {
+                options.audio_params.wpm = static_cast<unsigned>(std::stoul(option.value));
+            } else if (option.name == "tone" && option.has_value) {
+                options.audio_params.tone_hz = static_cast<unsigned>(std::stoul(option.value));
+            } else if (option.name == "sample-rate" && option.has_value) {
+                options.audio_params.sample_rate = static_cast<unsigned>(std::stoul(option.value));
+            } else {
+                error = "Error: unsupported morse option '" + option.name + "'.";
+                return false;
+            }
+        }
+    } catch (const std::exception& e) {
+        error = std::string("Error: invalid morse option: ") + e.what();
+        return false;
+    }
+    return true;
+}
+
+extern "C" {
+
+static CipherResultC morseEncodeBuffer(const unsigned char* data, size_t size, const CipherParamsC* params) {
+    MorsePluginOptions options;
+    std::string error;
+    if (!parseMorseOptions(params, options, error)) return pluginError(error);
+    if (options.audio) return pluginError("Error: Morse audio is only available for files.");
+
+    MorseEncodedResult result = encodeTextToMorse(std::string(reinterpret_cast<const char*>(data), size));
+    if (!result.success) return pluginError(result.error_message);
+    return pluginData(result.binary_data.data(), result.binary_data.size());
+}
+
+static CipherResultC morseDecodeBuffer(const unsigned char* data, size_t size, const CipherParamsC* params) {
+    MorsePluginOptions options;
+    std::string error;
+    if (!parseMorseOptions(params, options, error)) return pluginError(error);
+    if (options.audio) return pluginError("Error: Morse audio cannot be decoded.");
+
+    MorseDecodedResult result = decodeTextFromMorse(std::vector<unsigned char>(data, data + size));
+    if (!result.success) return pluginError(result.error_message);
+    return pluginData(reinterpret_cast<const unsigned char*>(result.plaintext.data()), result.plaintext.size());
+}
+
+static CipherResultC morseEncodeFile(const char* inputPath, const char* outputPath, const CipherParamsC* params) {
+    MorsePluginOptions options;
+    std::string error;
+    if (!parseMorseOptions(params, options, error)) return pluginError(error);
+    if (!inputPath || !outputPath) return pluginError("Error: input and output files must be specified.");
+
+    const CipherStatsSinkC* stats = params ? params->stats : nullptr;
+    MorseFileOperationResult result = options.audio
+        ? encodeFileToMorseWav(inputPath, outputPath, options.audio_params, stats)
+        : encodeFileToMorse(inputPath, outputPath, stats);
+    return result.success ? pluginSuccess(result.message) : pluginError(result.message);
+}
+
+static CipherResultC morseDecodeFile(const char* inputPath, const char* outputPath, const CipherParamsC* params) {
+    MorsePluginOptions options;
+    std::string error;
+    if (!parseMorseOptions(params, options, error)) return pluginError(error);
+    if (options.audio) return pluginError("Error: Morse audio cannot be decoded.");
+    if (!inputPath || !outputPath) return pluginError("Error: input and output files must be specified.");
+
+    MorseFileOperationResult result = decodeFileFromMorse(inputPath, outputPath, params ? params->stats : nullptr);
+    return result.success ? pluginSuccess(result.message) : pluginError(result.message);
+}
+
+static int morseInto(const unsigned char* data, size_t size, unsigned char* output, size_t capacity,
+                     size_t* output_size, const CipherParamsC* params, bool encode) {
+    MorsePluginOptions options;
+    std::string error;
+    if (!output_size || (!data && size) || !parseMorseOptions(params, options, error) || options.audio) {
+        return CIPHER_STATUS_INVALID_ARGUMENT;
+    }
+    MorseBufferStatus status = encode ? encodeMorseInto(data, size, output, capacity, *output_size)
+                                      : decodeMorseInto(data, size, output, capacity, *output_size);
+    switch (status) {
+    case MorseBufferStatus::Ok: return CIPHER_STATUS_OK;
+    case MorseBufferStatus::BufferTooSmall: return CIPHER_STATUS_BUFFER_TOO_SMALL;
+    default: return CIPHER_STATUS_INVALID_DATA;
+    }
+}
+
+static int morseEncodeInto(const unsigned char* data, size_t size, unsigned char* output, size_t capacity,
+                           size_t* output_size, const CipherParamsC* params) {
+    return morseInto(data, size, output, capacity, output_size, params, true);
+}
+
+static int morseDecodeInto(const unsigned char* data, size_t size, unsigned char* output, size_t capacity,
+                           size_t* output_size, const CipherParamsC* params) {
+    return morseInto(data, size, output, capacity, output_size, params, false);
+}
+
+static const CipherFileActionC morseFileActions[] = {
+    {"Озвучить файл (WAV)", "audio"},
+};
+
+extern const CipherPluginDescriptor CIPHER_PLUGIN_DESCRIPTOR(morse) = {
+    CIPHER_PLUGIN_ABI_VERSION,
+    sizeof(CipherPluginDescriptor),
+    "morse",
+    "Морзе, универсальный бинарный (параметры: audio, wpm=N, tone=Гц, sample-rate=Гц)",
+    CIPHER_CAP_BUFFER | CIPHER_CAP_FILE | CIPHER_CAP_INTO,
+    morseEncodeBuffer,
+    morseDecodeBuffer,
+    morseEncodeFile,
+    morseDecodeFile,
+    nullptr,
+    nullptr,
+    nullptr,
+    pluginFreeResult,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    morseEncodeInto,
+    morseDecodeInto,
+    morseFileActions,
+    sizeof(morseFileActions) / sizeof(morseFileActions[0]),
+};
+
+}
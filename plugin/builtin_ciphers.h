@@ -0,0 +1,28 @@
+#ifndef CIPHER_BUILTIN_CIPHERS_H
+#define CIPHER_BUILTIN_CIPHERS_H
+
+// Шифры, встроенные в исполняемый файл при статической сборке (CIPHER_STATIC_PLUGINS).
+// Список составляется на этапе компиляции: дескрипторы — константы, поэтому
+// регистрация не требует ни dlopen, ни сканирования каталога, а LTO видит
+// вызовы из точек входа плагинов в ядра шифров целиком.
+
+#include "cipher_plugin.h"
+
+#ifdef CIPHER_STATIC_PLUGINS
+
+extern "C" {
+extern const CipherPluginDescriptor CIPHER_PLUGIN_DESCRIPTOR(gost);
+extern const CipherPluginDescriptor CIPHER_PLUGIN_DESCRIPTOR(morse);
+extern const CipherPluginDescriptor CIPHER_PLUGIN_DESCRIPTOR(rot13);
+}
+
+// Новый встроенный шифр добавляется сюда и в список исходников статической сборки.
+inline constexpr const CipherPluginDescriptor* BUILTIN_CIPHERS[] = {
+    &CIPHER_PLUGIN_DESCRIPTOR(gost),
+    &CIPHER_PLUGIN_DESCRIPTOR(morse),
+    &CIPHER_PLUGIN_DESCRIPTOR(rot13),
+};
+
+#endif // CIPHER_STATIC_PLUGINS
+
+#endif // CIPHER_BUILTIN_CIPHERS_H
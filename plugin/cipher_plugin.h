@@ -0,0 +1,172 @@
+#ifndef CIPHER_PLUGIN_H
+#define CIPHER_PLUGIN_H
+
+// Версионированный ABI плагинов шифрования.
+//
+// Библиотека шифра экспортирует единственный символ CIPHER_PLUGIN_SYMBOL —
+// константный дескриптор со сведениями о шифре, флагами возможностей и
+// указателями на точки входа. Основная программа находит такие библиотеки в
+// каталоге плагинов и связывается с ними только через дескриптор, поэтому
+// новый шифр подключается без изменения основной программы.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cipher_stats.h"
+
+#ifdef _WIN32
+#define CIPHER_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define CIPHER_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Версия ABI. Меняется при несовместимых изменениях; новые поля добавляются
+// только в конец дескриптора, их наличие проверяется по struct_size.
+// Версия 2: поле stats в CipherParamsC.
+#define CIPHER_PLUGIN_ABI_VERSION 2u
+
+// Имя экспортируемого дескриптора.
+#define CIPHER_PLUGIN_SYMBOL "cipher_plugin_descriptor"
+
+// Флаги возможностей (CipherPluginDescriptor::capabilities).
+#define CIPHER_CAP_BUFFER    (1u << 0)  // encode_buffer/decode_buffer
+#define CIPHER_CAP_FILE      (1u << 1)  // encode_file/decode_file
+#define CIPHER_CAP_STREAMING (1u << 2)  // файлы обрабатываются потоково, память не зависит от размера
+#define CIPHER_CAP_IN_PLACE  (1u << 3)  // преобразование файла на месте (CIPHER_JOB_IN_PLACE)
+#define CIPHER_CAP_PARALLEL  (1u << 4)  // многопоточная обработка файла (CIPHER_JOB_PARALLEL)
+#define CIPHER_CAP_BATCH     (1u << 5)  // encode_batch/decode_batch
+#define CIPHER_CAP_KEYED     (1u << 6)  // требуется ключ (key_hex), при шифровании возвращается IV
+#define CIPHER_CAP_KEYGEN    (1u << 7)  // generate_key
+#define CIPHER_CAP_CHUNKED   (1u << 8)  // stream_*: обработка потока байт частями (конвейеры)
+#define CIPHER_CAP_INTO      (1u << 9)  // encode_into/decode_into: запись в буфер вызывающего
+#define CIPHER_CAP_DIRECT_IO (1u << 10) // файлы читаются и пишутся в обход страничного кэша (CIPHER_JOB_DIRECT_IO)
+
+// Флаги задания (CipherParamsC::flags).
+#define CIPHER_JOB_IN_PLACE (1u << 0)  // файл input_path преобразуется на месте, output_path не используется
+#define CIPHER_JOB_PARALLEL (1u << 1)  // многопоточная обработка, thread_count потоков
+#define CIPHER_JOB_DIRECT_IO (1u << 2) // ввод-вывод файлов в обход страничного кэша (O_DIRECT), где это возможно
+
+// Параметры задания. Нулевая структура (или NULL) — значения по умолчанию.
+typedef struct {
+    uint32_t flags;          // CIPHER_JOB_*
+    const char* key_hex;     // Ключ (шифры с CIPHER_CAP_KEYED)
+    const char* iv_hex;      // IV; при шифровании NULL или "" — случайный
+    unsigned thread_count;   // CIPHER_JOB_PARALLEL: число потоков (0 — все потоки общего пула)
+    size_t msync_window;     // CIPHER_JOB_IN_PLACE: сбрасывать изменения окнами такого размера (0 — в конце)
+    const char* options;     // Параметры шифра "имя=значение;имя;..." (неизвестные имена — ошибка)
+    // Приёмник статистики стадий (NULL — без замеров). Его вызывают файловые и
+    // потоковые функции; буферные вызовы замеряет вызывающая сторона.
+    const CipherStatsSinkC* stats;
+} CipherParamsC;
+
+// Результат любой операции. Освобождается функцией free_result того же плагина.
+typedef struct {
+    bool success;
+    char* message;           // Сообщение об успехе или ошибке (может быть NULL)
+    unsigned char* data;     // Выходной буфер операций с буферами
+    size_t data_size;
+    char* key_hex;           // Сгенерированный ключ (generate_key)
+    char* iv_hex;            // Использованный IV (шифры с CIPHER_CAP_KEYED)
+} CipherResultC;
+
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+} CipherBufferC;
+
+typedef CipherResultC (*CipherBufferFunc)(const unsigned char* data, size_t size, const CipherParamsC* params);
+typedef CipherResultC (*CipherFileFunc)(const char* input_path, const char* output_path, const CipherParamsC* params);
+typedef CipherResultC (*CipherKeyGenFunc)(void);
+// Пакетная обработка: results[i] — результат для inputs[i], каждый освобождается
+// free_result. Возвращает true, если все элементы обработаны успешно.
+typedef bool (*CipherBatchFunc)(const CipherBufferC* inputs, size_t count, const CipherParamsC* params,
+                                CipherResultC* results);
+typedef void (*CipherFreeResultFunc)(CipherResultC* result);
+
+// Потоковая обработка (CIPHER_CAP_CHUNKED). stream_open создаёт состояние потока
+// в *stream; stream_update обрабатывает очередную часть данных, stream_finish —
+// хвост потока; готовый результат передаётся в sink (указатель действителен только
+// во время вызова), sink возвращает false, чтобы прервать обработку. Результат
+// каждого вызова освобождается free_result, stream_close освобождает поток.
+// Выход потока совпадает с выходом encode_buffer/decode_buffer для всех данных
+// сразу; шифры с ключом передают IV в начале потока.
+typedef bool (*CipherSinkFunc)(void* context, const unsigned char* data, size_t size);
+typedef CipherResultC (*CipherStreamOpenFunc)(bool encode, const CipherParamsC* params, void** stream);
+typedef CipherResultC (*CipherStreamUpdateFunc)(void* stream, const unsigned char* data, size_t size,
+                                                CipherSinkFunc sink, void* context);
+typedef CipherResultC (*CipherStreamFinishFunc)(void* stream, CipherSinkFunc sink, void* context);
+typedef void (*CipherStreamCloseFunc)(void* stream);
+
+// Коды возврата encode_into/decode_into.
+#define CIPHER_STATUS_OK                0
+#define CIPHER_STATUS_BUFFER_TOO_SMALL  1  // *output_size — требуемый размер
+#define CIPHER_STATUS_INVALID_ARGUMENT  2  // неверные параметры (ключ, IV, options)
+#define CIPHER_STATUS_INVALID_DATA      3  // вход не расшифровывается
+
+// Двоично-безопасное преобразование без копий и без выделения памяти под
+// результат: вход (data, size), выход пишется в output ёмкостью capacity, его
+// размер — в *output_size. Запрос размера: output == NULL. Сообщений об ошибках
+// нет — подробности даёт encode_buffer/decode_buffer. Шифры с ключом требуют
+// iv_hex и при шифровании (IV в выход не пишется).
+typedef int (*CipherIntoFunc)(const unsigned char* data, size_t size, unsigned char* output, size_t capacity,
+                              size_t* output_size, const CipherParamsC* params);
+
+// Дополнительный пункт меню для файлов: encode_file с заданными параметрами
+// (например, озвучивание Морзе — "audio"). Параметры пользователя дописываются
+// к options через ';'.
+typedef struct {
+    const char* label;    // Текст пункта меню
+    const char* options;  // CipherParamsC::options
+} CipherFileActionC;
+
+// Указатели на функции, не заявленные в capabilities, могут быть NULL.
+typedef struct {
+    uint32_t abi_version;    // CIPHER_PLUGIN_ABI_VERSION
+    uint32_t struct_size;    // sizeof(CipherPluginDescriptor) при сборке плагина
+    const char* name;        // Имя для --cipher
+    const char* description; // Описание для меню и --list-ciphers
+    uint32_t capabilities;   // CIPHER_CAP_*
+
+    CipherBufferFunc encode_buffer;
+    CipherBufferFunc decode_buffer;
+    CipherFileFunc encode_file;
+    CipherFileFunc decode_file;
+    CipherKeyGenFunc generate_key;
+    CipherBatchFunc encode_batch;
+    CipherBatchFunc decode_batch;
+    CipherFreeResultFunc free_result;  // Обязательна
+
+    // Добавлены после первой версии; читаются, только если их покрывает struct_size.
+    CipherStreamOpenFunc stream_open;
+    CipherStreamUpdateFunc stream_update;
+    CipherStreamFinishFunc stream_finish;
+    CipherStreamCloseFunc stream_close;
+    CipherIntoFunc encode_into;
+    CipherIntoFunc decode_into;
+    const CipherFileActionC* file_actions;  // Требует CIPHER_CAP_FILE
+    size_t file_action_count;
+} CipherPluginDescriptor;
+
+// Имя дескриптора в исходнике плагина: extern const CipherPluginDescriptor
+// CIPHER_PLUGIN_DESCRIPTOR(id) = {...} внутри extern "C". Библиотека-плагин
+// экспортирует его как CIPHER_PLUGIN_SYMBOL. При статической сборке
+// (CIPHER_STATIC_PLUGINS) все шифры попадают в один исполняемый файл, поэтому
+// имя уникально для каждого шифра, а список задаёт plugin/builtin_ciphers.h.
+#ifdef CIPHER_STATIC_PLUGINS
+#define CIPHER_PLUGIN_DESCRIPTOR(id) cipher_plugin_descriptor_##id
+#else
+#define CIPHER_PLUGIN_DESCRIPTOR(id) cipher_plugin_descriptor
+// Без повторного CIPHER_PLUGIN_EXPORT в определении — видимость задаёт это объявление.
+CIPHER_PLUGIN_EXPORT extern const CipherPluginDescriptor cipher_plugin_descriptor;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CIPHER_PLUGIN_H
@@ -0,0 +1,122 @@
+#ifndef CIPHER_PLUGIN_UTIL_HPP
+#define CIPHER_PLUGIN_UTIL_HPP
+
+// Вспомогательные функции для реализации плагинов на C++: разбор строки
+// параметров, заполнение и освобождение CipherResultC. Всё объявлено inline,
+// чтобы каждый плагин получал свою копию и не зависел от других библиотек.
+
+#include "cipher_plugin.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct PluginOption {
+    std::string name;
+    std::string value;
+    bool has_value = false;
+};
+
+// Разбирает строку "имя=значение;имя;..." (пустые элементы пропускаются).
+inline std::vector<PluginOption> parsePluginOptions(const char* options) {
+    std::vector<PluginOption> result;
+    if (!options) return result;
+    std::string text(options);
+    std::size_t start = 0;
+    while (start <= text.size()) {
+        std::size_t end = text.find(';', start);
+        if (end == std::string::npos) end = text.size();
+        std::string item = text.substr(start, end - start);
+        if (!item.empty()) {
+            PluginOption option;
+            std::size_t eq = item.find('=');
+            option.name = item.substr(0, eq);
+            if (eq != std::string::npos) {
+                option.value = item.substr(eq + 1);
+                option.has_value = true;
+            }
+            result.push_back(std::move(option));
+        }
+        start = end + 1;
+    }
+    return result;
+}
+
+// Значение hex-цифры или -1.
+inline int pluginHexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Hex-строка в байты; при ошибке — std::invalid_argument.
+inline std::vector<unsigned char> pluginHexToBytes(const std::string& hex) {
+    if (hex.length() % 2 != 0) {
+        throw std::invalid_argument("Hex string must have an even number of characters.");
+    }
+    std::vector<unsigned char> bytes;
+    bytes.reserve(hex.length() / 2);
+    for (std::size_t i = 0; i < hex.length(); i += 2) {
+        int high = pluginHexDigit(hex[i]);
+        int low = pluginHexDigit(hex[i + 1]);
+        if (high < 0 || low < 0) throw std::invalid_argument("Invalid character in hex string: " + hex.substr(i, 2));
+        bytes.push_back(static_cast<unsigned char>(high << 4 | low));
+    }
+    return bytes;
+}
+
+// Hex-строка ровно из 2 * size символов в массив out без выделения памяти
+// (для encode_into/decode_into); false — строка другой длины или с неверным символом.
+inline bool pluginHexToArray(const char* hex, unsigned char* out, std::size_t size) {
+    if (!hex) return false;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (!hex[2 * i] || !hex[2 * i + 1]) return false;
+        int high = pluginHexDigit(hex[2 * i]);
+        int low = pluginHexDigit(hex[2 * i + 1]);
+        if (high < 0 || low < 0) return false;
+        out[i] = static_cast<unsigned char>(high << 4 | low);
+    }
+    return hex[2 * size] == '\0';
+}
+
+// Память результатов выделяется через new[] и освобождается pluginFreeResult.
+inline char* pluginDuplicateString(const std::string& s) {
+    char* cstr = new char[s.length() + 1];
+    std::memcpy(cstr, s.c_str(), s.length() + 1);
+    return cstr;
+}
+
+inline CipherResultC pluginError(const std::string& message) {
+    CipherResultC result = {};
+    result.success = false;
+    result.message = pluginDuplicateString(message);
+    return result;
+}
+
+inline CipherResultC pluginSuccess(const std::string& message) {
+    CipherResultC result = {};
+    result.success = true;
+    result.message = pluginDuplicateString(message);
+    return result;
+}
+
+inline CipherResultC pluginData(const unsigned char* data, std::size_t size) {
+    CipherResultC result = {};
+    result.success = true;
+    result.data = new unsigned char[size ? size : 1];
+    if (size) std::memcpy(result.data, data, size);
+    result.data_size = size;
+    return result;
+}
+
+inline void pluginFreeResult(CipherResultC* result) {
+    if (!result) return;
+    delete[] result->message;
+    delete[] result->data;
+    delete[] result->key_hex;
+    delete[] result->iv_hex;
+    *result = {};
+}
+
+#endif // CIPHER_PLUGIN_UTIL_HPP
@@ -0,0 +1,38 @@
+#ifndef CIPHER_PROBES_H
+#define CIPHER_PROBES_H
+
+// Статические точки трассировки (USDT) в горячих путях шифров.
+//
+// При сборке с -DCIPHER_USDT (build.sh: CIPHER_USDT=1, CMake: -DCIPHER_USDT=ON)
+// CIPHER_PROBE(provider, name, args...) раскрывается в зонд sys/sdt.h: в коде
+// остаётся одна инструкция nop, а в ELF — запись .note.stapsdt, по которой
+// bpftrace, perf или SystemTap подключаются к работающему процессу без
+// пересборки и перезапуска. Без флага макрос пуст и аргументы не вычисляются.
+//
+// Провайдеры — gost, morse и rot13; зонды у всех одинаковые:
+//   chunk_start(offset, size), chunk_done(offset, size)  — обработка части данных
+//   key_setup(...)                                       — шифр подготовлен к работе
+//   pad(padding_len), unpad(padding_len, ok)             — дополнение PKCS7 (ГОСТ)
+//   read_start(size), read_done(bytes)                   — чтение входа
+//   write_start(size), write_done(bytes)                 — запись выхода
+// У gost есть также frame(offset, size, stored) — блок сжатого файла: позиция и
+// размер открытого текста и размер кадра (stored == size — блок без сжатия).
+// offset — позиция части от начала данных. Пары *_start/*_done в одном потоке
+// дают задержку, например:
+//   bpftrace -e 'usdt:./librot13_cipher.so:rot13:chunk_start { @t[tid] = nsecs; }
+//                usdt:./librot13_cipher.so:rot13:chunk_done /@t[tid]/ {
+//                    @us = hist((nsecs - @t[tid]) / 1000); delete(@t[tid]); }'
+
+#ifdef CIPHER_USDT
+#if defined(__has_include)
+#if !__has_include(<sys/sdt.h>)
+#error "CIPHER_USDT requires <sys/sdt.h> (systemtap-sdt-dev / systemtap-sdt-devel)"
+#endif
+#endif
+#include <sys/sdt.h>
+#define CIPHER_PROBE(provider, name, ...) STAP_PROBEV(provider, name, __VA_ARGS__)
+#else
+#define CIPHER_PROBE(provider, name, ...) ((void)0)
+#endif
+
+#endif // CIPHER_PROBES_H
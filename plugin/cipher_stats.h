@@ -0,0 +1,47 @@
+#ifndef CIPHER_STATS_H
+#define CIPHER_STATS_H
+
+// Статистика стадий обработки (cipher_tool --stats).
+//
+// Библиотеки шифров сообщают время и объём каждой стадии через обратный вызов,
+// переданный вызывающей стороной: в параметрах задания плагина
+// (CipherParamsC::stats) или в функциях *Stats_C мостов. Без приёмника (NULL)
+// замеры не выполняются.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Стадии (CipherStageStatsC::stage).
+#define CIPHER_STAGE_LOAD      0u  // загрузка библиотек шифров (только основная программа)
+#define CIPHER_STAGE_PARSE     1u  // разбор ключа, IV и hex-входа, подготовка шифра
+#define CIPHER_STAGE_READ      2u  // чтение входа
+#define CIPHER_STAGE_TRANSFORM 3u  // преобразование данных
+#define CIPHER_STAGE_WRITE     4u  // запись выхода
+#define CIPHER_STAGE_COUNT     5u
+
+// Один замер. Стадия, выполненная частями (по блокам, в нескольких потоках),
+// сообщается несколькими замерами — их суммирует получатель.
+typedef struct {
+    uint32_t stage;    // CIPHER_STAGE_*
+    uint64_t wall_ns;  // Астрономическое время
+    uint64_t cpu_ns;   // Процессорное время потока, выполнившего замер
+    uint64_t bytes;    // Обработано байт (0 — не применимо)
+} CipherStageStatsC;
+
+// Вызывается в потоке, выполнившем работу, поэтому при многопоточной обработке —
+// одновременно из нескольких потоков.
+typedef void (*CipherStatsFunc)(void* context, const CipherStageStatsC* stats);
+
+typedef struct CipherStatsSinkC {
+    CipherStatsFunc report;
+    void* context;
+} CipherStatsSinkC;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CIPHER_STATS_H
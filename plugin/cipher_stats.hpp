@@ -0,0 +1,85 @@
+#ifndef CIPHER_STATS_HPP
+#define CIPHER_STATS_HPP
+
+// Замер стадии для библиотек на C++ (см. cipher_stats.h). Всё объявлено inline,
+// чтобы каждая библиотека получала свою копию.
+
+#include "cipher_stats.h"
+#include <chrono>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Процессорное время вызывающего потока, нс.
+inline uint64_t cipherThreadCpuNs() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) return 0;
+    auto ticks = [](const FILETIME& t) { return (static_cast<uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime; };
+    return (ticks(kernel) + ticks(user)) * 100;
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000u + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+inline uint64_t cipherWallNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+// Замеряет стадию от создания до stop() или разрушения и сообщает результат
+// приёмнику. Без приёмника ничего не делает и часы не читает. pause()/resume()
+// исключают из замера вложенную работу другой стадии (например, запись).
+class CipherStageTimer {
+public:
+    CipherStageTimer(const CipherStatsSinkC* sink, uint32_t stage)
+        : sink_(sink && sink->report ? sink : nullptr), stage_(stage) {
+        resume();
+    }
+    ~CipherStageTimer() { stop(); }
+    CipherStageTimer(const CipherStageTimer&) = delete;
+    CipherStageTimer& operator=(const CipherStageTimer&) = delete;
+
+    void addBytes(uint64_t bytes) { bytes_ += bytes; }
+
+    void pause() {
+        if (!sink_ || !running_) return;
+        wall_ += cipherWallNs() - wallStart_;
+        cpu_ += cipherThreadCpuNs() - cpuStart_;
+        running_ = false;
+    }
+
+    void resume() {
+        if (!sink_ || running_) return;
+        wallStart_ = cipherWallNs();
+        cpuStart_ = cipherThreadCpuNs();
+        running_ = true;
+    }
+
+    void stop() {
+        if (!sink_) return;
+        pause();
+        CipherStageStatsC stats = {stage_, wall_, cpu_, bytes_};
+        sink_->report(sink_->context, &stats);
+        sink_ = nullptr;
+    }
+
+private:
+    const CipherStatsSinkC* sink_;
+    uint32_t stage_;
+    bool running_ = false;
+    uint64_t wallStart_ = 0, cpuStart_ = 0;
+    uint64_t wall_ = 0, cpu_ = 0, bytes_ = 0;
+};
+
+#endif // CIPHER_STATS_HPP
@@ -0,0 +1,166 @@
+#include "crc_framing.h"
+#include "crc32c.h"
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+static const unsigned char CRC_FRAME_MAGIC[8] = {'C', 'I', 'P', 'H', 'C', 'R', 'C', '1'};
+static const std::size_t CRC_FRAME_HEADER_SIZE = sizeof(CRC_FRAME_MAGIC) + 8;
+static const std::size_t CRC_FRAME_PREFIX_SIZE = 8;
+
+static void storeLe32(unsigned char* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out[i] = static_cast<unsigned char>(value >> (8 * i));
+}
+
+static uint32_t loadLe32(const unsigned char* in) {
+    return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8 | static_cast<uint32_t>(in[2]) << 16 |
+           static_cast<uint32_t>(in[3]) << 24;
+}
+
+static std::string hex32(uint32_t value) {
+    char text[11];
+    std::snprintf(text, sizeof(text), "0x%08x", value);
+    return text;
+}
+
+CrcFrameWriter::CrcFrameWriter(PipelineSink sink, uint32_t chunkSize)
+    : sink_(std::move(sink)), chunkSize_(std::min(std::max<uint32_t>(chunkSize, 1), CRC_FRAME_MAX_CHUNK_SIZE)) {}
+
+bool CrcFrameWriter::writeHeader(std::string& error) {
+    if (headerWritten_) return true;
+    unsigned char header[CRC_FRAME_HEADER_SIZE] = {};
+    std::copy(CRC_FRAME_MAGIC, CRC_FRAME_MAGIC + sizeof(CRC_FRAME_MAGIC), header);
+    storeLe32(header + 8, chunkSize_);
+    headerWritten_ = true;
+    return sink_(header, sizeof(header), error);
+}
+
+bool CrcFrameWriter::writeFrame(const unsigned char* data, std::size_t size, std::string& error) {
+    unsigned char prefix[CRC_FRAME_PREFIX_SIZE];
+    storeLe32(prefix, static_cast<uint32_t>(size));
+    storeLe32(prefix + 4, size ? cipher_crc32c(0, data, size) : 0);
+    return sink_(prefix, sizeof(prefix), error) && (size == 0 || sink_(data, size, error));
+}
+
+bool CrcFrameWriter::write(const unsigned char* data, std::size_t size, std::string& error) {
+    if (!writeHeader(error)) return false;
+    if (!pending_.empty()) {
+        std::size_t take = std::min<std::size_t>(size, chunkSize_ - pending_.size());
+        pending_.insert(pending_.end(), data, data + take);
+        data += take;
+        size -= take;
+        if (pending_.size() < chunkSize_) return true;
+        if (!writeFrame(pending_.data(), pending_.size(), error)) return false;
+        pending_.clear();
+    }
+    // Полные блоки идут в приёмник без копирования.
+    for (; size >= chunkSize_; data += chunkSize_, size -= chunkSize_) {
+        if (!writeFrame(data, chunkSize_, error)) return false;
+    }
+    pending_.insert(pending_.end(), data, data + size);
+    return true;
+}
+
+bool CrcFrameWriter::finish(std::string& error) {
+    if (!writeHeader(error)) return false;
+    if (!pending_.empty()) {
+        if (!writeFrame(pending_.data(), pending_.size(), error)) return false;
+        pending_.clear();
+    }
+    return writeFrame(nullptr, 0, error);
+}
+
+CrcFrameReader::CrcFrameReader(PipelineSource source) : source_(std::move(source)) {}
+
+bool CrcFrameReader::readExact(unsigned char* buffer, std::size_t size, std::size_t& got, std::string& error) {
+    got = 0;
+    while (got < size) {
+        std::size_t n = 0;
+        if (!source_(buffer + got, size - got, n, error)) return false;
+        if (n == 0) break;
+        got += n;
+    }
+    fileOffset_ += got;
+    return true;
+}
+
+bool CrcFrameReader::readHeader(std::string& error) {
+    unsigned char header[CRC_FRAME_HEADER_SIZE];
+    std::size_t got = 0;
+    if (!readExact(header, sizeof(header), got, error)) return false;
+    if (got < sizeof(header) || !std::equal(CRC_FRAME_MAGIC, CRC_FRAME_MAGIC + sizeof(CRC_FRAME_MAGIC), header)) {
+        error = "Вход не содержит кадров с контрольными суммами (--crc при шифровании не указывался?).";
+        return false;
+    }
+    chunkSize_ = loadLe32(header + 8);
+    if (chunkSize_ == 0 || chunkSize_ > CRC_FRAME_MAX_CHUNK_SIZE || loadLe32(header + 12) != 0) {
+        error = "Повреждён заголовок кадров с контрольными суммами.";
+        return false;
+    }
+    headerRead_ = true;
+    return true;
+}
+
+bool CrcFrameReader::nextFrame(std::string& error) {
+    uint64_t frameOffset = fileOffset_;
+    std::string where = "блок " + std::to_string(frameIndex_) + ", смещение в файле " + std::to_string(frameOffset);
+    unsigned char prefix[CRC_FRAME_PREFIX_SIZE];
+    std::size_t got = 0;
+    if (!readExact(prefix, sizeof(prefix), got, error)) return false;
+    if (got < sizeof(prefix)) {
+        error = "Файл обрезан: нет завершающего кадра (" + where + ").";
+        return false;
+    }
+    uint32_t size = loadLe32(prefix);
+    uint32_t expected = loadLe32(prefix + 4);
+    if (size == 0) {
+        if (expected != 0) {
+            error = "Повреждён завершающий кадр (" + where + ").";
+            return false;
+        }
+        unsigned char extra;
+        if (!readExact(&extra, 1, got, error)) return false;
+        if (got != 0) {
+            error = "Данные после завершающего кадра (смещение в файле " + std::to_string(fileOffset_ - 1) + ").";
+            return false;
+        }
+        finished_ = true;
+        frame_.clear();
+        position_ = 0;
+        return true;
+    }
+    if (size > chunkSize_) {
+        error = "Повреждён заголовок кадра (" + where + "): размер " + std::to_string(size) + ".";
+        return false;
+    }
+    frame_.resize(size);
+    if (!readExact(frame_.data(), size, got, error)) return false;
+    if (got < size) {
+        error = "Файл обрезан внутри кадра (" + where + ").";
+        return false;
+    }
+    uint32_t actual = cipher_crc32c(0, frame_.data(), size);
+    if (actual != expected) {
+        error = "Контрольная сумма не совпадает (" + where + ", данные " + std::to_string(dataOffset_) + "–" +
+                std::to_string(dataOffset_ + size - 1) + "): CRC32C " + hex32(actual) + ", ожидалась " +
+                hex32(expected) + ".";
+        return false;
+    }
+    position_ = 0;
+    ++frameIndex_;
+    dataOffset_ += size;
+    return true;
+}
+
+bool CrcFrameReader::read(unsigned char* buffer, std::size_t capacity, std::size_t& size, std::string& error) {
+    size = 0;
+    if (!headerRead_ && !readHeader(error)) return false;
+    while (position_ == frame_.size()) {
+        if (finished_) return true;
+        if (!nextFrame(error)) return false;
+    }
+    size = std::min(capacity, frame_.size() - position_);
+    std::copy(frame_.begin() + position_, frame_.begin() + position_ + size, buffer);
+    position_ += size;
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef CIPHER_CRC_FRAMING_H
+#define CIPHER_CRC_FRAMING_H
+
+// Кадры с контрольными суммами вокруг выхода шифров (--crc), чтобы повреждение
+// файла обнаруживалось при чтении, на первом испорченном блоке, а не после
+// расшифрования всего файла (или не обнаруживалось вовсе). Работает с любым
+// шифром и конвейером: при шифровании оборачивается приёмник, при
+// расшифровании — источник, и блок проверяется до передачи шифру.
+//
+// Формат: заголовок — сигнатура "CIPHCRC1", размер блока (uint32 LE) и резерв
+// (uint32, 0); затем кадры — размер данных (uint32 LE, от 1 до размера блока),
+// их CRC32C (uint32 LE, runtime/crc32c.h) и сами данные; в конце — кадр с
+// нулевыми размером и суммой. Файл без завершающего кадра считается обрезанным.
+
+#include "pipeline.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+const uint32_t CRC_FRAME_CHUNK_SIZE = 1u << 20;
+const uint32_t CRC_FRAME_MAX_CHUNK_SIZE = 64u << 20;
+
+// Разбивает записываемые данные на кадры и передаёт их в sink.
+class CrcFrameWriter {
+public:
+    explicit CrcFrameWriter(PipelineSink sink, uint32_t chunkSize = CRC_FRAME_CHUNK_SIZE);
+
+    // Сигнатура совпадает с PipelineSink.
+    bool write(const unsigned char* data, std::size_t size, std::string& error);
+    // Записывает неполный блок и завершающий кадр; вызывается после последней записи.
+    bool finish(std::string& error);
+
+private:
+    bool writeHeader(std::string& error);
+    bool writeFrame(const unsigned char* data, std::size_t size, std::string& error);
+
+    PipelineSink sink_;
+    uint32_t chunkSize_;
+    bool headerWritten_ = false;
+    std::vector<unsigned char> pending_;
+};
+
+// Читает кадры из source, проверяет их суммы и отдаёт данные. Ошибка сообщает
+// номер блока и его смещение в файле и в данных.
+class CrcFrameReader {
+public:
+    explicit CrcFrameReader(PipelineSource source);
+
+    // Сигнатура совпадает с PipelineSource.
+    bool read(unsigned char* buffer, std::size_t capacity, std::size_t& size, std::string& error);
+
+private:
+    bool readExact(unsigned char* buffer, std::size_t size, std::size_t& got, std::string& error);
+    bool readHeader(std::string& error);
+    bool nextFrame(std::string& error);
+
+    PipelineSource source_;
+    bool headerRead_ = false;
+    bool finished_ = false;
+    uint32_t chunkSize_ = 0;
+    std::vector<unsigned char> frame_;
+    std::size_t position_ = 0;
+    uint64_t frameIndex_ = 0;
+    uint64_t fileOffset_ = 0;
+    uint64_t dataOffset_ = 0;
+};
+
+#endif // CIPHER_CRC_FRAMING_H
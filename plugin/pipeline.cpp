@@ -0,0 +1,229 @@
+#include "pipeline.h"
+#include "cipher_stats.hpp"
+#include "plugin_host.h"
+#include "spsc_ring.h"
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Размер кольца между стадиями и части, которой читается источник.
+static const std::size_t PIPELINE_RING_SIZE = 1u << 20;
+static const std::size_t PIPELINE_READ_SIZE = 256u * 1024u;
+
+namespace {
+
+// Общее состояние запуска: первая ошибка отменяет все кольца, остальные
+// (обычно следствия отмены) отбрасываются.
+class PipelineRun {
+public:
+    explicit PipelineRun(std::size_t stages) {
+        for (std::size_t i = 0; i <= stages; ++i) {
+            rings_.emplace_back(new SpscRing(PIPELINE_RING_SIZE));
+        }
+    }
+
+    SpscRing& ring(std::size_t index) { return *rings_[index]; }
+
+    void fail(const std::string& message) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_.empty()) return;
+            error_ = message.empty() ? "Error: pipeline failed." : message;
+        }
+        for (auto& ring : rings_) ring->cancel();
+    }
+
+    std::string error() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_;
+    }
+
+private:
+    std::vector<std::unique_ptr<SpscRing>> rings_;
+    std::mutex mutex_;
+    std::string error_;
+};
+
+// Проверяет и освобождает результат вызова плагина.
+bool takeResult(const CipherPluginDescriptor* plugin, CipherResultC& result, PipelineRun& run) {
+    bool success = result.success;
+    if (!success) {
+        run.fail(result.message ? result.message : std::string("Error: ") + plugin->name + " failed.");
+    }
+    plugin->free_result(&result);
+    return success;
+}
+
+// Выход потоковой стадии. Пока следующая стадия не освободит место в кольце,
+// замер преобразования приостановлен.
+struct StageOutput {
+    SpscRing* ring;
+    CipherStageTimer* timer;
+};
+
+bool ringSink(void* context, const unsigned char* data, std::size_t size) {
+    StageOutput* output = static_cast<StageOutput*>(context);
+    output->timer->pause();
+    bool accepted = output->ring->write(data, size);
+    output->timer->resume();
+    return accepted;
+}
+
+void runChunkedStage(const PipelineStage& stage, bool encode, const CipherParamsC& params, SpscRing& in,
+                     SpscRing& out, PipelineRun& run) {
+    const CipherPluginDescriptor* plugin = stage.plugin;
+    void* stream = nullptr;
+    CipherResultC result = plugin->stream_open(encode, &params, &stream);
+    if (!takeResult(plugin, result, run)) return;
+
+    bool ok = true;
+    const unsigned char* data = nullptr;
+    while (ok) {
+        std::size_t size = in.peek(&data);
+        if (size == 0) break;
+        CipherStageTimer timer(stage.stats, CIPHER_STAGE_TRANSFORM);
+        StageOutput output = {&out, &timer};
+        result = plugin->stream_update(stream, data, size, ringSink, &output);
+        timer.addBytes(size);
+        timer.stop();
+        ok = takeResult(plugin, result, run);
+        in.consume(size);
+    }
+    if (ok && !in.cancelled()) {
+        CipherStageTimer timer(stage.stats, CIPHER_STAGE_TRANSFORM);
+        StageOutput output = {&out, &timer};
+        result = plugin->stream_finish(stream, ringSink, &output);
+        timer.stop();
+        takeResult(plugin, result, run);
+    }
+    plugin->stream_close(stream);
+}
+
+void runBufferStage(const PipelineStage& stage, bool encode, const CipherParamsC& params, SpscRing& in,
+                    SpscRing& out, PipelineRun& run) {
+    std::vector<unsigned char> input;
+    const unsigned char* data = nullptr;
+    while (std::size_t size = in.peek(&data)) {
+        input.insert(input.end(), data, data + size);
+        in.consume(size);
+    }
+    if (in.cancelled()) return;
+
+    // Сначала без лишней копии результата; при ошибке буферный вызов даст её текст.
+    const CipherPluginDescriptor* plugin = stage.plugin;
+    std::vector<unsigned char> output;
+    CipherStageTimer timer(stage.stats, CIPHER_STAGE_TRANSFORM);
+    timer.addBytes(input.size());
+    if (pluginTransformInto(*plugin, encode, input.data(), input.size(), &params, output)) {
+        timer.stop();
+        out.write(output.data(), output.size());
+        return;
+    }
+    CipherBufferFunc function = encode ? plugin->encode_buffer : plugin->decode_buffer;
+    CipherResultC result = function(input.data(), input.size(), &params);
+    timer.stop();
+    if (result.success) {
+        out.write(result.data, result.data_size);
+    }
+    takeResult(plugin, result, run);
+}
+
+} // namespace
+
+std::string validatePipeline(const std::vector<PipelineStage>& stages) {
+    if (stages.empty()) return "Error: pipeline has no stages.";
+    for (const PipelineStage& stage : stages) {
+        const CipherPluginDescriptor* plugin = stage.plugin;
+        bool chunked = pluginHasStreams(*plugin);
+        if (!chunked && !(plugin->capabilities & CIPHER_CAP_BUFFER)) {
+            return std::string("Error: cipher '") + plugin->name + "' cannot be used in a pipeline.";
+        }
+        // IV шифра с ключом передаётся внутри потока только потоковым API.
+        if (!chunked && (plugin->capabilities & CIPHER_CAP_KEYED)) {
+            return std::string("Error: keyed cipher '") + plugin->name + "' does not support chunked streams.";
+        }
+    }
+    return "";
+}
+
+PipelineResult runPipeline(const std::vector<PipelineStage>& stages, bool encrypt, const std::string& key_hex,
+                           const std::string& iv_hex, const PipelineSource& source, const PipelineSink& sink,
+                           const CipherStatsSinkC* stats) {
+    PipelineResult pipelineResult;
+    pipelineResult.message = validatePipeline(stages);
+    if (!pipelineResult.message.empty()) return pipelineResult;
+
+    std::vector<PipelineStage> order(stages);
+    if (!encrypt) order.assign(stages.rbegin(), stages.rend());
+
+    PipelineRun run(order.size());
+    std::vector<std::thread> threads;
+
+    threads.emplace_back([&] {
+        SpscRing& out = run.ring(0);
+        try {
+            std::vector<unsigned char> buffer(PIPELINE_READ_SIZE);
+            for (;;) {
+                std::size_t size = 0;
+                std::string error;
+                CipherStageTimer timer(stats, CIPHER_STAGE_READ);
+                if (!source(buffer.data(), buffer.size(), size, error)) {
+                    run.fail(error);
+                    break;
+                }
+                timer.addBytes(size);
+                timer.stop();
+                if (size == 0 || !out.write(buffer.data(), size)) break;
+            }
+        } catch (const std::exception& e) {
+            run.fail(std::string("Error: ") + e.what());
+        }
+        out.close();
+    });
+
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        threads.emplace_back([&, i] {
+            const PipelineStage& stage = order[i];
+            CipherParamsC params = {};
+            params.options = stage.options.c_str();
+            params.stats = stage.stats;
+            if (stage.plugin->capabilities & CIPHER_CAP_KEYED) {
+                params.key_hex = key_hex.c_str();
+                if (encrypt) params.iv_hex = iv_hex.c_str();
+            }
+            SpscRing& in = run.ring(i);
+            SpscRing& out = run.ring(i + 1);
+            try {
+                if (pluginHasStreams(*stage.plugin)) {
+                    runChunkedStage(stage, encrypt, params, in, out, run);
+                } else {
+                    runBufferStage(stage, encrypt, params, in, out, run);
+                }
+            } catch (const std::exception& e) {
+                run.fail(std::string("Error: ") + stage.plugin->name + ": " + e.what());
+            }
+            out.close();
+        });
+    }
+
+    SpscRing& last = run.ring(order.size());
+    const unsigned char* data = nullptr;
+    while (std::size_t size = last.peek(&data)) {
+        std::string error;
+        CipherStageTimer timer(stats, CIPHER_STAGE_WRITE);
+        if (!sink(data, size, error)) {
+            run.fail(error);
+            break;
+        }
+        timer.addBytes(size);
+        timer.stop();
+        last.consume(size);
+    }
+
+    for (std::thread& thread : threads) thread.join();
+
+    pipelineResult.message = run.error();
+    pipelineResult.success = pipelineResult.message.empty();
+    if (pipelineResult.success) pipelineResult.message = "Pipeline completed successfully.";
+    return pipelineResult;
+}
@@ -0,0 +1,51 @@
+#ifndef CIPHER_PIPELINE_H
+#define CIPHER_PIPELINE_H
+
+// Конвейер шифров: данные проходят через несколько плагинов подряд
+// (--cipher rot13,morse,gost). Каждая стадия работает в своём потоке, соседние
+// стадии связаны кольцевыми буферами SPSC (plugin/spsc_ring.h), так что стадии
+// обрабатывают разные части данных одновременно, а промежуточные результаты не
+// пишутся на диск. При расшифровании стадии применяются в обратном порядке.
+//
+// Стадии с CIPHER_CAP_CHUNKED обрабатывают поток частями. Остальные накапливают
+// весь свой вход и вызывают encode_buffer/decode_buffer один раз.
+
+#include "cipher_plugin.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct PipelineStage {
+    const CipherPluginDescriptor* plugin = nullptr;
+    std::string options;  // CipherParamsC::options этой стадии
+    // Приёмник статистики стадии (NULL — без замеров): передаётся плагину, а
+    // конвейер сообщает в него время преобразования без ожидания соседних стадий.
+    const CipherStatsSinkC* stats = nullptr;
+};
+
+// Источник заполняет buffer и возвращает число байт в size (0 — конец данных);
+// false — ошибка чтения, её текст в error.
+using PipelineSource = std::function<bool(unsigned char* buffer, std::size_t capacity, std::size_t& size,
+                                          std::string& error)>;
+// Приёмник результата; false — ошибка записи, её текст в error.
+using PipelineSink = std::function<bool(const unsigned char* data, std::size_t size, std::string& error)>;
+
+struct PipelineResult {
+    bool success = false;
+    std::string message;
+};
+
+// Проверяет, что каждая стадия умеет обрабатывать буферы или поток. Пустая строка — всё в порядке.
+std::string validatePipeline(const std::vector<PipelineStage>& stages);
+
+// stages перечислены в порядке шифрования. key_hex передаётся стадиям с
+// CIPHER_CAP_KEYED, iv_hex — им же при шифровании (пустой — случайный; IV
+// записывается в начало выхода стадии и при расшифровании читается оттуда же).
+// Источник вызывается в отдельном потоке, приёмник — в вызывающем; время их
+// работы сообщается в stats как чтение и запись.
+PipelineResult runPipeline(const std::vector<PipelineStage>& stages, bool encrypt, const std::string& key_hex,
+                           const std::string& iv_hex, const PipelineSource& source, const PipelineSink& sink,
+                           const CipherStatsSinkC* stats = nullptr);
+
+#endif // CIPHER_PIPELINE_H
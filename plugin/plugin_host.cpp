@@ -0,0 +1,201 @@
+#include "plugin_host.h"
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+// Минимальный размер дескриптора версии 1 — до поля free_result включительно.
+static const std::size_t DESCRIPTOR_V1_SIZE =
+    offsetof(CipherPluginDescriptor, free_result) + sizeof(CipherFreeResultFunc);
+// Размер дескриптора с потоковыми функциями.
+static const std::size_t DESCRIPTOR_STREAM_SIZE =
+    offsetof(CipherPluginDescriptor, stream_close) + sizeof(CipherStreamCloseFunc);
+// Размер дескриптора с encode_into/decode_into.
+static const std::size_t DESCRIPTOR_INTO_SIZE =
+    offsetof(CipherPluginDescriptor, decode_into) + sizeof(CipherIntoFunc);
+// Размер дескриптора с дополнительными действиями над файлами.
+static const std::size_t DESCRIPTOR_FILE_ACTIONS_SIZE =
+    offsetof(CipherPluginDescriptor, file_action_count) + sizeof(size_t);
+
+static void closeLibrary(void* handle) {
+    if (!handle) return;
+#ifdef _WIN32
+    FreeLibrary(static_cast<HMODULE>(handle));
+#else
+    dlclose(handle);
+#endif
+}
+
+static bool isLibraryPath(const std::filesystem::path& path) {
+    // Общий пул потоков (runtime/cipher_runtime.h) лежит рядом с плагинами, но плагином не является.
+    if (path.stem() == "libcipher_runtime") return false;
+    std::string extension = path.extension().string();
+#ifdef _WIN32
+    return extension == ".dll";
+#else
+    return extension == ".so" || extension == ".dylib";
+#endif
+}
+
+std::string validatePluginDescriptor(const CipherPluginDescriptor* descriptor) {
+    if (!descriptor) return "descriptor is null";
+    if (descriptor->abi_version != CIPHER_PLUGIN_ABI_VERSION) {
+        return "unsupported ABI version " + std::to_string(descriptor->abi_version) + " (expected " +
+               std::to_string(CIPHER_PLUGIN_ABI_VERSION) + ")";
+    }
+    if (descriptor->struct_size < DESCRIPTOR_V1_SIZE) {
+        return "descriptor is too small (" + std::to_string(descriptor->struct_size) + " bytes)";
+    }
+    if (!descriptor->name || !*descriptor->name) return "cipher name is empty";
+    if (!descriptor->free_result) return "free_result is missing";
+
+    uint32_t caps = descriptor->capabilities;
+    if ((caps & CIPHER_CAP_BUFFER) && (!descriptor->encode_buffer || !descriptor->decode_buffer)) {
+        return "buffer capability declared without encode_buffer/decode_buffer";
+    }
+    if ((caps & CIPHER_CAP_FILE) && (!descriptor->encode_file || !descriptor->decode_file)) {
+        return "file capability declared without encode_file/decode_file";
+    }
+    if ((caps & (CIPHER_CAP_IN_PLACE | CIPHER_CAP_PARALLEL | CIPHER_CAP_STREAMING | CIPHER_CAP_DIRECT_IO)) && !(caps & CIPHER_CAP_FILE)) {
+        return "file job capabilities declared without file capability";
+    }
+    if ((caps & CIPHER_CAP_BATCH) && (!descriptor->encode_batch || !descriptor->decode_batch)) {
+        return "batch capability declared without encode_batch/decode_batch";
+    }
+    if ((caps & CIPHER_CAP_KEYGEN) && !descriptor->generate_key) {
+        return "keygen capability declared without generate_key";
+    }
+    if ((caps & CIPHER_CAP_CHUNKED) && !pluginHasStreams(*descriptor)) {
+        return "chunked capability declared without stream_open/stream_update/stream_finish/stream_close";
+    }
+    if ((caps & CIPHER_CAP_INTO) && !pluginHasInto(*descriptor)) {
+        return "into capability declared without encode_into/decode_into";
+    }
+    if (descriptor->struct_size >= DESCRIPTOR_FILE_ACTIONS_SIZE && descriptor->file_action_count > 0) {
+        if (!(caps & CIPHER_CAP_FILE)) return "file actions declared without file capability";
+        if (!descriptor->file_actions) return "file_actions is missing";
+        for (size_t i = 0; i < descriptor->file_action_count; ++i) {
+            if (!descriptor->file_actions[i].label || !descriptor->file_actions[i].options) {
+                return "file action " + std::to_string(i) + " has no label or options";
+            }
+        }
+    }
+    return "";
+}
+
+size_t pluginFileActionCount(const CipherPluginDescriptor& descriptor) {
+    if (!(descriptor.capabilities & CIPHER_CAP_FILE) || descriptor.struct_size < DESCRIPTOR_FILE_ACTIONS_SIZE ||
+        !descriptor.file_actions) {
+        return 0;
+    }
+    return descriptor.file_action_count;
+}
+
+bool pluginHasInto(const CipherPluginDescriptor& descriptor) {
+    return (descriptor.capabilities & CIPHER_CAP_INTO) && descriptor.struct_size >= DESCRIPTOR_INTO_SIZE &&
+           descriptor.encode_into && descriptor.decode_into;
+}
+
+bool pluginTransformInto(const CipherPluginDescriptor& descriptor, bool encode, const unsigned char* data,
+                         size_t size, const CipherParamsC* params, std::vector<unsigned char>& out) {
+    if (!pluginHasInto(descriptor)) return false;
+    CipherIntoFunc transform = encode ? descriptor.encode_into : descriptor.decode_into;
+    size_t required = 0;
+    int status = transform(data, size, nullptr, 0, &required, params);
+    if (status != CIPHER_STATUS_OK && status != CIPHER_STATUS_BUFFER_TOO_SMALL) return false;
+    out.resize(required);
+    status = transform(data, size, out.data(), out.size(), &required, params);
+    out.resize(required);
+    return status == CIPHER_STATUS_OK;
+}
+
+bool pluginHasStreams(const CipherPluginDescriptor& descriptor) {
+    return (descriptor.capabilities & CIPHER_CAP_CHUNKED) && descriptor.struct_size >= DESCRIPTOR_STREAM_SIZE &&
+           descriptor.stream_open && descriptor.stream_update && descriptor.stream_finish && descriptor.stream_close;
+}
+
+PluginRegistry::~PluginRegistry() {
+    for (LoadedPlugin& plugin : plugins_) {
+        closeLibrary(plugin.handle);
+    }
+}
+
+void PluginRegistry::discover(const std::string& directory, std::vector<std::string>& errors) {
+    std::error_code ec;
+    std::vector<std::filesystem::path> candidates;
+    for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec) && isLibraryPath(it->path())) {
+            candidates.push_back(it->path());
+        }
+    }
+    if (ec) {
+        errors.push_back(directory + ": " + ec.message());
+        return;
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const std::filesystem::path& candidate : candidates) {
+        std::string error;
+        if (!load(candidate.string(), error)) {
+            errors.push_back(candidate.string() + ": " + error);
+        }
+    }
+}
+
+bool PluginRegistry::add(const CipherPluginDescriptor* descriptor, const std::string& source, std::string& error) {
+    error = validatePluginDescriptor(descriptor);
+    if (!error.empty()) return false;
+    if (const CipherPluginDescriptor* existing = find(descriptor->name)) {
+        auto same = std::find_if(plugins_.begin(), plugins_.end(),
+                                 [&](const LoadedPlugin& plugin) { return plugin.descriptor == existing; });
+        error = std::string("cipher '") + descriptor->name + "' is already provided by " + same->path;
+        return false;
+    }
+    plugins_.push_back({nullptr, source, descriptor});
+    return true;
+}
+
+bool PluginRegistry::load(const std::string& path, std::string& error) {
+#ifdef _WIN32
+    HMODULE module = LoadLibraryA(path.c_str());
+    if (!module) {
+        error = "cannot load library (error " + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+    void* handle = module;
+    void* symbol = reinterpret_cast<void*>(GetProcAddress(module, CIPHER_PLUGIN_SYMBOL));
+#else
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        const char* message = dlerror();
+        error = message ? message : "cannot load library";
+        return false;
+    }
+    void* symbol = dlsym(handle, CIPHER_PLUGIN_SYMBOL);
+#endif
+    if (!symbol) {
+        closeLibrary(handle);
+        error = "no " CIPHER_PLUGIN_SYMBOL " symbol";
+        return false;
+    }
+
+    if (!add(static_cast<const CipherPluginDescriptor*>(symbol), path, error)) {
+        closeLibrary(handle);
+        return false;
+    }
+    plugins_.back().handle = handle;
+    return true;
+}
+
+const CipherPluginDescriptor* PluginRegistry::find(const std::string& name) const {
+    for (const LoadedPlugin& plugin : plugins_) {
+        if (name == plugin.descriptor->name) return plugin.descriptor;
+    }
+    return nullptr;
+}
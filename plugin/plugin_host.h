@@ -0,0 +1,63 @@
+#ifndef CIPHER_PLUGIN_HOST_H
+#define CIPHER_PLUGIN_HOST_H
+
+#include "cipher_plugin.h"
+#include <string>
+#include <vector>
+
+// Загруженный плагин. handle — дескриптор библиотеки (nullptr, если дескриптор
+// зарегистрирован напрямую), path — откуда он получен.
+struct LoadedPlugin {
+    void* handle = nullptr;
+    std::string path;
+    const CipherPluginDescriptor* descriptor = nullptr;
+};
+
+// Проверяет дескриптор: версию ABI, размер структуры, имя, free_result и наличие
+// точек входа для каждой заявленной возможности. Пустая строка — дескриптор корректен.
+std::string validatePluginDescriptor(const CipherPluginDescriptor* descriptor);
+
+// Заявлены ли потоковые функции и покрывает ли их дескриптор (плагины первой
+// версии ABI собраны с дескриптором без них).
+bool pluginHasStreams(const CipherPluginDescriptor& descriptor);
+
+// Заявлены ли encode_into/decode_into и покрывает ли их дескриптор.
+bool pluginHasInto(const CipherPluginDescriptor& descriptor);
+
+// Число дополнительных действий над файлами (file_actions), которые покрывает
+// дескриптор; 0 — действий нет.
+size_t pluginFileActionCount(const CipherPluginDescriptor& descriptor);
+
+// Преобразует данные через encode_into/decode_into: запрос размера и запись
+// прямо в out. false — функции не заявлены или плагин сообщил об ошибке; тогда
+// подробности даст encode_buffer/decode_buffer.
+bool pluginTransformInto(const CipherPluginDescriptor& descriptor, bool encode, const unsigned char* data,
+                         size_t size, const CipherParamsC* params, std::vector<unsigned char>& out);
+
+// Реестр плагинов. Библиотеки загружаются с немедленным связыванием (RTLD_NOW),
+// так что неразрешённые зависимости плагина обнаруживаются при загрузке, а не
+// посреди работы. Библиотеки выгружаются при уничтожении реестра.
+class PluginRegistry {
+public:
+    PluginRegistry() = default;
+    ~PluginRegistry();
+    PluginRegistry(const PluginRegistry&) = delete;
+    PluginRegistry& operator=(const PluginRegistry&) = delete;
+
+    // Загружает все библиотеки (*.so, *.dylib, *.dll) из каталога в порядке имён.
+    // Библиотеки без корректного дескриптора пропускаются с сообщением в errors.
+    void discover(const std::string& directory, std::vector<std::string>& errors);
+
+    // Регистрирует дескриптор, уже находящийся в памяти процесса.
+    bool add(const CipherPluginDescriptor* descriptor, const std::string& source, std::string& error);
+
+    const CipherPluginDescriptor* find(const std::string& name) const;
+    const std::vector<LoadedPlugin>& plugins() const { return plugins_; }
+
+private:
+    bool load(const std::string& path, std::string& error);
+
+    std::vector<LoadedPlugin> plugins_;
+};
+
+#endif // CIPHER_PLUGIN_HOST_H
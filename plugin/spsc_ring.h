@@ -0,0 +1,106 @@
+#ifndef CIPHER_SPSC_RING_H
+#define CIPHER_SPSC_RING_H
+
+// Кольцевой буфер байт с одним писателем и одним читателем (SPSC) — канал между
+// соседними стадиями конвейера. Счётчики head/tail только растут и лежат в
+// разных строках кэша, поэтому стороны не делят запись в одну строку; блокировок
+// нет. Если буфер полон, писатель ждёт (обратное давление), если пуст — читатель.
+// cancel() будит обе стороны и прекращает обмен.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+class SpscRing {
+public:
+    // capacity округляется вверх до степени двойки.
+    explicit SpscRing(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) size <<= 1;
+        capacity_ = size;
+        mask_ = size - 1;
+        buffer_.reset(new unsigned char[size]);
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Писатель. Возвращает false, если обмен отменён.
+    bool write(const unsigned char* data, std::size_t size) {
+        std::uint64_t head = head_.load(std::memory_order_relaxed);
+        unsigned spins = 0;
+        while (size > 0) {
+            if (cancelled_.load(std::memory_order_relaxed)) return false;
+            std::size_t space = capacity_ - static_cast<std::size_t>(head - tail_.load(std::memory_order_acquire));
+            if (space == 0) {
+                backoff(spins);
+                continue;
+            }
+            spins = 0;
+            std::size_t position = static_cast<std::size_t>(head) & mask_;
+            std::size_t chunk = std::min({size, space, capacity_ - position});
+            std::memcpy(buffer_.get() + position, data, chunk);
+            head += chunk;
+            head_.store(head, std::memory_order_release);
+            data += chunk;
+            size -= chunk;
+        }
+        return !cancelled_.load(std::memory_order_relaxed);
+    }
+
+    // Писатель: данных больше не будет.
+    void close() { closed_.store(true, std::memory_order_release); }
+
+    // Читатель. Ждёт данных и возвращает непрерывный участок; size == 0 — поток
+    // закончился (или обмен отменён, см. cancelled()). После обработки участка
+    // нужно вызвать consume.
+    std::size_t peek(const unsigned char** data) {
+        std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+        unsigned spins = 0;
+        for (;;) {
+            if (cancelled_.load(std::memory_order_relaxed)) return 0;
+            bool closed = closed_.load(std::memory_order_acquire);
+            std::size_t available = static_cast<std::size_t>(head_.load(std::memory_order_acquire) - tail);
+            if (available > 0) {
+                std::size_t position = static_cast<std::size_t>(tail) & mask_;
+                *data = buffer_.get() + position;
+                return std::min(available, capacity_ - position);
+            }
+            if (closed) return 0;
+            backoff(spins);
+        }
+    }
+
+    void consume(std::size_t size) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + size, std::memory_order_release);
+    }
+
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+private:
+    // Короткое ожидание уступает процессор, длинное — засыпает, чтобы простаивающая
+    // стадия не занимала ядро.
+    static void backoff(unsigned& spins) {
+        if (++spins < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    alignas(64) std::atomic<std::uint64_t> head_{0};
+    alignas(64) std::atomic<std::uint64_t> tail_{0};
+    alignas(64) std::atomic<bool> closed_{false};
+    std::atomic<bool> cancelled_{false};
+    std::size_t capacity_ = 0;
+    std::size_t mask_ = 0;
+    std::unique_ptr<unsigned char[]> buffer_;
+};
+
+#endif // CIPHER_SPSC_RING_H
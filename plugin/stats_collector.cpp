@@ -0,0 +1,175 @@
+#include "stats_collector.h"
+#include "cipher_stats.hpp"
+#include <cstdio>
+#include <sstream>
+
+#ifdef _WIN32
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+static const char* const STAGE_NAMES[CIPHER_STAGE_COUNT] = {"load", "parse", "read", "transform", "write"};
+
+// Процессорное время всех потоков процесса, нс.
+static uint64_t processCpuNs() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0;
+    auto ticks = [](const FILETIME& t) { return (static_cast<uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime; };
+    return (ticks(kernel) + ticks(user)) * 100;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    auto ns = [](const timeval& t) {
+        return static_cast<uint64_t>(t.tv_sec) * 1000000000u + static_cast<uint64_t>(t.tv_usec) * 1000u;
+    };
+    return ns(usage.ru_utime) + ns(usage.ru_stime);
+#endif
+}
+
+// Пиковый объём резидентной памяти процесса, КиБ.
+static uint64_t peakRssKiB() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss) / 1024;  // в байтах
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+static double toMs(uint64_t ns) {
+    return static_cast<double>(ns) / 1e6;
+}
+
+// МБ/с (10^6 байт), 0 — нет данных.
+static double megabytesPerSecond(uint64_t bytes, uint64_t ns) {
+    return ns ? static_cast<double>(bytes) / 1e6 / (static_cast<double>(ns) / 1e9) : 0.0;
+}
+
+static std::string jsonString(const std::string& text) {
+    std::string result = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+            result += escaped;
+        } else {
+            result += c;
+        }
+    }
+    return result + "\"";
+}
+
+static std::string fixed(double value, int digits) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return buffer;
+}
+
+// Выравнивает text по ширине |width| символов UTF-8: width < 0 — по левому краю.
+static std::string column(const std::string& text, int width) {
+    int length = 0;
+    for (char c : text) {
+        if ((static_cast<unsigned char>(c) & 0xC0) != 0x80) ++length;
+    }
+    int padding = (width < 0 ? -width : width) - length;
+    if (padding <= 0) return width < 0 ? text + " " : " " + text;
+    return width < 0 ? text + std::string(padding, ' ') : std::string(padding, ' ') + text;
+}
+
+StatsCollector::StatsCollector() : startWallNs_(cipherWallNs()), startCpuNs_(processCpuNs()) {}
+
+const CipherStatsSinkC* StatsCollector::sink(const std::string& cipher) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Source& source : sources_) {
+        if (source.cipher == cipher) return &source.sink;
+    }
+    sources_.emplace_back();
+    Source& source = sources_.back();
+    source.owner = this;
+    source.cipher = cipher;
+    source.sink.report = receive;
+    source.sink.context = &source;
+    return &source.sink;
+}
+
+void StatsCollector::receive(void* context, const CipherStageStatsC* stats) {
+    Source* source = static_cast<Source*>(context);
+    if (!stats || stats->stage >= CIPHER_STAGE_COUNT) return;
+    std::lock_guard<std::mutex> lock(source->owner->mutex_);
+    StageTotals& totals = source->stages[stats->stage];
+    ++totals.calls;
+    totals.wall_ns += stats->wall_ns;
+    totals.cpu_ns += stats->cpu_ns;
+    totals.bytes += stats->bytes;
+    totals.threads.insert(std::this_thread::get_id());
+    source->owner->threads_.insert(std::this_thread::get_id());
+}
+
+// Время стадии — сумма замеров: у стадии, выполненной в нескольких потоках, оно
+// больше астрономического. Загрузка потоков — доля процессорного времени
+// процесса от времени работы всех потоков, сообщавших замеры.
+std::string StatsCollector::report(bool json) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t wallNs = cipherWallNs() - startWallNs_;
+    uint64_t cpuNs = processCpuNs() - startCpuNs_;
+    std::size_t threads = threads_.empty() ? 1 : threads_.size();
+    double utilization = wallNs ? static_cast<double>(cpuNs) / (static_cast<double>(wallNs) * threads) : 0.0;
+    uint64_t rss = peakRssKiB();
+
+    std::ostringstream out;
+    if (json) {
+        out << "{\"wall_ms\":" << fixed(toMs(wallNs), 3) << ",\"cpu_ms\":" << fixed(toMs(cpuNs), 3)
+            << ",\"threads\":" << threads << ",\"thread_utilization\":" << fixed(utilization, 3)
+            << ",\"peak_rss_kib\":" << rss << ",\"stages\":[";
+        bool first = true;
+        for (const Source& source : sources_) {
+            for (uint32_t stage = 0; stage < CIPHER_STAGE_COUNT; ++stage) {
+                const StageTotals& totals = source.stages[stage];
+                if (!totals.calls) continue;
+                out << (first ? "" : ",") << "{\"stage\":\"" << STAGE_NAMES[stage] << "\",\"cipher\":"
+                    << (source.cipher.empty() ? std::string("null") : jsonString(source.cipher))
+                    << ",\"calls\":" << totals.calls << ",\"wall_ms\":" << fixed(toMs(totals.wall_ns), 3)
+                    << ",\"cpu_ms\":" << fixed(toMs(totals.cpu_ns), 3) << ",\"bytes\":" << totals.bytes
+                    << ",\"mb_per_s\":" << fixed(megabytesPerSecond(totals.bytes, totals.wall_ns), 2)
+                    << ",\"threads\":" << totals.threads.size() << "}";
+                first = false;
+            }
+        }
+        out << "]}\n";
+        return out.str();
+    }
+
+    auto row = [&out](const std::string& stage, const std::string& cipher, const std::string& calls,
+                      const std::string& wall, const std::string& cpu, const std::string& bytes,
+                      const std::string& rate, const std::string& threads) {
+        out << "  " << column(stage, -10) << column(cipher, -9) << column(calls, 7) << column(wall, 13)
+            << column(cpu, 13) << column(bytes, 15) << column(rate, 11) << column(threads, 8) << "\n";
+    };
+    out << "Статистика по стадиям (время — сумма по потокам):\n";
+    row("стадия", "шифр", "вызовы", "время, мс", "CPU, мс", "байт", "МБ/с", "потоки");
+    for (const Source& source : sources_) {
+        for (uint32_t stage = 0; stage < CIPHER_STAGE_COUNT; ++stage) {
+            const StageTotals& totals = source.stages[stage];
+            if (!totals.calls) continue;
+            row(STAGE_NAMES[stage], source.cipher.empty() ? "-" : source.cipher, std::to_string(totals.calls),
+                fixed(toMs(totals.wall_ns), 3), fixed(toMs(totals.cpu_ns), 3), std::to_string(totals.bytes),
+                totals.bytes ? fixed(megabytesPerSecond(totals.bytes, totals.wall_ns), 1) : "-",
+                std::to_string(totals.threads.size()));
+        }
+    }
+    out << "Всего: " << fixed(toMs(wallNs), 3) << " мс, CPU " << fixed(toMs(cpuNs), 3) << " мс, потоков " << threads
+        << ", загрузка потоков " << fixed(utilization * 100, 1) << "%, пиковый RSS " << rss << " КиБ\n";
+    return out.str();
+}
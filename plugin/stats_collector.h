@@ -0,0 +1,57 @@
+#ifndef CIPHER_STATS_COLLECTOR_H
+#define CIPHER_STATS_COLLECTOR_H
+
+// Сбор статистики стадий для cipher_tool --stats: замеры библиотек шифров
+// (cipher_stats.h) и самой программы суммируются по шифру и стадии, к ним
+// добавляются итоги процесса — время, процессорное время, число потоков и
+// пиковый объём резидентной памяти.
+
+#include "cipher_stats.h"
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+class StatsCollector {
+public:
+    StatsCollector();
+    StatsCollector(const StatsCollector&) = delete;
+    StatsCollector& operator=(const StatsCollector&) = delete;
+
+    // Приёмник замеров шифра cipher; пустое имя — сама программа. Повторный
+    // вызов с тем же именем возвращает тот же приёмник. Указатель действителен,
+    // пока существует сборщик; приёмник можно вызывать из любого потока.
+    const CipherStatsSinkC* sink(const std::string& cipher);
+
+    // Отчёт: таблица для человека или одна строка JSON.
+    std::string report(bool json) const;
+
+private:
+    struct StageTotals {
+        uint64_t calls = 0;
+        uint64_t wall_ns = 0;
+        uint64_t cpu_ns = 0;
+        uint64_t bytes = 0;
+        std::set<std::thread::id> threads;
+    };
+
+    struct Source {
+        StatsCollector* owner = nullptr;
+        std::string cipher;
+        CipherStatsSinkC sink = {};
+        std::array<StageTotals, CIPHER_STAGE_COUNT> stages;
+    };
+
+    static void receive(void* context, const CipherStageStatsC* stats);
+
+    mutable std::mutex mutex_;
+    std::deque<Source> sources_;  // deque: адреса приёмников не меняются при добавлении
+    std::set<std::thread::id> threads_;
+    uint64_t startWallNs_ = 0;
+    uint64_t startCpuNs_ = 0;
+};
+
+#endif // CIPHER_STATS_COLLECTOR_H
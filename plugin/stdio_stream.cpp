@@ -0,0 +1,155 @@
+#include "stdio_stream.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/uio.h>
+#endif
+
+// Размер буфера обычной записи и желаемый размер канала для vmsplice.
+static const std::size_t STDOUT_BUFFER_SIZE = 1u << 20;
+
+static std::string systemError(const char* what) {
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+bool readStdin(unsigned char* buffer, std::size_t capacity, std::size_t& size, std::string& error) {
+#ifdef _WIN32
+    static bool binary = (_setmode(_fileno(stdin), _O_BINARY), true);
+    (void)binary;
+    size = std::fread(buffer, 1, capacity, stdin);
+    if (size == 0 && std::ferror(stdin)) {
+        error = "Ошибка чтения стандартного ввода.";
+        return false;
+    }
+    return true;
+#else
+    for (;;) {
+        ssize_t n = ::read(STDIN_FILENO, buffer, capacity);
+        if (n >= 0) {
+            size = static_cast<std::size_t>(n);
+            return true;
+        }
+        if (errno != EINTR) {
+            error = systemError("Ошибка чтения стандартного ввода");
+            return false;
+        }
+    }
+#endif
+}
+
+StdoutWriter::StdoutWriter() {
+    std::fflush(stdout);
+#ifdef _WIN32
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    capacity_ = STDOUT_BUFFER_SIZE;
+#ifdef __linux__
+    struct stat st;
+    if (fstat(STDOUT_FILENO, &st) == 0 && S_ISFIFO(st.st_mode)) {
+        // Увеличить канал может не получиться (ограничение pipe-max-size) —
+        // тогда буферы подстраиваются под его текущий размер.
+        fcntl(STDOUT_FILENO, F_SETPIPE_SZ, static_cast<int>(STDOUT_BUFFER_SIZE));
+        int pipeSize = fcntl(STDOUT_FILENO, F_GETPIPE_SZ);
+        if (pipeSize > 0) {
+            splice_ = true;
+            capacity_ = static_cast<std::size_t>(pipeSize);
+        }
+    }
+#endif
+#ifdef _WIN32
+    buffers_[0] = new unsigned char[capacity_];
+#else
+    // Страницы, переданные через vmsplice, остаются в канале после выхода из
+    // программы, поэтому память берётся у mmap напрямую: munmap её не изменит, а
+    // освобождённый блок кучи мог бы быть перезаписан до того, как его прочтут.
+    for (unsigned i = 0; i < (splice_ ? 2u : 1u); ++i) {
+        void* memory = mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            splice_ = false;
+            break;
+        }
+        buffers_[i] = static_cast<unsigned char*>(memory);
+    }
+#endif
+}
+
+StdoutWriter::~StdoutWriter() {
+#ifdef _WIN32
+    delete[] buffers_[0];
+#else
+    for (unsigned char* buffer : buffers_) {
+        if (buffer) munmap(buffer, capacity_);
+    }
+#endif
+}
+
+bool StdoutWriter::write(const unsigned char* data, std::size_t size, std::string& error) {
+    if (!buffers_[0]) return writeOut(data, size, error);
+    while (size > 0) {
+        std::size_t chunk = std::min(size, capacity_ - used_);
+        std::memcpy(buffers_[current_] + used_, data, chunk);
+        used_ += chunk;
+        data += chunk;
+        size -= chunk;
+        if (used_ == capacity_ && !flush(error)) return false;
+    }
+    return true;
+}
+
+bool StdoutWriter::flush(std::string& error) {
+    if (used_ == 0) return true;
+    bool ok = writeOut(buffers_[current_], used_, error);
+    used_ = 0;
+    // Следующий буфер свободен: пока канал принимал этот (размером с канал
+    // целиком), читатель забрал всё, что было передано раньше.
+    if (splice_) current_ ^= 1u;
+    return ok;
+}
+
+bool StdoutWriter::writeOut(const unsigned char* data, std::size_t size, std::string& error) {
+#ifdef _WIN32
+    if (std::fwrite(data, 1, size, stdout) != size || std::fflush(stdout) != 0) {
+        error = "Ошибка записи в стандартный вывод.";
+        return false;
+    }
+    return true;
+#else
+    while (size > 0) {
+        ssize_t n;
+#ifdef __linux__
+        if (splice_) {
+            struct iovec iov = {const_cast<unsigned char*>(data), size};
+            n = vmsplice(STDOUT_FILENO, &iov, 1, 0);
+            if (n < 0 && (errno == EINVAL || errno == ENOSYS)) {
+                splice_ = false;
+                continue;
+            }
+        } else
+#endif
+        {
+            n = ::write(STDOUT_FILENO, data, size);
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            error = systemError("Ошибка записи в стандартный вывод");
+            return false;
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+#endif
+}
@@ -0,0 +1,40 @@
+#ifndef CIPHER_STDIO_STREAM_H
+#define CIPHER_STDIO_STREAM_H
+
+// Стандартный ввод и вывод как источник и приёмник конвейера (--input - и
+// --output -), чтобы cipher_tool работал внутри цепочек команд оболочки без
+// промежуточных файлов. Данные передаются как есть, в двоичном режиме.
+
+#include <cstddef>
+#include <string>
+
+// Чтение стандартного ввода частями; сигнатура совпадает с PipelineSource.
+bool readStdin(unsigned char* buffer, std::size_t capacity, std::size_t& size, std::string& error);
+
+// Буферизованная запись в стандартный вывод. Если вывод — канал (Linux),
+// буферы передаются ядру через vmsplice без копирования: их два, каждый размером
+// с канал, и заполняется всегда тот, который читатель канала уже забрал целиком.
+// Иначе данные копятся в буфере и пишутся крупными блоками.
+class StdoutWriter {
+public:
+    StdoutWriter();
+    ~StdoutWriter();
+    StdoutWriter(const StdoutWriter&) = delete;
+    StdoutWriter& operator=(const StdoutWriter&) = delete;
+
+    // Сигнатура совпадает с PipelineSink.
+    bool write(const unsigned char* data, std::size_t size, std::string& error);
+    // Передаёт остаток буфера; вызывается после последней записи.
+    bool flush(std::string& error);
+
+private:
+    bool writeOut(const unsigned char* data, std::size_t size, std::string& error);
+
+    bool splice_ = false;
+    std::size_t capacity_ = 0;
+    unsigned char* buffers_[2] = {nullptr, nullptr};
+    unsigned current_ = 0;
+    std::size_t used_ = 0;
+};
+
+#endif // CIPHER_STDIO_STREAM_H
@@ -1,72 +1,421 @@
 #include "rot13_bitwise.h"
+#include "rot13_simd.h"
+#include "cipher_probes.h"
+#include "cipher_progress.hpp"
+#include "cipher_stats.hpp"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
-#include <sstream>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
 #include <vector>
 
-const unsigned char XOR_KEY = 170;
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
-std::string applyRot13(const std::string& text) {
-    std::string result = text;
-    for (char& c : result) {
-        if (c >= 'a' && c <= 'z') {
-            c = (c - 'a' + 13) % 26 + 'a';
-        } else if (c >= 'A' && c <= 'Z') {
-            c = (c - 'A' + 13) % 26 + 'A';
-        }
+// Размер блока потоковой обработки файлов.
+const std::size_t FILE_CHUNK_SIZE = 1 << 20;
+// Размер блока параллельной обработки по умолчанию и его выравнивание.
+const std::size_t PARALLEL_CHUNK_SIZE = 8 << 20;
+const std::size_t PARALLEL_CHUNK_ALIGNMENT = 4096;
+
+// Применяет преобразование, выбранное параметрами; offset — позиция in[0] от начала
+// данных (задаёт фазу ключа). Возвращает число обработанных байт: в режиме UTF-8
+// при final == false незавершённая пара в конце остаётся.
+static std::size_t applyRot13Xor(const Rot13XorCipher& cipher, const Rot13Options& options,
+                                 const unsigned char* in, unsigned char* out, std::size_t size,
+                                 Rot13XorDirection direction, uint64_t offset, bool final) {
+    CIPHER_PROBE(rot13, chunk_start, offset, size);
+    std::size_t done = size;
+    if (options.cyrillic) {
+        done = cipher.transformUtf8(in, out, size, direction, final, offset);
+    } else {
+        cipher.transform(in, out, size, direction, offset);
     }
-    return result;
+    CIPHER_PROBE(rot13, chunk_done, offset, done);
+    return done;
 }
 
-std::string applyXor(const std::string& text) {
-    std::string result = text;
-    for (char& c : result) {
-        c ^= XOR_KEY;
+// Готовит шифр по параметрам; при недопустимых параметрах возвращает false и сообщение.
+static bool makeCipher(const Rot13Options& options, Rot13XorCipher& cipher, std::string& error,
+                       const CipherStatsSinkC* stats = nullptr) {
+    CipherStageTimer timer(stats, CIPHER_STAGE_PARSE);
+    try {
+        cipher = Rot13XorCipher(options.rotation, options.xor_key);
+        CIPHER_PROBE(rot13, key_setup, options.rotation, options.xor_key.size());
+        return true;
+    } catch (const std::invalid_argument& e) {
+        error = std::string("Error: ") + e.what();
+        return false;
     }
-    return result;
 }
 
-EncodedResult encodeTextRot13Xor(const std::string& text) {
-    std::string rot13_text = applyRot13(text);
-    std::string xor_text = applyXor(rot13_text);
-    std::vector<unsigned char> binary_data(xor_text.begin(), xor_text.end());
-    return {true, "", binary_data};
+EncodedResult encodeTextRot13Xor(const std::string& text, const Rot13Options& options) {
+    Rot13XorCipher cipher;
+    std::string error;
+    if (!makeCipher(options, cipher, error)) return {false, error, {}};
+
+    std::vector<unsigned char> binary_data(text.size());
+    applyRot13Xor(cipher, options, reinterpret_cast<const unsigned char*>(text.data()), binary_data.data(),
+                  text.size(), Rot13XorDirection::Encode, 0, true);
+    return {true, "", std::move(binary_data)};
 }
 
-DecodedResult decodeTextRot13Xor(const std::vector<unsigned char>& data) {
-    std::string xor_text(data.begin(), data.end());
-    std::string rot13_text = applyXor(xor_text);
-    std::string original_text = applyRot13(rot13_text);
-    return {true, "", original_text};
+DecodedResult decodeTextRot13Xor(const std::vector<unsigned char>& data, const Rot13Options& options) {
+    Rot13XorCipher cipher;
+    std::string error;
+    if (!makeCipher(options, cipher, error)) return {false, error, ""};
+
+    std::string original_text(data.size(), '\0');
+    applyRot13Xor(cipher, options, data.data(), reinterpret_cast<unsigned char*>(&original_text[0]), data.size(),
+                  Rot13XorDirection::Decode, 0, true);
+    return {true, "", std::move(original_text)};
 }
 
-FileOperationResult encodeFileRot13Xor(const std::string& inputFilePath, const std::string& outputFilePath) {
-    std::ifstream inputFile(inputFilePath, std::ios::binary);
-    if (!inputFile) return {false, "Error: Could not open input file."};
+// Преобразует файл на месте. На POSIX файл отображается в память (MAP_SHARED)
+// и страницы меняются напрямую; при msyncWindow > 0 изменения сбрасываются на
+// диск окнами этого размера, что ограничивает объём «грязных» страниц.
+static FileOperationResult transformFileRot13XorInPlace(const std::string& filePath, std::size_t msyncWindow,
+                                                        Rot13XorDirection direction, const Rot13Options& options,
+                                                        const std::string& successMessage,
+                                                        const CipherStatsSinkC* stats) {
+    Rot13XorCipher cipher;
+    std::string error;
+    if (!makeCipher(options, cipher, error, stats)) return {false, error};
+#ifndef _WIN32
+    int fd = ::open(filePath.c_str(), O_RDWR);
+    if (fd < 0) return {false, "Error: Could not open file for in-place transformation."};
 
-    std::string fileContent((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return {false, "Error: Could not stat file."};
+    }
+    auto fileSize = static_cast<std::size_t>(st.st_size);
+    if (fileSize == 0) {
+        ::close(fd);
+        return {true, successMessage};
+    }
 
-    EncodedResult encoded = encodeTextRot13Xor(fileContent);
-    if (!encoded.success) return {false, encoded.error_message};
+    void* mapping = ::mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        ::close(fd);
+        return {false, "Error: Could not map file into memory."};
+    }
+    ::madvise(mapping, fileSize, MADV_SEQUENTIAL);
 
-    std::ofstream outputFile(outputFilePath, std::ios::binary);
-    if (!outputFile) return {false, "Error: Could not create output file."};
-    outputFile.write(reinterpret_cast<const char*>(encoded.binary_data.data()), encoded.binary_data.size());
+    auto* data = static_cast<unsigned char*>(mapping);
+    std::size_t window = msyncWindow > 0 ? msyncWindow : fileSize;
+    auto pageSize = static_cast<std::size_t>(std::max(1L, ::sysconf(_SC_PAGESIZE)));
+    if (window % pageSize != 0) {
+        window += pageSize - window % pageSize;
+    }
+
+    bool ok = true;
+    std::size_t offset = 0;
+    while (offset < fileSize && ok) {
+        std::size_t length = std::min(window, fileSize - offset);
+        bool final = offset + length == fileSize;
+        // Чтение здесь — подкачка страниц отображения, она входит в преобразование.
+        CipherStageTimer transformTimer(stats, CIPHER_STAGE_TRANSFORM);
+        std::size_t done = applyRot13Xor(cipher, options, data + offset, data + offset, length, direction, offset, final);
+        transformTimer.addBytes(done);
+        transformTimer.stop();
+        if (msyncWindow > 0) {
+            CipherStageTimer writeTimer(stats, CIPHER_STAGE_WRITE);
+            std::size_t syncStart = offset / pageSize * pageSize;
+            CIPHER_PROBE(rot13, write_start, offset + done - syncStart);
+            ok = ::msync(data + syncStart, offset + done - syncStart, MS_SYNC) == 0;
+            CIPHER_PROBE(rot13, write_done, ok ? offset + done - syncStart : 0);
+            writeTimer.addBytes(offset + done - syncStart);
+        }
+        offset += done;
+    }
+
+    ::munmap(mapping, fileSize);
+    ::close(fd);
+    if (!ok) return {false, "Error: msync failed while writing file."};
+    return {true, successMessage};
+#else
+    (void)msyncWindow;
+    std::fstream file(filePath, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file) return {false, "Error: Could not open file for in-place transformation."};
+
+    std::vector<unsigned char> buffer(FILE_CHUNK_SIZE);
+    std::streamoff offset = 0;
+    while (true) {
+        CipherStageTimer readTimer(stats, CIPHER_STAGE_READ);
+        file.seekg(offset);
+        CIPHER_PROBE(rot13, read_start, buffer.size());
+        file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        std::streamsize got = file.gcount();
+        CIPHER_PROBE(rot13, read_done, got);
+        if (got <= 0) break;
+        readTimer.addBytes(static_cast<uint64_t>(got));
+        readTimer.stop();
+        bool final = got < static_cast<std::streamsize>(buffer.size());
+        file.clear();
+        CipherStageTimer transformTimer(stats, CIPHER_STAGE_TRANSFORM);
+        std::size_t done = applyRot13Xor(cipher, options, buffer.data(), buffer.data(), static_cast<std::size_t>(got),
+                                         direction, static_cast<uint64_t>(offset), final);
+        transformTimer.addBytes(done);
+        transformTimer.stop();
+        CipherStageTimer writeTimer(stats, CIPHER_STAGE_WRITE);
+        file.seekp(offset);
+        CIPHER_PROBE(rot13, write_start, done);
+        file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(done));
+        if (!file) return {false, "Error: Could not write file."};
+        CIPHER_PROBE(rot13, write_done, done);
+        writeTimer.addBytes(done);
+        offset += static_cast<std::streamoff>(done);
+    }
+    return {true, successMessage};
+#endif
+}
 
-    return {true, "File successfully encoded."};
+static bool isSameFile(const std::string& a, const std::string& b) {
+    std::error_code ec;
+    return std::filesystem::equivalent(a, b, ec) && !ec;
 }
 
-FileOperationResult decodeFileRot13Xor(const std::string& inputFilePath, const std::string& outputFilePath) {
-    std::ifstream inputFile(inputFilePath, std::ios::binary);
-    if (!inputFile) return {false, "Error: Could not open input file."};
+// Преобразование длину не меняет и не имеет состояния, поэтому файл
+// обрабатывается блоками фиксированного размера прямо в буфере чтения.
+// Если вход и выход — один и тот же файл, он преобразуется на месте.
+static FileOperationResult transformFileRot13Xor(const std::string& inputFilePath, const std::string& outputFilePath,
+                                                 Rot13XorDirection direction, const Rot13Options& options,
+                                                 const std::string& successMessage, const CipherStatsSinkC* stats,
+                                                 const CipherProgressC* progress = nullptr) {
+    if (isSameFile(inputFilePath, outputFilePath)) {
+        return transformFileRot13XorInPlace(inputFilePath, 0, direction, options, successMessage, stats);
+    }
 
-    std::vector<unsigned char> binaryInput((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+    Rot13XorCipher cipher;
+    std::string error;
+    if (!makeCipher(options, cipher, error, stats)) return {false, error};
 
-    DecodedResult decoded = decodeTextRot13Xor(binaryInput);
-    if (!decoded.success) return {false, decoded.error_message};
+    std::ifstream inputFile(inputFilePath, std::ios::binary);
+    if (!inputFile) return {false, "Error: Could not open input file."};
 
     std::ofstream outputFile(outputFilePath, std::ios::binary);
     if (!outputFile) return {false, "Error: Could not create output file."};
-    outputFile << decoded.text;
 
-    return {true, "File successfully decoded."};
-}
\ No newline at end of file
+    std::error_code sizeError;
+    uint64_t inputSize = std::filesystem::file_size(inputFilePath, sizeError);
+    CipherProgress tracker(progress, sizeError ? 0 : inputSize);
+
+    // В режиме UTF-8 незавершённая пара в конце блока переносится в начало следующего.
+    std::vector<unsigned char> buffer(FILE_CHUNK_SIZE);
+    std::size_t carry = 0;
+    uint64_t position = 0;  // смещение buffer[0] во входном файле
+    while (true) {
+        CipherStageTimer readTimer(stats, CIPHER_STAGE_READ);
+        CIPHER_PROBE(rot13, read_start, buffer.size() - carry);
+        inputFile.read(reinterpret_cast<char*>(buffer.data() + carry), static_cast<std::streamsize>(buffer.size() - carry));
+        auto got = static_cast<std::size_t>(inputFile.gcount());
+        CIPHER_PROBE(rot13, read_done, got);
+        readTimer.addBytes(got);
+        readTimer.stop();
+        std::size_t size = carry + got;
+        if (size == 0) break;
+        bool final = !inputFile;
+        CipherStageTimer transformTimer(stats, CIPHER_STAGE_TRANSFORM);
+        std::size_t done = applyRot13Xor(cipher, options, buffer.data(), buffer.data(), size, direction, position, final);
+        transformTimer.addBytes(done);
+        transformTimer.stop();
+        CipherStageTimer writeTimer(stats, CIPHER_STAGE_WRITE);
+        CIPHER_PROBE(rot13, write_start, done);
+        outputFile.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(done));
+        if (!outputFile) return {false, "Error: Could not write output file."};
+        CIPHER_PROBE(rot13, write_done, done);
+        writeTimer.addBytes(done);
+        writeTimer.stop();
+        if (!tracker.advance(got) && !final) return {false, CIPHER_CANCELLED_MESSAGE};
+        carry = size - done;
+        position += done;
+        std::memmove(buffer.data(), buffer.data() + done, carry);
+        if (final) break;
+    }
+    if (inputFile.bad()) return {false, "Error: Could not read input file."};
+
+    return {true, successMessage};
+}
+
+FileOperationResult encodeFileRot13Xor(const std::string& inputFilePath, const std::string& outputFilePath,
+                                       const Rot13Options& options, const CipherStatsSinkC* stats,
+                                       const CipherProgressC* progress) {
+    return transformFileRot13Xor(inputFilePath, outputFilePath, Rot13XorDirection::Encode, options,
+                                 "File successfully encoded.", stats, progress);
+}
+
+FileOperationResult decodeFileRot13Xor(const std::string& inputFilePath, const std::string& outputFilePath,
+                                       const Rot13Options& options, const CipherStatsSinkC* stats) {
+    return transformFileRot13Xor(inputFilePath, outputFilePath, Rot13XorDirection::Decode, options,
+                                 "File successfully decoded.", stats);
+}
+
+FileOperationResult encodeFileRot13XorInPlace(const std::string& filePath, std::size_t msyncWindow,
+                                              const Rot13Options& options, const CipherStatsSinkC* stats) {
+    return transformFileRot13XorInPlace(filePath, msyncWindow, Rot13XorDirection::Encode, options,
+                                        "File successfully encoded in place.", stats);
+}
+
+FileOperationResult decodeFileRot13XorInPlace(const std::string& filePath, std::size_t msyncWindow,
+                                              const Rot13Options& options, const CipherStatsSinkC* stats) {
+    return transformFileRot13XorInPlace(filePath, msyncWindow, Rot13XorDirection::Decode, options,
+                                        "File successfully decoded in place.", stats);
+}
+
+#ifndef _WIN32
+static bool preadAll(int fd, unsigned char* buffer, std::size_t length, uint64_t offset) {
+    std::size_t done = 0;
+    while (done < length) {
+        ssize_t got = ::pread(fd, buffer + done, length - done, static_cast<off_t>(offset + done));
+        if (got <= 0) return false;
+        done += static_cast<std::size_t>(got);
+    }
+    return true;
+}
+
+static bool pwriteAll(int fd, const unsigned char* buffer, std::size_t length, uint64_t offset) {
+    std::size_t done = 0;
+    while (done < length) {
+        ssize_t put = ::pwrite(fd, buffer + done, length - done, static_cast<off_t>(offset + done));
+        if (put <= 0) return false;
+        done += static_cast<std::size_t>(put);
+    }
+    return true;
+}
+#endif
+
+// Каждый байт преобразуется независимо (фаза ключа определяется смещением), поэтому файл делится на выровненные блоки,
+// которые участники параллельного цикла общего пула (runtime/thread_pool.h) обрабатывают
+// так: pread, преобразование на месте в собственном буфере участника, pwrite по тому же смещению.
+// В режиме UTF-8 буква кириллицы на границе блоков принадлежит блоку, в котором
+// лежит её первый байт: поток читает по одному байту до и после своего блока.
+static FileOperationResult transformFileRot13XorParallel(const std::string& inputFilePath,
+                                                         const std::string& outputFilePath,
+                                                         unsigned threadCount, std::size_t chunkSize,
+                                                         Rot13XorDirection direction, const Rot13Options& options,
+                                                         const std::string& successMessage,
+                                                         const CipherStatsSinkC* stats) {
+#ifndef _WIN32
+    if (isSameFile(inputFilePath, outputFilePath)) {
+        return transformFileRot13XorInPlace(inputFilePath, 0, direction, options, successMessage, stats);
+    }
+
+    Rot13XorCipher cipher;
+    std::string error;
+    if (!makeCipher(options, cipher, error, stats)) return {false, error};
+
+    int inFd = ::open(inputFilePath.c_str(), O_RDONLY);
+    if (inFd < 0) return {false, "Error: Could not open input file."};
+
+    struct stat st;
+    if (::fstat(inFd, &st) != 0) {
+        ::close(inFd);
+        return {false, "Error: Could not stat input file."};
+    }
+    auto fileSize = static_cast<uint64_t>(st.st_size);
+
+    int outFd = ::open(outputFilePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (outFd < 0) {
+        ::close(inFd);
+        return {false, "Error: Could not create output file."};
+    }
+    if (::ftruncate(outFd, static_cast<off_t>(fileSize)) != 0) {
+        ::close(inFd);
+        ::close(outFd);
+        return {false, "Error: Could not preallocate output file."};
+    }
+
+    if (chunkSize == 0) chunkSize = PARALLEL_CHUNK_SIZE;
+    chunkSize = (chunkSize + PARALLEL_CHUNK_ALIGNMENT - 1) / PARALLEL_CHUNK_ALIGNMENT * PARALLEL_CHUNK_ALIGNMENT;
+    if (threadCount == 0) threadCount = cipher_runtime_threads();
+
+    std::atomic<bool> failed{false};
+    std::mutex errorMutex;
+    std::string errorMessage;
+
+    auto fail = [&](const std::string& message) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!failed.exchange(true)) errorMessage = message;
+    };
+
+    std::vector<std::vector<unsigned char>> buffers(threadCount);
+    cipherParallelFor(fileSize, chunkSize, threadCount, [&](uint64_t begin, uint64_t end, unsigned slot) {
+        if (failed.load(std::memory_order_relaxed)) return;
+        // Один байт контекста слева и справа для режима UTF-8.
+        std::vector<unsigned char>& buffer = buffers[slot];
+        buffer.resize(chunkSize + 2);
+
+        uint64_t readBegin = begin;
+        uint64_t readEnd = end;
+        if (options.cyrillic) {
+            readBegin = begin > 0 ? begin - 1 : 0;
+            readEnd = std::min<uint64_t>(end + 1, fileSize);
+        }
+        CipherStageTimer readTimer(stats, CIPHER_STAGE_READ);
+        CIPHER_PROBE(rot13, read_start, readEnd - readBegin);
+        if (!preadAll(inFd, buffer.data(), static_cast<std::size_t>(readEnd - readBegin), readBegin)) {
+            fail("Error: Could not read input file.");
+            return;
+        }
+        CIPHER_PROBE(rot13, read_done, readEnd - readBegin);
+        readTimer.addBytes(readEnd - readBegin);
+        readTimer.stop();
+
+        // Байт файла по смещению pos (readBegin <= pos <= readEnd) в буфере.
+        auto at = [&](uint64_t pos) { return buffer.data() + static_cast<std::size_t>(pos - readBegin); };
+        if (options.cyrillic) {
+            if (begin > 0 && cipher.utf8PairStartsAt(at(begin - 1), direction, begin - 1)) ++begin;
+            if (end < fileSize && cipher.utf8PairStartsAt(at(end - 1), direction, end - 1)) ++end;
+        }
+        auto length = static_cast<std::size_t>(end - begin);
+        CipherStageTimer transformTimer(stats, CIPHER_STAGE_TRANSFORM);
+        applyRot13Xor(cipher, options, at(begin), at(begin), length, direction, begin, true);
+        transformTimer.addBytes(length);
+        transformTimer.stop();
+
+        CipherStageTimer writeTimer(stats, CIPHER_STAGE_WRITE);
+        CIPHER_PROBE(rot13, write_start, length);
+        if (!pwriteAll(outFd, at(begin), length, begin)) {
+            fail("Error: Could not write output file.");
+            return;
+        }
+        CIPHER_PROBE(rot13, write_done, length);
+        writeTimer.addBytes(length);
+    });
+
+    ::close(inFd);
+    if (::close(outFd) != 0 && !failed) fail("Error: Could not write output file.");
+    if (failed) return {false, errorMessage};
+    return {true, successMessage};
+#else
+    (void)threadCount;
+    (void)chunkSize;
+    return transformFileRot13Xor(inputFilePath, outputFilePath, direction, options, successMessage, stats);
+#endif
+}
+
+FileOperationResult encodeFileRot13XorParallel(const std::string& inputFilePath, const std::string& outputFilePath,
+                                               unsigned threadCount, std::size_t chunkSize,
+                                               const Rot13Options& options, const CipherStatsSinkC* stats) {
+    return transformFileRot13XorParallel(inputFilePath, outputFilePath, threadCount, chunkSize,
+                                         Rot13XorDirection::Encode, options, "File successfully encoded.", stats);
+}
+
+FileOperationResult decodeFileRot13XorParallel(const std::string& inputFilePath, const std::string& outputFilePath,
+                                               unsigned threadCount, std::size_t chunkSize,
+                                               const Rot13Options& options, const CipherStatsSinkC* stats) {
+    return transformFileRot13XorParallel(inputFilePath, outputFilePath, threadCount, chunkSize,
+                                         Rot13XorDirection::Decode, options, "File successfully decoded.", stats);
+}
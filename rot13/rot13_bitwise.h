@@ -1,9 +1,14 @@
 #ifndef ROT13_XOR_CIPHER_HPP
 #define ROT13_XOR_CIPHER_HPP
 
+#include "rot13_simd.h"
+#include <cstddef>
 #include <string>
 #include <vector>
 
+struct CipherStatsSinkC; // plugin/cipher_stats.h
+struct CipherProgressC;  // runtime/cipher_progress.h
+
 struct EncodedResult {
     bool success;
     std::string error_message;
@@ -21,10 +26,53 @@ struct FileOperationResult {
     std::string message;
 };
 
-EncodedResult encodeTextRot13Xor(const std::string& text);
-DecodedResult decodeTextRot13Xor(const std::vector<unsigned char>& data);
+// Параметры преобразования.
+struct Rot13Options {
+    // Рассматривать данные как UTF-8 и вращать также русский алфавит (33 буквы, с Ё/ё).
+    // Кириллица сдвигается на rotation позиций при кодировании и обратно при декодировании.
+    bool cyrillic = false;
+    // Сдвиг при кодировании (по модулю 26, для кириллицы — по модулю 33).
+    int rotation = ROT13_DEFAULT_ROTATION;
+    // Ключ XOR, повторяемый по всей длине данных; позиция в ключе отсчитывается от
+    // начала текста или файла. Пустой ключ — ошибка.
+    std::vector<unsigned char> xor_key = {XOR_KEY};
+};
+
+EncodedResult encodeTextRot13Xor(const std::string& text, const Rot13Options& options = {});
+DecodedResult decodeTextRot13Xor(const std::vector<unsigned char>& data, const Rot13Options& options = {});
+
+// Файловые функции сообщают время подготовки шифра, чтения, преобразования и
+// записи в stats, если он задан (см. plugin/cipher_stats.h); при многопоточной
+// обработке — из рабочих потоков.
+// progress (может быть nullptr) получает ход в байтах входа после каждого блока
+// и может отменить кодирование (runtime/cipher_progress.h); при преобразовании
+// на месте (вход и выход — один файл) он не используется.
+FileOperationResult encodeFileRot13Xor(const std::string& inputFilePath, const std::string& outputFilePath,
+                                       const Rot13Options& options = {}, const CipherStatsSinkC* stats = nullptr,
+                                       const CipherProgressC* progress = nullptr);
+FileOperationResult decodeFileRot13Xor(const std::string& inputFilePath, const std::string& outputFilePath,
+                                       const Rot13Options& options = {}, const CipherStatsSinkC* stats = nullptr);
+
+// Преобразование файла на месте (без второго файла). msyncWindow > 0 задаёт размер
+// окна в байтах, после обработки которого изменения синхронно сбрасываются на диск.
+FileOperationResult encodeFileRot13XorInPlace(const std::string& filePath, std::size_t msyncWindow = 0,
+                                              const Rot13Options& options = {},
+                                              const CipherStatsSinkC* stats = nullptr);
+FileOperationResult decodeFileRot13XorInPlace(const std::string& filePath, std::size_t msyncWindow = 0,
+                                              const Rot13Options& options = {},
+                                              const CipherStatsSinkC* stats = nullptr);
 
-FileOperationResult encodeFileRot13Xor(const std::string& inputFilePath, const std::string& outputFilePath);
-FileOperationResult decodeFileRot13Xor(const std::string& inputFilePath, const std::string& outputFilePath);
+// Многопоточная обработка больших файлов блоками через pread/pwrite на общем пуле
+// потоков (runtime/cipher_runtime.h). threadCount ограничивает число участвующих
+// потоков, 0 — все потоки пула; chunkSize = 0 — размер блока по умолчанию (8 МиБ),
+// иначе он округляется вверх до 4 КиБ.
+FileOperationResult encodeFileRot13XorParallel(const std::string& inputFilePath, const std::string& outputFilePath,
+                                               unsigned threadCount = 0, std::size_t chunkSize = 0,
+                                               const Rot13Options& options = {},
+                                               const CipherStatsSinkC* stats = nullptr);
+FileOperationResult decodeFileRot13XorParallel(const std::string& inputFilePath, const std::string& outputFilePath,
+                                               unsigned threadCount = 0, std::size_t chunkSize = 0,
+                                               const Rot13Options& options = {},
+                                               const CipherStatsSinkC* stats = nullptr);
 
 #endif // ROT13_XOR_CIPHER_HPP
\ No newline at end of file
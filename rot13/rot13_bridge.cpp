@@ -1,16 +1,128 @@
 #include "rot13_bridge.h"
 #include "rot13_bitwise.h"
+#include <cstdio>
 #include <cstring>
 #include <vector>
 
-// Вспомогательная функция для копирования std::string в C-строку (char*)
+// Вспомогательная функция для копирования std::string в C-строку (char*).
+// Пустая строка тоже копируется: успешный результат с пустым текстом — не NULL.
 static char* duplicate_string(const std::string& s) {
-    if (s.empty()) return nullptr;
     char* cstr = new char[s.length() + 1];
-    std::strcpy(cstr, s.c_str());
+    std::memcpy(cstr, s.c_str(), s.length() + 1);
     return cstr;
 }
 
+// Аргументы encodeFileRot13XorAsync_C, скопированные для потока задания.
+struct Rot13FileWork {
+    std::string inputFilePath;
+    std::string outputFilePath;
+};
+
+static void run_encode_file_rot13(CipherAsyncJobC* job, void* work, const CipherProgressC* progress) {
+    auto* args = static_cast<Rot13FileWork*>(work);
+    FileOperationResult result = encodeFileRot13Xor(args->inputFilePath, args->outputFilePath, {}, nullptr, progress);
+    if (!result.success && cipher_async_stopped(job)) std::remove(args->outputFilePath.c_str());
+    cipher_async_finish(job, result.success, result.message.c_str(), nullptr);
+}
+
+static void free_rot13_file_work(void* work) {
+    delete static_cast<Rot13FileWork*>(work);
+}
+
+static Rot13Options to_options(const Rot13OptionsC* options) {
+    Rot13Options result;
+    if (options) {
+        result.cyrillic = options->cyrillic;
+        if (options->rotation_set) result.rotation = options->rotation;
+        if (options->xor_key) result.xor_key.assign(options->xor_key, options->xor_key + options->xor_key_size);
+    }
+    return result;
+}
+
+static EncodedResultC to_c_result(const EncodedResult& result) {
+    EncodedResultC c_result = {};
+    c_result.success = result.success;
+    c_result.error_message = duplicate_string(result.error_message);
+    if (result.success) {
+        c_result.data_size = result.binary_data.size();
+        c_result.binary_data = new unsigned char[c_result.data_size];
+        std::memcpy(c_result.binary_data, result.binary_data.data(), c_result.data_size);
+    }
+    return c_result;
+}
+
+static DecodedResultC to_c_result(const DecodedResult& result) {
+    DecodedResultC c_result = {};
+    c_result.success = result.success;
+    c_result.error_message = duplicate_string(result.error_message);
+    if (result.success) {
+        c_result.text = duplicate_string(result.text);
+    }
+    return c_result;
+}
+
+static_assert(ROT13_INTO_MAX_KEY_SIZE == ROT13_BOUNDED_KEY_MAX, "Key limit of *Into_C must match the kernel.");
+
+// Ядро по умолчанию (сдвиг 13, ключ 170) создаётся один раз; для других
+// параметров таблицы и поток ключа строятся в стеке, так что функции *Into_C
+// память не выделяют ни при каких параметрах.
+static Rot13StatusC transform_into(const unsigned char* input, size_t input_size, unsigned char* output,
+                                  size_t output_capacity, size_t* output_size, const Rot13OptionsC* options,
+                                  Rot13XorDirection direction) {
+    if ((!input && input_size) || !output_size) return ROT13_STATUS_INVALID_ARGUMENT;
+    *output_size = input_size;
+    if (output_capacity < input_size || (!output && input_size)) return ROT13_STATUS_BUFFER_TOO_SMALL;
+
+    const bool cyrillic = options && options->cyrillic;
+    try {
+        if (options && (options->rotation_set || options->xor_key)) {
+            static const unsigned char default_key = XOR_KEY;
+            int rotation = options->rotation_set ? options->rotation : ROT13_DEFAULT_ROTATION;
+            const unsigned char* key = options->xor_key ? options->xor_key : &default_key;
+            size_t key_size = options->xor_key ? options->xor_key_size : 1;
+            if (!rot13XorTransformBounded(rotation, key, key_size, cyrillic, input, output, input_size, direction)) {
+                return ROT13_STATUS_INVALID_ARGUMENT;
+            }
+            return ROT13_STATUS_OK;
+        }
+        static const Rot13XorCipher default_cipher;
+        if (cyrillic) {
+            default_cipher.transformUtf8(input, output, input_size, direction, true);
+        } else {
+            default_cipher.transform(input, output, input_size, direction);
+        }
+    } catch (...) {
+        // Исключение не должно пересечь границу C.
+        return ROT13_STATUS_INVALID_ARGUMENT;
+    }
+    return ROT13_STATUS_OK;
+}
+
+static FileOperationResultC to_c_result(const FileOperationResult& result) {
+    FileOperationResultC c_result = {};
+    c_result.success = result.success;
+    c_result.message = duplicate_string(result.message);
+    return c_result;
+}
+
+static FileOperationResult transform_file(const char* inputFilePath, const char* outputFilePath,
+                                          const Rot13OptionsC* options, bool encode,
+                                          const CipherStatsSinkC* stats = nullptr) {
+    Rot13Options cpp_options = to_options(options);
+    if (options && options->in_place) {
+        std::size_t window = options->msync_window;
+        return encode ? encodeFileRot13XorInPlace(inputFilePath, window, cpp_options, stats)
+                      : decodeFileRot13XorInPlace(inputFilePath, window, cpp_options, stats);
+    }
+    if (options && options->parallel) {
+        unsigned threads = options->thread_count;
+        return encode ? encodeFileRot13XorParallel(inputFilePath, outputFilePath, threads, 0, cpp_options, stats)
+                      : decodeFileRot13XorParallel(inputFilePath, outputFilePath, threads, 0, cpp_options, stats);
+    }
+    return encode ? encodeFileRot13Xor(inputFilePath, outputFilePath, cpp_options, stats)
+                  : decodeFileRot13Xor(inputFilePath, outputFilePath, cpp_options, stats);
+}
+
 extern "C" {
 
 DLL_EXPORT EncodedResultC encodeTextRot13Xor_C(const char* text) {
@@ -46,6 +158,12 @@ DLL_EXPORT FileOperationResultC encodeFileRot13Xor_C(const char* inputFilePath,
     return c_result;
 }
 
+DLL_EXPORT CipherAsyncJobC* encodeFileRot13XorAsync_C(const char* inputFilePath, const char* outputFilePath,
+                                                      const CipherAsyncOptionsC* options) {
+    auto* work = new Rot13FileWork{inputFilePath, outputFilePath};
+    return cipher_async_submit(run_encode_file_rot13, work, free_rot13_file_work, options);
+}
+
 DLL_EXPORT FileOperationResultC decodeFileRot13Xor_C(const char* inputFilePath, const char* outputFilePath) {
     FileOperationResult result = decodeFileRot13Xor(inputFilePath, outputFilePath);
     FileOperationResultC c_result = {};
@@ -54,6 +172,76 @@ DLL_EXPORT FileOperationResultC decodeFileRot13Xor_C(const char* inputFilePath,
     return c_result;
 }
 
+DLL_EXPORT FileOperationResultC encodeFileRot13XorInPlace_C(const char* filePath, size_t msync_window) {
+    FileOperationResult result = encodeFileRot13XorInPlace(filePath, msync_window);
+    FileOperationResultC c_result = {};
+    c_result.success = result.success;
+    c_result.message = duplicate_string(result.message);
+    return c_result;
+}
+
+DLL_EXPORT FileOperationResultC decodeFileRot13XorInPlace_C(const char* filePath, size_t msync_window) {
+    FileOperationResult result = decodeFileRot13XorInPlace(filePath, msync_window);
+    FileOperationResultC c_result = {};
+    c_result.success = result.success;
+    c_result.message = duplicate_string(result.message);
+    return c_result;
+}
+
+DLL_EXPORT FileOperationResultC encodeFileRot13XorParallel_C(const char* inputFilePath, const char* outputFilePath, unsigned thread_count) {
+    FileOperationResult result = encodeFileRot13XorParallel(inputFilePath, outputFilePath, thread_count);
+    FileOperationResultC c_result = {};
+    c_result.success = result.success;
+    c_result.message = duplicate_string(result.message);
+    return c_result;
+}
+
+DLL_EXPORT FileOperationResultC decodeFileRot13XorParallel_C(const char* inputFilePath, const char* outputFilePath, unsigned thread_count) {
+    FileOperationResult result = decodeFileRot13XorParallel(inputFilePath, outputFilePath, thread_count);
+    FileOperationResultC c_result = {};
+    c_result.success = result.success;
+    c_result.message = duplicate_string(result.message);
+    return c_result;
+}
+
+DLL_EXPORT EncodedResultC encodeTextRot13XorEx_C(const unsigned char* text, size_t text_size, const Rot13OptionsC* options) {
+    std::string input(reinterpret_cast<const char*>(text), text_size);
+    return to_c_result(encodeTextRot13Xor(input, to_options(options)));
+}
+
+DLL_EXPORT DecodedResultC decodeTextRot13XorEx_C(const unsigned char* data, size_t data_size, const Rot13OptionsC* options) {
+    std::vector<unsigned char> data_vec(data, data + data_size);
+    return to_c_result(decodeTextRot13Xor(data_vec, to_options(options)));
+}
+
+DLL_EXPORT FileOperationResultC encodeFileRot13XorEx_C(const char* inputFilePath, const char* outputFilePath, const Rot13OptionsC* options) {
+    return to_c_result(transform_file(inputFilePath, outputFilePath, options, true));
+}
+
+DLL_EXPORT FileOperationResultC decodeFileRot13XorEx_C(const char* inputFilePath, const char* outputFilePath, const Rot13OptionsC* options) {
+    return to_c_result(transform_file(inputFilePath, outputFilePath, options, false));
+}
+
+DLL_EXPORT FileOperationResultC encodeFileRot13XorStats_C(const char* inputFilePath, const char* outputFilePath,
+                                                          const Rot13OptionsC* options, const CipherStatsSinkC* stats) {
+    return to_c_result(transform_file(inputFilePath, outputFilePath, options, true, stats));
+}
+
+DLL_EXPORT FileOperationResultC decodeFileRot13XorStats_C(const char* inputFilePath, const char* outputFilePath,
+                                                          const Rot13OptionsC* options, const CipherStatsSinkC* stats) {
+    return to_c_result(transform_file(inputFilePath, outputFilePath, options, false, stats));
+}
+
+DLL_EXPORT Rot13StatusC encodeRot13XorInto_C(const unsigned char* input, size_t input_size, unsigned char* output,
+                                             size_t output_capacity, size_t* output_size, const Rot13OptionsC* options) {
+    return transform_into(input, input_size, output, output_capacity, output_size, options, Rot13XorDirection::Encode);
+}
+
+DLL_EXPORT Rot13StatusC decodeRot13XorInto_C(const unsigned char* input, size_t input_size, unsigned char* output,
+                                             size_t output_capacity, size_t* output_size, const Rot13OptionsC* options) {
+    return transform_into(input, input_size, output, output_capacity, output_size, options, Rot13XorDirection::Decode);
+}
+
 // Реализация функций для освобождения памяти
 DLL_EXPORT void free_rot13_encoded_result_C(EncodedResultC* result) {
     if (result) {
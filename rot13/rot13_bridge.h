@@ -4,6 +4,9 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "cipher_async.h"
+#include "cipher_stats.h"
+
 #ifdef _WIN32
 #define DLL_EXPORT __declspec(dllexport)
 #else
@@ -34,12 +37,70 @@ typedef struct {
     char* message;
 } FileOperationResultC;
 
+// Параметры расширенных функций (*Ex_C). Указатель может быть NULL — тогда
+// используются значения по умолчанию (все поля нулевые).
+typedef struct {
+    bool cyrillic;          // UTF-8: вращать также русский алфавит
+    bool in_place;          // Файл: преобразовать inputFilePath на месте, outputFilePath не используется
+    size_t msync_window;    // Файл на месте: сбрасывать изменения окнами такого размера (0 — нет)
+    bool parallel;          // Файл: многопоточная обработка блоками
+    unsigned thread_count;  // Число потоков (0 — все потоки общего пула, см. cipher_runtime.h)
+    bool rotation_set;      // Использовать rotation вместо сдвига по умолчанию (13)
+    int rotation;           // Сдвиг при кодировании (по модулю 26, для кириллицы — 33)
+    const unsigned char* xor_key;  // Повторяющийся ключ XOR (NULL — один байт 170)
+    size_t xor_key_size;           // Длина ключа в байтах
+} Rot13OptionsC;
+
+// Наибольшая длина xor_key для функций *Into_C.
+#define ROT13_INTO_MAX_KEY_SIZE 256
+
+// Коды возврата функций *Into_C.
+typedef enum {
+    ROT13_STATUS_OK = 0,
+    ROT13_STATUS_BUFFER_TOO_SMALL = 1,  // *output_size — требуемый размер
+    ROT13_STATUS_INVALID_ARGUMENT = 2,
+} Rot13StatusC;
+
 // Объявления экспортируемых C-функций
 
 DLL_EXPORT EncodedResultC encodeTextRot13Xor_C(const char* text);
 DLL_EXPORT DecodedResultC decodeTextRot13Xor_C(const unsigned char* data, size_t data_size);
 DLL_EXPORT FileOperationResultC encodeFileRot13Xor_C(const char* inputFilePath, const char* outputFilePath);
 DLL_EXPORT FileOperationResultC decodeFileRot13Xor_C(const char* inputFilePath, const char* outputFilePath);
+DLL_EXPORT FileOperationResultC encodeFileRot13XorInPlace_C(const char* filePath, size_t msync_window);
+DLL_EXPORT FileOperationResultC decodeFileRot13XorInPlace_C(const char* filePath, size_t msync_window);
+DLL_EXPORT FileOperationResultC encodeFileRot13XorParallel_C(const char* inputFilePath, const char* outputFilePath, unsigned thread_count);
+DLL_EXPORT FileOperationResultC decodeFileRot13XorParallel_C(const char* inputFilePath, const char* outputFilePath, unsigned thread_count);
+
+DLL_EXPORT EncodedResultC encodeTextRot13XorEx_C(const unsigned char* text, size_t text_size, const Rot13OptionsC* options);
+DLL_EXPORT DecodedResultC decodeTextRot13XorEx_C(const unsigned char* data, size_t data_size, const Rot13OptionsC* options);
+DLL_EXPORT FileOperationResultC encodeFileRot13XorEx_C(const char* inputFilePath, const char* outputFilePath, const Rot13OptionsC* options);
+DLL_EXPORT FileOperationResultC decodeFileRot13XorEx_C(const char* inputFilePath, const char* outputFilePath, const Rot13OptionsC* options);
+
+// То же, что *Ex_C, с замером стадий: stats (может быть NULL) получает время
+// подготовки шифра, чтения, преобразования и записи (см. plugin/cipher_stats.h).
+DLL_EXPORT FileOperationResultC encodeFileRot13XorStats_C(const char* inputFilePath, const char* outputFilePath,
+                                                          const Rot13OptionsC* options, const CipherStatsSinkC* stats);
+DLL_EXPORT FileOperationResultC decodeFileRot13XorStats_C(const char* inputFilePath, const char* outputFilePath,
+                                                          const Rot13OptionsC* options, const CipherStatsSinkC* stats);
+
+// Асинхронный encodeFileRot13Xor_C: задание ставится в очередь пула заданий и
+// функция сразу возвращает описатель (см. runtime/cipher_async.h). Ход, отмена
+// и срок проверяются после каждого блока; остановленное задание удаляет
+// неполный выход. options может быть NULL.
+DLL_EXPORT CipherAsyncJobC* encodeFileRot13XorAsync_C(const char* inputFilePath, const char* outputFilePath,
+                                                      const CipherAsyncOptionsC* options);
+
+// Двоично-безопасные функции без выделения памяти: вход — (input, input_size),
+// результат (того же размера) пишется в output ёмкостью output_capacity, его
+// размер — в *output_size. output может совпадать с input. Запрос размера:
+// output == NULL — возвращается ROT13_STATUS_BUFFER_TOO_SMALL и требуемый размер.
+// in_place, parallel и thread_count в options не используются. Пустой ключ или
+// ключ длиннее ROT13_INTO_MAX_KEY_SIZE — ROT13_STATUS_INVALID_ARGUMENT.
+DLL_EXPORT Rot13StatusC encodeRot13XorInto_C(const unsigned char* input, size_t input_size, unsigned char* output,
+                                             size_t output_capacity, size_t* output_size, const Rot13OptionsC* options);
+DLL_EXPORT Rot13StatusC decodeRot13XorInto_C(const unsigned char* input, size_t input_size, unsigned char* output,
+                                             size_t output_capacity, size_t* output_size, const Rot13OptionsC* options);
 
 // Функции для освобождения памяти, выделенной внутри библиотеки
 DLL_EXPORT void free_rot13_encoded_result_C(EncodedResultC* result);
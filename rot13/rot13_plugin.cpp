@@ -0,0 +1,249 @@
+// Дескриптор плагина ROT13 + XOR (см. plugin/cipher_plugin.h).
+// Параметры: "cyrillic", "rot=N", "xor-key=hex".
+
+#include "cipher_plugin.h"
+#include "cipher_plugin_util.hpp"
+#include "cipher_stats.hpp"
+#include "rot13_bitwise.h"
+#include "rot13_simd.h"
+#include <string>
+#include <vector>
+
+// Переводит строку параметров задания в Rot13Options; неизвестное имя — ошибка.
+static bool parseRot13Options(const CipherParamsC* params, Rot13Options& options, std::string& error) {
+    try {
+        for (const PluginOption& option : parsePluginOptions(params ? params->options : nullptr)) {
+            if (option.name == "cyrillic" && !option.has_value) {
+                options.cyrillic = true;
+            } else if (option.name == "rot" && option.has_value) {
+                options.rotation = std::stoi(option.value);
+            } else if (option.name == "xor-key" && option.has_value) {
+                options.xor_key = pluginHexToBytes(option.value);
+            } else {
+                error = "Error: unsupported rot13 option '" + option.name + "'.";
+                return false;
+            }
+        }
+    } catch (const std::exception& e) {
+        error = std::string("Error: invalid rot13 option: ") + e.what();
+        return false;
+    }
+    return true;
+}
+
+static bool prepareRot13(const CipherParamsC* params, Rot13Options& options, Rot13XorCipher& cipher,
+                         std::string& error) {
+    if (!parseRot13Options(params, options, error)) return false;
+    try {
+        cipher = Rot13XorCipher(options.rotation, options.xor_key);
+        return true;
+    } catch (const std::invalid_argument& e) {
+        error = std::string("Error: ") + e.what();
+        return false;
+    }
+}
+
+// Каждый буфер — отдельный текст: фаза ключа отсчитывается от его начала.
+static CipherResultC transformBuffer(const Rot13XorCipher& cipher, const Rot13Options& options,
+                                     const unsigned char* data, size_t size, Rot13XorDirection direction) {
+    CipherResultC result = pluginData(data, size);
+    if (options.cyrillic) {
+        cipher.transformUtf8(result.data, result.data, size, direction, true);
+    } else {
+        cipher.transform(result.data, result.data, size, direction);
+    }
+    return result;
+}
+
+static CipherResultC rot13Buffer(const unsigned char* data, size_t size, const CipherParamsC* params,
+                                 Rot13XorDirection direction) {
+    Rot13Options options;
+    Rot13XorCipher cipher;
+    std::string error;
+    if (!prepareRot13(params, options, cipher, error)) return pluginError(error);
+    return transformBuffer(cipher, options, data, size, direction);
+}
+
+// Таблицы и ядро готовятся один раз на весь пакет.
+static bool rot13Batch(const CipherBufferC* inputs, size_t count, const CipherParamsC* params,
+                       CipherResultC* results, Rot13XorDirection direction) {
+    Rot13Options options;
+    Rot13XorCipher cipher;
+    std::string error;
+    if (!prepareRot13(params, options, cipher, error)) {
+        for (size_t i = 0; i < count; ++i) results[i] = pluginError(error);
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        results[i] = transformBuffer(cipher, options, inputs[i].data, inputs[i].size, direction);
+    }
+    return true;
+}
+
+static CipherResultC rot13File(const char* inputPath, const char* outputPath, const CipherParamsC* params,
+                               bool encode) {
+    Rot13Options options;
+    std::string error;
+    if (!parseRot13Options(params, options, error)) return pluginError(error);
+    if (!inputPath) return pluginError("Error: input file is not specified.");
+
+    uint32_t flags = params ? params->flags : 0;
+    const CipherStatsSinkC* stats = params ? params->stats : nullptr;
+    FileOperationResult result;
+    if (flags & CIPHER_JOB_IN_PLACE) {
+        size_t window = params->msync_window;
+        result = encode ? encodeFileRot13XorInPlace(inputPath, window, options, stats)
+                        : decodeFileRot13XorInPlace(inputPath, window, options, stats);
+    } else if (!outputPath) {
+        return pluginError("Error: output file is not specified.");
+    } else if (flags & CIPHER_JOB_PARALLEL) {
+        unsigned threads = params->thread_count;
+        result = encode ? encodeFileRot13XorParallel(inputPath, outputPath, threads, 0, options, stats)
+                        : decodeFileRot13XorParallel(inputPath, outputPath, threads, 0, options, stats);
+    } else {
+        result = encode ? encodeFileRot13Xor(inputPath, outputPath, options, stats)
+                        : decodeFileRot13Xor(inputPath, outputPath, options, stats);
+    }
+    return result.success ? pluginSuccess(result.message) : pluginError(result.message);
+}
+
+// Состояние потока: offset — позиция следующего байта (фаза ключа), carry —
+// ведущий байт кириллицы, пара которого ещё не пришла.
+struct Rot13Stream {
+    Rot13Options options;
+    Rot13XorCipher cipher;
+    Rot13XorDirection direction = Rot13XorDirection::Encode;
+    uint64_t offset = 0;
+    std::vector<unsigned char> carry;
+    std::vector<unsigned char> out;
+};
+
+static CipherResultC rot13StreamEmit(Rot13Stream* stream, const unsigned char* data, size_t size, bool final,
+                                     CipherSinkFunc sink, void* context) {
+    std::vector<unsigned char>& out = stream->out;
+    size_t processed = size;
+    if (stream->options.cyrillic) {
+        out.assign(stream->carry.begin(), stream->carry.end());
+        out.insert(out.end(), data, data + size);
+        processed = stream->cipher.transformUtf8(out.data(), out.data(), out.size(), stream->direction, final,
+                                                 stream->offset);
+        stream->carry.assign(out.begin() + processed, out.end());
+    } else {
+        out.resize(size);
+        stream->cipher.transform(data, out.data(), size, stream->direction, stream->offset);
+    }
+    stream->offset += processed;
+    if (processed && !sink(context, out.data(), processed)) {
+        return pluginError("Error: stream output was rejected.");
+    }
+    return pluginSuccess("");
+}
+
+// Размер результата равен размеру входа, output может совпадать с data.
+static int rot13Into(const unsigned char* data, size_t size, unsigned char* output, size_t capacity,
+                     size_t* output_size, const CipherParamsC* params, Rot13XorDirection direction) {
+    if (!output_size || (!data && size)) return CIPHER_STATUS_INVALID_ARGUMENT;
+    *output_size = size;
+    Rot13Options options;
+    Rot13XorCipher cipher;
+    std::string error;
+    if (!prepareRot13(params, options, cipher, error)) return CIPHER_STATUS_INVALID_ARGUMENT;
+    if (capacity < size || (!output && size)) return CIPHER_STATUS_BUFFER_TOO_SMALL;
+    if (options.cyrillic) {
+        cipher.transformUtf8(data, output, size, direction, true);
+    } else {
+        cipher.transform(data, output, size, direction);
+    }
+    return CIPHER_STATUS_OK;
+}
+
+extern "C" {
+
+static CipherResultC rot13EncodeBuffer(const unsigned char* data, size_t size, const CipherParamsC* params) {
+    return rot13Buffer(data, size, params, Rot13XorDirection::Encode);
+}
+
+static CipherResultC rot13DecodeBuffer(const unsigned char* data, size_t size, const CipherParamsC* params) {
+    return rot13Buffer(data, size, params, Rot13XorDirection::Decode);
+}
+
+static CipherResultC rot13EncodeFile(const char* inputPath, const char* outputPath, const CipherParamsC* params) {
+    return rot13File(inputPath, outputPath, params, true);
+}
+
+static CipherResultC rot13DecodeFile(const char* inputPath, const char* outputPath, const CipherParamsC* params) {
+    return rot13File(inputPath, outputPath, params, false);
+}
+
+static bool rot13EncodeBatch(const CipherBufferC* inputs, size_t count, const CipherParamsC* params,
+                             CipherResultC* results) {
+    return rot13Batch(inputs, count, params, results, Rot13XorDirection::Encode);
+}
+
+static bool rot13DecodeBatch(const CipherBufferC* inputs, size_t count, const CipherParamsC* params,
+                             CipherResultC* results) {
+    return rot13Batch(inputs, count, params, results, Rot13XorDirection::Decode);
+}
+
+static CipherResultC rot13StreamOpen(bool encode, const CipherParamsC* params, void** stream) {
+    CipherStageTimer timer(params ? params->stats : nullptr, CIPHER_STAGE_PARSE);
+    Rot13Stream* state = new Rot13Stream;
+    std::string error;
+    if (!prepareRot13(params, state->options, state->cipher, error)) {
+        delete state;
+        return pluginError(error);
+    }
+    state->direction = encode ? Rot13XorDirection::Encode : Rot13XorDirection::Decode;
+    *stream = state;
+    return pluginSuccess("");
+}
+
+static CipherResultC rot13StreamUpdate(void* stream, const unsigned char* data, size_t size, CipherSinkFunc sink,
+                                       void* context) {
+    return rot13StreamEmit(static_cast<Rot13Stream*>(stream), data, size, false, sink, context);
+}
+
+static CipherResultC rot13StreamFinish(void* stream, CipherSinkFunc sink, void* context) {
+    return rot13StreamEmit(static_cast<Rot13Stream*>(stream), nullptr, 0, true, sink, context);
+}
+
+static void rot13StreamClose(void* stream) {
+    delete static_cast<Rot13Stream*>(stream);
+}
+
+static int rot13EncodeInto(const unsigned char* data, size_t size, unsigned char* output, size_t capacity,
+                           size_t* output_size, const CipherParamsC* params) {
+    return rot13Into(data, size, output, capacity, output_size, params, Rot13XorDirection::Encode);
+}
+
+static int rot13DecodeInto(const unsigned char* data, size_t size, unsigned char* output, size_t capacity,
+                           size_t* output_size, const CipherParamsC* params) {
+    return rot13Into(data, size, output, capacity, output_size, params, Rot13XorDirection::Decode);
+}
+
+extern const CipherPluginDescriptor CIPHER_PLUGIN_DESCRIPTOR(rot13) = {
+    CIPHER_PLUGIN_ABI_VERSION,
+    sizeof(CipherPluginDescriptor),
+    "rot13",
+    "ROT-N + XOR (параметры: cyrillic, rot=N, xor-key=hex)",
+    CIPHER_CAP_BUFFER | CIPHER_CAP_FILE | CIPHER_CAP_STREAMING | CIPHER_CAP_IN_PLACE | CIPHER_CAP_PARALLEL |
+        CIPHER_CAP_BATCH | CIPHER_CAP_CHUNKED | CIPHER_CAP_INTO,
+    rot13EncodeBuffer,
+    rot13DecodeBuffer,
+    rot13EncodeFile,
+    rot13DecodeFile,
+    nullptr,
+    rot13EncodeBatch,
+    rot13DecodeBatch,
+    pluginFreeResult,
+    rot13StreamOpen,
+    rot13StreamUpdate,
+    rot13StreamFinish,
+    rot13StreamClose,
+    rot13EncodeInto,
+    rot13DecodeInto,
+    nullptr,
+    0,
+};
+
+}
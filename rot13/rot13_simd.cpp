@@ -0,0 +1,706 @@
+#include "rot13_simd.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ROT13_HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr int LATIN_ALPHABET_SIZE = 26;
+constexpr int CYRILLIC_ALPHABET_SIZE = 33;
+
+// Ширина самого широкого вектора: от любой фазы ключа в key_stream должно быть
+// доступно столько байт (плюс один байт просмотра вперёд для кириллицы).
+constexpr std::size_t MAX_VECTOR_WIDTH = 64;
+
+constexpr int normalize_shift(int shift, int modulo) {
+    return (shift % modulo + modulo) % modulo;
+}
+
+constexpr unsigned char rotate_latin(unsigned char c, int shift) {
+    if (c >= 'a' && c <= 'z') return static_cast<unsigned char>((c - 'a' + shift) % LATIN_ALPHABET_SIZE + 'a');
+    if (c >= 'A' && c <= 'Z') return static_cast<unsigned char>((c - 'A' + shift) % LATIN_ALPHABET_SIZE + 'A');
+    return c;
+}
+
+// --- Кириллица ---
+// Двухбайтовые последовательности D0/D1 xx покрывают U+0400..U+047F; индекс таблицы
+// (lead & 1) * 64 + (cont & 0x3F). Записи хранят пару после вращения (без XOR).
+
+struct Utf8Pair {
+    unsigned char lead;
+    unsigned char cont;
+};
+
+// Позиция буквы в алфавите А Б В Г Д Е Ё Ж ... Я или -1.
+constexpr int cyrillic_index(unsigned cp, unsigned base, unsigned yo) {
+    if (cp == yo) return 6;
+    if (cp >= base && cp < base + 32) {
+        int k = static_cast<int>(cp - base);
+        return k < 6 ? k : k + 1;
+    }
+    return -1;
+}
+
+constexpr unsigned cyrillic_codepoint(int index, unsigned base, unsigned yo) {
+    if (index == 6) return yo;
+    return base + static_cast<unsigned>(index < 6 ? index : index - 1);
+}
+
+constexpr unsigned rotate_cyrillic(unsigned cp, int shift) {
+    const unsigned bases[2][2] = {{0x410, 0x401}, {0x430, 0x451}};  // прописные, строчные
+    for (const auto& letters : bases) {
+        int index = cyrillic_index(cp, letters[0], letters[1]);
+        if (index >= 0) {
+            return cyrillic_codepoint(normalize_shift(index + shift, CYRILLIC_ALPHABET_SIZE), letters[0], letters[1]);
+        }
+    }
+    return cp;
+}
+
+constexpr std::array<Utf8Pair, 128> build_cyrillic_table(int shift) {
+    std::array<Utf8Pair, 128> table{};
+    for (unsigned i = 0; i < 128; ++i) {
+        unsigned cp = rotate_cyrillic(0x400 + i, shift);
+        table[i] = {static_cast<unsigned char>(0xC0 | (cp >> 6)), static_cast<unsigned char>(0x80 | (cp & 0x3F))};
+    }
+    return table;
+}
+
+static_assert(rotate_cyrillic(rotate_cyrillic(0x401, 13), -13) == 0x401, "Cyrillic rotation must be invertible.");
+
+constexpr bool is_cyrillic_lead(unsigned char b) { return b == 0xD0 || b == 0xD1; }
+constexpr bool is_continuation(unsigned char b) { return (b & 0xC0) == 0x80; }
+
+// Размер блока, обрабатываемого скалярно, и предел одного ASCII-отрезка
+// (чтобы сканирование и преобразование шли по данным, ещё лежащим в L1).
+constexpr std::size_t UTF8_SCALAR_BLOCK = 64;
+constexpr std::size_t UTF8_ASCII_RUN_LIMIT = 16 * 1024;
+// Ширина блока векторной обработки кириллицы (плюс один байт просмотра вперёд).
+constexpr std::size_t CYRILLIC_BLOCK = 32;
+
+} // namespace
+
+struct Rot13XorCipher::State {
+    using TransformFunc = void (*)(const State&, const unsigned char*, unsigned char*, std::size_t,
+                                   Rot13XorDirection, std::size_t);
+    using AsciiPrefixFunc = std::size_t (*)(const State&, const unsigned char*, std::size_t, Rot13XorDirection,
+                                            std::size_t);
+    using CyrillicRunFunc = std::size_t (*)(const State&, const unsigned char*, unsigned char*, std::size_t,
+                                            Rot13XorDirection, std::size_t);
+
+    int latin_shift = 0;     // сдвиг латиницы при кодировании, 0..25
+    int cyrillic_shift = 0;  // сдвиг кириллицы при кодировании, 0..32
+    std::size_t key_size = 0;
+    // Ключ, повторённый до key_size + MAX_VECTOR_WIDTH + 1 байт: ключ для позиции с
+    // фазой p начинается с key_stream[p], что позволяет загружать его вектором.
+    // Лежит в owned_key_stream или, для состояния в стеке, в памяти вызывающего.
+    const unsigned char* key_stream = nullptr;
+    std::vector<unsigned char> owned_key_stream;
+    std::array<unsigned char, 256> latin_encode{};  // таблицы вращения без XOR
+    std::array<unsigned char, 256> latin_decode{};
+    std::array<Utf8Pair, 128> cyrillic_encode{};
+    std::array<Utf8Pair, 128> cyrillic_decode{};
+
+    // Последний аргумент ядер — фаза ключа (offset mod key_size).
+    TransformFunc transform = nullptr;
+    AsciiPrefixFunc ascii_prefix = nullptr;
+    CyrillicRunFunc cyrillic_run = nullptr;  // nullptr — только скалярный декодер
+
+    int latin_shift_for(Rot13XorDirection direction) const {
+        return direction == Rot13XorDirection::Encode ? latin_shift
+                                                      : normalize_shift(-latin_shift, LATIN_ALPHABET_SIZE);
+    }
+    int cyrillic_shift_for(Rot13XorDirection direction) const {
+        return direction == Rot13XorDirection::Encode ? cyrillic_shift
+                                                      : normalize_shift(-cyrillic_shift, CYRILLIC_ALPHABET_SIZE);
+    }
+};
+
+namespace {
+
+using State = Rot13XorCipher::State;
+
+// Фаза ключа при проходе векторами ширины Width. Для KeyLen != 0 длина известна при
+// компиляции; если Width кратна KeyLen, фаза не меняется (Fixed) и вектор ключа
+// загружается один раз до цикла.
+template <std::size_t KeyLen, std::size_t Width>
+class KeyCursor {
+public:
+    static constexpr bool Fixed = KeyLen != 0 && Width % KeyLen == 0;
+
+    KeyCursor(const State& state, std::size_t phase)
+        : stream_(state.key_stream),
+          size_(KeyLen != 0 ? KeyLen : state.key_size),
+          step_(Width % size_),
+          phase_(phase) {}
+
+    const unsigned char* at() const { return stream_ + phase_; }
+    std::size_t phase() const { return phase_; }
+
+    void advance() {
+        if constexpr (!Fixed) {
+            phase_ += step_;
+            if (phase_ >= size_) phase_ -= size_;
+        }
+    }
+
+private:
+    const unsigned char* stream_;
+    std::size_t size_;
+    std::size_t step_;
+    std::size_t phase_;
+};
+
+template <std::size_t KeyLen>
+void transform_scalar(const State& state, const unsigned char* in, unsigned char* out, std::size_t size,
+                      Rot13XorDirection direction, std::size_t phase) {
+    KeyCursor<KeyLen, 1> key(state, phase);
+    if (direction == Rot13XorDirection::Encode) {
+        const unsigned char* table = state.latin_encode.data();
+        for (std::size_t i = 0; i < size; ++i) {
+            out[i] = static_cast<unsigned char>(table[in[i]] ^ *key.at());
+            key.advance();
+        }
+    } else {
+        const unsigned char* table = state.latin_decode.data();
+        for (std::size_t i = 0; i < size; ++i) {
+            out[i] = table[in[i] ^ *key.at()];
+            key.advance();
+        }
+    }
+}
+
+std::size_t ascii_prefix_scalar(const State& state, const unsigned char* in, std::size_t size,
+                                Rot13XorDirection direction, std::size_t phase) {
+    std::size_t i = 0;
+    if (direction == Rot13XorDirection::Encode) {
+        while (i < size && (in[i] & 0x80) == 0) ++i;
+        return i;
+    }
+    KeyCursor<0, 1> key(state, phase);
+    while (i < size && ((in[i] ^ *key.at()) & 0x80) == 0) {
+        ++i;
+        key.advance();
+    }
+    return i;
+}
+
+#ifdef ROT13_HAVE_X86_KERNELS
+
+// Векторный ROT-N: у букв t = (c | 0x20) - 'a' < 26; буквы с t <= 25 - N
+// сдвигаются на +N, остальные — на N - 26. Прочие байты не меняются.
+
+__attribute__((target("sse2")))
+inline __m128i rotate_sse2(__m128i v, __m128i up, __m128i down, __m128i limit) {
+    const __m128i t = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(25)), t);
+    const __m128i low = _mm_cmpeq_epi8(_mm_min_epu8(t, limit), t);
+    const __m128i delta = _mm_or_si128(_mm_and_si128(low, up), _mm_andnot_si128(low, down));
+    return _mm_add_epi8(v, _mm_and_si128(delta, is_alpha));
+}
+
+template <std::size_t KeyLen>
+__attribute__((target("sse2")))
+void transform_sse2(const State& state, const unsigned char* in, unsigned char* out, std::size_t size,
+                    Rot13XorDirection direction, std::size_t phase) {
+    using Cursor = KeyCursor<KeyLen, 16>;
+    Cursor key(state, phase);
+    const int shift = state.latin_shift_for(direction);
+    const __m128i up = _mm_set1_epi8(static_cast<char>(shift));
+    const __m128i down = _mm_set1_epi8(static_cast<char>(shift - LATIN_ALPHABET_SIZE));
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(LATIN_ALPHABET_SIZE - 1 - shift));
+    const bool encode = direction == Rot13XorDirection::Encode;
+
+    __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.at()));
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        if constexpr (!Cursor::Fixed) k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.at()));
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        v = encode ? _mm_xor_si128(rotate_sse2(v, up, down, limit), k)
+                   : rotate_sse2(_mm_xor_si128(v, k), up, down, limit);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+        key.advance();
+    }
+    transform_scalar<KeyLen>(state, in + i, out + i, size - i, direction, key.phase());
+}
+
+__attribute__((target("avx2")))
+inline __m256i rotate_avx2(__m256i v, __m256i up, __m256i down, __m256i limit) {
+    const __m256i t = _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const __m256i is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(25)), t);
+    const __m256i low = _mm256_cmpeq_epi8(_mm256_min_epu8(t, limit), t);
+    const __m256i delta = _mm256_blendv_epi8(down, up, low);
+    return _mm256_add_epi8(v, _mm256_and_si256(delta, is_alpha));
+}
+
+template <std::size_t KeyLen>
+__attribute__((target("avx2")))
+void transform_avx2(const State& state, const unsigned char* in, unsigned char* out, std::size_t size,
+                    Rot13XorDirection direction, std::size_t phase) {
+    using Cursor = KeyCursor<KeyLen, 32>;
+    Cursor key(state, phase);
+    const int shift = state.latin_shift_for(direction);
+    const __m256i up = _mm256_set1_epi8(static_cast<char>(shift));
+    const __m256i down = _mm256_set1_epi8(static_cast<char>(shift - LATIN_ALPHABET_SIZE));
+    const __m256i limit = _mm256_set1_epi8(static_cast<char>(LATIN_ALPHABET_SIZE - 1 - shift));
+    const bool encode = direction == Rot13XorDirection::Encode;
+
+    __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key.at()));
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        if constexpr (!Cursor::Fixed) k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key.at()));
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        v = encode ? _mm256_xor_si256(rotate_avx2(v, up, down, limit), k)
+                   : rotate_avx2(_mm256_xor_si256(v, k), up, down, limit);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+        key.advance();
+    }
+    transform_scalar<KeyLen>(state, in + i, out + i, size - i, direction, key.phase());
+}
+
+__attribute__((target("avx512bw")))
+inline __m512i rotate_avx512(__m512i v, __m512i up, __m512i down, __m512i limit) {
+    const __m512i t = _mm512_sub_epi8(_mm512_or_si512(v, _mm512_set1_epi8(0x20)), _mm512_set1_epi8('a'));
+    const __mmask64 is_alpha = _mm512_cmple_epu8_mask(t, _mm512_set1_epi8(25));
+    const __mmask64 low = _mm512_cmple_epu8_mask(t, limit);
+    const __m512i delta = _mm512_mask_blend_epi8(low, down, up);
+    return _mm512_mask_add_epi8(v, is_alpha, v, delta);
+}
+
+template <std::size_t KeyLen>
+__attribute__((target("avx512bw")))
+void transform_avx512(const State& state, const unsigned char* in, unsigned char* out, std::size_t size,
+                      Rot13XorDirection direction, std::size_t phase) {
+    using Cursor = KeyCursor<KeyLen, 64>;
+    Cursor key(state, phase);
+    const int shift = state.latin_shift_for(direction);
+    const __m512i up = _mm512_set1_epi8(static_cast<char>(shift));
+    const __m512i down = _mm512_set1_epi8(static_cast<char>(shift - LATIN_ALPHABET_SIZE));
+    const __m512i limit = _mm512_set1_epi8(static_cast<char>(LATIN_ALPHABET_SIZE - 1 - shift));
+    const bool encode = direction == Rot13XorDirection::Encode;
+
+    __m512i k = _mm512_loadu_si512(key.at());
+    std::size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        if constexpr (!Cursor::Fixed) k = _mm512_loadu_si512(key.at());
+        __m512i v = _mm512_loadu_si512(in + i);
+        v = encode ? _mm512_xor_si512(rotate_avx512(v, up, down, limit), k)
+                   : rotate_avx512(_mm512_xor_si512(v, k), up, down, limit);
+        _mm512_storeu_si512(out + i, v);
+        key.advance();
+    }
+    if (i < size) {
+        // Хвост обрабатывается маскированными загрузкой и записью.
+        if constexpr (!Cursor::Fixed) k = _mm512_loadu_si512(key.at());
+        const __mmask64 tail = (1ull << (size - i)) - 1;
+        __m512i v = _mm512_maskz_loadu_epi8(tail, in + i);
+        v = encode ? _mm512_xor_si512(rotate_avx512(v, up, down, limit), k)
+                   : rotate_avx512(_mm512_xor_si512(v, k), up, down, limit);
+        _mm512_mask_storeu_epi8(out + i, tail, v);
+    }
+}
+
+// --- Векторная обработка кириллицы (AVX2) ---
+// Блок из 32 байт, в котором каждый байт — ASCII или часть пары D0/D1 + продолжение,
+// преобразуется целиком: по второму байту пары вычисляется смещение t = cp - 0x400,
+// буква переводится в номер в алфавите, сдвигается и кодируется обратно.
+
+__attribute__((target("avx2")))
+inline __m256i shift_up_1_avx2(__m256i v) {  // r[j] = v[j - 1], r[0] = 0
+    return _mm256_alignr_epi8(v, _mm256_permute2x128_si256(v, v, 0x08), 15);
+}
+
+__attribute__((target("avx2")))
+inline __m256i shift_down_1_avx2(__m256i v) {  // r[j] = v[j + 1], r[31] = 0
+    return _mm256_alignr_epi8(_mm256_permute2x128_si256(v, v, 0x81), v, 1);
+}
+
+__attribute__((target("avx2")))
+inline __m256i expand_mask_avx2(uint32_t mask) {  // бит j -> байт j = 0xFF
+    const __m256i select = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                            2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i bits = _mm256_set1_epi64x(static_cast<long long>(0x8040201008040201ull));
+    __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int>(mask)), select);
+    return _mm256_cmpeq_epi8(_mm256_and_si256(v, bits), bits);
+}
+
+__attribute__((target("avx2")))
+inline __m256i in_range_avx2(__m256i v, char lo, char hi) {  // lo <= v <= hi, v < 0x80
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), v));
+}
+
+// Возвращает число записанных байт (31 или 32) либо 0, если блок нужно обработать
+// скалярно. Читает 33 байта входа и ключа: последний нужен, чтобы распознать пару
+// на границе. latin — векторы up/down/limit для rotate_avx2.
+__attribute__((target("avx2")))
+inline std::size_t cyrillic_block_avx2(const unsigned char* in, unsigned char* out, const unsigned char* key,
+                                       bool encode, int shift, const __m256i* latin) {
+    const __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key));
+    const __m256i in_key = encode ? _mm256_setzero_si256() : k;
+    const __m256i out_key = encode ? k : _mm256_setzero_si256();
+
+    const __m256i x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)), in_key);
+    const unsigned char next = static_cast<unsigned char>(in[32] ^ (encode ? 0 : key[32]));
+
+    const __m256i is_lead = _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(static_cast<char>(0xD0))),
+                                            _mm256_cmpeq_epi8(x, _mm256_set1_epi8(static_cast<char>(0xD1))));
+    const __m256i is_cont = _mm256_cmpeq_epi8(_mm256_and_si256(x, _mm256_set1_epi8(static_cast<char>(0xC0))),
+                                              _mm256_set1_epi8(static_cast<char>(0x80)));
+    const auto lead = static_cast<uint32_t>(_mm256_movemask_epi8(is_lead));
+    const auto cont = static_cast<uint32_t>(_mm256_movemask_epi8(is_cont));
+    const auto non_ascii = static_cast<uint32_t>(_mm256_movemask_epi8(x));
+
+    const uint32_t starts = lead & ((cont >> 1) | (is_continuation(next) ? 0x80000000u : 0u));
+    const uint32_t seconds = starts << 1;
+    if ((non_ascii & ~(starts | seconds)) != 0) return 0;
+
+    // t = cp - 0x400 для второго байта пары (0..127, знаковые сравнения корректны).
+    const __m256i prev = shift_up_1_avx2(x);
+    const __m256i lead_odd = _mm256_cmpeq_epi8(_mm256_and_si256(prev, _mm256_set1_epi8(1)), _mm256_set1_epi8(1));
+    const __m256i t = _mm256_or_si256(_mm256_and_si256(lead_odd, _mm256_set1_epi8(0x40)),
+                                      _mm256_and_si256(x, _mm256_set1_epi8(0x3F)));
+
+    const __m256i upper = in_range_avx2(t, 0x10, 0x2F);
+    const __m256i lower = in_range_avx2(t, 0x30, 0x4F);
+    const __m256i yo_upper = _mm256_cmpeq_epi8(t, _mm256_set1_epi8(0x01));
+    const __m256i yo_lower = _mm256_cmpeq_epi8(t, _mm256_set1_epi8(0x51));
+    const __m256i is_lower_case = _mm256_or_si256(lower, yo_lower);
+    const __m256i yo = _mm256_or_si256(yo_upper, yo_lower);
+    const __m256i letter = _mm256_or_si256(_mm256_or_si256(upper, lower), yo);
+
+    const __m256i base = _mm256_blendv_epi8(_mm256_set1_epi8(0x10), _mm256_set1_epi8(0x30), is_lower_case);
+    const __m256i index = _mm256_sub_epi8(t, base);
+    // Номер в алфавите: буквы после Е сдвинуты на одну позицию из-за Ё.
+    __m256i ord = _mm256_sub_epi8(index, _mm256_cmpgt_epi8(index, _mm256_set1_epi8(5)));
+    ord = _mm256_blendv_epi8(ord, _mm256_set1_epi8(6), yo);
+    ord = _mm256_add_epi8(ord, _mm256_set1_epi8(static_cast<char>(shift)));
+    ord = _mm256_sub_epi8(ord, _mm256_and_si256(_mm256_cmpgt_epi8(ord, _mm256_set1_epi8(CYRILLIC_ALPHABET_SIZE - 1)),
+                                                _mm256_set1_epi8(CYRILLIC_ALPHABET_SIZE)));
+    const __m256i index2 = _mm256_add_epi8(ord, _mm256_cmpgt_epi8(ord, _mm256_set1_epi8(6)));
+    __m256i t2 = _mm256_add_epi8(base, index2);
+    const __m256i yo_t = _mm256_blendv_epi8(_mm256_set1_epi8(0x01), _mm256_set1_epi8(0x51), is_lower_case);
+    t2 = _mm256_blendv_epi8(t2, yo_t, _mm256_cmpeq_epi8(ord, _mm256_set1_epi8(6)));
+    const __m256i t_new = _mm256_blendv_epi8(t, t2, letter);
+
+    const __m256i new_cont = _mm256_or_si256(_mm256_set1_epi8(static_cast<char>(0x80)),
+                                             _mm256_and_si256(t_new, _mm256_set1_epi8(0x3F)));
+    const __m256i new_lead = _mm256_or_si256(_mm256_set1_epi8(static_cast<char>(0xD0)),
+                                             _mm256_and_si256(_mm256_cmpgt_epi8(t_new, _mm256_set1_epi8(0x3F)),
+                                                              _mm256_set1_epi8(1)));
+
+    __m256i result = rotate_avx2(x, latin[0], latin[1], latin[2]);
+    result = _mm256_blendv_epi8(result, new_cont, expand_mask_avx2(seconds));
+    result = _mm256_blendv_epi8(result, shift_down_1_avx2(new_lead), expand_mask_avx2(starts));
+    result = _mm256_xor_si256(result, out_key);
+
+    // Пара, начинающаяся в последнем байте, достанется следующему блоку:
+    // её первый байт восстанавливается (важно при in == out).
+    const unsigned char last = in[31];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), result);
+    if (starts & 0x80000000u) {
+        out[31] = last;
+        return 31;
+    }
+    return 32;
+}
+
+// Обрабатывает подряд идущие блоки смешанного ASCII/кириллического текста;
+// возвращает число обработанных байт (0 — первый блок требует скалярного декодера).
+__attribute__((target("avx2")))
+std::size_t cyrillic_run_avx2(const State& state, const unsigned char* in, unsigned char* out, std::size_t size,
+                              Rot13XorDirection direction, std::size_t phase) {
+    const bool encode = direction == Rot13XorDirection::Encode;
+    const int shift = state.latin_shift_for(direction);
+    const __m256i latin[3] = {_mm256_set1_epi8(static_cast<char>(shift)),
+                              _mm256_set1_epi8(static_cast<char>(shift - LATIN_ALPHABET_SIZE)),
+                              _mm256_set1_epi8(static_cast<char>(LATIN_ALPHABET_SIZE - 1 - shift))};
+    const int cyrillic_shift = state.cyrillic_shift_for(direction);
+    const std::size_t key_size = state.key_size;
+    const std::size_t step_short = (CYRILLIC_BLOCK - 1) % key_size;
+    const std::size_t step_full = CYRILLIC_BLOCK % key_size;
+
+    std::size_t i = 0;
+    while (size - i > CYRILLIC_BLOCK) {
+        std::size_t done = cyrillic_block_avx2(in + i, out + i, state.key_stream + phase, encode,
+                                               cyrillic_shift, latin);
+        if (done == 0) break;
+        i += done;
+        phase += done == CYRILLIC_BLOCK ? step_full : step_short;
+        if (phase >= key_size) phase -= key_size;
+    }
+    return i;
+}
+
+__attribute__((target("sse2")))
+std::size_t ascii_prefix_sse2(const State& state, const unsigned char* in, std::size_t size,
+                              Rot13XorDirection direction, std::size_t phase) {
+    KeyCursor<0, 16> key(state, phase);
+    const bool decode = direction == Rot13XorDirection::Decode;
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        if (decode) v = _mm_xor_si128(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.at())));
+        if (_mm_movemask_epi8(v) != 0) break;
+        key.advance();
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+std::size_t ascii_prefix_avx2(const State& state, const unsigned char* in, std::size_t size,
+                              Rot13XorDirection direction, std::size_t phase) {
+    KeyCursor<0, 32> key(state, phase);
+    const bool decode = direction == Rot13XorDirection::Decode;
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        if (decode) v = _mm256_xor_si256(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key.at())));
+        if (_mm256_movemask_epi8(v) != 0) break;
+        key.advance();
+    }
+    return i;
+}
+
+__attribute__((target("avx512bw")))
+std::size_t ascii_prefix_avx512(const State& state, const unsigned char* in, std::size_t size,
+                                Rot13XorDirection direction, std::size_t phase) {
+    KeyCursor<0, 64> key(state, phase);
+    const bool decode = direction == Rot13XorDirection::Decode;
+    std::size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        __m512i v = _mm512_loadu_si512(in + i);
+        if (decode) v = _mm512_xor_si512(v, _mm512_loadu_si512(key.at()));
+        if (_mm512_movepi8_mask(v) != 0) break;
+        key.advance();
+    }
+    return i;
+}
+
+#endif // ROT13_HAVE_X86_KERNELS
+
+enum class Isa { Scalar, Sse2, Avx2, Avx512bw };
+
+struct IsaChoice {
+    Isa isa;
+    const char* name;
+};
+
+IsaChoice select_isa() {
+    const char* forced = std::getenv("CIPHER_ROT13_KERNEL");
+    auto allowed = [forced](const char* name) {
+        // Принудительный выбор допускает только эту или более простые реализации.
+        static const char* const order[] = {"scalar", "sse2", "avx2", "avx512bw"};
+        if (!forced) return true;
+        int forced_rank = -1, rank = -1;
+        for (int i = 0; i < 4; ++i) {
+            if (std::strcmp(order[i], forced) == 0) forced_rank = i;
+            if (std::strcmp(order[i], name) == 0) rank = i;
+        }
+        return forced_rank < 0 || rank <= forced_rank;
+    };
+#ifdef ROT13_HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (allowed("avx512bw") && __builtin_cpu_supports("avx512bw")) return {Isa::Avx512bw, "avx512bw"};
+    if (allowed("avx2") && __builtin_cpu_supports("avx2")) return {Isa::Avx2, "avx2"};
+    if (allowed("sse2") && __builtin_cpu_supports("sse2")) return {Isa::Sse2, "sse2"};
+#else
+    (void)allowed;
+#endif
+    return {Isa::Scalar, "scalar"};
+}
+
+const IsaChoice& active_isa() {
+    // Инициализация статической переменной потокобезопасна, далее — только чтение.
+    static const IsaChoice choice = select_isa();
+    return choice;
+}
+
+template <std::size_t KeyLen>
+void bind_kernels(State& state, Isa isa) {
+    switch (isa) {
+#ifdef ROT13_HAVE_X86_KERNELS
+    case Isa::Avx512bw:
+        state.transform = transform_avx512<KeyLen>;
+        state.ascii_prefix = ascii_prefix_avx512;
+        state.cyrillic_run = cyrillic_run_avx2;
+        return;
+    case Isa::Avx2:
+        state.transform = transform_avx2<KeyLen>;
+        state.ascii_prefix = ascii_prefix_avx2;
+        state.cyrillic_run = cyrillic_run_avx2;
+        return;
+    case Isa::Sse2:
+        state.transform = transform_sse2<KeyLen>;
+        state.ascii_prefix = ascii_prefix_sse2;
+        state.cyrillic_run = nullptr;
+        return;
+#endif
+    default:
+        state.transform = transform_scalar<KeyLen>;
+        state.ascii_prefix = ascii_prefix_scalar;
+        state.cyrillic_run = nullptr;
+        return;
+    }
+}
+
+// Специализации под распространённые длины ключа; остальные — общий вариант (0).
+void bind_kernels(State& state) {
+    const Isa isa = active_isa().isa;
+    switch (state.key_size) {
+    case 1: bind_kernels<1>(state, isa); break;
+    case 2: bind_kernels<2>(state, isa); break;
+    case 4: bind_kernels<4>(state, isa); break;
+    case 8: bind_kernels<8>(state, isa); break;
+    case 16: bind_kernels<16>(state, isa); break;
+    case 32: bind_kernels<32>(state, isa); break;
+    default: bind_kernels<0>(state, isa); break;
+    }
+}
+
+} // namespace
+
+// stream — key_size + MAX_VECTOR_WIDTH + 1 байт для потока ключа.
+static void init_state(State& state, int rotation, const unsigned char* key, std::size_t key_size,
+                       unsigned char* stream) {
+    state.latin_shift = normalize_shift(rotation, LATIN_ALPHABET_SIZE);
+    state.cyrillic_shift = normalize_shift(rotation, CYRILLIC_ALPHABET_SIZE);
+    state.key_size = key_size;
+    for (std::size_t i = 0; i < key_size + MAX_VECTOR_WIDTH + 1; ++i) {
+        stream[i] = key[i % key_size];
+    }
+    state.key_stream = stream;
+    for (unsigned b = 0; b < 256; ++b) {
+        auto byte = static_cast<unsigned char>(b);
+        state.latin_encode[b] = rotate_latin(byte, state.latin_shift_for(Rot13XorDirection::Encode));
+        state.latin_decode[b] = rotate_latin(byte, state.latin_shift_for(Rot13XorDirection::Decode));
+    }
+    state.cyrillic_encode = build_cyrillic_table(state.cyrillic_shift);
+    state.cyrillic_decode = build_cyrillic_table(-state.cyrillic_shift);
+    bind_kernels(state);
+}
+
+static std::size_t transform_utf8(const State& state, const unsigned char* in, unsigned char* out,
+                                  std::size_t size, Rot13XorDirection direction, bool final, std::uint64_t offset);
+
+Rot13XorCipher::Rot13XorCipher(int rotation, const std::vector<unsigned char>& key) {
+    if (key.empty()) {
+        throw std::invalid_argument("XOR key must not be empty.");
+    }
+    auto state = std::make_shared<State>();
+    state->owned_key_stream.resize(key.size() + MAX_VECTOR_WIDTH + 1);
+    init_state(*state, rotation, key.data(), key.size(), state->owned_key_stream.data());
+    state_ = std::move(state);
+}
+
+void Rot13XorCipher::transform(const unsigned char* in, unsigned char* out, std::size_t size,
+                               Rot13XorDirection direction, std::uint64_t offset) const {
+    const State& state = *state_;
+    state.transform(state, in, out, size, direction, static_cast<std::size_t>(offset % state.key_size));
+}
+
+std::size_t Rot13XorCipher::transformUtf8(const unsigned char* in, unsigned char* out, std::size_t size,
+                                          Rot13XorDirection direction, bool final, std::uint64_t offset) const {
+    return transform_utf8(*state_, in, out, size, direction, final, offset);
+}
+
+bool rot13XorTransformBounded(int rotation, const unsigned char* key, std::size_t key_size, bool utf8,
+                              const unsigned char* in, unsigned char* out, std::size_t size,
+                              Rot13XorDirection direction) noexcept {
+    if (!key || key_size == 0 || key_size > ROT13_BOUNDED_KEY_MAX) return false;
+    State state;  // owned_key_stream остаётся пустым и память не выделяет
+    unsigned char stream[ROT13_BOUNDED_KEY_MAX + MAX_VECTOR_WIDTH + 1];
+    init_state(state, rotation, key, key_size, stream);
+    if (utf8) {
+        transform_utf8(state, in, out, size, direction, true, 0);
+    } else {
+        state.transform(state, in, out, size, direction, 0);
+    }
+    return true;
+}
+
+static std::size_t transform_utf8(const State& state, const unsigned char* in, unsigned char* out,
+                                  std::size_t size, Rot13XorDirection direction, bool final, std::uint64_t offset) {
+    const bool encode = direction == Rot13XorDirection::Encode;
+    const unsigned char* byte_table = encode ? state.latin_encode.data() : state.latin_decode.data();
+    const Utf8Pair* pair_table = encode ? state.cyrillic_encode.data() : state.cyrillic_decode.data();
+    const unsigned char* key = state.key_stream;
+    const std::size_t key_size = state.key_size;
+    auto phase = static_cast<std::size_t>(offset % key_size);
+    auto advance = [&](std::size_t n) { phase = (phase + n) % key_size; };
+    auto step = [&](std::size_t n) {  // n <= 2, без деления
+        phase += n;
+        while (phase >= key_size) phase -= key_size;
+    };
+
+    std::size_t i = 0;
+    while (i < size) {
+        std::size_t run = state.ascii_prefix(state, in + i, std::min(size - i, UTF8_ASCII_RUN_LIMIT), direction, phase);
+        if (run > 0) {
+            state.transform(state, in + i, out + i, run, direction, phase);
+            i += run;
+            advance(run);
+            continue;
+        }
+
+        if (state.cyrillic_run) {
+            std::size_t done = state.cyrillic_run(state, in + i, out + i, size - i, direction, phase);
+            if (done > 0) {
+                i += done;
+                advance(done);
+                continue;
+            }
+        }
+
+        // При кодировании XOR накладывается после вращения, при декодировании — снимается до него.
+        const std::size_t block_end = std::min(i + UTF8_SCALAR_BLOCK, size);
+        while (i < block_end) {
+            const unsigned char k0 = key[phase];
+            const auto lead = static_cast<unsigned char>(encode ? in[i] : in[i] ^ k0);
+            if (is_cyrillic_lead(lead)) {
+                if (i + 1 >= size) {
+                    if (!final) return i;
+                } else {
+                    const unsigned char k1 = key[phase + 1];
+                    const auto cont = static_cast<unsigned char>(encode ? in[i + 1] : in[i + 1] ^ k1);
+                    if (is_continuation(cont)) {
+                        const Utf8Pair& pair = pair_table[(lead & 1) * 64 + (cont & 0x3F)];
+                        out[i] = static_cast<unsigned char>(encode ? pair.lead ^ k0 : pair.lead);
+                        out[i + 1] = static_cast<unsigned char>(encode ? pair.cont ^ k1 : pair.cont);
+                        i += 2;
+                        step(2);
+                        continue;
+                    }
+                }
+            }
+            out[i] = encode ? static_cast<unsigned char>(byte_table[in[i]] ^ k0) : byte_table[in[i] ^ k0];
+            ++i;
+            step(1);
+        }
+    }
+    return i;
+}
+
+bool Rot13XorCipher::utf8PairStartsAt(const unsigned char* in, Rot13XorDirection direction,
+                                      std::uint64_t offset) const {
+    const State& state = *state_;
+    unsigned char k0 = 0, k1 = 0;
+    if (direction == Rot13XorDirection::Decode) {
+        const auto phase = static_cast<std::size_t>(offset % state.key_size);
+        k0 = state.key_stream[phase];
+        k1 = state.key_stream[phase + 1];
+    }
+    return is_cyrillic_lead(static_cast<unsigned char>(in[0] ^ k0)) &&
+           is_continuation(static_cast<unsigned char>(in[1] ^ k1));
+}
+
+const char* rot13XorKernelName() {
+    return active_isa().name;
+}
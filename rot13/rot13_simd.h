@@ -0,0 +1,73 @@
+#ifndef ROT13_SIMD_H
+#define ROT13_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Параметры по умолчанию: сдвиг 13 и однобайтовый ключ XOR.
+constexpr int ROT13_DEFAULT_ROTATION = 13;
+constexpr unsigned char XOR_KEY = 170;
+
+// Направление преобразования (N — сдвиг, key — повторяющийся ключ XOR):
+//   Encode: out[i] = ROT-N(in[i]) ^ key[i mod len]
+//   Decode: out[i] = ROT-(-N)(in[i] ^ key[i mod len])
+enum class Rot13XorDirection { Encode, Decode };
+
+// Подготовленное преобразование ROT-N + XOR. При создании строятся таблицы для
+// сдвига и выбирается ядро (AVX-512BW, AVX2, SSE2 или табличное скалярное),
+// инстанцированное под длину ключа: для длин 1, 2, 4, 8, 16 и 32 байта шаблон
+// специализирован отдельно и вектор ключа загружается один раз, для остальных
+// длин фаза ключа сдвигается на ширину вектора за итерацию.
+// Объект неизменяем, дёшево копируется и может использоваться из нескольких потоков.
+class Rot13XorCipher {
+public:
+    struct State;
+
+    // rotation берётся по модулю 26 для латиницы и по модулю 33 для кириллицы.
+    // Пустой ключ — std::invalid_argument.
+    explicit Rot13XorCipher(int rotation = ROT13_DEFAULT_ROTATION,
+                            const std::vector<unsigned char>& key = {XOR_KEY});
+
+    // offset — позиция in[0] в потоке данных, от неё зависит фаза ключа. Поэтому
+    // части одного файла можно обрабатывать независимо и в любом порядке.
+    // Допускается in == out (преобразование на месте).
+    void transform(const unsigned char* in, unsigned char* out, std::size_t size,
+                   Rot13XorDirection direction, std::uint64_t offset = 0) const;
+
+    // Преобразование UTF-8 текста, при котором кроме латиницы вращается и русский
+    // алфавит из 33 букв (с Ё/ё на своём месте) — на N позиций при кодировании и
+    // обратно при декодировании. Блоки чистого ASCII и смешанного ASCII/кириллицы
+    // обрабатываются векторно, прочие — двухбайтовым скалярным декодером.
+    // Длина не меняется. Если final == false и данные заканчиваются ведущим байтом
+    // кириллицы без продолжения, этот байт не обрабатывается; функция возвращает
+    // число обработанных байт (остаток нужно передать в следующий вызов).
+    std::size_t transformUtf8(const unsigned char* in, unsigned char* out, std::size_t size,
+                              Rot13XorDirection direction, bool final, std::uint64_t offset = 0) const;
+
+    // Начинается ли в in[0] двухбайтовая буква кириллицы (проверяются in[0] и in[1]).
+    // Нужна, чтобы не разрезать такую пару между независимо обрабатываемыми блоками.
+    bool utf8PairStartsAt(const unsigned char* in, Rot13XorDirection direction, std::uint64_t offset = 0) const;
+
+private:
+    std::shared_ptr<const State> state_;
+};
+
+// Наибольшая длина ключа для rot13XorTransformBounded.
+constexpr std::size_t ROT13_BOUNDED_KEY_MAX = 256;
+
+// Однократное преобразование без выделения памяти и без исключений: таблицы и
+// поток ключа строятся в стеке (для функций *Into_C). utf8 — как transformUtf8
+// с final == true, иначе как transform. false — ключ пуст или длиннее
+// ROT13_BOUNDED_KEY_MAX байт.
+bool rot13XorTransformBounded(int rotation, const unsigned char* key, std::size_t key_size, bool utf8,
+                              const unsigned char* in, unsigned char* out, std::size_t size,
+                              Rot13XorDirection direction) noexcept;
+
+// Имя выбранной реализации ("avx512bw", "avx2", "sse2" или "scalar").
+// Переменная окружения CIPHER_ROT13_KERNEL позволяет принудительно выбрать более
+// простую реализацию, например для сравнения производительности.
+const char* rot13XorKernelName();
+
+#endif // ROT13_SIMD_H
@@ -0,0 +1,286 @@
+#include "cipher_async.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using CipherAsyncClock = std::chrono::steady_clock;
+
+// Описатель принадлежит вызывающему и пулу заданий: его освобождает тот, кто
+// отпустит его последним (cipher_async_free или поток пула после выполнения).
+struct CipherAsyncJobC {
+    CipherAsyncWorkFunc run = nullptr;
+    void* work = nullptr;
+    void (*freeWork)(void*) = nullptr;
+    CipherAsyncOptionsC options = {};
+    bool hasDeadline = false;
+    CipherAsyncClock::time_point deadline;
+    CipherProgressC hook = {};
+
+    std::atomic<int> state{CIPHER_ASYNC_QUEUED};
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> timedOut{false};
+    std::atomic<bool> stopped{false};  // остановка передана операции
+    std::atomic<uint64_t> done{0};
+    std::atomic<uint64_t> total{0};
+    std::atomic<int> refs{2};
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::string message;
+    std::string ivHex;
+    bool hasIv = false;
+    bool notified = false;      // обратный вызов done выполнен
+    std::thread::id doneThread;  // поток, выполняющий done
+};
+
+namespace {
+
+bool isFinal(int state) {
+    return state >= CIPHER_ASYNC_SUCCEEDED;
+}
+
+// true — отмена запрошена или срок истёк.
+bool stopRequested(CipherAsyncJobC* job) {
+    if (job->cancelled.load(std::memory_order_relaxed) || job->timedOut.load(std::memory_order_relaxed)) return true;
+    if (job->hasDeadline && CipherAsyncClock::now() >= job->deadline) {
+        job->timedOut.store(true, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void release(CipherAsyncJobC* job) {
+    if (job->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete job;
+}
+
+// Приёмник хода, который получает операция задания.
+int reportProgress(void* context, uint64_t done, uint64_t total) {
+    auto* job = static_cast<CipherAsyncJobC*>(context);
+    job->done.store(done, std::memory_order_relaxed);
+    job->total.store(total, std::memory_order_relaxed);
+    if (job->options.progress) job->options.progress(job->options.context, done, total);
+    if (!stopRequested(job)) return 0;
+    job->stopped.store(true, std::memory_order_relaxed);
+    return 1;
+}
+
+void freeWork(CipherAsyncJobC* job) {
+    if (job->freeWork) job->freeWork(job->work);
+    job->work = nullptr;
+}
+
+// Пул заданий: общая очередь и потоки, которые берут из неё задания по одному.
+// Потоки запускаются при первом задании и отсоединены; как и пул параллельных
+// циклов, пул не разрушается.
+class JobPool {
+public:
+    void submit(CipherAsyncJobC* job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            startWorkers();
+            queue_.push_back(job);
+        }
+        wake_.notify_one();
+    }
+
+    // Убирает ещё не начатое задание из очереди; false — его уже взял поток.
+    bool discard(CipherAsyncJobC* job) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find(queue_.begin(), queue_.end(), job);
+        if (it == queue_.end()) return false;
+        queue_.erase(it);
+        return true;
+    }
+
+    void setWorkers(unsigned count) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            requested_ = count;
+            if (running_ > 0) startWorkers();
+        }
+        wake_.notify_all();
+    }
+
+private:
+    unsigned target() const {
+        return requested_ ? requested_ : std::max(2u, cipher_runtime_default_threads());
+    }
+
+    // Вызывается под mutex_.
+    void startWorkers() {
+        while (running_ < target()) {
+            ++running_;
+            std::thread([this] { workerLoop(); }).detach();
+        }
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this] { return !queue_.empty() || running_ > target(); });
+            if (running_ > target()) {
+                --running_;
+                return;
+            }
+            CipherAsyncJobC* job = queue_.front();
+            queue_.pop_front();
+            job->state.store(CIPHER_ASYNC_RUNNING, std::memory_order_release);
+            lock.unlock();
+            execute(job);
+            lock.lock();
+        }
+    }
+
+    static void execute(CipherAsyncJobC* job) {
+        // Отменённое или просроченное в очереди задание не запускается.
+        if (stopRequested(job)) {
+            job->stopped.store(true);
+            cipher_async_finish(job, 0, nullptr, nullptr);
+        } else {
+            job->run(job, job->work, &job->hook);
+            if (!isFinal(job->state.load(std::memory_order_acquire))) {
+                cipher_async_finish(job, 0, "Error: The operation did not report a result.", nullptr);
+            }
+        }
+        freeWork(job);
+        release(job);
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<CipherAsyncJobC*> queue_;
+    unsigned requested_ = 0;
+    unsigned running_ = 0;
+};
+
+JobPool& pool() {
+    static JobPool* instance = new JobPool;
+    return *instance;
+}
+
+} // namespace
+
+extern "C" {
+
+CIPHER_RUNTIME_API CipherAsyncJobC* cipher_async_submit(CipherAsyncWorkFunc run, void* work,
+                                                        void (*free_work)(void* work),
+                                                        const CipherAsyncOptionsC* options) {
+    auto* job = new CipherAsyncJobC;
+    job->run = run;
+    job->work = work;
+    job->freeWork = free_work;
+    if (options) job->options = *options;
+    if (job->options.deadline_ms) {
+        job->hasDeadline = true;
+        job->deadline = CipherAsyncClock::now() + std::chrono::milliseconds(job->options.deadline_ms);
+    }
+    job->hook.report = reportProgress;
+    job->hook.context = job;
+    pool().submit(job);
+    return job;
+}
+
+CIPHER_RUNTIME_API void cipher_async_finish(CipherAsyncJobC* job, int success, const char* message,
+                                            const char* iv_hex) {
+    int state;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        if (isFinal(job->state.load(std::memory_order_relaxed))) return;
+        // Операция, успевшая закончиться до проверки отмены, считается успешной.
+        if (success) {
+            state = CIPHER_ASYNC_SUCCEEDED;
+        } else if (job->stopped.load() && job->timedOut.load()) {
+            state = CIPHER_ASYNC_TIMED_OUT;
+            message = "Error: Deadline exceeded.";
+        } else if (job->stopped.load()) {
+            state = CIPHER_ASYNC_CANCELLED;
+            message = "Operation cancelled.";
+        } else {
+            state = CIPHER_ASYNC_FAILED;
+        }
+        job->message = message ? message : "";
+        job->hasIv = iv_hex != nullptr;
+        if (iv_hex) job->ivHex = iv_hex;
+        job->doneThread = std::this_thread::get_id();
+        job->state.store(state, std::memory_order_release);
+    }
+    // Ожидающие просыпаются после done, так что к возврату из ожидания
+    // уведомление уже обработано.
+    if (job->options.done) job->options.done(job->options.context, job, static_cast<CipherAsyncStateC>(state));
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->notified = true;
+    }
+    job->finished.notify_all();
+}
+
+CIPHER_RUNTIME_API int cipher_async_stopped(const CipherAsyncJobC* job) {
+    return job->stopped.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+CIPHER_RUNTIME_API CipherAsyncStateC cipher_async_poll(const CipherAsyncJobC* job, uint64_t* done, uint64_t* total) {
+    if (done) *done = job->done.load(std::memory_order_relaxed);
+    if (total) *total = job->total.load(std::memory_order_relaxed);
+    return static_cast<CipherAsyncStateC>(job->state.load(std::memory_order_acquire));
+}
+
+CIPHER_RUNTIME_API CipherAsyncStateC cipher_async_wait(CipherAsyncJobC* job, uint64_t timeout_ms) {
+    std::unique_lock<std::mutex> lock(job->mutex);
+    auto ready = [job] { return job->notified; };
+    if (timeout_ms == CIPHER_ASYNC_WAIT_FOREVER) {
+        job->finished.wait(lock, ready);
+    } else {
+        // Ограничение не даёт переполниться сроку ожидания в наносекундах.
+        uint64_t ms = std::min<uint64_t>(timeout_ms, uint64_t{1} << 40);
+        job->finished.wait_for(lock, std::chrono::milliseconds(ms), ready);
+    }
+    return static_cast<CipherAsyncStateC>(job->state.load(std::memory_order_acquire));
+}
+
+CIPHER_RUNTIME_API void cipher_async_cancel(CipherAsyncJobC* job) {
+    if (isFinal(job->state.load(std::memory_order_acquire))) return;
+    job->cancelled.store(true, std::memory_order_relaxed);
+    // Задание из очереди завершается сразу, не дожидаясь свободного потока.
+    if (pool().discard(job)) {
+        job->stopped.store(true);
+        cipher_async_finish(job, 0, nullptr, nullptr);
+        freeWork(job);
+        release(job);
+    }
+}
+
+CIPHER_RUNTIME_API const char* cipher_async_message(const CipherAsyncJobC* job) {
+    if (!isFinal(job->state.load(std::memory_order_acquire))) return nullptr;
+    return job->message.c_str();
+}
+
+CIPHER_RUNTIME_API const char* cipher_async_iv_hex(const CipherAsyncJobC* job) {
+    if (!isFinal(job->state.load(std::memory_order_acquire)) || !job->hasIv) return nullptr;
+    return job->ivHex.c_str();
+}
+
+CIPHER_RUNTIME_API void cipher_async_free(CipherAsyncJobC* job) {
+    if (!job) return;
+    cipher_async_cancel(job);
+    // Из самого done ждать нечего: описатель до конца done держит поток,
+    // который его вызвал.
+    {
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->finished.wait(lock, [job] {
+            return job->notified || (isFinal(job->state.load(std::memory_order_acquire)) &&
+                                     job->doneThread == std::this_thread::get_id());
+        });
+    }
+    release(job);
+}
+
+CIPHER_RUNTIME_API void cipher_async_set_workers(unsigned count) {
+    pool().setWorkers(count);
+}
+
+}
@@ -0,0 +1,107 @@
+#ifndef CIPHER_ASYNC_H
+#define CIPHER_ASYNC_H
+
+// Асинхронные задания (функции *Async_C мостов).
+//
+// Файловая операция ставится в очередь и выполняется на пуле заданий runtime,
+// а вызывающий сразу получает описатель, по которому опрашивает и ждёт
+// задание, отменяет его или получает уведомление о завершении. Одновременно
+// выполняется не больше заданий, чем потоков в пуле заданий, остальные ждут в
+// очереди, так что число заданий в работе не ограничено числом потоков
+// вызывающего. Пул заданий отделён от пула параллельных циклов
+// (cipher_runtime.h): задание в основном ждёт ввода-вывода, а параллельные
+// вычисления его операции по-прежнему делят общий пул.
+//
+// Отмена и срок кооперативные (см. cipher_progress.h): операция замечает их
+// между блоками, удаляет неполный выход и завершается состоянием
+// CIPHER_ASYNC_CANCELLED или CIPHER_ASYNC_TIMED_OUT. Задание, ещё не
+// начатое к этому моменту, не запускается вовсе.
+
+#include "cipher_progress.h"
+#include "cipher_runtime.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct CipherAsyncJobC CipherAsyncJobC;
+
+typedef enum {
+    CIPHER_ASYNC_QUEUED = 0,
+    CIPHER_ASYNC_RUNNING = 1,
+    CIPHER_ASYNC_SUCCEEDED = 2,
+    CIPHER_ASYNC_FAILED = 3,
+    CIPHER_ASYNC_CANCELLED = 4,
+    CIPHER_ASYNC_TIMED_OUT = 5,
+} CipherAsyncStateC;
+
+// Ход задания; вызывается в потоке пула заданий.
+typedef void (*CipherAsyncProgressFunc)(void* context, uint64_t done, uint64_t total);
+// Завершение задания (state — одно из конечных состояний); вызывается один раз,
+// когда сообщение и IV уже доступны: в потоке пула заданий, а для задания,
+// отменённого до начала, — в потоке, вызвавшем отмену.
+typedef void (*CipherAsyncDoneFunc)(void* context, CipherAsyncJobC* job, CipherAsyncStateC state);
+
+// Параметры задания. Указатель может быть NULL — тогда все поля нулевые.
+typedef struct {
+    CipherAsyncProgressFunc progress;  // NULL — ход доступен только через cipher_async_poll
+    CipherAsyncDoneFunc done;          // NULL — без уведомления
+    void* context;                     // Передаётся progress и done
+    uint64_t deadline_ms;              // Срок от постановки в очередь, мс (0 — без срока)
+} CipherAsyncOptionsC;
+
+#define CIPHER_ASYNC_WAIT_FOREVER UINT64_MAX
+
+// Состояние задания; done и total (могут быть NULL) получают последний
+// сообщённый ход в байтах входа.
+CIPHER_RUNTIME_API CipherAsyncStateC cipher_async_poll(const CipherAsyncJobC* job, uint64_t* done, uint64_t* total);
+
+// Ждёт завершения не дольше timeout_ms (CIPHER_ASYNC_WAIT_FOREVER — без
+// ограничения) и возвращает состояние задания.
+CIPHER_RUNTIME_API CipherAsyncStateC cipher_async_wait(CipherAsyncJobC* job, uint64_t timeout_ms);
+
+// Просит прекратить задание; не ждёт его завершения.
+CIPHER_RUNTIME_API void cipher_async_cancel(CipherAsyncJobC* job);
+
+// Сообщение операции и использованный IV (hex; NULL, если операция его не
+// сообщает). До завершения — NULL. Строки живут до cipher_async_free.
+CIPHER_RUNTIME_API const char* cipher_async_message(const CipherAsyncJobC* job);
+CIPHER_RUNTIME_API const char* cipher_async_iv_hex(const CipherAsyncJobC* job);
+
+// Отменяет незавершённое задание, ждёт его завершения и освобождает
+// описатель. Можно вызывать из done, но не из progress.
+CIPHER_RUNTIME_API void cipher_async_free(CipherAsyncJobC* job);
+
+// Число потоков пула заданий; 0 — по умолчанию (cipher_runtime_default_threads,
+// но не меньше двух). Лишние потоки завершаются, закончив текущее задание.
+CIPHER_RUNTIME_API void cipher_async_set_workers(unsigned count);
+
+// --- Для мостов ---
+
+// Выполняет операцию в потоке пула заданий и обязательно завершает задание
+// вызовом cipher_async_finish. progress передаётся файловой функции шифра.
+typedef void (*CipherAsyncWorkFunc)(CipherAsyncJobC* job, void* work, const CipherProgressC* progress);
+
+// Ставит работу в очередь. free_work (может быть NULL) освобождает work после
+// выполнения или отмены до начала.
+CIPHER_RUNTIME_API CipherAsyncJobC* cipher_async_submit(CipherAsyncWorkFunc run, void* work,
+                                                        void (*free_work)(void* work),
+                                                        const CipherAsyncOptionsC* options);
+
+// Результат операции; iv_hex может быть NULL. Неуспех после того, как
+// операции передана остановка, завершает задание состоянием
+// CIPHER_ASYNC_CANCELLED или CIPHER_ASYNC_TIMED_OUT.
+CIPHER_RUNTIME_API void cipher_async_finish(CipherAsyncJobC* job, int success, const char* message,
+                                            const char* iv_hex);
+
+// Ненулевое значение — приёмник хода уже попросил операцию прекратить работу
+// (отмена или срок), так что её неуспех вызван остановкой и неполный выход
+// можно удалить.
+CIPHER_RUNTIME_API int cipher_async_stopped(const CipherAsyncJobC* job);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CIPHER_ASYNC_H
@@ -0,0 +1,31 @@
+#ifndef CIPHER_PROGRESS_H
+#define CIPHER_PROGRESS_H
+
+// Ход файловой операции и её отмена.
+//
+// Файловые функции библиотек шифров, принимающие приёмник хода, сообщают ему,
+// сколько байт входа обработано, и по ответу прекращают работу. Отмена
+// кооперативная: операция проверяет её между блоками и завершается ошибкой
+// "Operation cancelled.". Асинхронные задания мостов (cipher_async.h) передают
+// сюда собственный приёмник, через который работают отмена и срок.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// done из total байт входа обработано (total — 0, если размер неизвестен).
+// Вызывается в потоке операции; ненулевой результат просит её прекратить.
+typedef int (*CipherProgressFunc)(void* context, uint64_t done, uint64_t total);
+
+typedef struct CipherProgressC {
+    CipherProgressFunc report;
+    void* context;
+} CipherProgressC;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CIPHER_PROGRESS_H
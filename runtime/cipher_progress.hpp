@@ -0,0 +1,30 @@
+#ifndef CIPHER_PROGRESS_HPP
+#define CIPHER_PROGRESS_HPP
+
+// Счётчик хода для библиотек на C++ (см. cipher_progress.h).
+
+#include "cipher_progress.h"
+#include <cstdint>
+
+const char* const CIPHER_CANCELLED_MESSAGE = "Operation cancelled.";
+
+// Копит обработанные байты и сообщает их приёмнику. Без приёмника ничего не
+// делает и отмену не запрашивает.
+class CipherProgress {
+public:
+    CipherProgress(const CipherProgressC* sink, uint64_t total)
+        : sink_(sink && sink->report ? sink : nullptr), total_(total) {}
+
+    // false — приёмник просит прекратить операцию.
+    bool advance(uint64_t bytes) {
+        done_ += bytes;
+        return !sink_ || sink_->report(sink_->context, done_, total_) == 0;
+    }
+
+private:
+    const CipherProgressC* sink_;
+    uint64_t total_;
+    uint64_t done_ = 0;
+};
+
+#endif // CIPHER_PROGRESS_HPP
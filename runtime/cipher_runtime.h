@@ -0,0 +1,48 @@
+#ifndef CIPHER_RUNTIME_H
+#define CIPHER_RUNTIME_H
+
+// Общая среда выполнения библиотек шифров (libcipher_runtime).
+//
+// Все библиотеки шифров и основная программа связываются с одной разделяемой
+// библиотекой, поэтому в процессе существует один пул потоков: параллельные
+// пути разных шифров, в том числе одновременно работающих в конвейере, делят
+// его потоки и не создают больше потоков, чем доступно процессу ядер.
+// Программы, использующие мосты *_bridge, управляют пулом этими же функциями.
+
+#ifdef CIPHER_STATIC_PLUGINS
+#define CIPHER_RUNTIME_API
+#elif defined(_WIN32)
+#ifdef CIPHER_RUNTIME_BUILD
+#define CIPHER_RUNTIME_API __declspec(dllexport)
+#else
+#define CIPHER_RUNTIME_API __declspec(dllimport)
+#endif
+#else
+#define CIPHER_RUNTIME_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Число потоков пула, включая вызывающий поток параллельного цикла.
+// 0 — по умолчанию (cipher_runtime_default_threads). Новое значение применяется
+// к следующему параллельному циклу, начатому, когда пул свободен.
+CIPHER_RUNTIME_API void cipher_runtime_set_threads(unsigned count);
+
+// Текущее число потоков пула (с учётом значения по умолчанию).
+CIPHER_RUNTIME_API unsigned cipher_runtime_threads(void);
+
+// Число потоков по умолчанию: ядра из маски привязки процесса, ограниченные
+// квотой CPU cgroup (v2: cpu.max, v1: cpu.cfs_quota_us / cpu.cfs_period_us).
+CIPHER_RUNTIME_API unsigned cipher_runtime_default_threads(void);
+
+// Ненулевое значение закрепляет рабочий поток i за i-м ядром маски привязки
+// процесса. Как и число потоков, применяется при следующем запуске пула.
+CIPHER_RUNTIME_API void cipher_runtime_set_affinity(int enabled);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CIPHER_RUNTIME_H
@@ -0,0 +1,170 @@
+#include "crc32c.h"
+#include <array>
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define CRC32C_HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Отражённый полином: младший бит — старшая степень.
+const uint32_t CRC32C_POLY = 0x82F63B78u;
+
+using Crc32cTables = std::array<std::array<uint32_t, 256>, 8>;
+
+// tables[k][b] — сумма байта b, за которым следуют k нулевых байт (слайсинг по 8).
+constexpr Crc32cTables build_tables() {
+    Crc32cTables tables{};
+    for (uint32_t b = 0; b < 256; ++b) {
+        uint32_t crc = b;
+        for (int bit = 0; bit < 8; ++bit) crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        tables[0][b] = crc;
+    }
+    for (size_t k = 1; k < 8; ++k) {
+        for (uint32_t b = 0; b < 256; ++b) {
+            uint32_t prev = tables[k - 1][b];
+            tables[k][b] = (prev >> 8) ^ tables[0][prev & 0xFF];
+        }
+    }
+    return tables;
+}
+
+constexpr Crc32cTables TABLES = build_tables();
+
+// Ядра работают с внутренним состоянием (уже инвертированной суммой).
+uint32_t crc32c_scalar(uint32_t crc, const unsigned char* p, size_t size) {
+    for (; size >= 8; p += 8, size -= 8) {
+        uint32_t lo = crc ^ (static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+                             static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24);
+        uint32_t hi = static_cast<uint32_t>(p[4]) | static_cast<uint32_t>(p[5]) << 8 |
+                      static_cast<uint32_t>(p[6]) << 16 | static_cast<uint32_t>(p[7]) << 24;
+        crc = TABLES[7][lo & 0xFF] ^ TABLES[6][(lo >> 8) & 0xFF] ^ TABLES[5][(lo >> 16) & 0xFF] ^
+              TABLES[4][lo >> 24] ^ TABLES[3][hi & 0xFF] ^ TABLES[2][(hi >> 8) & 0xFF] ^
+              TABLES[1][(hi >> 16) & 0xFF] ^ TABLES[0][hi >> 24];
+    }
+    for (; size > 0; ++p, --size) crc = TABLES[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+#ifdef CRC32C_HAVE_X86_KERNELS
+
+// Блоки трёх потоков: длинные для больших данных и короткие для остатка.
+const size_t LONG_BLOCK = 8192;
+const size_t SHORT_BLOCK = 256;
+
+// x^n mod P в отражённом виде.
+uint32_t x_pow_mod(size_t n) {
+    uint32_t value = 0x80000000u; // x^0
+    for (size_t i = 0; i < n; ++i) value = (value & 1) ? (value >> 1) ^ CRC32C_POLY : value >> 1;
+    return value;
+}
+
+// Множители сдвига состояния на блок: crc * x^(8 * block) получается как
+// clmul(crc, x^(8 * block - 33)) с приведением инструкцией crc32 (она
+// добавляет x^32, а отражённое умножение — ещё x).
+struct ShiftConstants {
+    uint32_t long_block = x_pow_mod(8 * LONG_BLOCK - 33);
+    uint32_t short_block = x_pow_mod(8 * SHORT_BLOCK - 33);
+};
+
+const ShiftConstants& shift_constants() {
+    static const ShiftConstants constants;
+    return constants;
+}
+
+uint64_t load64(const unsigned char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+__attribute__((target("sse4.2")))
+uint32_t crc32c_sse42(uint32_t crc, const unsigned char* p, size_t size) {
+    for (; size > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0; ++p, --size) crc = _mm_crc32_u8(crc, *p);
+    uint64_t state = crc;
+    for (; size >= 8; p += 8, size -= 8) state = _mm_crc32_u64(state, load64(p));
+    crc = static_cast<uint32_t>(state);
+    for (; size > 0; ++p, --size) crc = _mm_crc32_u8(crc, *p);
+    return crc;
+}
+
+__attribute__((target("sse4.2,pclmul")))
+uint64_t shift_state(uint64_t state, uint32_t constant) {
+    __m128i product = _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<int64_t>(state)),
+                                           _mm_cvtsi32_si128(static_cast<int>(constant)), 0x00);
+    return _mm_crc32_u64(0, static_cast<uint64_t>(_mm_cvtsi128_si64(product)));
+}
+
+// Три независимых потока скрывают задержку crc32 (3 такта при пропускной
+// способности 1 за такт); их суммы объединяются сдвигом состояния на блок.
+__attribute__((target("sse4.2,pclmul")))
+uint32_t crc32c_sse42_pclmul(uint32_t crc, const unsigned char* p, size_t size) {
+    for (; size > 0 && (reinterpret_cast<uintptr_t>(p) & 7) != 0; ++p, --size) crc = _mm_crc32_u8(crc, *p);
+    const ShiftConstants& constants = shift_constants();
+    uint64_t state = crc;
+    for (; size >= 3 * LONG_BLOCK; p += 3 * LONG_BLOCK, size -= 3 * LONG_BLOCK) {
+        uint64_t second = 0, third = 0;
+        for (size_t i = 0; i < LONG_BLOCK; i += 8) {
+            state = _mm_crc32_u64(state, load64(p + i));
+            second = _mm_crc32_u64(second, load64(p + LONG_BLOCK + i));
+            third = _mm_crc32_u64(third, load64(p + 2 * LONG_BLOCK + i));
+        }
+        state = shift_state(state, constants.long_block) ^ second;
+        state = shift_state(state, constants.long_block) ^ third;
+    }
+    for (; size >= 3 * SHORT_BLOCK; p += 3 * SHORT_BLOCK, size -= 3 * SHORT_BLOCK) {
+        uint64_t second = 0, third = 0;
+        for (size_t i = 0; i < SHORT_BLOCK; i += 8) {
+            state = _mm_crc32_u64(state, load64(p + i));
+            second = _mm_crc32_u64(second, load64(p + SHORT_BLOCK + i));
+            third = _mm_crc32_u64(third, load64(p + 2 * SHORT_BLOCK + i));
+        }
+        state = shift_state(state, constants.short_block) ^ second;
+        state = shift_state(state, constants.short_block) ^ third;
+    }
+    return crc32c_sse42(static_cast<uint32_t>(state), p, size);
+}
+
+#endif // CRC32C_HAVE_X86_KERNELS
+
+struct Crc32cKernel {
+    uint32_t (*update)(uint32_t crc, const unsigned char* p, size_t size);
+    const char* name;
+};
+
+Crc32cKernel select_kernel() {
+#ifdef CRC32C_HAVE_X86_KERNELS
+    const char* forced = std::getenv("CIPHER_CRC32C_KERNEL");
+    if (!forced || std::strcmp(forced, "scalar") != 0) {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul")) {
+            return {crc32c_sse42_pclmul, "sse42-pclmul"};
+        }
+        if (__builtin_cpu_supports("sse4.2")) return {crc32c_sse42, "sse42"};
+    }
+#endif
+    return {crc32c_scalar, "scalar"};
+}
+
+const Crc32cKernel& kernel() {
+    static const Crc32cKernel selected = select_kernel();
+    return selected;
+}
+
+} // namespace
+
+extern "C" {
+
+CIPHER_RUNTIME_API uint32_t cipher_crc32c(uint32_t crc, const void* data, size_t size) {
+    if (size == 0) return crc;
+    return ~kernel().update(~crc, static_cast<const unsigned char*>(data), size);
+}
+
+CIPHER_RUNTIME_API const char* cipher_crc32c_kernel_name(void) {
+    return kernel().name;
+}
+
+}
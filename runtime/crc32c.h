@@ -0,0 +1,33 @@
+#ifndef CIPHER_CRC32C_H
+#define CIPHER_CRC32C_H
+
+// CRC32C (полином Кастаньоли 0x1EDC6F41, как в iSCSI, ext4 и SSE4.2) для
+// контроля целостности блоков (--crc, plugin/crc_framing.h).
+//
+// На x86 с SSE4.2 сумма считается инструкцией crc32 по трём независимым
+// потокам данных, а их суммы объединяются умножением без переносов (PCLMUL);
+// без PCLMUL — одним потоком crc32, без SSE4.2 — таблично по 8 байт.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cipher_runtime.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Продолжает сумму crc (0 — начало данных) на size байт data:
+// cipher_crc32c(cipher_crc32c(0, a, n), b, m) равно сумме a и b подряд.
+// Для "123456789" результат 0xE3069283.
+CIPHER_RUNTIME_API uint32_t cipher_crc32c(uint32_t crc, const void* data, size_t size);
+
+// Имя выбранной реализации ("sse42-pclmul", "sse42" или "scalar"). Переменная
+// окружения CIPHER_CRC32C_KERNEL=scalar принудительно выбирает табличную.
+CIPHER_RUNTIME_API const char* cipher_crc32c_kernel_name(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CIPHER_CRC32C_H
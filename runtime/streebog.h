@@ -0,0 +1,50 @@
+#ifndef CIPHER_STREEBOG_H
+#define CIPHER_STREEBOG_H
+
+// Хеш-функция Стрибог (ГОСТ Р 34.11-2012, RFC 6986) с дайджестом 256 или
+// 512 бит — отпечатки файлов (--hash) без отдельного чтения данных внешней
+// программой.
+//
+// Преобразование LPS (подстановка, перестановка байт и линейное отображение)
+// выполняется по таблицам 8×256 64-битных слов, построенным при компиляции:
+// каждое слово состояния — восемь обращений к таблицам и семь XOR. Дайджест
+// совпадает по порядку байт с gostsum, OpenSSL и nettle.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cipher_runtime.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CIPHER_STREEBOG_BLOCK_SIZE 64
+#define CIPHER_STREEBOG_MAX_DIGEST_SIZE 64
+
+// Состояние потокового вычисления; поля не предназначены для прямого изменения.
+typedef struct CipherStreebogC {
+    uint64_t h[8];
+    uint64_t n[8];     // обработано бит
+    uint64_t sigma[8]; // сумма блоков по модулю 2^512
+    unsigned char buffer[CIPHER_STREEBOG_BLOCK_SIZE];
+    size_t buffered;
+    size_t digest_size; // 32 или 64 байта
+} CipherStreebogC;
+
+// Начинает вычисление; digest_bits — 256 или 512. 0 — недопустимый размер.
+CIPHER_RUNTIME_API int cipher_streebog_init(CipherStreebogC* ctx, unsigned digest_bits);
+
+// Добавляет size байт data; данные можно подавать частями любой длины.
+CIPHER_RUNTIME_API void cipher_streebog_update(CipherStreebogC* ctx, const void* data, size_t size);
+
+// Записывает ctx->digest_size байт дайджеста в digest. После вызова ctx нужно
+// снова инициализировать.
+// Для пустых данных Стрибог-256 даёт 3f539a213e97c802cc229d474c6aa32a825a360b2a933a949fd925208d9ce1bb.
+CIPHER_RUNTIME_API void cipher_streebog_final(CipherStreebogC* ctx, unsigned char* digest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CIPHER_STREEBOG_H
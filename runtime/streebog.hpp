@@ -0,0 +1,39 @@
+#ifndef CIPHER_STREEBOG_HPP
+#define CIPHER_STREEBOG_HPP
+
+// Обёртка над streebog.h для кода на C++.
+
+#include "streebog.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class Streebog {
+public:
+    // digest_bits — 256 или 512, иначе std::invalid_argument.
+    explicit Streebog(unsigned digest_bits = 512) : bits_(digest_bits) {
+        if (!cipher_streebog_init(&ctx_, digest_bits)) {
+            throw std::invalid_argument("Стрибог: размер дайджеста " + std::to_string(digest_bits) +
+                                        " (ожидается 256 или 512)");
+        }
+    }
+
+    void update(const unsigned char* data, size_t size) { cipher_streebog_update(&ctx_, data, size); }
+
+    // Дайджест; после вызова вычисление начинается заново.
+    std::vector<unsigned char> finish() {
+        std::vector<unsigned char> digest(ctx_.digest_size);
+        cipher_streebog_final(&ctx_, digest.data());
+        cipher_streebog_init(&ctx_, bits_);
+        return digest;
+    }
+
+    // "Стрибог-256" или "Стрибог-512" для сообщений.
+    std::string name() const { return "Стрибог-" + std::to_string(bits_); }
+
+private:
+    CipherStreebogC ctx_;
+    unsigned bits_;
+};
+
+#endif // CIPHER_STREEBOG_HPP
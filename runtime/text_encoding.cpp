@@ -0,0 +1,411 @@
+#include "text_encoding.h"
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define TEXT_HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr char HEX_DIGITS[] = "0123456789abcdef";
+constexpr char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+constexpr char Z85_ALPHABET[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ.-:+=^!/*?&<>()[]{}@%$#";
+constexpr uint64_t BASE85_GROUP_LIMIT = 0xFFFFFFFFull;
+
+// Значение символа в алфавите, -1 — символа в алфавите нет.
+constexpr std::array<int8_t, 256> build_values(const char* alphabet, std::size_t size) {
+    std::array<int8_t, 256> table{};
+    for (auto& entry : table) entry = -1;
+    for (std::size_t i = 0; i < size; ++i) table[static_cast<unsigned char>(alphabet[i])] = static_cast<int8_t>(i);
+    return table;
+}
+
+constexpr std::array<int8_t, 256> build_hex_values() {
+    std::array<int8_t, 256> table = build_values(HEX_DIGITS, 16);
+    for (int i = 0; i < 6; ++i) table['A' + i] = static_cast<int8_t>(10 + i);
+    return table;
+}
+
+constexpr auto HEX_VALUES = build_hex_values();
+constexpr auto BASE64_VALUES = build_values(BASE64_ALPHABET, 64);
+constexpr auto BASE85_VALUES = build_values(Z85_ALPHABET, 85);
+
+// Векторные ядра обрабатывают начало данных целыми блоками и возвращают, сколько
+// входа обработано; остаток, включая дополнение и ошибки, разбирает скалярный код.
+// Декодеры останавливаются перед первым блоком с недопустимым символом.
+struct Kernels {
+    std::size_t (*hex_encode)(const unsigned char* in, std::size_t size, char* out);
+    std::size_t (*hex_decode)(const char* in, std::size_t length, unsigned char* out);
+    std::size_t (*base64_encode)(const unsigned char* in, std::size_t size, char* out);
+    std::size_t (*base64_decode)(const char* in, std::size_t length, unsigned char* out);
+    std::size_t (*base85_encode)(const unsigned char* in, std::size_t size, char* out);
+    const char* name;
+};
+
+std::size_t encode_none(const unsigned char*, std::size_t, char*) {
+    return 0;
+}
+
+std::size_t decode_none(const char*, std::size_t, unsigned char*) {
+    return 0;
+}
+
+#ifdef TEXT_HAVE_X86_KERNELS
+
+// 16 байт — 32 символа: полубайты расширяются до 16-битных слов (старший —
+// в младший байт слова, чтобы идти первым) и переводятся в цифры таблицей.
+__attribute__((target("avx2")))
+std::size_t hex_encode_avx2(const unsigned char* in, std::size_t size, char* out) {
+    const __m256i digits = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd',
+                                            'e', 'f', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b',
+                                            'c', 'd', 'e', 'f');
+    const __m256i low_nibble = _mm256_set1_epi16(0x0F);
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m256i bytes = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+        __m256i nibbles = _mm256_or_si256(_mm256_srli_epi16(bytes, 4),
+                                          _mm256_slli_epi16(_mm256_and_si256(bytes, low_nibble), 8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i), _mm256_shuffle_epi8(digits, nibbles));
+    }
+    return i;
+}
+
+// 32 символа — 16 байт: цифры и буквы (в любом регистре) проверяются
+// сравнениями, пары полубайтов собираются умножением-сложением.
+__attribute__((target("avx2")))
+std::size_t hex_decode_avx2(const char* in, std::size_t length, unsigned char* out) {
+    std::size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+        __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+        __m256i letter = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+        if (_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_letter)) != -1) break;
+        __m256i values = _mm256_blendv_epi8(_mm256_add_epi8(letter, _mm256_set1_epi8(10)), digit, is_digit);
+        __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi16(0x0110));
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(pairs, pairs), 0xD8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 2), _mm256_castsi256_si128(packed));
+    }
+    return i;
+}
+
+// 24 байта — 32 символа (W. Muła, D. Lemire): каждая тройка байт раскладывается
+// в слово так, что четыре 6-битных индекса выделяются двумя умножениями, а
+// индексы переводятся в символы прибавлением смещения диапазона алфавита.
+__attribute__((target("avx2")))
+std::size_t base64_encode_avx2(const unsigned char* in, std::size_t size, char* out) {
+    const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                             1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m256i offsets = _mm256_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+                                             65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+    std::size_t i = 0, o = 0;
+    // Читается 28 байт: две половины вектора по 16 байт со сдвигом 12.
+    for (; i + 28 <= size; i += 24, o += 32) {
+        __m256i bytes = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12)), 1);
+        bytes = _mm256_shuffle_epi8(bytes, shuffle);
+        __m256i ac = _mm256_mulhi_epu16(_mm256_and_si256(bytes, _mm256_set1_epi32(0x0FC0FC00)),
+                                        _mm256_set1_epi32(0x04000040));
+        __m256i bd = _mm256_mullo_epi16(_mm256_and_si256(bytes, _mm256_set1_epi32(0x003F03F0)),
+                                        _mm256_set1_epi32(0x01000010));
+        __m256i indices = _mm256_or_si256(ac, bd);
+        __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        range = _mm256_sub_epi8(range, _mm256_cmpgt_epi8(indices, _mm256_set1_epi8(25)));
+        __m256i chars = _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, range));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), chars);
+    }
+    return i;
+}
+
+// 32 символа — 24 байта: допустимость проверяется по таблицам старшего и
+// младшего полубайта, значения получаются прибавлением смещения по старшему
+// полубайту ('/' отдельно), четвёрки 6-битных значений склеиваются умножениями.
+__attribute__((target("avx2")))
+std::size_t base64_decode_avx2(const char* in, std::size_t length, unsigned char* out) {
+    const __m256i lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A,
+                                            0x1B, 0x1B, 0x1B, 0x1A, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+                                            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                              0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask_2f = _mm256_set1_epi8(0x2F);
+    const __m256i pack_shuffle = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                  2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i store_mask = _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0);
+    std::size_t i = 0, o = 0;
+    for (; i + 32 <= length; i += 32, o += 24) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(chars, 4), mask_2f);
+        __m256i lo = _mm256_shuffle_epi8(lut_lo, _mm256_and_si256(chars, mask_2f));
+        __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+        if (!_mm256_testz_si256(lo, hi)) break;
+        __m256i is_slash = _mm256_cmpeq_epi8(chars, mask_2f);
+        __m256i values = _mm256_add_epi8(chars, _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(is_slash, hi_nibbles)));
+        __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        __m256i words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+        __m256i bytes = _mm256_shuffle_epi8(words, pack_shuffle);
+        bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_maskstore_epi32(reinterpret_cast<int*>(out + o), store_mask, bytes);
+    }
+    return i;
+}
+
+// Частное от деления 32-битных слов на 85: v * ceil(2^38 / 85) >> 38 точно для
+// любого 32-битного v; произведения считаются отдельно для чётных и нечётных слов.
+__attribute__((target("avx2")))
+inline __m256i div85_avx2(__m256i value) {
+    const __m256i magic = _mm256_set1_epi32(static_cast<int>(0xC0C0C0C1u));
+    __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(value, magic), 38);
+    __m256i odd = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(value, 32), magic), 38);
+    return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+}
+
+// 32 байта — 40 символов: восемь групп по 4 байта делятся на 85 векторно,
+// цифры переводятся в символы таблицей (85 символов не помещаются в перестановку байт).
+__attribute__((target("avx2")))
+std::size_t base85_encode_avx2(const unsigned char* in, std::size_t size, char* out) {
+    const __m256i to_big_endian = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                                   3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m256i base = _mm256_set1_epi32(85);
+    alignas(32) uint32_t digits[5][8];
+    std::size_t i = 0, o = 0;
+    for (; i + 32 <= size; i += 32, o += 40) {
+        __m256i value = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)),
+                                            to_big_endian);
+        for (int k = 4; k > 0; --k) {
+            __m256i quotient = div85_avx2(value);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(digits[k]),
+                               _mm256_sub_epi32(value, _mm256_mullo_epi32(quotient, base)));
+            value = quotient;
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(digits[0]), value);
+        for (int group = 0; group < 8; ++group) {
+            for (int k = 0; k < 5; ++k) out[o + group * 5 + k] = Z85_ALPHABET[digits[k][group]];
+        }
+    }
+    return i;
+}
+
+#endif // TEXT_HAVE_X86_KERNELS
+
+Kernels select_kernels() {
+    Kernels scalar = {encode_none, decode_none, encode_none, decode_none, encode_none, "scalar"};
+#ifdef TEXT_HAVE_X86_KERNELS
+    const char* forced = std::getenv("CIPHER_TEXT_KERNEL");
+    __builtin_cpu_init();
+    if ((!forced || std::strcmp(forced, "scalar") != 0) && __builtin_cpu_supports("avx2")) {
+        return {hex_encode_avx2, hex_decode_avx2, base64_encode_avx2, base64_decode_avx2, base85_encode_avx2, "avx2"};
+    }
+#endif
+    return scalar;
+}
+
+const Kernels& kernels() {
+    static const Kernels selected = select_kernels();
+    return selected;
+}
+
+std::size_t hex_encode(const unsigned char* in, std::size_t size, char* out) {
+    for (std::size_t i = kernels().hex_encode(in, size, out); i < size; ++i) {
+        out[2 * i] = HEX_DIGITS[in[i] >> 4];
+        out[2 * i + 1] = HEX_DIGITS[in[i] & 0x0F];
+    }
+    return size * 2;
+}
+
+bool hex_decode(const char* in, std::size_t length, unsigned char* out, std::size_t& out_size) {
+    if (length % 2 != 0) return false;
+    for (std::size_t i = kernels().hex_decode(in, length, out); i < length; i += 2) {
+        int high = HEX_VALUES[static_cast<unsigned char>(in[i])];
+        int low = HEX_VALUES[static_cast<unsigned char>(in[i + 1])];
+        if (high < 0 || low < 0) return false;
+        out[i / 2] = static_cast<unsigned char>(high << 4 | low);
+    }
+    out_size = length / 2;
+    return true;
+}
+
+std::size_t base64_encode(const unsigned char* in, std::size_t size, char* out) {
+    std::size_t i = kernels().base64_encode(in, size, out);
+    std::size_t o = i / 3 * 4;
+    for (; i + 3 <= size; i += 3, o += 4) {
+        uint32_t group = static_cast<uint32_t>(in[i]) << 16 | static_cast<uint32_t>(in[i + 1]) << 8 | in[i + 2];
+        out[o] = BASE64_ALPHABET[group >> 18];
+        out[o + 1] = BASE64_ALPHABET[(group >> 12) & 0x3F];
+        out[o + 2] = BASE64_ALPHABET[(group >> 6) & 0x3F];
+        out[o + 3] = BASE64_ALPHABET[group & 0x3F];
+    }
+    if (i < size) {
+        uint32_t group = static_cast<uint32_t>(in[i]) << 16;
+        if (i + 1 < size) group |= static_cast<uint32_t>(in[i + 1]) << 8;
+        out[o] = BASE64_ALPHABET[group >> 18];
+        out[o + 1] = BASE64_ALPHABET[(group >> 12) & 0x3F];
+        out[o + 2] = i + 1 < size ? BASE64_ALPHABET[(group >> 6) & 0x3F] : '=';
+        out[o + 3] = '=';
+        o += 4;
+    }
+    return o;
+}
+
+bool base64_decode(const char* in, std::size_t length, unsigned char* out, std::size_t& out_size) {
+    if (length % 4 != 0) return false;
+    std::size_t i = kernels().base64_decode(in, length, out);
+    std::size_t o = i / 4 * 3;
+    for (; i < length; i += 4) {
+        // '=' допускается только в последней четвёрке: "xx==" или "xxx=".
+        bool last = i + 4 == length;
+        std::size_t padding = last && in[i + 3] == '=' ? (in[i + 2] == '=' ? 2 : 1) : 0;
+        uint32_t group = 0;
+        for (std::size_t k = 0; k < 4 - padding; ++k) {
+            int value = BASE64_VALUES[static_cast<unsigned char>(in[i + k])];
+            if (value < 0) return false;
+            group |= static_cast<uint32_t>(value) << (18 - 6 * k);
+        }
+        out[o++] = static_cast<unsigned char>(group >> 16);
+        if (padding < 2) out[o++] = static_cast<unsigned char>(group >> 8);
+        if (padding < 1) out[o++] = static_cast<unsigned char>(group);
+    }
+    out_size = o;
+    return true;
+}
+
+void base85_encode_group(uint32_t value, char* out, std::size_t count) {
+    char digits[5];
+    for (int k = 4; k >= 0; --k) {
+        digits[k] = Z85_ALPHABET[value % 85];
+        value /= 85;
+    }
+    std::memcpy(out, digits, count);
+}
+
+std::size_t base85_encode(const unsigned char* in, std::size_t size, char* out) {
+    std::size_t i = kernels().base85_encode(in, size, out);
+    std::size_t o = i / 4 * 5;
+    for (; i + 4 <= size; i += 4, o += 5) {
+        uint32_t value = static_cast<uint32_t>(in[i]) << 24 | static_cast<uint32_t>(in[i + 1]) << 16 |
+                         static_cast<uint32_t>(in[i + 2]) << 8 | in[i + 3];
+        base85_encode_group(value, out + o, 5);
+    }
+    if (i < size) {
+        // Неполная группа дополняется нулями, из её кода берутся первые n + 1 символов.
+        uint32_t value = 0;
+        std::size_t tail = size - i;
+        for (std::size_t k = 0; k < tail; ++k) value |= static_cast<uint32_t>(in[i + k]) << (24 - 8 * k);
+        base85_encode_group(value, out + o, tail + 1);
+        o += tail + 1;
+    }
+    return o;
+}
+
+bool base85_decode(const char* in, std::size_t length, unsigned char* out, std::size_t& out_size) {
+    if (length % 5 == 1) return false;
+    std::size_t o = 0;
+    for (std::size_t i = 0; i < length; i += 5) {
+        // Неполная группа из m символов дополняется старшей цифрой (84), из
+        // значения берутся первые m - 1 байт.
+        std::size_t count = length - i < 5 ? length - i : 5;
+        uint64_t value = 0;
+        for (std::size_t k = 0; k < 5; ++k) {
+            int digit = k < count ? BASE85_VALUES[static_cast<unsigned char>(in[i + k])] : 84;
+            if (digit < 0) return false;
+            value = value * 85 + static_cast<uint64_t>(digit);
+        }
+        if (value > BASE85_GROUP_LIMIT) return false;
+        for (std::size_t k = 0; k + 1 < count; ++k) out[o++] = static_cast<unsigned char>(value >> (24 - 8 * k));
+    }
+    out_size = o;
+    return true;
+}
+
+} // namespace
+
+extern "C" {
+
+CIPHER_RUNTIME_API size_t cipher_text_encoded_size(CipherTextEncodingC encoding, size_t size) {
+    switch (encoding) {
+    case CIPHER_TEXT_BASE64:
+        return (size + 2) / 3 * 4;
+    case CIPHER_TEXT_BASE85:
+        return size / 4 * 5 + (size % 4 ? size % 4 + 1 : 0);
+    default:
+        return size * 2;
+    }
+}
+
+CIPHER_RUNTIME_API size_t cipher_text_encode(CipherTextEncodingC encoding, const unsigned char* data, size_t size,
+                                             char* out) {
+    switch (encoding) {
+    case CIPHER_TEXT_BASE64:
+        return base64_encode(data, size, out);
+    case CIPHER_TEXT_BASE85:
+        return base85_encode(data, size, out);
+    default:
+        return hex_encode(data, size, out);
+    }
+}
+
+CIPHER_RUNTIME_API size_t cipher_text_decoded_max_size(CipherTextEncodingC encoding, size_t length) {
+    switch (encoding) {
+    case CIPHER_TEXT_BASE64:
+        return length / 4 * 3;
+    case CIPHER_TEXT_BASE85:
+        return length / 5 * 4 + (length % 5 > 1 ? length % 5 - 1 : 0);
+    default:
+        return length / 2;
+    }
+}
+
+CIPHER_RUNTIME_API int cipher_text_decode(CipherTextEncodingC encoding, const char* text, size_t length,
+                                          unsigned char* out, size_t* out_size) {
+    std::size_t size = 0;
+    bool ok = false;
+    switch (encoding) {
+    case CIPHER_TEXT_BASE64:
+        ok = base64_decode(text, length, out, size);
+        break;
+    case CIPHER_TEXT_BASE85:
+        ok = base85_decode(text, length, out, size);
+        break;
+    default:
+        ok = hex_decode(text, length, out, size);
+        break;
+    }
+    if (out_size) *out_size = ok ? size : 0;
+    return ok ? 1 : 0;
+}
+
+CIPHER_RUNTIME_API const char* cipher_text_encoding_name(CipherTextEncodingC encoding) {
+    switch (encoding) {
+    case CIPHER_TEXT_BASE64:
+        return "base64";
+    case CIPHER_TEXT_BASE85:
+        return "base85";
+    default:
+        return "hex";
+    }
+}
+
+CIPHER_RUNTIME_API int cipher_text_encoding_from_name(const char* name, CipherTextEncodingC* encoding) {
+    static const CipherTextEncodingC all[] = {CIPHER_TEXT_HEX, CIPHER_TEXT_BASE64, CIPHER_TEXT_BASE85};
+    for (CipherTextEncodingC candidate : all) {
+        if (name && std::strcmp(name, cipher_text_encoding_name(candidate)) == 0) {
+            if (encoding) *encoding = candidate;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+CIPHER_RUNTIME_API const char* cipher_text_kernel_name(void) {
+    return kernels().name;
+}
+
+}
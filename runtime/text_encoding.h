@@ -0,0 +1,58 @@
+#ifndef CIPHER_TEXT_ENCODING_H
+#define CIPHER_TEXT_ENCODING_H
+
+// Текстовые представления двоичных данных для текстового режима (--text,
+// --encoding) и мостов: hex (+100% к объёму), Base64 (+33%) и Base85 (+25%).
+//
+// Base64 — RFC 4648, стандартный алфавит с дополнением '='. Base85 — алфавит Z85
+// (без кавычек и обратной косой черты, удобен в командной строке и JSON);
+// группа из 4 байт (big-endian) даёт 5 символов, неполная последняя группа из
+// n байт — n + 1 символ, как в Ascii85. Пробелы и переводы строк не допускаются.
+//
+// Кодеры и декодеры hex и Base64, а также кодер Base85 имеют ядра AVX2,
+// выбираемые при первом вызове по возможностям процессора.
+
+#include <stddef.h>
+
+#include "cipher_runtime.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    CIPHER_TEXT_HEX = 0,
+    CIPHER_TEXT_BASE64 = 1,
+    CIPHER_TEXT_BASE85 = 2,
+} CipherTextEncodingC;
+
+// Длина текста для size байт.
+CIPHER_RUNTIME_API size_t cipher_text_encoded_size(CipherTextEncodingC encoding, size_t size);
+
+// Записывает в out ровно cipher_text_encoded_size(encoding, size) символов,
+// без завершающего нуля, и возвращает их число.
+CIPHER_RUNTIME_API size_t cipher_text_encode(CipherTextEncodingC encoding, const unsigned char* data, size_t size,
+                                             char* out);
+
+// Наибольший размер данных для текста длины length (буфер для cipher_text_decode).
+CIPHER_RUNTIME_API size_t cipher_text_decoded_max_size(CipherTextEncodingC encoding, size_t length);
+
+// Декодирует text; размер результата — в *out_size. Возвращает 0, если текст
+// недопустим (символ вне алфавита, неверная длина или дополнение).
+CIPHER_RUNTIME_API int cipher_text_decode(CipherTextEncodingC encoding, const char* text, size_t length,
+                                          unsigned char* out, size_t* out_size);
+
+// Имя кодировки ("hex", "base64", "base85") и обратное преобразование
+// (возвращает 0 для неизвестного имени).
+CIPHER_RUNTIME_API const char* cipher_text_encoding_name(CipherTextEncodingC encoding);
+CIPHER_RUNTIME_API int cipher_text_encoding_from_name(const char* name, CipherTextEncodingC* encoding);
+
+// Имя выбранной реализации ("avx2" или "scalar"). Переменная окружения
+// CIPHER_TEXT_KERNEL=scalar принудительно выбирает скалярную.
+CIPHER_RUNTIME_API const char* cipher_text_kernel_name(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CIPHER_TEXT_ENCODING_H
@@ -0,0 +1,25 @@
+#ifndef CIPHER_TEXT_ENCODING_HPP
+#define CIPHER_TEXT_ENCODING_HPP
+
+// Обёртки над text_encoding.h для кода на C++.
+
+#include "text_encoding.h"
+#include <string>
+#include <vector>
+
+inline std::string encodeText(CipherTextEncodingC encoding, const unsigned char* data, size_t size) {
+    std::string text(cipher_text_encoded_size(encoding, size), '\0');
+    if (!text.empty()) cipher_text_encode(encoding, data, size, &text[0]);
+    return text;
+}
+
+// false — текст недопустим для кодировки.
+inline bool decodeText(CipherTextEncodingC encoding, const std::string& text, std::vector<unsigned char>& data) {
+    data.resize(cipher_text_decoded_max_size(encoding, text.size()));
+    size_t size = 0;
+    if (!cipher_text_decode(encoding, text.data(), text.size(), data.data(), &size)) return false;
+    data.resize(size);
+    return true;
+}
+
+#endif // CIPHER_TEXT_ENCODING_HPP
@@ -0,0 +1,372 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Один вызов cipherParallelFor. Части раздаются по атомарному счётчику next,
+// поэтому участники, которым достались быстрые части, забирают следующие.
+// Задания участников могут пережить вызов (их ещё не взял ни один поток, а
+// части уже разобраны), поэтому задание живёт в shared_ptr, а fn вызывается
+// только для полученной части — до того, как вызов вернёт управление.
+struct ParallelJob {
+    uint64_t size = 0;
+    uint64_t chunk = 0;
+    uint64_t chunkCount = 0;
+    const CipherRangeFunction* fn = nullptr;
+    std::atomic<uint64_t> next{0};
+    std::atomic<uint64_t> finished{0};
+    std::atomic<bool> failed{false};
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+};
+
+void runParticipant(ParallelJob& job, unsigned slot) {
+    while (true) {
+        uint64_t index = job.next.fetch_add(1, std::memory_order_relaxed);
+        if (index >= job.chunkCount) return;
+        // После ошибки оставшиеся части только отмечаются завершёнными.
+        if (!job.failed.load(std::memory_order_relaxed)) {
+            uint64_t begin = index * job.chunk;
+            try {
+                (*job.fn)(begin, std::min(begin + job.chunk, job.size), slot);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job.mutex);
+                if (!job.error) job.error = std::current_exception();
+                job.failed.store(true, std::memory_order_relaxed);
+            }
+        }
+        if (job.finished.fetch_add(1, std::memory_order_acq_rel) + 1 == job.chunkCount) {
+            std::lock_guard<std::mutex> lock(job.mutex);
+            job.done.notify_all();
+        }
+    }
+}
+
+// Ядра из маски привязки процесса.
+std::vector<unsigned> allowedCpus() {
+    std::vector<unsigned> cpus;
+#ifdef _WIN32
+    DWORD_PTR processMask = 0, systemMask = 0;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+        for (unsigned cpu = 0; cpu < sizeof(DWORD_PTR) * 8; ++cpu) {
+            if (processMask & (static_cast<DWORD_PTR>(1) << cpu)) cpus.push_back(cpu);
+        }
+    }
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    return cpus;
+}
+
+void pinCurrentThread(unsigned cpu) {
+#ifdef _WIN32
+    SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;  // macOS не даёт закреплять потоки за ядрами
+#endif
+}
+
+#ifdef __linux__
+// Квота CPU группы в ядрах (0 — не ограничена) по файлам cpu.max (v2) или
+// cpu.cfs_quota_us и cpu.cfs_period_us (v1) каталога dir.
+double cgroupQuotaAt(const std::string& dir, bool v2) {
+    if (v2) {
+        std::ifstream file(dir + "/cpu.max");
+        std::string quota;
+        double period = 0;
+        if (!(file >> quota >> period) || quota == "max" || period <= 0) return 0;
+        return std::strtod(quota.c_str(), nullptr) / period;
+    }
+    std::ifstream quotaFile(dir + "/cpu.cfs_quota_us");
+    std::ifstream periodFile(dir + "/cpu.cfs_period_us");
+    double quota = 0, period = 0;
+    if (!(quotaFile >> quota) || !(periodFile >> period) || quota <= 0 || period <= 0) return 0;
+    return quota / period;
+}
+
+// Наименьшая квота на пути от группы процесса (/proc/self/cgroup) к корню.
+// В контейнере /sys/fs/cgroup обычно уже корень группы контейнера, поэтому
+// проверяется и сам каталог монтирования.
+double cgroupCpuQuota() {
+    std::ifstream file("/proc/self/cgroup");
+    std::string line;
+    double result = 0;
+    auto consider = [&result](double quota) {
+        if (quota > 0 && (result == 0 || quota < result)) result = quota;
+    };
+    while (std::getline(file, line)) {
+        // Формат строки: иерархия:контроллеры:путь.
+        std::size_t first = line.find(':');
+        std::size_t second = first == std::string::npos ? first : line.find(':', first + 1);
+        if (second == std::string::npos) continue;
+        std::string controllers = line.substr(first + 1, second - first - 1);
+        std::string path = line.substr(second + 1);
+        bool v2 = line.compare(0, first, "0") == 0 && controllers.empty();
+        std::vector<std::string> roots;
+        if (v2) {
+            roots = {"/sys/fs/cgroup"};
+        } else if (("," + controllers + ",").find(",cpu,") != std::string::npos) {
+            roots = {"/sys/fs/cgroup/cpu,cpuacct", "/sys/fs/cgroup/cpu"};
+        } else {
+            continue;
+        }
+        for (const std::string& root : roots) {
+            std::string dir = path;
+            while (true) {
+                consider(cgroupQuotaAt(root + (dir == "/" ? "" : dir), v2));
+                if (dir.empty() || dir == "/") break;
+                std::size_t slash = dir.rfind('/');
+                dir = slash == 0 || slash == std::string::npos ? "/" : dir.substr(0, slash);
+            }
+        }
+    }
+    return result;
+}
+#endif
+
+// Пул с очередью заданий у каждого рабочего потока: поток берёт задания из
+// конца своей очереди, а опустев, крадёт из начала чужих. Заданием здесь
+// является участник параллельного цикла; сами части участники делят по
+// счётчику задания.
+class WorkStealingPool {
+public:
+    void setThreads(unsigned threads) {
+        std::lock_guard<std::mutex> lock(startMutex_);
+        requested_ = threads;
+    }
+
+    void setAffinity(bool pin) {
+        std::lock_guard<std::mutex> lock(startMutex_);
+        pin_ = pin;
+    }
+
+    unsigned threads() {
+        std::lock_guard<std::mutex> lock(startMutex_);
+        return requested_ ? requested_ : cipher_runtime_default_threads();
+    }
+
+    void run(const std::shared_ptr<ParallelJob>& job, unsigned participants) {
+        {
+            std::lock_guard<std::mutex> lock(startMutex_);
+            if (activeJobs_ == 0) applyConfig();
+            ++activeJobs_;
+        }
+        if (!workers_.empty()) {
+            std::size_t target = current_ >= 0 ? static_cast<std::size_t>(current_) : nextWorker_++;
+            for (unsigned slot = 1; slot < participants; ++slot) {
+                push(target++ % workers_.size(), {job, slot});
+            }
+        }
+        runParticipant(*job, 0);
+        {
+            std::unique_lock<std::mutex> lock(job->mutex);
+            job->done.wait(lock, [&] { return job->finished.load(std::memory_order_acquire) == job->chunkCount; });
+        }
+        std::lock_guard<std::mutex> lock(startMutex_);
+        --activeJobs_;
+    }
+
+private:
+    struct Task {
+        std::shared_ptr<ParallelJob> job;
+        unsigned slot = 0;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    // Перезапускает рабочие потоки, если изменились настройки. Вызывается под
+    // startMutex_, когда ни один цикл не выполняется.
+    void applyConfig() {
+        unsigned threads = requested_ ? requested_ : cipher_runtime_default_threads();
+        if (threads == started_ && pin_ == startedPinned_) return;
+        stopWorkers();
+        std::vector<unsigned> cpus = pin_ ? allowedCpus() : std::vector<unsigned>();
+        // Вызывающий поток цикла тоже участник, поэтому рабочих на один меньше.
+        for (unsigned i = 1; i < threads; ++i) workers_.push_back(std::make_unique<Worker>());
+        for (std::size_t i = 0; i < workers_.size(); ++i) {
+            int cpu = cpus.empty() ? -1 : static_cast<int>(cpus[(i + 1) % cpus.size()]);
+            workers_[i]->thread = std::thread([this, i, cpu] { workerLoop(i, cpu); });
+        }
+        started_ = threads;
+        startedPinned_ = pin_;
+    }
+
+    void stopWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) worker->thread.join();
+        workers_.clear();
+        queued_ = 0;
+        stop_ = false;
+    }
+
+    void push(std::size_t index, Task task) {
+        {
+            // Счётчик растёт раньше, чем задание попадает в очередь: рабочий
+            // поток, увидевший счётчик, может лишь сделать лишний круг поиска.
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            ++queued_;
+        }
+        {
+            std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+            workers_[index]->tasks.push_back(std::move(task));
+        }
+        wake_.notify_one();
+    }
+
+    bool take(std::size_t self, Task& task) {
+        for (std::size_t k = 0; k < workers_.size(); ++k) {
+            Worker& worker = *workers_[(self + k) % workers_.size()];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            if (worker.tasks.empty()) continue;
+            if (k == 0) {
+                task = std::move(worker.tasks.back());
+                worker.tasks.pop_back();
+            } else {
+                task = std::move(worker.tasks.front());
+                worker.tasks.pop_front();
+            }
+            --queued_;
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(std::size_t self, int cpu) {
+        current_ = static_cast<int>(self);
+        if (cpu >= 0) pinCurrentThread(static_cast<unsigned>(cpu));
+        while (true) {
+            Task task;
+            if (take(self, task)) {
+                runParticipant(*task.job, task.slot);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            wake_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+            if (stop_) return;
+        }
+    }
+
+    std::mutex startMutex_;
+    unsigned requested_ = 0;
+    bool pin_ = false;
+    unsigned started_ = 1;
+    bool startedPinned_ = false;
+    unsigned activeJobs_ = 0;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<std::size_t> nextWorker_{0};
+
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::atomic<std::size_t> queued_{0};
+    bool stop_ = false;
+
+    static thread_local int current_;  // номер рабочего потока пула, -1 — чужой поток
+};
+
+thread_local int WorkStealingPool::current_ = -1;
+
+// Пул не разрушается: при завершении процесса его потоки могут ждать заданий,
+// а в Windows ожидание потоков из деструктора при выгрузке DLL блокируется.
+WorkStealingPool& pool() {
+    static WorkStealingPool* instance = new WorkStealingPool;
+    return *instance;
+}
+
+} // namespace
+
+void cipherParallelFor(uint64_t size, uint64_t chunkHint, unsigned participants, const CipherRangeFunction& fn) {
+    if (size == 0) return;
+    if (participants == 0) participants = pool().threads();
+    uint64_t chunk = chunkHint;
+    if (chunk == 0) chunk = std::max<uint64_t>(CIPHER_PARALLEL_MIN_CHUNK, size / (uint64_t{participants} * 4));
+    chunk = (chunk + CIPHER_PARALLEL_CHUNK_ALIGNMENT - 1) / CIPHER_PARALLEL_CHUNK_ALIGNMENT *
+            CIPHER_PARALLEL_CHUNK_ALIGNMENT;
+    uint64_t chunkCount = (size + chunk - 1) / chunk;
+    participants = static_cast<unsigned>(std::min<uint64_t>(participants, chunkCount));
+
+    if (participants <= 1) {
+        for (uint64_t begin = 0; begin < size; begin += chunk) fn(begin, std::min(begin + chunk, size), 0);
+        return;
+    }
+
+    auto job = std::make_shared<ParallelJob>();
+    job->size = size;
+    job->chunk = chunk;
+    job->chunkCount = chunkCount;
+    job->fn = &fn;
+    pool().run(job, participants);
+    if (job->error) std::rethrow_exception(job->error);
+}
+
+extern "C" {
+
+CIPHER_RUNTIME_API void cipher_runtime_set_threads(unsigned count) {
+    pool().setThreads(count);
+}
+
+CIPHER_RUNTIME_API unsigned cipher_runtime_threads(void) {
+    return pool().threads();
+}
+
+CIPHER_RUNTIME_API unsigned cipher_runtime_default_threads(void) {
+    // Значение читается один раз: квоты cgroup не меняются за время работы.
+    static const unsigned threads = [] {
+        unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<unsigned> allowed = allowedCpus();
+        if (!allowed.empty()) cpus = static_cast<unsigned>(allowed.size());
+#ifdef __linux__
+        double quota = cgroupCpuQuota();
+        if (quota > 0) cpus = std::min(cpus, static_cast<unsigned>(std::ceil(quota)));
+#endif
+        return std::max(1u, cpus);
+    }();
+    return threads;
+}
+
+CIPHER_RUNTIME_API void cipher_runtime_set_affinity(int enabled) {
+    pool().setAffinity(enabled != 0);
+}
+
+}
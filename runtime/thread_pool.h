@@ -0,0 +1,28 @@
+#ifndef CIPHER_THREAD_POOL_H
+#define CIPHER_THREAD_POOL_H
+
+// Параллельный цикл по байтовому диапазону на общем пуле потоков (см. cipher_runtime.h).
+
+#include "cipher_runtime.h"
+#include <cstdint>
+#include <functional>
+
+// Вызывается для части [begin, end); slot — номер участника цикла, меньший
+// participants: части одного участника выполняются последовательно, поэтому
+// по slot можно выбирать собственный буфер.
+using CipherRangeFunction = std::function<void(uint64_t begin, uint64_t end, unsigned slot)>;
+
+// Размер части по умолчанию и кратность, до которой округляется подсказка.
+constexpr uint64_t CIPHER_PARALLEL_MIN_CHUNK = 64 * 1024;
+constexpr uint64_t CIPHER_PARALLEL_CHUNK_ALIGNMENT = 4096;
+
+// Делит [0, size) на части по chunkHint байт (0 — по размеру и числу потоков;
+// подсказка округляется вверх до 4 КиБ, так что границы частей выровнены) и
+// выполняет fn не более чем participants участниками (0 — по числу потоков
+// пула). Вызывающий поток участвует в работе, поэтому цикл можно запускать и
+// из потоков пула. Первое исключение из fn останавливает раздачу частей и
+// пробрасывается после завершения уже начатых.
+CIPHER_RUNTIME_API void cipherParallelFor(uint64_t size, uint64_t chunkHint, unsigned participants,
+                                          const CipherRangeFunction& fn);
+
+#endif // CIPHER_THREAD_POOL_H